@@ -0,0 +1,76 @@
+/**
+ * @file executor.cpp
+ * @brief Executor process for out-of-process JIT compilation.
+ *
+ * This file contains the main function of slang-executor, the child process a Jit
+ * started with an executor runs its code in. The JIT (parsing, compiling, caches) stays
+ * in the host, which sends the executor the linked machine code and asks it to call
+ * pluhs over a pair of pipes. A crash in the program only takes the executor down.
+ *
+ * @author Sagar Patel
+ * @date 10-18-2026
+ *
+ * Project: S-Lang Compiler
+ */
+
+#include <llvm/ExecutionEngine/Orc/Shared/SimpleRemoteEPCUtils.h>
+#include <llvm/ExecutionEngine/Orc/TargetProcess/RegisterEHFrames.h>
+#include <llvm/ExecutionEngine/Orc/TargetProcess/SimpleExecutorMemoryManager.h>
+#include <llvm/ExecutionEngine/Orc/TargetProcess/SimpleRemoteEPCServer.h>
+#include <llvm/Support/DynamicLibrary.h>
+#include <llvm/Support/Error.h>
+#include <llvm/Support/raw_ostream.h>
+#include <string>
+
+/**
+ * @brief Main entry point of the executor.
+ *
+ * Serves the host on the given pipes until it disconnects (or its end of the pipes
+ * closes, eg. because it exited), then exits.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line argument strings: the file descriptors to read
+ * requests from and write results to.
+ * @return Returns 0 once the host disconnects, 1 if the connection failed.
+ */
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        llvm::errs() << "Usage: slang-executor <in-fd> <out-fd>\n"
+                     << "Started by slang with --isolate, not meant to be run "
+                     << "directly.\n";
+        return 1;
+    }
+    int in_fd = std::stoi(argv[1]);
+    int out_fd = std::stoi(argv[2]);
+
+    // Programs call into the executor's own symbols (eg. printf for yap), and the JIT
+    // looks up the ones registering unwind info by name, so they must be linked in.
+    llvm::sys::DynamicLibrary::LoadLibraryPermanently(nullptr);
+    volatile auto register_eh_frames = &llvm_orc_registerEHFrameSectionWrapper;
+    volatile auto deregister_eh_frames = &llvm_orc_deregisterEHFrameSectionWrapper;
+    (void)register_eh_frames;
+    (void)deregister_eh_frames;
+
+    using llvm::orc::SimpleRemoteEPCServer;
+    using Dispatcher = SimpleRemoteEPCServer::ThreadDispatcher;
+    auto server = SimpleRemoteEPCServer::Create<llvm::orc::FDSimpleRemoteEPCTransport>(
+        [](SimpleRemoteEPCServer::Setup& setup) -> llvm::Error {
+            setup.setDispatcher(std::make_unique<Dispatcher>());
+            setup.bootstrapSymbols() = SimpleRemoteEPCServer::defaultBootstrapSymbols();
+            setup.services().push_back(
+                std::make_unique<llvm::orc::rt_bootstrap::SimpleExecutorMemoryManager>());
+            return llvm::Error::success();
+        },
+        in_fd, out_fd);
+    if (!server) {
+        llvm::logAllUnhandledErrors(server.takeError(), llvm::errs(),
+                                    "[ERROR] slang-executor: ");
+        return 1;
+    }
+    if (llvm::Error error = (*server)->waitForDisconnect()) {
+        llvm::logAllUnhandledErrors(std::move(error), llvm::errs(),
+                                    "[ERROR] slang-executor: ");
+        return 1;
+    }
+    return 0;
+}
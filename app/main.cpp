@@ -13,7 +13,17 @@
  * Project: S-Lang Compiler
  */
 
+#include "batch.hpp"
+#include "repl.hpp"
 #include "slang.hpp"
+#include "stats.hpp"
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <chrono>
+#include <fcntl.h>
+#include <filesystem>
+#include <iomanip>
+#include <unistd.h>
 
 // Flag to check if verbose mode is enabled
 bool debug_mode = false;
@@ -51,31 +61,102 @@ void print_logo() {
  * 'output.ll'.
  *  - '-e': Print IR code.
  *  - '-v': Enable verbose mode for detailed output.
+ *  - '-j': JIT compile and run the program instead of writing IR.
+ *  - '-s': Keep snapshots of the JIT compiled code in a directory (implies '-j').
+ *  - '-O0' to '-O3': Optimization level of the JIT or executable [Default: -O2].
+ *  - '-f': Fuel budget of the JIT compiled program (implies '-j').
+ *  - '--isolate': Run the JIT compiled program in a child process (implies '-j').
+ *  - '--profile': Write a sampled profile of the JIT compiled program (implies '-j').
+ *  - '-p': JIT compile on a pipeline of threads (implies '-j').
+ *  - '--timeline': Write the timeline of the pipeline's threads to a file.
+ *  - '--jobs': Number of threads every parallel phase shares.
+ *  - '--stats': Print compiler statistics once done ('--stats=json' for JSON).
+ *  - '--lex-only', '--parse-only', '--check': Stop after lexing, parsing or checking.
+ *  - '--stream': Generate IR a declaration at a time, in bounded memory.
+ *  - '-o': Compile an executable instead of writing IR.
+ *  - '--static-runtime': Link the executable statically against the S-Lang runtime.
+ * A file path of '-' reads the program from stdin instead.
+ * 'slang repl' starts an interactive session instead of compiling a file.
+ * 'slang batch' compiles many files at once and runs the main pluh of each.
  *
  * @note This function terminates the program after displaying the help message.
  */
 void usage() {
     print_logo();
-    std::cout << "Usage: ./slang [options] [file]" << std::endl;
+    std::cout << "Usage: ./slang [options] [file|-]" << std::endl;
+    std::cout << "       ./slang --lex-only|--parse-only|--check [-v] [file|-...]"
+              << std::endl;
+    std::cout << "       ./slang repl [-v]" << std::endl;
+    std::cout << "       ./slang batch [-v] [-O<n>] [--jobs n] [-m formulas] [file...]"
+              << std::endl;
     std::cout << "Options:" << std::endl;
     std::cout << "  -h  Show this help message" << std::endl;
     std::cout << "  -r  Rename outputted IR file [Default: output.ll]" << std::endl;
     std::cout << "  -e  Print IR code" << std::endl;
     std::cout << "  -v  Enable verbose mode" << std::endl;
+    std::cout << "  -j  JIT compile and run the program instead of writing IR"
+              << std::endl;
+    std::cout << "  -s  Keep JIT snapshots in a directory for faster restarts "
+              << "(implies -j)" << std::endl;
+    std::cout << "  -O  Optimization level, -O0 to -O3 [Default: -O2]" << std::endl;
+    std::cout << "  -f  Stop the program once it runs out of fuel (implies -j)"
+              << std::endl;
+    std::cout << "  -p  JIT compile on a pipeline of threads (implies -j)" << std::endl;
+    std::cout << "  -o  Compile an executable instead of writing IR" << std::endl;
+    std::cout << "  --isolate     Run the program in a child process, so a crash only "
+              << "takes it down (implies -j)" << std::endl;
+    std::cout << "  --profile     Write a profile of the program (collapsed stacks, for "
+              << "flamegraphs) to a file (implies -j)" << std::endl;
+    std::cout << "  --jobs        Threads to compile on [Default: one per core]"
+              << std::endl;
+    std::cout << "  --timeline    Write the pipeline's timeline (Chrome trace) to a file"
+              << std::endl;
+    std::cout << "  --stats       Print compiler statistics to stderr once done"
+              << std::endl;
+    std::cout << "  --stats=json  Print compiler statistics as JSON instead" << std::endl;
+    std::cout << "  --stream      Generate IR one pluh at a time, in bounded memory"
+              << std::endl;
+    std::cout << "  --static-runtime  Link the executable statically against the "
+              << "S-Lang runtime instead of libc, for a faster startup" << std::endl;
+    std::cout << "  --lex-only    Only lex the files, without LLVM" << std::endl;
+    std::cout << "  --parse-only  Only lex and parse the files, without LLVM"
+              << std::endl;
+    std::cout << "  --check       Parse and check the files for errors, without LLVM"
+              << std::endl;
+    std::cout << "Batch options:" << std::endl;
+    std::cout << "  -m  Most files compiled into one module [Default: 512]" << std::endl;
     exit(1);
 }
 
+/**
+ * @brief Reads a stream with no known size to its end, a block at a time.
+ *
+ * @param in The stream to read.
+ *
+ * @return std::string -> Everything left in the stream.
+ */
+std::string read_to_end(std::istream& in) {
+    std::string content;
+    size_t size = 0;
+    do {
+        content.resize(size + (1 << 16));
+        in.read(content.data() + size, 1 << 16);
+        size += in.gcount();
+    } while (in);
+    content.resize(size);
+    return content;
+}
+
 /**
  * @brief Reads the contents of a file and returns it as a string.
  *
  * This function opens a file specified by 'file_path' and reads its contents into a
  * string. If the file cannot be opened or read, it throws a 'process_file_error'
- * exception. The function uses a standard input file stream (`std::ifstream`) to read
- * data, and a string stream
- * (`std::stringstream`) to collect the file's contents.
+ * exception. A file is read straight into a string of its size, so the contents are
+ * only held once (not again in a string stream), even for inputs of gigabytes.
  *
  * @param file_path A constant reference to a string containing the path to the file to be
- * processed.
+ * processed, or "-" to read stdin to its end.
  * @return A string containing the contents of the file.
  *
  * @throws process_file_error If the file cannot be opened or another file reading error
@@ -87,13 +168,22 @@ void usage() {
  */
 std::string process_file(const std::string& file_path) {
     try {
-        std::ifstream file(file_path);
+        if (file_path == "-") {
+            return read_to_end(std::cin);
+        }
+        std::ifstream file(file_path, std::ios::binary);
         if (!file.is_open()) {
             throw process_file_error("Error opening file!");
         }
-        std::stringstream buffer;
-        buffer << file.rdbuf();
-        std::string file_content = buffer.str();
+        std::error_code error;
+        if (!std::filesystem::is_regular_file(file_path, error)) {
+            // Pipes (eg. process substitution) have no size to read up to.
+            return read_to_end(file);
+        }
+        std::string file_content(std::filesystem::file_size(file_path), '\0');
+        if (!file.read(file_content.data(), file_content.size())) {
+            throw process_file_error("Error reading file!");
+        }
         return file_content;
     } catch (const std::exception& e) {
         std::cerr << "[ERROR] " << e.what() << std::endl;
@@ -104,6 +194,25 @@ std::string process_file(const std::string& file_path) {
     }
 }
 
+/**
+ * @brief Opens a file to read source code from a chunk at a time (see Lexer).
+ *
+ * @param file_path The path of the file, or "-" for stdin.
+ * @return int -> The file descriptor, STDIN_FILENO for "-".
+ *
+ * @throws process_file_error If the file cannot be opened.
+ */
+int open_source(const std::string& file_path) {
+    if (file_path == "-") {
+        return STDIN_FILENO;
+    }
+    int fd = open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw process_file_error("Error opening file!");
+    }
+    return fd;
+}
+
 /**
  * @brief Processes individual flag characters from a command-line argument string.
  *
@@ -111,14 +220,17 @@ std::string process_file(const std::string& file_path) {
  * character as a separate command-line flag. It supports several flags:
  *  - 'h': Calls the 'usage()' function to display help information.
  *  - 'e': Enables IR code printing by setting 'print_IR' to true.
+ *  - 'j': Enables JIT mode by setting 'run_jit' to true.
  *  - 'v': Enables verbose mode by setting the global 'debug_mode' to true.
  * If an unrecognized flag is encountered, it calls 'usage()' to display help information.
  *
  * @param flags A constant reference to a string containing the flag characters.
  * @param print_IR A reference to a boolean that is set to true if the 'e' flag is
  * present.
+ * @param run_jit A reference to a boolean that is set to true if the 'j' flag is
+ * present.
  */
-void process_single_flags(const std::string& flags, bool& print_IR) {
+void process_single_flags(const std::string& flags, bool& print_IR, bool& run_jit) {
     for (const char flag : flags) {
         switch (flag) {
         case 'h':
@@ -132,6 +244,10 @@ void process_single_flags(const std::string& flags, bool& print_IR) {
             print_IR = true;
             debug << "[DEBUG] IR code will be printed." << std::endl;
             break;
+        case 'j':
+            run_jit = true;
+            debug << "[DEBUG] Program will be JIT compiled and run." << std::endl;
+            break;
         default:
             debug << "[DEBUG] Invalid flag: " << flag << std::endl;
             usage();
@@ -139,6 +255,187 @@ void process_single_flags(const std::string& flags, bool& print_IR) {
     }
 }
 
+/**
+ * @brief Processes a statistics flag, enabling statistics if it is one.
+ *
+ * @param arg The command-line argument.
+ * @param stats_format Set to "text" for '--stats' or "json" for '--stats=json'.
+ * @return true if the argument was a statistics flag, false otherwise.
+ */
+bool process_stats_flag(const std::string& arg, std::string& stats_format) {
+    if (arg != "--stats" && arg != "--stats=json") {
+        return false;
+    }
+    stats_format = arg == "--stats" ? "text" : "json";
+    Statistic::enable();
+    debug << "[DEBUG] Compiler statistics enabled." << std::endl;
+    return true;
+}
+
+/**
+ * @brief Processes a '--jobs' flag, setting the workers of the shared scheduler if it
+ * is one.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line argument strings.
+ * @param i Index of the argument, moved past the number of jobs.
+ * @return true if the argument was a '--jobs' flag, false otherwise.
+ *
+ * @throws std::invalid_argument If the number of jobs is missing or invalid.
+ */
+bool process_jobs_flag(int argc, char* argv[], int& i) {
+    if (std::string(argv[i]) != "--jobs") {
+        return false;
+    }
+    if (i + 1 >= argc) {
+        throw std::invalid_argument("No number specified for --jobs option.");
+    }
+    int jobs = std::stoi(argv[++i]);
+    if (jobs < 0) {
+        throw std::invalid_argument("Jobs must not be negative.");
+    }
+    Scheduler::set_shared_workers(jobs);
+    debug << "[DEBUG] Compiling on " << jobs << " jobs." << std::endl;
+    return true;
+}
+
+/**
+ * @brief Prints the compiler statistics to stderr, if they were asked for, along with
+ * the utilization of the scheduler's workers if any ran.
+ *
+ * @param stats_format "text", "json", or empty if they weren't asked for.
+ */
+void print_stats(const std::string& stats_format) {
+    if (stats_format == "text") {
+        Statistic::print(std::cerr);
+    } else if (stats_format == "json") {
+        Statistic::print_json(std::cerr);
+    }
+    if (!stats_format.empty() && Scheduler::has_shared()) {
+        Scheduler::get_shared().print_utilization(std::cerr);
+    }
+}
+
+/**
+ * @brief Runs the front end of the compiler over files, stopping after a phase.
+ *
+ * None of the phases touch LLVM, so this is cheap enough to run over thousands of files,
+ * eg. as a pre-commit check. Every file that fails is reported on stderr. Files are read
+ * a chunk at a time as they're lexed, so lexing alone runs in constant memory however
+ * large the input (eg. generated code piped into '-').
+ *
+ * @param phase "lex", "parse" or "check", the last phase to run.
+ * @param paths The files to run it over.
+ * @return Returns 0 if every file passed, 1 otherwise.
+ */
+int run_front_end(const std::string& phase, const std::vector<std::string>& paths) {
+    int status = 0;
+    for (const auto& path : paths) {
+        debug << "[DEBUG] Processing file: " << path << std::endl;
+        int fd = -1;
+        try {
+            fd = open_source(path);
+            if (phase == "lex") {
+                Lexer lexer(fd);
+                size_t tokens = 0;
+                while (lexer.get_token().first != TokenType::END_OF_FILE) {
+                    ++tokens;
+                }
+                debug << "[DEBUG] Tokens lexed: " << tokens << std::endl;
+            } else {
+                Parser parser(fd);
+                TeaSpill tea = parser.parse_tea();
+                if (phase == "check") {
+                    Checker checker;
+                    checker.check(tea);
+                }
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "[ERROR] " << path << ": " << e.what() << std::endl;
+            status = 1;
+        }
+        if (fd > STDIN_FILENO) {
+            close(fd);
+        }
+    }
+    if (status == 0) {
+        std::cerr << "[INFO] " << paths.size() << " files passed." << std::endl;
+    }
+    return status;
+}
+
+/**
+ * @brief Compiles many files as one batch, then runs the main pluh of each in order.
+ *
+ * The compile time of the batch, and the time per file, is reported on stderr.
+ *
+ * @param argc The number of command-line arguments.
+ * @param argv The array of command-line argument strings, starting with "batch".
+ * @return Returns 0 if every file compiled, 1 otherwise.
+ */
+int run_batch(int argc, char* argv[]) {
+    size_t formulas_per_module = 512;    // Most files compiled into one module
+    unsigned opt_level = 2;              // JIT optimization level
+    std::vector<std::string> paths = {}; // Files to compile
+    bool print_IR = false;               // Unused, batches don't write any IR.
+    bool run_jit = false;                // Unused, batches always JIT compile.
+    std::string stats_format = "";       // Format to print statistics in, if any
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (process_jobs_flag(argc, argv, i)) {
+                continue;
+            } else if (arg == "-m" && i + 1 < argc) {
+                formulas_per_module = std::stoul(argv[++i]);
+            } else if (arg.size() == 3 && arg[1] == 'O' && arg[2] >= '0' &&
+                       arg[2] <= '3') {
+                opt_level = arg[2] - '0';
+            } else if (process_stats_flag(arg, stats_format)) {
+                continue;
+            } else if (arg[0] == '-') {
+                process_single_flags(arg.substr(1), print_IR, run_jit);
+            } else {
+                paths.push_back(arg);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "[ERROR] " << e.what() << std::endl;
+        usage();
+    }
+
+    std::vector<std::string> sources = {};
+    for (const auto& path : paths) {
+        sources.push_back(process_file(path));
+    }
+    try {
+        BatchCompiler compiler("main", nullptr, formulas_per_module, opt_level);
+        auto start = std::chrono::steady_clock::now();
+        std::vector<Formula> formulas = compiler.compile(sources);
+        auto compiled = std::chrono::steady_clock::now();
+        double ms = std::chrono::duration<double, std::milli>(compiled - start).count();
+        std::cerr << std::fixed << std::setprecision(2) << "[INFO] Compiled "
+                  << sources.size() << " files in " << ms << " ms ("
+                  << (sources.empty() ? 0 : ms * 1000 / sources.size()) << " us per file)"
+                  << std::endl;
+
+        int status = 0;
+        for (size_t i = 0; i < formulas.size(); ++i) {
+            if (!formulas[i].error.empty()) {
+                std::cerr << "[ERROR] " << paths[i] << ": " << formulas[i].error
+                          << std::endl;
+                status = 1;
+                continue;
+            }
+            reinterpret_cast<int (*)()>(formulas[i].address)();
+        }
+        print_stats(stats_format);
+        return status;
+    } catch (const std::exception& e) {
+        std::cerr << "[ERROR] " << e.what() << std::endl;
+        return 1;
+    }
+}
+
 /**
  * @brief Main entry point of the program.
  *
@@ -146,6 +443,18 @@ void process_single_flags(const std::string& flags, bool& print_IR) {
  * program. It requires at least one argument (file path). The function supports several
  * options:
  *  - '-r': Specify a custom name for the output file.
+ *  - '-s': Specify a directory for JIT snapshots.
+ *  - '-O<n>': Specify the JIT optimization level.
+ *  - '-f': Specify the fuel budget of the program.
+ *  - '--isolate': Run the program in slang-executor, next to this binary.
+ *  - '-p': JIT compile on a pipeline of threads.
+ *  - '--jobs': Specify the threads to compile on.
+ *  - '--timeline': Specify a file for the pipeline's timeline.
+ *  - '--stats': Print compiler statistics, as text or '--stats=json'.
+ *  - '--lex-only', '--parse-only', '--check': Run the front end over one or more files.
+ *  - '--stream': Generate IR one declaration at a time.
+ *  - '-o': Specify an executable to compile the program into.
+ *  - '--static-runtime': Link the executable against the static runtime.
  *  - Other flags processed by the 'process_single_flags' function.
  * If the required file path is not provided or multiple file paths are given, it throws
  * an exception. After processing arguments, it proceeds to read the file content and
@@ -164,17 +473,53 @@ int main(int argc, char* argv[]) {
     if (argc < 2) {
         usage();
     }
+    if (std::string(argv[1]) == "repl") {
+        bool print_IR = false; // Unused, the REPL doesn't write any IR.
+        bool run_jit = false;  // Unused, the REPL always JIT compiles.
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg[0] != '-') {
+                usage();
+            }
+            process_single_flags(arg.substr(1), print_IR, run_jit);
+        }
+        print_logo();
+        try {
+            Repl repl;
+            repl.run(std::cin);
+        } catch (const std::exception& e) {
+            std::cerr << "[ERROR] " << e.what() << std::endl;
+            exit(1);
+        }
+        return 0;
+    }
+    if (std::string(argv[1]) == "batch") {
+        return run_batch(argc, argv);
+    }
     std::string file_path = "";         // Path to file to be processed
     std::string content = "";           // Content of file to be processed
     bool emit_IR = false;               // Flag to check if IR code should be printed
     std::string filename = "output.ll"; // Name of output file
-    bool file_path_set = false;         // Flag to check if file path has been set
+    bool run_jit = false;               // Flag to check if the program should be run
+    std::string snapshot_dir = "";      // Directory for JIT snapshots
+    unsigned opt_level = 2;             // JIT optimization level
+    int64_t fuel = -1;                  // Fuel budget of the program, -1 for unmetered
+    std::string stats_format = "";      // Format to print statistics in, if any
+    std::string front_end = "";         // Last front end phase to run, if not compiling
+    std::vector<std::string> paths = {}; // Paths of the files to be processed
+    bool stream = false;                // Flag to check if IR should be streamed
+    bool pipeline = false;              // Flag to check if the JIT should pipeline
+    bool isolate = false;               // Flag to check if the program runs in a child
+    std::string timeline_file = "";     // File for the pipeline's timeline
+    std::string executable = "";        // Executable to compile, if any
+    bool static_runtime = false;        // Flag to check if the runtime is linked in
+    std::string profile_file = "";      // File for the program's profile, if any
 
     try {
         for (int i = 1; i < argc; ++i) {
             std::string arg = argv[i];
             debug << "[DEBUG] Processing argument: " << arg << std::endl;
-            if (arg[0] == '-') {
+            if (arg[0] == '-' && arg != "-") {
                 if (arg == "-r") {
                     if (i + 1 < argc) {
                         filename = argv[++i];
@@ -182,19 +527,101 @@ int main(int argc, char* argv[]) {
                         throw std::invalid_argument(
                             "No filename specified for -r option.");
                     }
+                } else if (arg == "-s") {
+                    if (i + 1 < argc) {
+                        snapshot_dir = argv[++i];
+                        run_jit = true;
+                    } else {
+                        throw std::invalid_argument(
+                            "No directory specified for -s option.");
+                    }
+                } else if (arg == "-f") {
+                    if (i + 1 < argc) {
+                        fuel = std::stoll(argv[++i]);
+                        if (fuel < 0) {
+                            throw std::invalid_argument("Fuel must not be negative.");
+                        }
+                        run_jit = true;
+                    } else {
+                        throw std::invalid_argument("No fuel specified for -f option.");
+                    }
+                } else if (arg == "-o") {
+                    if (i + 1 < argc) {
+                        executable = argv[++i];
+                    } else {
+                        throw std::invalid_argument(
+                            "No filename specified for -o option.");
+                    }
+                } else if (arg == "--static-runtime") {
+                    static_runtime = true;
+                } else if (arg == "-p") {
+                    pipeline = true;
+                    run_jit = true;
+                } else if (arg == "--isolate") {
+                    isolate = true;
+                    run_jit = true;
+                } else if (arg == "--profile") {
+                    if (i + 1 < argc) {
+                        profile_file = argv[++i];
+                        run_jit = true;
+                    } else {
+                        throw std::invalid_argument(
+                            "No filename specified for --profile option.");
+                    }
+                } else if (process_jobs_flag(argc, argv, i)) {
+                    continue;
+                } else if (arg == "--timeline") {
+                    if (i + 1 < argc) {
+                        timeline_file = argv[++i];
+                    } else {
+                        throw std::invalid_argument(
+                            "No filename specified for --timeline option.");
+                    }
+                } else if (arg.size() == 3 && arg[1] == 'O' && arg[2] >= '0' &&
+                           arg[2] <= '3') {
+                    opt_level = arg[2] - '0';
+                } else if (process_stats_flag(arg, stats_format)) {
+                    continue;
+                } else if (arg == "--stream") {
+                    stream = true;
+                } else if (arg == "--lex-only" || arg == "--parse-only" ||
+                           arg == "--check") {
+                    front_end = arg == "--lex-only"     ? "lex"
+                                : arg == "--parse-only" ? "parse"
+                                                        : "check";
                 } else {
-                    process_single_flags(arg.substr(1), emit_IR);
+                    process_single_flags(arg.substr(1), emit_IR, run_jit);
                 }
-            } else if (!file_path_set) {
-                file_path = arg;
-                file_path_set = true;
             } else {
-                throw std::invalid_argument("Multiple file paths provided.");
+                paths.push_back(arg);
             }
         }
 
-        if (file_path.empty())
+        // Only the front end runs over several files at once.
+        if (front_end.empty() && paths.size() > 1) {
+            throw std::invalid_argument("Multiple file paths provided.");
+        }
+        if (paths.empty())
             throw std::invalid_argument("No file path/content provided.");
+        if (isolate && (fuel >= 0 || pipeline)) {
+            throw std::invalid_argument("--isolate can't be combined with -f or -p.");
+        }
+        if (!profile_file.empty() && (isolate || pipeline)) {
+            throw std::invalid_argument(
+                "--profile can't be combined with --isolate or -p.");
+        }
+#if !defined(__linux__)
+        if (!profile_file.empty()) {
+            throw std::invalid_argument("--profile is only supported on Linux.");
+        }
+#endif
+        if (!executable.empty() && run_jit) {
+            throw std::invalid_argument("-o can't be combined with JIT options.");
+        }
+        if (static_runtime && executable.empty()) {
+            throw std::invalid_argument("--static-runtime needs -o.");
+        }
+        file_path = paths.front();
 
     } catch (const std::exception& e) {
         std::cerr << "[ERROR] " << e.what() << std::endl;
@@ -204,7 +631,16 @@ int main(int argc, char* argv[]) {
         usage();
     }
 
-    print_logo();
+    if (!front_end.empty()) {
+        int status = run_front_end(front_end, paths);
+        print_stats(stats_format);
+        return status;
+    }
+
+    // JIT mode only prints what the program does.
+    if (!run_jit) {
+        print_logo();
+    }
     debug << "[DEBUG] File path: " << file_path << std::endl;
     debug << "[DEBUG] Output file name: " << filename << std::endl;
     debug << "[DEBUG] Processing file..." << std::endl;
@@ -213,11 +649,50 @@ int main(int argc, char* argv[]) {
 
     debug << "[DEBUG] File processed." << std::endl;
 
-    Slang slang(content);
-    if (emit_IR) {
-        slang.print_IR();
+    try {
+        Slang slang(std::move(content), fuel, stream);
+        if (emit_IR) {
+            slang.print_IR();
+        }
+        if (!executable.empty()) {
+            // The runtime is installed with the libraries, next to slang's directory.
+            std::string runtime = "";
+            if (static_runtime) {
+                llvm::SmallString<256> path(llvm::sys::fs::getMainExecutable(
+                    argv[0], reinterpret_cast<void*>(&usage)));
+                llvm::sys::path::remove_filename(path);
+                llvm::sys::path::append(path, "..", "lib", "libslang_rt.a");
+                runtime = path.str().str();
+            }
+            slang.compile_executable(executable, opt_level, runtime);
+            print_stats(stats_format);
+            return 0;
+        }
+        if (run_jit && pipeline) {
+            int result = slang.run_pipelined(opt_level, timeline_file);
+            print_stats(stats_format);
+            return result;
+        }
+        if (run_jit) {
+            // The executor is installed next to slang.
+            std::string executor = "";
+            if (isolate) {
+                llvm::SmallString<256> path(llvm::sys::fs::getMainExecutable(
+                    argv[0], reinterpret_cast<void*>(&usage)));
+                llvm::sys::path::remove_filename(path);
+                llvm::sys::path::append(path, "slang-executor");
+                executor = path.str().str();
+            }
+            int result = slang.run_jit(snapshot_dir, opt_level, executor, profile_file);
+            print_stats(stats_format);
+            return result;
+        }
+        slang.write_to_file(filename);
+        print_stats(stats_format);
+    } catch (const std::exception& e) {
+        std::cerr << "[ERROR] " << e.what() << std::endl;
+        exit(1);
     }
-    slang.write_to_file(filename);
 
     return 0;
 }
@@ -0,0 +1,115 @@
+// Measures how much memory the AST of a large program takes, and how fast it's built.
+//
+// Generates a program of pluhs in the style of benchmarks/nbody.slg: arithmetic over
+// variables and literals, conditions, loops and calls. It's parsed into an AST that's
+// kept alive, and the heap the AST holds, the allocations that built it and the best
+// parse throughput of a few runs are reported, along with the sizes of its handles and
+// nodes.
+//
+// Usage: bench_ast [-p pluhs] [-n runs]
+
+#include "parser.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <malloc.h>
+#include <new>
+#include <optional>
+#include <string>
+
+bool debug_mode = false;
+DebugStream debug;
+
+static size_t allocations = 0; // Calls to operator new so far.
+
+void* operator new(size_t size) {
+    ++allocations;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+// Returns a program of `pluhs` pluhs, each calling the one before it.
+std::string generate(int pluhs) {
+    std::string code = "spillingTeaAbout ast\nplug sqrt(x : float) : float\n";
+    for (int i = 0; i < pluhs; ++i) {
+        std::string name = "step" + std::to_string(i);
+        std::string callee = "step" + std::to_string(i == 0 ? 0 : i - 1);
+        code += "pluh " + name + "(n : int, x : float) : float {\n"
+                "    cookUp total : float = x * 2.5 + n / 3 - 0.1\n"
+                "    cookUp i : int = 0\n"
+                "    holdUp i < n {\n"
+                "        fr? i % 2 == 0 {\n"
+                "            total = total + " + callee + "(i - 1, x * 0.5)\n"
+                "        } justLikeThat? {\n"
+                "            total = total - sqrt(x * x + 1.25) / (i + 1)\n"
+                "        }\n"
+                "        i = i + 1\n"
+                "    }\n"
+                "    yeet total * (x + 1.0) - n\n"
+                "}\n";
+    }
+    return code;
+}
+
+int main(int argc, char* argv[]) {
+    int pluhs = 100000;
+    int runs = 3;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        if (flag == "-p") {
+            pluhs = std::stoi(argv[i + 1]);
+        } else if (flag == "-n") {
+            runs = std::stoi(argv[i + 1]);
+        } else {
+            std::cerr << "Usage: bench_ast [-p pluhs] [-n runs]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::string code = generate(pluhs);
+    double megabytes = double(code.size()) / 1e6;
+    std::printf("pluhs: %d, source: %.1f MB\n", pluhs, megabytes);
+    std::printf("sizeof: Expression %zu, Statement %zu, BinaryExpression %zu, "
+                "FrOngJustLikeThatStatement %zu\n",
+                sizeof(Expression), sizeof(Statement), sizeof(BinaryExpression),
+                sizeof(FrOngJustLikeThatStatement));
+
+    // The AST is measured once the parser (and its lexer's buffer) is gone.
+    size_t heap_before = mallinfo2().uordblks;
+    size_t allocations_before = allocations;
+    std::optional<TeaSpill> tea;
+    {
+        Parser parser(code);
+        tea.emplace(parser.parse_tea());
+    }
+    double held = double(mallinfo2().uordblks - heap_before);
+    size_t built = allocations - allocations_before;
+
+    double best = 0;
+    for (int run = 0; run < runs; ++run) {
+        auto begin = std::chrono::steady_clock::now();
+        Parser parser(code);
+        TeaSpill parsed = parser.parse_tea();
+        double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - begin)
+                             .count();
+        best = run == 0 ? seconds : std::min(best, seconds);
+    }
+
+    std::printf("%12s %14s %16s %12s\n", "AST (MB)", "allocations", "bytes/src byte",
+                "parse MB/s");
+    std::printf("%12.1f %14zu %16.2f %12.2f\n", held / 1e6, built,
+                held / double(code.size()), megabytes / best);
+    return tea->get_declarations().empty();
+}
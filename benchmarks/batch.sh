@@ -0,0 +1,92 @@
+#!/bin/bash
+
+# Measures the amortized compile latency of a formula as the batch size grows.
+#
+# Generates $FORMULAS tiny programs (formulas), then for every batch size compiles the
+# first that many of them with `slang batch`, once with one module per formula and once
+# batched into shared modules. The best of $RUNS runs of each is reported as the compile
+# time per formula, which doesn't include starting slang or running the formulas.
+#
+# Usage: benchmarks/batch.sh [-b "1 10 100 1000"] [-t threads] [-n runs]
+#
+# Environment:
+#   SLANG     Path to the slang binary           [Default: build/bin/slang]
+#   OUT_DIR   Where the formulas go              [Default: benchmarks/out]
+
+set -e
+
+BENCH_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+ROOT_DIR="$(dirname "$BENCH_DIR")"
+
+SLANG="${SLANG:-$ROOT_DIR/build/bin/slang}"
+OUT_DIR="${OUT_DIR:-$BENCH_DIR/out}"
+BATCH_SIZES="1 10 100 1000"
+THREADS=0
+RUNS=3
+
+while getopts "b:t:n:h" flag; do
+    case "$flag" in
+    b) BATCH_SIZES="$OPTARG" ;;
+    t) THREADS="$OPTARG" ;;
+    n) RUNS="$OPTARG" ;;
+    *)
+        sed -n '3,14p' "${BASH_SOURCE[0]}" | sed 's/^# \{0,1\}//'
+        exit 1
+        ;;
+    esac
+done
+
+if [ ! -x "$SLANG" ]; then
+    echo "[ERROR] slang not found at $SLANG (build the project or set SLANG)" >&2
+    exit 1
+fi
+
+formulas="$OUT_DIR/batch_formulas"
+mkdir -p "$formulas"
+largest=$(echo "$BATCH_SIZES" | tr ' ' '\n' | sort -n | tail -1)
+
+# Every formula gets different constants so none of them are identical.
+for i in $(seq "$largest"); do
+    cat >"$formulas/f$i.slg" <<EOF2
+spillingTeaAbout formula$i
+
+pluh score(x : int) : int {
+    fr? (x > $i) {
+        yeet (x * $((i % 7 + 2)) + $i) % 1000
+    }
+    yeet x - $i
+}
+
+pluh main() : int {
+    yeet score($((i * 3)))
+}
+EOF2
+done
+
+# Prints the best compile time per formula of compiling the first $1 formulas $RUNS
+# times, in microseconds, with at most $2 formulas per module.
+best_us_per_formula() {
+    local files=()
+    for i in $(seq "$1"); do
+        files+=("$formulas/f$i.slg")
+    done
+    local best=""
+    for _ in $(seq "$RUNS"); do
+        local us
+        us=$("$SLANG" batch --jobs "$THREADS" -m "$2" "${files[@]}" 2>&1 >/dev/null |
+            sed -n 's/.*(\([0-9.]*\) us per file).*/\1/p')
+        if [ -z "$best" ] || awk -v a="$us" -v b="$best" 'BEGIN { exit !(a < b) }'; then
+            best=$us
+        fi
+    done
+    echo "$best"
+}
+
+printf "%-10s %18s %18s %10s\n" "formulas" "separate (us/f)" "batched (us/f)" "speedup"
+for size in $BATCH_SIZES; do
+    separate=$(best_us_per_formula "$size" 1)
+    batched=$(best_us_per_formula "$size" 512)
+    speedup=$(awk -v s="$separate" -v b="$batched" \
+        'BEGIN { if (b == 0) b = 1; printf "%.2f", s / b }')
+    printf "%-10s %18s %18s %10s\n" "$size" "$separate" "$batched" "$speedup"
+done
@@ -0,0 +1,56 @@
+/* binary-trees with a maximum depth of 16: allocates and walks many perfect binary
+ * trees while one long-lived tree stays alive. */
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct Node {
+    struct Node* left;
+    struct Node* right;
+} Node;
+
+static Node* make_tree(int depth) {
+    Node* node = malloc(sizeof(Node));
+    if (depth == 0) {
+        node->left = node->right = NULL;
+    } else {
+        node->left = make_tree(depth - 1);
+        node->right = make_tree(depth - 1);
+    }
+    return node;
+}
+
+static int check_tree(const Node* node) {
+    if (!node->left)
+        return 1;
+    return 1 + check_tree(node->left) + check_tree(node->right);
+}
+
+static void free_tree(Node* node) {
+    if (node->left) {
+        free_tree(node->left);
+        free_tree(node->right);
+    }
+    free(node);
+}
+
+int main(void) {
+    int min_depth = 4, max_depth = 16;
+
+    Node* stretch = make_tree(max_depth + 1);
+    printf("%d\n", check_tree(stretch));
+    free_tree(stretch);
+
+    Node* long_lived = make_tree(max_depth);
+    for (int depth = min_depth; depth <= max_depth; depth += 2) {
+        int iterations = 1 << (max_depth - depth + min_depth);
+        int check = 0;
+        for (int i = 0; i < iterations; ++i) {
+            Node* tree = make_tree(depth);
+            check += check_tree(tree);
+            free_tree(tree);
+        }
+        printf("%d\n", check);
+    }
+    printf("%d\n", check_tree(long_lived));
+    return 0;
+}
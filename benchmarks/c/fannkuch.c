@@ -0,0 +1,62 @@
+/* fannkuch-redux for n = 10: walks every permutation, counting pancake flips.
+ * Prints the checksum followed by the maximum number of flips. */
+#include <stdio.h>
+#include <stdlib.h>
+
+static int fannkuch(int n, int* checksum_out) {
+    int* perm = calloc((size_t)n, sizeof(int));
+    int* perm1 = calloc((size_t)n, sizeof(int));
+    int* count = calloc((size_t)n, sizeof(int));
+    int max_flips = 0, perm_count = 0, checksum = 0;
+    for (int i = 0; i < n; ++i)
+        perm1[i] = i;
+    int r = n;
+    for (;;) {
+        while (r != 1) {
+            count[r - 1] = r;
+            --r;
+        }
+        for (int i = 0; i < n; ++i)
+            perm[i] = perm1[i];
+        int flips = 0;
+        int k = perm[0];
+        while (k != 0) {
+            for (int lo = 0, hi = k; lo < hi; ++lo, --hi) {
+                int tmp = perm[lo];
+                perm[lo] = perm[hi];
+                perm[hi] = tmp;
+            }
+            ++flips;
+            k = perm[0];
+        }
+        if (flips > max_flips)
+            max_flips = flips;
+        checksum += perm_count % 2 == 0 ? flips : -flips;
+        for (;;) {
+            if (r == n) {
+                *checksum_out = checksum;
+                free(perm);
+                free(perm1);
+                free(count);
+                return max_flips;
+            }
+            int perm0 = perm1[0];
+            for (int i = 0; i < r; ++i)
+                perm1[i] = perm1[i + 1];
+            perm1[r] = perm0;
+            --count[r];
+            if (count[r] > 0)
+                break;
+            ++r;
+        }
+        ++perm_count;
+    }
+}
+
+int main(void) {
+    int checksum = 0;
+    int max_flips = fannkuch(10, &checksum);
+    printf("%d\n", checksum);
+    printf("%d\n", max_flips);
+    return 0;
+}
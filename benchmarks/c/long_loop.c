@@ -0,0 +1,18 @@
+/* A main that spends its whole life in one loop. Stresses time to peak performance. */
+#include <stdio.h>
+
+int main(void) {
+    int iterations = 200000000;
+    int x = 1;
+    int sum = 0;
+    double acc = 0.0;
+    for (int i = 0; i < iterations; ++i) {
+        x = (x * 1103 + 12345) % 65536;
+        if (x % 3 == 0)
+            sum = (sum + x) % 1000003;
+        acc = acc + x * 0.5;
+    }
+    printf("%d\n", sum);
+    printf("%f\n", acc);
+    return 0;
+}
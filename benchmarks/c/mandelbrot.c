@@ -0,0 +1,29 @@
+/* Counts the points of a 1200x1200 grid that stay inside the Mandelbrot set after
+ * 50 iterations (the classic version writes them out as a bitmap instead). */
+#include <stdio.h>
+
+static int in_set(double cr, double ci) {
+    double zr = 0.0, zi = 0.0;
+    for (int i = 0; i < 50; ++i) {
+        double tr = zr * zr - zi * zi + cr;
+        zi = 2.0 * zr * zi + ci;
+        zr = tr;
+        if (zr * zr + zi * zi > 4.0)
+            return 0;
+    }
+    return 1;
+}
+
+int main(void) {
+    int n = 1200;
+    int inside = 0;
+    for (int y = 0; y < n; ++y) {
+        double ci = 2.0 * y / n - 1.0;
+        for (int x = 0; x < n; ++x) {
+            double cr = 2.0 * x / n - 1.5;
+            inside += in_set(cr, ci);
+        }
+    }
+    printf("%d\n", inside);
+    return 0;
+}
@@ -0,0 +1,103 @@
+/* Jovian planets n-body simulation, 1 million steps of 0.01. */
+#include <math.h>
+#include <stdio.h>
+
+#define PI 3.141592653589793
+#define SOLAR_MASS (4.0 * PI * PI)
+#define DAYS_PER_YEAR 365.24
+
+typedef struct {
+    double x, y, z, vx, vy, vz, mass;
+} Body;
+
+static Body make_body(double x, double y, double z, double vx, double vy, double vz,
+                      double mass) {
+    Body b = {x,
+              y,
+              z,
+              vx * DAYS_PER_YEAR,
+              vy * DAYS_PER_YEAR,
+              vz * DAYS_PER_YEAR,
+              mass * SOLAR_MASS};
+    return b;
+}
+
+static void offset_momentum(Body* bodies, int n) {
+    double px = 0.0, py = 0.0, pz = 0.0;
+    for (int i = 0; i < n; ++i) {
+        px += bodies[i].vx * bodies[i].mass;
+        py += bodies[i].vy * bodies[i].mass;
+        pz += bodies[i].vz * bodies[i].mass;
+    }
+    bodies[0].vx = 0.0 - px / bodies[0].mass;
+    bodies[0].vy = 0.0 - py / bodies[0].mass;
+    bodies[0].vz = 0.0 - pz / bodies[0].mass;
+}
+
+static double energy(const Body* bodies, int n) {
+    double e = 0.0;
+    for (int i = 0; i < n; ++i) {
+        const Body* b = &bodies[i];
+        e += 0.5 * b->mass * (b->vx * b->vx + b->vy * b->vy + b->vz * b->vz);
+        for (int j = i + 1; j < n; ++j) {
+            double dx = b->x - bodies[j].x;
+            double dy = b->y - bodies[j].y;
+            double dz = b->z - bodies[j].z;
+            e -= b->mass * bodies[j].mass / sqrt(dx * dx + dy * dy + dz * dz);
+        }
+    }
+    return e;
+}
+
+static void advance(Body* bodies, int n, double dt) {
+    for (int i = 0; i < n; ++i) {
+        for (int j = i + 1; j < n; ++j) {
+            double dx = bodies[i].x - bodies[j].x;
+            double dy = bodies[i].y - bodies[j].y;
+            double dz = bodies[i].z - bodies[j].z;
+            double d2 = dx * dx + dy * dy + dz * dz;
+            double mag = dt / (d2 * sqrt(d2));
+            bodies[i].vx -= dx * bodies[j].mass * mag;
+            bodies[i].vy -= dy * bodies[j].mass * mag;
+            bodies[i].vz -= dz * bodies[j].mass * mag;
+            bodies[j].vx += dx * bodies[i].mass * mag;
+            bodies[j].vy += dy * bodies[i].mass * mag;
+            bodies[j].vz += dz * bodies[i].mass * mag;
+        }
+    }
+    for (int i = 0; i < n; ++i) {
+        bodies[i].x += dt * bodies[i].vx;
+        bodies[i].y += dt * bodies[i].vy;
+        bodies[i].z += dt * bodies[i].vz;
+    }
+}
+
+int main(void) {
+    Body bodies[5] = {
+        /* sun */
+        make_body(0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 1.0),
+        /* jupiter */
+        make_body(4.84143144246472090, -1.16032004402742839, -0.103622044471123109,
+                  0.00166007664274403694, 0.00769901118419740425,
+                  -0.0000690460016972063023, 0.000954791938424326609),
+        /* saturn */
+        make_body(8.34336671824457987, 4.12479856412430479, -0.403523417114321381,
+                  -0.00276742510726862411, 0.00499852801234917238,
+                  0.0000230417297573763929, 0.000285885980666130812),
+        /* uranus */
+        make_body(12.8943695621391310, -15.1111514016986312, -0.223307578892655734,
+                  0.00296460137564761618, 0.00237847173959480950,
+                  -0.0000296589568540237556, 0.0000436624404335156298),
+        /* neptune */
+        make_body(15.3796971148509165, -25.9193146099879641, 0.179258772950371181,
+                  0.00268067772490389322, 0.00162824170038242295,
+                  -0.0000951592254519715870, 0.0000515138902046611451),
+    };
+    int n = 5;
+    offset_momentum(bodies, n);
+    printf("%f\n", energy(bodies, n));
+    for (int step = 0; step < 1000000; ++step)
+        advance(bodies, n, 0.01);
+    printf("%f\n", energy(bodies, n));
+    return 0;
+}
@@ -0,0 +1,24 @@
+/* Sieve of Eratosthenes counting the primes below 10 million. */
+#include <stdio.h>
+#include <stdlib.h>
+
+static int count_primes(int limit) {
+    int* composite = calloc((size_t)limit, sizeof(int));
+    int count = 0;
+    for (int i = 2; i < limit; ++i) {
+        if (composite[i] == 0) {
+            ++count;
+            if (i <= limit / i) {
+                for (int j = i * i; j < limit; j += i)
+                    composite[j] = 1;
+            }
+        }
+    }
+    free(composite);
+    return count;
+}
+
+int main(void) {
+    printf("%d\n", count_primes(10000000));
+    return 0;
+}
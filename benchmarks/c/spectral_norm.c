@@ -0,0 +1,53 @@
+/* Spectral norm of the infinite matrix A (a[i][j] = 1/((i+j)(i+j+1)/2+i+1)),
+ * using 10 steps of the power method on a 1000x1000 slice. */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static double eval_a(int i, int j) { return 1.0 / ((i + j) * (i + j + 1) / 2 + i + 1); }
+
+static void times(int n, const double* u, double* au) {
+    for (int i = 0; i < n; ++i) {
+        double sum = 0.0;
+        for (int j = 0; j < n; ++j)
+            sum += eval_a(i, j) * u[j];
+        au[i] = sum;
+    }
+}
+
+static void times_transposed(int n, const double* u, double* au) {
+    for (int i = 0; i < n; ++i) {
+        double sum = 0.0;
+        for (int j = 0; j < n; ++j)
+            sum += eval_a(j, i) * u[j];
+        au[i] = sum;
+    }
+}
+
+static void times_ata(int n, const double* u, double* atau, double* tmp) {
+    times(n, u, tmp);
+    times_transposed(n, tmp, atau);
+}
+
+int main(void) {
+    int n = 1000;
+    double* u = calloc((size_t)n, sizeof(double));
+    double* v = calloc((size_t)n, sizeof(double));
+    double* tmp = calloc((size_t)n, sizeof(double));
+    for (int i = 0; i < n; ++i)
+        u[i] = 1.0;
+    for (int i = 0; i < 10; ++i) {
+        times_ata(n, u, v, tmp);
+        times_ata(n, v, u, tmp);
+    }
+    double vbv = 0.0, vv = 0.0;
+    for (int i = 0; i < n; ++i) {
+        vbv += u[i] * v[i];
+        vv += v[i] * v[i];
+    }
+    printf("%f\n", sqrt(vbv / vv));
+    free(u);
+    free(v);
+    free(tmp);
+    return 0;
+}
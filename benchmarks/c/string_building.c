@@ -0,0 +1,43 @@
+/* Builds one long string out of the decimal spellings of 0 to 999,999 separated by
+ * commas, then hashes it. Prints the length and the hash. */
+#include <stdio.h>
+#include <stdlib.h>
+
+typedef struct {
+    char* data;
+    int length;
+    int capacity;
+} StringBuilder;
+
+static void push(StringBuilder* sb, char c) {
+    if (sb->length == sb->capacity) {
+        sb->capacity = sb->capacity ? sb->capacity * 2 : 64;
+        sb->data = realloc(sb->data, (size_t)sb->capacity);
+    }
+    sb->data[sb->length++] = c;
+}
+
+static void push_number(StringBuilder* sb, int x) {
+    if (x >= 10)
+        push_number(sb, x / 10);
+    push(sb, (char)('0' + x % 10));
+}
+
+static int hash(const StringBuilder* sb) {
+    int h = 0;
+    for (int i = 0; i < sb->length; ++i)
+        h = (h * 31 + sb->data[i]) % 65521;
+    return h;
+}
+
+int main(void) {
+    StringBuilder sb = {NULL, 0, 0};
+    for (int i = 0; i < 1000000; ++i) {
+        push_number(&sb, i);
+        push(&sb, ',');
+    }
+    printf("%d\n", sb.length);
+    printf("%d\n", hash(&sb));
+    free(sb.data);
+    return 0;
+}
@@ -0,0 +1,126 @@
+// Measures how long S-Lang executables take from exec to exit, linked against libc and
+// against the static runtime (slang -o with and without --static-runtime).
+//
+// Compiles a small program that yaps a few values into both kinds of executables, then
+// spawns each of them many times in turn, with its output going to /dev/null, and
+// reports the mean and best time from spawning it to reaping it. The program itself
+// runs for a few microseconds, so what's left is the cost of starting and exiting. How
+// long linking each one took is reported too.
+//
+// Usage: bench_exec [-n runs]
+
+#include "codegen.hpp"
+#include "native.hpp"
+#include "parser.hpp"
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <filesystem>
+#include <iostream>
+#include <spawn.h>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+bool debug_mode = false;
+DebugStream debug;
+
+const std::string program = R"(spillingTeaAbout exec
+pluh square(x : int) : int { yeet x * x }
+pluh main() : int {
+    yap(square(12))
+    yap(3.25)
+    yap("started")
+    yeet 0
+})";
+
+// Seconds since a point in time.
+double since(std::chrono::steady_clock::time_point start) {
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double>(elapsed).count();
+}
+
+// Compiles the program into an executable, against the runtime if there's one, and
+// returns how long linking it took in seconds.
+double compile(const std::string& executable, const std::string& runtime) {
+    Parser parser(program);
+    TeaSpill tea = parser.parse_tea();
+    Codegen codegen;
+    codegen.generate_ir(tea);
+    std::unique_ptr<llvm::LLVMContext> context = codegen.take_context();
+    std::unique_ptr<llvm::Module> module = codegen.take_module();
+    NativeCompiler compiler(2, runtime);
+    compiler.compile(*module, executable);
+    return compiler.get_link_time();
+}
+
+// Spawns an executable and waits for it, returning the seconds it took.
+double exec_once(const std::string& executable, posix_spawn_file_actions_t* actions) {
+    char* argv[] = {const_cast<char*>(executable.c_str()), nullptr};
+    char* envp[] = {nullptr};
+    auto start = std::chrono::steady_clock::now();
+    pid_t pid = 0;
+    if (posix_spawn(&pid, executable.c_str(), actions, nullptr, argv, envp) != 0) {
+        std::cerr << "[ERROR] Could not run " << executable << std::endl;
+        exit(1);
+    }
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return since(start);
+}
+
+int main(int argc, char* argv[]) {
+    int runs = 2000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        if (flag == "-n") {
+            runs = std::stoi(argv[i + 1]);
+        } else {
+            std::cerr << "Usage: bench_exec [-n runs]" << std::endl;
+            return 1;
+        }
+    }
+
+    // The runtime is built with the libraries, next to this binary's directory.
+    llvm::SmallString<256> runtime(
+        llvm::sys::fs::getMainExecutable(argv[0], reinterpret_cast<void*>(&since)));
+    llvm::sys::path::remove_filename(runtime);
+    llvm::sys::path::append(runtime, "..", "lib", "libslang_rt.a");
+
+    std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / "slang_bench_exec";
+    std::filesystem::create_directories(directory);
+    const std::string names[] = {"libc", "static runtime"};
+    const std::string executables[] = {(directory / "libc").string(),
+                                       (directory / "static").string()};
+    double link[2] = {compile(executables[0], ""),
+                      compile(executables[1], runtime.str().str())};
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    double total[2] = {0, 0};
+    double best[2] = {1e9, 1e9};
+    // Alternate between the two, so both see the same system load.
+    for (int run = 0; run < runs; ++run) {
+        for (int kind = 0; kind < 2; ++kind) {
+            double seconds = exec_once(executables[kind], &actions);
+            total[kind] += seconds;
+            best[kind] = std::min(best[kind], seconds);
+        }
+    }
+    posix_spawn_file_actions_destroy(&actions);
+
+    std::cout << "runs: " << runs << std::endl;
+    std::printf("%-16s %12s %12s %12s %12s\n", "executable", "mean (us)", "best (us)",
+                "size (KB)", "link (ms)");
+    for (int kind = 0; kind < 2; ++kind) {
+        std::printf("%-16s %12.1f %12.1f %12.1f %12.2f\n", names[kind].c_str(),
+                    total[kind] / runs * 1e6, best[kind] * 1e6,
+                    std::filesystem::file_size(executables[kind]) / 1024.0,
+                    link[kind] * 1e3);
+    }
+    std::filesystem::remove_all(directory);
+}
@@ -0,0 +1,84 @@
+#!/bin/bash
+
+# Measures the overhead of fuel metering on the benchmark corpus.
+#
+# Every benchmark is run in the JIT unmetered (`slang -j`) and metered with a budget it
+# can never use up (`slang -f`). The runtime is built as a shared library and preloaded,
+# so the JIT resolves the benchmarks' plugs against it. Both outputs must match, and the
+# best of $RUNS runs of each is reported with the metered/unmetered ratio.
+#
+# Usage: benchmarks/fuel.sh [-O level] [-n runs] [benchmark...]
+#
+# Environment:
+#   SLANG     Path to the slang binary           [Default: build/bin/slang]
+#   CC        C compiler for the runtime         [Default: cc]
+#   OUT_DIR   Where the runtime and outputs go   [Default: benchmarks/out]
+
+set -e
+
+BENCH_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+ROOT_DIR="$(dirname "$BENCH_DIR")"
+
+SLANG="${SLANG:-$ROOT_DIR/build/bin/slang}"
+CC="${CC:-cc}"
+OUT_DIR="${OUT_DIR:-$BENCH_DIR/out}"
+OPT_LEVEL=2
+RUNS=3
+FUEL=9000000000000000000
+
+while getopts "O:n:h" flag; do
+    case "$flag" in
+    O) OPT_LEVEL="$OPTARG" ;;
+    n) RUNS="$OPTARG" ;;
+    *)
+        sed -n '3,15p' "${BASH_SOURCE[0]}" | sed 's/^# \{0,1\}//'
+        exit 1
+        ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+BENCHMARKS="$*"
+if [ -z "$BENCHMARKS" ]; then
+    BENCHMARKS="$(cd "$BENCH_DIR" && ls *.slg | sed 's/\.slg$//')"
+fi
+
+if [ ! -x "$SLANG" ]; then
+    echo "[ERROR] slang not found at $SLANG (build the project or set SLANG)" >&2
+    exit 1
+fi
+
+mkdir -p "$OUT_DIR"
+"$CC" -O2 -shared -fPIC "$BENCH_DIR/runtime/bench_rt.c" -o "$OUT_DIR/bench_rt.so"
+
+# Prints the best wall-clock time of running slang with the given arguments $RUNS times,
+# in milliseconds, and leaves the output of the last run in $1.
+best_time_ms() {
+    local output="$1"
+    shift
+    local best=""
+    for _ in $(seq "$RUNS"); do
+        local start end elapsed
+        start=$(date +%s%N)
+        LD_PRELOAD="$OUT_DIR/bench_rt.so" "$SLANG" "-O$OPT_LEVEL" "$@" >"$output" 2>/dev/null
+        end=$(date +%s%N)
+        elapsed=$(((end - start) / 1000000))
+        if [ -z "$best" ] || [ "$elapsed" -lt "$best" ]; then
+            best=$elapsed
+        fi
+    done
+    echo "$best"
+}
+
+printf "%-16s %14s %12s %10s\n" "benchmark" "unmetered (ms)" "metered (ms)" "overhead"
+for bench in $BENCHMARKS; do
+    unmetered_ms=$(best_time_ms "$OUT_DIR/$bench.unmetered.out" -j "$BENCH_DIR/$bench.slg")
+    metered_ms=$(best_time_ms "$OUT_DIR/$bench.metered.out" -f "$FUEL" "$BENCH_DIR/$bench.slg")
+    if ! cmp -s "$OUT_DIR/$bench.unmetered.out" "$OUT_DIR/$bench.metered.out"; then
+        echo "[ERROR] $bench printed different output when metered" >&2
+        exit 1
+    fi
+    ratio=$(awk -v m="$metered_ms" -v u="$unmetered_ms" \
+        'BEGIN { if (u == 0) u = 1; printf "%.2f", m / u }')
+    printf "%-16s %14s %12s %10s\n" "$bench" "$unmetered_ms" "$metered_ms" "$ratio"
+done
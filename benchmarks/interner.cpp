@@ -0,0 +1,132 @@
+// Measures how interning identifiers and string literals scales with threads.
+//
+// Lexes a generated program once, keeping the contents of its IDENTIFIER and STRING
+// tokens. Then, for every thread count, each thread interns every token (starting at a
+// different one, as if each lexed a file of its own sharing the program's names) into
+// a mutex-guarded std::unordered_set and into an Interner. The best of a few runs of
+// each is reported as millions of tokens interned per second, over all threads.
+//
+// Usage: bench_interner [-t "1 2 4 8 16 32"] [-p pluhs] [-n runs]
+
+#include "interner.hpp"
+#include "lexer.hpp"
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+bool debug_mode = false;
+DebugStream debug;
+
+// Returns a program of pluhs that call each other and yap strings, with the names a
+// real program reuses (parameters, locals) and the ones it doesn't (pluh names).
+std::string generate(int pluhs) {
+    std::string code = "spillingTeaAbout interner\nplug yap(s : string) : npc\n";
+    for (int i = 0; i < pluhs; ++i) {
+        std::string name = "p" + std::to_string(i);
+        code += "pluh " + name + "(x : int, y : int) : int {\n"
+                "    cookUp total : int = x\n"
+                "    cookUp i : int = 0\n"
+                "    holdUp i < y {\n"
+                "        total = total + i * x\n"
+                "        i = i + 1\n"
+                "    }\n"
+                "    yap(\"" + name + " done\")\n"
+                "    yap(\"total\")\n";
+        code += i ? "    yeet p" + std::to_string(i - 1) + "(total, y)\n}\n"
+                  : "    yeet total\n}\n";
+    }
+    return code;
+}
+
+// Returns the best time, in seconds, of interning every token on each of `threads`
+// threads. Every run calls `start` for an empty table and the function interning into it.
+double best_time(const std::vector<std::string>& tokens, unsigned threads, int runs,
+                 const std::function<std::function<void(const std::string&)>()>& start) {
+    double best = 0;
+    for (int run = 0; run < runs; ++run) {
+        auto intern = start();
+        auto begin = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers = {};
+        for (unsigned thread = 0; thread < threads; ++thread) {
+            workers.emplace_back([&, thread]() {
+                size_t offset = tokens.size() * thread / threads;
+                for (size_t i = 0; i < tokens.size(); ++i) {
+                    intern(tokens[(offset + i) % tokens.size()]);
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - begin)
+                             .count();
+        best = run == 0 ? seconds : std::min(best, seconds);
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<unsigned> thread_counts = {1, 2, 4, 8, 16, 32};
+    int pluhs = 20000;
+    int runs = 3;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        if (flag == "-t") {
+            thread_counts.clear();
+            std::istringstream counts(argv[i + 1]);
+            for (unsigned count = 0; counts >> count;) {
+                thread_counts.push_back(count);
+            }
+        } else if (flag == "-p") {
+            pluhs = std::stoi(argv[i + 1]);
+        } else if (flag == "-n") {
+            runs = std::stoi(argv[i + 1]);
+        } else {
+            std::cerr << "Usage: bench_interner [-t \"1 2 4 8 16 32\"] [-p pluhs] "
+                      << "[-n runs]" << std::endl;
+            return 1;
+        }
+    }
+
+    Lexer lexer(generate(pluhs));
+    std::vector<std::string> tokens = {};
+    for (Token token = lexer.get_token(); token.first != TokenType::END_OF_FILE;
+         token = lexer.get_token()) {
+        if (token.first == TokenType::IDENTIFIER || token.first == TokenType::STRING) {
+            tokens.push_back(token.second);
+        }
+    }
+    std::unordered_set<std::string> distinct(tokens.begin(), tokens.end());
+    std::cout << "tokens: " << tokens.size() << ", distinct: " << distinct.size()
+              << ", cores: " << std::thread::hardware_concurrency() << std::endl;
+
+    std::printf("%-8s %16s %16s %10s\n", "threads", "locked (Mtok/s)",
+                "interner (Mtok/s)", "speedup");
+    for (unsigned threads : thread_counts) {
+        std::unordered_set<std::string> table = {};
+        std::mutex mutex;
+        double locked = best_time(tokens, threads, runs, [&]() {
+            table.clear();
+            return [&](const std::string& token) {
+                std::lock_guard<std::mutex> lock(mutex);
+                table.insert(token);
+            };
+        });
+        std::unique_ptr<Interner> interner = nullptr;
+        double lock_free = best_time(tokens, threads, runs, [&]() {
+            interner = std::make_unique<Interner>();
+            return [&](const std::string& token) { interner->intern(token); };
+        });
+        double total = double(tokens.size()) * threads / 1e6;
+        std::printf("%-8u %16.2f %16.2f %10.2f\n", threads, total / locked,
+                    total / lock_free, locked / lock_free);
+    }
+}
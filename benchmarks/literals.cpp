@@ -0,0 +1,109 @@
+// Measures how fast number literals are lexed and parsed.
+//
+// Generates a data table: a program of pluhs that each cook up a row of int and float
+// literals, the kind of source a generator writes out. It's lexed token by token, then
+// lexed and parsed into an AST, and the best of a few runs of each is reported as
+// millions of literals and megabytes of source per second.
+//
+// Usage: bench_literals [-r rows] [-n runs]
+
+#include "lexer.hpp"
+#include "parser.hpp"
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <string>
+
+bool debug_mode = false;
+DebugStream debug;
+
+static const int ints_per_row = 4;   // Int literals in a row.
+static const int floats_per_row = 4; // Float literals in a row.
+
+// Returns a program of `rows` pluhs, each cooking up a row of pseudo-random literals.
+std::string generate(int rows) {
+    std::string code = "spillingTeaAbout literals\n";
+    uint64_t state = 88172645463325252ULL;
+    auto next = [&]() {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+    for (int row = 0; row < rows; ++row) {
+        code += "pluh row" + std::to_string(row) + "() : float {\n";
+        for (int i = 0; i < ints_per_row; ++i) {
+            code += "    cookUp i" + std::to_string(i) + " : int = " +
+                    std::to_string(next() % 2147483647) + "\n";
+        }
+        for (int i = 0; i < floats_per_row; ++i) {
+            char value[32];
+            std::snprintf(value, sizeof(value), "%u.%06u", unsigned(next() % 100000),
+                          unsigned(next() % 1000000));
+            code += "    cookUp f" + std::to_string(i) + " : float = " + value + "\n";
+        }
+        code += "    yeet f0\n}\n";
+    }
+    return code;
+}
+
+// Returns the best time, in seconds, of a few runs of `run`.
+double best_time(int runs, const std::function<void()>& run) {
+    double best = 0;
+    for (int i = 0; i < runs; ++i) {
+        auto begin = std::chrono::steady_clock::now();
+        run();
+        double seconds = std::chrono::duration<double>(
+                             std::chrono::steady_clock::now() - begin)
+                             .count();
+        best = i == 0 ? seconds : std::min(best, seconds);
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    int rows = 200000;
+    int runs = 3;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        if (flag == "-r") {
+            rows = std::stoi(argv[i + 1]);
+        } else if (flag == "-n") {
+            runs = std::stoi(argv[i + 1]);
+        } else {
+            std::cerr << "Usage: bench_literals [-r rows] [-n runs]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::string code = generate(rows);
+    double literals = double(rows) * (ints_per_row + floats_per_row);
+    double megabytes = double(code.size()) / 1e6;
+    std::printf("literals: %.0f, source: %.1f MB\n", literals, megabytes);
+
+    // The sums keep the values from being optimized away.
+    double sum = 0;
+    double lex = best_time(runs, [&]() {
+        Lexer lexer(code);
+        for (Token token = lexer.get_token(); token.first != TokenType::END_OF_FILE;
+             token = lexer.get_token()) {
+            if (token.first == TokenType::INT) {
+                sum += double(token.int_value);
+            } else if (token.first == TokenType::FLOAT) {
+                sum += token.float_value;
+            }
+        }
+    });
+    size_t pluhs = 0;
+    double parse = best_time(runs, [&]() {
+        Parser parser(code);
+        pluhs += parser.parse_tea().get_declarations().size();
+    });
+
+    std::printf("%-8s %12s %12s\n", "stage", "Mlit/s", "MB/s");
+    std::printf("%-8s %12.2f %12.2f\n", "lex", literals / lex / 1e6, megabytes / lex);
+    std::printf("%-8s %12.2f %12.2f\n", "parse", literals / parse / 1e6,
+                megabytes / parse);
+    return sum == 0 && pluhs == 0;
+}
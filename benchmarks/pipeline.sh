@@ -0,0 +1,95 @@
+#!/bin/bash
+
+# Measures JIT compile time of a large program with and without the pipeline.
+#
+# Generates a program of $PLUHS mid-sized pluhs, then JIT compiles and runs it with
+# `slang -j` (parse everything, then generate and compile one module) and with
+# `slang -p --jobs <threads>` for every thread count (parsing overlaps with generating
+# and compiling the pluhs parsed before). The best of $RUNS runs of each is reported, and
+# the timeline of the last pipelined run is written to $OUT_DIR/pipeline.json (open it
+# in chrome://tracing or https://ui.perfetto.dev to see the threads overlap).
+#
+# Usage: benchmarks/pipeline.sh [-p pluhs] [-t "1 2 4"] [-n runs]
+#
+# Environment:
+#   SLANG     Path to the slang binary           [Default: build/bin/slang]
+#   OUT_DIR   Where the program goes             [Default: benchmarks/out]
+
+set -e
+
+BENCH_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+ROOT_DIR="$(dirname "$BENCH_DIR")"
+
+SLANG="${SLANG:-$ROOT_DIR/build/bin/slang}"
+OUT_DIR="${OUT_DIR:-$BENCH_DIR/out}"
+PLUHS=2000
+THREAD_COUNTS="1 2 4"
+RUNS=3
+
+while getopts "p:t:n:h" flag; do
+    case "$flag" in
+    p) PLUHS="$OPTARG" ;;
+    t) THREAD_COUNTS="$OPTARG" ;;
+    n) RUNS="$OPTARG" ;;
+    *)
+        sed -n '3,17p' "${BASH_SOURCE[0]}" | sed 's/^# \{0,1\}//'
+        exit 1
+        ;;
+    esac
+done
+
+if [ ! -x "$SLANG" ]; then
+    echo "[ERROR] slang not found at $SLANG (build the project or set SLANG)" >&2
+    exit 1
+fi
+
+mkdir -p "$OUT_DIR"
+program="$OUT_DIR/pipeline.slg"
+
+# Every pluh calls the one before it, so none are dead code, and main yeets 0 so slang
+# exits cleanly.
+awk -v pluhs="$PLUHS" 'BEGIN {
+    print "spillingTeaAbout pipeline"
+    print "pluh p0(x : int) : int { yeet x }"
+    for (i = 1; i < pluhs; ++i) {
+        printf "pluh p%d(x : int) : int {\n" \
+            "    cookUp total : int = p%d(x %% %d)\n" \
+            "    cookUp i : int = 0\n" \
+            "    holdUp i < %d {\n" \
+            "        fr? (i * %d + x) %% 3 == 0 {\n" \
+            "            total = total + i * %d - x / %d\n" \
+            "        } justLikeThat? {\n" \
+            "            total = total - (i + %d) * 2\n" \
+            "        }\n" \
+            "        i = i + 1\n" \
+            "    }\n" \
+            "    yeet total %% %d\n" \
+            "}\n", i, i - 1, i % 97 + 1, i % 13 + 2, i % 7 + 1, i % 11 + 1, i % 5 + 1,
+            i % 17, i % 1000 + 1
+    }
+    printf "pluh main() : int { cookUp result : int = p%d(7) yeet 0 }\n", pluhs - 1
+}' >"$program"
+
+# Prints the best wall time, in seconds, of running slang with the given flags.
+best_of() {
+    python3 - "$RUNS" "$SLANG" "$@" "$program" <<'EOF2'
+import subprocess, sys, time
+best = None
+for _ in range(int(sys.argv[1])):
+    start = time.monotonic()
+    subprocess.run(sys.argv[2:], check=True, stdout=subprocess.DEVNULL)
+    seconds = time.monotonic() - start
+    best = seconds if best is None else min(best, seconds)
+print(f"{best:.3f}")
+EOF2
+}
+
+whole=$(best_of -j)
+echo "pluhs: $PLUHS, cores: $(nproc)"
+printf "%-16s %10s %10s\n" "mode" "time (s)" "speedup"
+printf "%-16s %10.2f %10.2f\n" "-j" "$whole" 1
+for threads in $THREAD_COUNTS; do
+    seconds=$(best_of -p --jobs "$threads" --timeline "$OUT_DIR/pipeline.json")
+    speedup=$(python3 -c "print($whole / $seconds)")
+    printf "%-16s %10.2f %10.2f\n" "-p --jobs $threads" "$seconds" "$speedup"
+done
@@ -0,0 +1,81 @@
+#!/bin/bash
+
+# Measures hot reload in the REPL: how long swapping a pluh in takes, and what calling
+# pluhs through their indirection stubs costs once nothing is being swapped.
+#
+# A REPL session defines a small pluh (step) and a loop calling it $ITERATIONS times
+# through its stub, then reloads step $RELOADS times. The loop is timed against the same
+# loop with step's body written inline, which is what the code would look like without
+# the stub (no call, and everything visible to the optimizer).
+#
+# Usage: benchmarks/reload.sh [-i iterations] [-r reloads]
+#
+# Environment:
+#   SLANG     Path to the slang binary           [Default: build/bin/slang]
+
+set -e
+
+BENCH_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+ROOT_DIR="$(dirname "$BENCH_DIR")"
+
+SLANG="${SLANG:-$ROOT_DIR/build/bin/slang}"
+ITERATIONS=100000000
+RELOADS=100
+
+while getopts "i:r:h" flag; do
+    case "$flag" in
+    i) ITERATIONS="$OPTARG" ;;
+    r) RELOADS="$OPTARG" ;;
+    *)
+        sed -n '3,15p' "${BASH_SOURCE[0]}" | sed 's/^# \{0,1\}//'
+        exit 1
+        ;;
+    esac
+done
+
+if [ ! -x "$SLANG" ]; then
+    echo "[ERROR] slang not found at $SLANG (build the project or set SLANG)" >&2
+    exit 1
+fi
+
+step_body='yeet (x * 1103 + 12345) % 65536'
+log=$({
+    echo "pluh step(x : int) : int { $step_body }"
+    echo "pluh spin(n : int) : int { cookUp x : int = 1 cookUp i : int = 0" \
+        "holdUp i < n { x = step(x) i = i + 1 } yeet x }"
+    echo "pluh spin_inline(n : int) : int { cookUp x : int = 1 cookUp i : int = 0" \
+        "holdUp i < n { x = (x * 1103 + 12345) % 65536 i = i + 1 } yeet x }"
+    echo "spin($ITERATIONS)"
+    echo "spin_inline($ITERATIONS)"
+    for _ in $(seq "$RELOADS"); do
+        echo "pluh step(x : int) : int { $step_body }"
+    done
+    echo "spin($ITERATIONS)"
+} | "$SLANG" repl 2>&1)
+
+if echo "$log" | grep -q "\[ERROR\]"; then
+    echo "$log" | grep "\[ERROR\]" >&2
+    exit 1
+fi
+
+# Latency lines look like "(compiled in 1.23 ms, swapped in 4.56 us, ran in 7.89 ms)".
+ran_ms=($(echo "$log" | sed -n 's/.*ran in \([0-9.]*\) ms.*/\1/p'))
+stub_ms=${ran_ms[3]}
+inline_ms=${ran_ms[4]}
+reloaded_ms=${ran_ms[$((${#ran_ms[@]} - 1))]}
+echo "$log" | sed -n 's/.*compiled in \([0-9.]*\) ms, swapped in \([0-9.]*\) us.*/\1 \2/p' |
+    awk -v reloads="$RELOADS" -v stub="$stub_ms" -v inline="$inline_ms" \
+        -v reloaded="$reloaded_ms" -v n="$ITERATIONS" '
+    {
+        compile += $1
+        swap += $2
+        if ($2 > max_swap) max_swap = $2
+    }
+    END {
+        printf "%-28s %10.2f ms\n", "reload compile (mean)", compile / NR
+        printf "%-28s %10.2f us\n", "reload swap (mean)", swap / NR
+        printf "%-28s %10.2f us\n", "reload swap (max)", max_swap
+        printf "%-28s %10.2f ns\n", "call through stub", stub * 1e6 / n
+        printf "%-28s %10.2f ns\n", "call after reloads", reloaded * 1e6 / n
+        printf "%-28s %10.2f ns\n", "inlined (no stub)", inline * 1e6 / n
+    }'
@@ -0,0 +1,120 @@
+// Measures what running JIT'd code in an executor process (slang --isolate) costs.
+//
+// Compiles a generated program of mid-sized pluhs into one module, once for a JIT
+// running the code in this process and once for one running it in slang-executor.
+// Compiling is the same for both, so only the rest is reported: starting the session
+// (and the executor), linking the program and transferring its code into the process it
+// runs in (the first lookup), and calling a pluh that returns straight away. The best of
+// a few runs of each is reported.
+//
+// Usage: bench_remote [-p pluhs] [-c calls] [-n runs]
+
+#include "codegen.hpp"
+#include "jit.hpp"
+#include "parser.hpp"
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+bool debug_mode = false;
+DebugStream debug;
+
+// Returns a program of pluhs that call each other, and a main that returns at once.
+std::string generate(int pluhs) {
+    std::string code = "spillingTeaAbout remote\npluh main() : int { yeet 0 }\n";
+    for (int i = 0; i < pluhs; ++i) {
+        code += "pluh p" + std::to_string(i) + "(x : int, y : int) : int {\n"
+                "    cookUp total : int = x\n"
+                "    cookUp i : int = 0\n"
+                "    holdUp i < y {\n"
+                "        total = total + i * x\n"
+                "        i = i + 1\n"
+                "    }\n";
+        code += i ? "    yeet p" + std::to_string(i - 1) + "(total, y)\n}\n"
+                  : "    yeet total\n}\n";
+    }
+    return code;
+}
+
+// Seconds since a point in time.
+double since(std::chrono::steady_clock::time_point start) {
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double>(elapsed).count();
+}
+
+struct Times {
+    double start; // Creating the session, in seconds.
+    double link;  // Linking the program into the process it runs in, in seconds.
+    double call;  // Calling main, in seconds per call.
+};
+
+// Times a session running the code where `executor` says, keeping the best of `runs`.
+Times measure(const std::string& code, const std::string& executor, int calls, int runs) {
+    Times best = {};
+    for (int run = 0; run < runs; ++run) {
+        Parser parser(code);
+        TeaSpill tea = parser.parse_tea();
+        Codegen codegen;
+        codegen.generate_ir(tea);
+
+        auto start = std::chrono::steady_clock::now();
+        Jit jit(nullptr, 2, nullptr, executor);
+        Times times = {since(start), 0, 0};
+        jit.compile_module(codegen.take_context(), codegen.take_module());
+        start = std::chrono::steady_clock::now();
+        uint64_t main_pluh = jit.lookup("main");
+        times.link = since(start);
+        start = std::chrono::steady_clock::now();
+        for (int call = 0; call < calls; ++call) {
+            jit.run(main_pluh);
+        }
+        times.call = since(start) / calls;
+        if (run == 0) {
+            best = times;
+        } else {
+            best = {std::min(best.start, times.start), std::min(best.link, times.link),
+                    std::min(best.call, times.call)};
+        }
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    int pluhs = 2000;
+    int calls = 10000;
+    int runs = 3;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        if (flag == "-p") {
+            pluhs = std::stoi(argv[i + 1]);
+        } else if (flag == "-c") {
+            calls = std::stoi(argv[i + 1]);
+        } else if (flag == "-n") {
+            runs = std::stoi(argv[i + 1]);
+        } else {
+            std::cerr << "Usage: bench_remote [-p pluhs] [-c calls] [-n runs]"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    // The executor is built next to this binary.
+    llvm::SmallString<256> executor(
+        llvm::sys::fs::getMainExecutable(argv[0], reinterpret_cast<void*>(&generate)));
+    llvm::sys::path::remove_filename(executor);
+    llvm::sys::path::append(executor, "slang-executor");
+
+    std::string code = generate(pluhs);
+    Times local = measure(code, "", calls, runs);
+    Times remote = measure(code, executor.str().str(), calls, runs);
+    std::cout << "pluhs: " << pluhs << ", calls: " << calls << std::endl;
+    std::printf("%-16s %12s %12s %12s\n", "mode", "start (ms)", "link (ms)",
+                "call (us)");
+    std::printf("%-16s %12.2f %12.2f %12.3f\n", "in process", local.start * 1e3,
+                local.link * 1e3, local.call * 1e6);
+    std::printf("%-16s %12.2f %12.2f %12.3f\n", "out of process", remote.start * 1e3,
+                remote.link * 1e3, remote.call * 1e6);
+}
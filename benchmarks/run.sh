@@ -0,0 +1,106 @@
+#!/bin/bash
+
+# Runs the S-Lang benchmark corpus against the C reference implementations.
+#
+# For every benchmark and optimization level, the S-Lang version is compiled to IR with
+# slang, optimized with opt, lowered with llc and linked against runtime/bench_rt.c. The
+# C reference is compiled with $CC at the same level. Both are run $RUNS times, their
+# outputs are compared, and the best wall-clock time of each is reported together with
+# the S-Lang/C ratio.
+#
+# Usage: benchmarks/run.sh [-O "0 1 2 3"] [-n runs] [benchmark...]
+#
+# Environment:
+#   SLANG     Path to the slang binary           [Default: build/bin/slang]
+#   LLVM_BIN  Directory holding opt and llc      [Default: $(llvm-config --bindir)]
+#   CC        C compiler for the references      [Default: cc]
+#   OUT_DIR   Where binaries are written         [Default: benchmarks/out]
+
+set -e
+
+BENCH_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+ROOT_DIR="$(dirname "$BENCH_DIR")"
+
+SLANG="${SLANG:-$ROOT_DIR/build/bin/slang}"
+LLVM_BIN="${LLVM_BIN:-$(llvm-config --bindir 2>/dev/null || true)}"
+CC="${CC:-cc}"
+OUT_DIR="${OUT_DIR:-$BENCH_DIR/out}"
+OPT_LEVELS="0 1 2 3"
+RUNS=3
+
+while getopts "O:n:h" flag; do
+    case "$flag" in
+    O) OPT_LEVELS="$OPTARG" ;;
+    n) RUNS="$OPTARG" ;;
+    *)
+        sed -n '3,18p' "${BASH_SOURCE[0]}" | sed 's/^# \{0,1\}//'
+        exit 1
+        ;;
+    esac
+done
+shift $((OPTIND - 1))
+
+BENCHMARKS="$*"
+if [ -z "$BENCHMARKS" ]; then
+    BENCHMARKS="$(cd "$BENCH_DIR" && ls *.slg | sed 's/\.slg$//')"
+fi
+
+if [ ! -x "$SLANG" ]; then
+    echo "[ERROR] slang not found at $SLANG (build the project or set SLANG)" >&2
+    exit 1
+fi
+OPT="${LLVM_BIN:+$LLVM_BIN/}opt"
+LLC="${LLVM_BIN:+$LLVM_BIN/}llc"
+
+mkdir -p "$OUT_DIR"
+
+# Prints the best wall-clock time of running $1 $RUNS times, in milliseconds, and leaves
+# the output of the last run in $2.
+best_time_ms() {
+    local best=""
+    for _ in $(seq "$RUNS"); do
+        local start end elapsed
+        start=$(date +%s%N)
+        "$1" >"$2"
+        end=$(date +%s%N)
+        elapsed=$(((end - start) / 1000000))
+        if [ -z "$best" ] || [ "$elapsed" -lt "$best" ]; then
+            best=$elapsed
+        fi
+    done
+    echo "$best"
+}
+
+# The runtime is always built at -O2 so every level links the same helpers.
+"$CC" -O2 -c "$BENCH_DIR/runtime/bench_rt.c" -o "$OUT_DIR/bench_rt.o"
+
+printf "%-16s %-4s %12s %12s %10s\n" "benchmark" "opt" "slang (ms)" "c (ms)" "slang/c"
+for bench in $BENCHMARKS; do
+    "$SLANG" "$BENCH_DIR/$bench.slg" -r "$OUT_DIR/$bench.ll" >/dev/null 2>&1 || {
+        echo "[ERROR] slang failed to compile $bench.slg" >&2
+        exit 1
+    }
+    for level in $OPT_LEVELS; do
+        slang_exe="$OUT_DIR/${bench}_slang_O$level"
+        c_exe="$OUT_DIR/${bench}_c_O$level"
+
+        "$OPT" "-O$level" "$OUT_DIR/$bench.ll" -o "$OUT_DIR/$bench.O$level.bc"
+        "$LLC" "-O$level" --relocation-model=pic -filetype=obj \
+            "$OUT_DIR/$bench.O$level.bc" -o "$slang_exe.o"
+        "$CC" "$slang_exe.o" "$OUT_DIR/bench_rt.o" -lm -o "$slang_exe"
+        "$CC" "-O$level" "$BENCH_DIR/c/$bench.c" -lm -o "$c_exe"
+
+        slang_ms=$(best_time_ms "$slang_exe" "$slang_exe.out")
+        c_ms=$(best_time_ms "$c_exe" "$c_exe.out")
+        if ! cmp -s "$slang_exe.out" "$c_exe.out"; then
+            echo "[ERROR] $bench -O$level: S-Lang and C outputs differ" >&2
+            diff "$slang_exe.out" "$c_exe.out" >&2 || true
+            exit 1
+        fi
+
+        ratio=$(awk -v s="$slang_ms" -v c="$c_ms" \
+            'BEGIN { if (c == 0) c = 1; printf "%.2f", s / c }')
+        printf "%-16s %-4s %12s %12s %10s\n" "$bench" "-O$level" "$slang_ms" "$c_ms" \
+            "$ratio"
+    done
+done
@@ -0,0 +1,162 @@
+/**
+ * @file bench_rt.c
+ * @brief Support pluhs for the S-Lang benchmark corpus
+ *
+ * S-Lang has no arrays, heap allocation or string concatenation yet, so the benchmarks
+ * that need them `plug` these helpers instead. Every object is referred to by an int
+ * handle, since ints are the only thing a pluh can pass around. The C reference
+ * implementations don't use this file, so the S-Lang/C ratio includes the cost of going
+ * through it.
+ *
+ * @author Sagar Patel
+ * @date 10-18-2026
+ *
+ * Project: S-Lang Compiler
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MAX_HANDLES 64
+
+static void fail(const char* message) {
+    fprintf(stderr, "[ERROR] %s\n", message);
+    exit(1);
+}
+
+/* -------------------------------------------------------------------------------------
+ * int and float vectors
+ * ------------------------------------------------------------------------------------- */
+
+static int* ivecs[MAX_HANDLES];
+static double* fvecs[MAX_HANDLES];
+
+int ivec_new(int size) {
+    for (int handle = 0; handle < MAX_HANDLES; ++handle) {
+        if (!ivecs[handle]) {
+            ivecs[handle] = calloc((size_t)size, sizeof(int));
+            if (!ivecs[handle])
+                fail("ivec_new: out of memory");
+            return handle;
+        }
+    }
+    fail("ivec_new: too many vectors");
+    return -1;
+}
+
+int ivec_get(int handle, int index) { return ivecs[handle][index]; }
+
+void ivec_set(int handle, int index, int value) { ivecs[handle][index] = value; }
+
+void ivec_free(int handle) {
+    free(ivecs[handle]);
+    ivecs[handle] = NULL;
+}
+
+int fvec_new(int size) {
+    for (int handle = 0; handle < MAX_HANDLES; ++handle) {
+        if (!fvecs[handle]) {
+            fvecs[handle] = calloc((size_t)size, sizeof(double));
+            if (!fvecs[handle])
+                fail("fvec_new: out of memory");
+            return handle;
+        }
+    }
+    fail("fvec_new: too many vectors");
+    return -1;
+}
+
+double fvec_get(int handle, int index) { return fvecs[handle][index]; }
+
+void fvec_set(int handle, int index, double value) { fvecs[handle][index] = value; }
+
+void fvec_free(int handle) {
+    free(fvecs[handle]);
+    fvecs[handle] = NULL;
+}
+
+/* -------------------------------------------------------------------------------------
+ * Tree nodes (binary-trees). Nodes live in a growable pool with a free list, and -1 is
+ * the null node.
+ * ------------------------------------------------------------------------------------- */
+
+static int* node_lefts;
+static int* node_rights;
+static int node_capacity;
+static int node_count;
+static int node_free_list = -1;
+
+int node_new(int left, int right) {
+    int node;
+    if (node_free_list != -1) {
+        node = node_free_list;
+        node_free_list = node_lefts[node];
+    } else {
+        if (node_count == node_capacity) {
+            node_capacity = node_capacity ? node_capacity * 2 : 1024;
+            node_lefts = realloc(node_lefts, (size_t)node_capacity * sizeof(int));
+            node_rights = realloc(node_rights, (size_t)node_capacity * sizeof(int));
+            if (!node_lefts || !node_rights)
+                fail("node_new: out of memory");
+        }
+        node = node_count++;
+    }
+    node_lefts[node] = left;
+    node_rights[node] = right;
+    return node;
+}
+
+int node_left(int node) { return node_lefts[node]; }
+
+int node_right(int node) { return node_rights[node]; }
+
+void node_free(int node) {
+    node_lefts[node] = node_free_list;
+    node_free_list = node;
+}
+
+/* -------------------------------------------------------------------------------------
+ * String builders (string-building)
+ * ------------------------------------------------------------------------------------- */
+
+typedef struct {
+    char* data;
+    int length;
+    int capacity;
+} StringBuilder;
+
+static StringBuilder* builders[MAX_HANDLES];
+
+int sb_new(void) {
+    for (int handle = 0; handle < MAX_HANDLES; ++handle) {
+        if (!builders[handle]) {
+            builders[handle] = calloc(1, sizeof(StringBuilder));
+            if (!builders[handle])
+                fail("sb_new: out of memory");
+            return handle;
+        }
+    }
+    fail("sb_new: too many string builders");
+    return -1;
+}
+
+void sb_push(int handle, char c) {
+    StringBuilder* sb = builders[handle];
+    if (sb->length == sb->capacity) {
+        sb->capacity = sb->capacity ? sb->capacity * 2 : 64;
+        sb->data = realloc(sb->data, (size_t)sb->capacity);
+        if (!sb->data)
+            fail("sb_push: out of memory");
+    }
+    sb->data[sb->length++] = c;
+}
+
+int sb_length(int handle) { return builders[handle]->length; }
+
+char sb_at(int handle, int index) { return builders[handle]->data[index]; }
+
+void sb_free(int handle) {
+    free(builders[handle]->data);
+    free(builders[handle]);
+    builders[handle] = NULL;
+}
@@ -0,0 +1,110 @@
+#!/bin/bash
+
+# Measures JIT startup with and without snapshots.
+#
+# Generates a program with many small pluhs (so compiling dominates running it), then
+# times running it with `slang -j` (no snapshot), `slang -s` with an empty snapshot
+# directory (cold: compile and write the snapshot) and `slang -s` again (warm: load the
+# snapshot). The best of $RUNS runs of each is reported.
+#
+# Usage: benchmarks/startup.sh [-p pluhs] [-n runs]
+#
+# Environment:
+#   SLANG     Path to the slang binary           [Default: build/bin/slang]
+#   OUT_DIR   Where the program and snapshots go [Default: benchmarks/out]
+
+set -e
+
+BENCH_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+ROOT_DIR="$(dirname "$BENCH_DIR")"
+
+SLANG="${SLANG:-$ROOT_DIR/build/bin/slang}"
+OUT_DIR="${OUT_DIR:-$BENCH_DIR/out}"
+PLUHS=2000
+RUNS=5
+
+while getopts "p:n:h" flag; do
+    case "$flag" in
+    p) PLUHS="$OPTARG" ;;
+    n) RUNS="$OPTARG" ;;
+    *)
+        sed -n '3,15p' "${BASH_SOURCE[0]}" | sed 's/^# \{0,1\}//'
+        exit 1
+        ;;
+    esac
+done
+
+if [ ! -x "$SLANG" ]; then
+    echo "[ERROR] slang not found at $SLANG (build the project or set SLANG)" >&2
+    exit 1
+fi
+
+mkdir -p "$OUT_DIR"
+program="$OUT_DIR/startup.slg"
+snapshots="$OUT_DIR/startup_snapshots"
+
+# Every pluh gets a slightly different body so none of them can be merged.
+{
+    echo "spillingTeaAbout startup"
+    for i in $(seq "$PLUHS"); do
+        cat <<EOF
+
+pluh step$i(n : int) : int {
+    cookUp total : int = $i
+    cookUp k : int = 0
+    holdUp (k < n) {
+        fr? (total % 2 == 0) {
+            total = total / 2 + k
+        } justLikeThat? {
+            total = total * 3 + $i
+        }
+        k = k + 1
+    }
+    yeet total % 1000
+}
+EOF
+    done
+    echo
+    echo "pluh main() : int {"
+    echo "    cookUp sum : int = 0"
+    for i in $(seq "$PLUHS"); do
+        echo "    sum = sum + step$i(8)"
+    done
+    echo "    yap(sum)"
+    echo "    yeet 0"
+    echo "}"
+} >"$program"
+
+# Prints the best wall-clock time of running slang with the given arguments $RUNS
+# times, in milliseconds. With -c, the snapshot directory is emptied before every run.
+best_time_ms() {
+    local clear=""
+    if [ "$1" = "-c" ]; then
+        clear=1
+        shift
+    fi
+    local best=""
+    for _ in $(seq "$RUNS"); do
+        if [ -n "$clear" ]; then
+            rm -rf "$snapshots"
+        fi
+        local start end elapsed
+        start=$(date +%s%N)
+        "$SLANG" "$@" "$program" >/dev/null 2>&1
+        end=$(date +%s%N)
+        elapsed=$(((end - start) / 1000000))
+        if [ -z "$best" ] || [ "$elapsed" -lt "$best" ]; then
+            best=$elapsed
+        fi
+    done
+    echo "$best"
+}
+
+no_snapshot_ms=$(best_time_ms -j)
+cold_ms=$(best_time_ms -c -s "$snapshots")
+warm_ms=$(best_time_ms -s "$snapshots")
+
+printf "%-12s %10s\n" "startup" "time (ms)"
+printf "%-12s %10s\n" "no snapshot" "$no_snapshot_ms"
+printf "%-12s %10s\n" "cold" "$cold_ms"
+printf "%-12s %10s\n" "warm" "$warm_ms"
@@ -0,0 +1,89 @@
+#!/bin/bash
+
+# Measures the peak memory of compiling a huge program, with and without streaming.
+#
+# Generates a program of about $SIZE megabytes made of many mid-sized pluhs, then
+# compiles it to IR with `slang` (the whole AST is built before generating IR) and with
+# `slang --stream` (each pluh is parsed, generated and freed before the next). The time
+# and peak RSS of each are reported. Both still hold the source and the LLVM module, so
+# streaming takes the AST, usually the largest of the three, out of the peak. Last, it's
+# only lexed (`slang --lex-only`), which reads it a chunk at a time in constant memory.
+#
+# Usage: benchmarks/stream.sh [-s megabytes]   (eg. -s 1024 for a 1 GB program)
+#
+# Environment:
+#   SLANG     Path to the slang binary           [Default: build/bin/slang]
+#   OUT_DIR   Where the program goes             [Default: benchmarks/out]
+
+set -e
+
+BENCH_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+ROOT_DIR="$(dirname "$BENCH_DIR")"
+
+SLANG="${SLANG:-$ROOT_DIR/build/bin/slang}"
+OUT_DIR="${OUT_DIR:-$BENCH_DIR/out}"
+SIZE=64
+
+while getopts "s:h" flag; do
+    case "$flag" in
+    s) SIZE="$OPTARG" ;;
+    *)
+        sed -n '3,16p' "${BASH_SOURCE[0]}" | sed 's/^# \{0,1\}//'
+        exit 1
+        ;;
+    esac
+done
+
+if [ ! -x "$SLANG" ]; then
+    echo "[ERROR] slang not found at $SLANG (build the project or set SLANG)" >&2
+    exit 1
+fi
+
+mkdir -p "$OUT_DIR"
+program="$OUT_DIR/stream.slg"
+
+# Every pluh is about 400 bytes and calls the one before it, so none are dead code.
+awk -v bytes="$((SIZE * 1024 * 1024))" 'BEGIN {
+    print "spillingTeaAbout stream"
+    print "pluh p0(x : int) : int { yeet x }"
+    written = 0
+    for (i = 1; written < bytes; ++i) {
+        pluh = sprintf("pluh p%d(x : int) : int {\n" \
+            "    cookUp total : int = p%d(x %% %d)\n" \
+            "    cookUp i : int = 0\n" \
+            "    holdUp i < %d {\n" \
+            "        fr? (i * %d + x) %% 3 == 0 {\n" \
+            "            total = total + i * %d - x / %d\n" \
+            "        } justLikeThat? {\n" \
+            "            total = total - (i + %d) * 2\n" \
+            "        }\n" \
+            "        i = i + 1\n" \
+            "    }\n" \
+            "    yeet total %% %d\n" \
+            "}\n", i, i - 1, i % 97 + 1, i % 13 + 2, i % 7 + 1, i % 11 + 1, i % 5 + 1,
+            i % 17, i % 1000 + 1)
+        printf "%s", pluh
+        written += length(pluh)
+    }
+    printf "pluh main() : int { yeet p%d(7) }\n", i - 1
+}' >"$program"
+
+# Prints the seconds and peak RSS (in MB) of compiling the program to IR with the given
+# extra flags.
+measure() {
+    python3 - "$SLANG" "$@" -r /dev/null "$program" <<'EOF2'
+import resource, subprocess, sys, time
+start = time.monotonic()
+subprocess.run(sys.argv[1:], check=True, stdout=subprocess.DEVNULL,
+               stderr=subprocess.DEVNULL)
+seconds = time.monotonic() - start
+peak_kb = resource.getrusage(resource.RUSAGE_CHILDREN).ru_maxrss
+print(f"{seconds:10.2f} {peak_kb / 1024:14.1f}")
+EOF2
+}
+
+echo "program: $(du -m "$program" | cut -f1) MB"
+printf "%-10s %10s %14s\n" "mode" "time (s)" "peak RSS (MB)"
+printf "%-10s %s\n" "whole" "$(measure)"
+printf "%-10s %s\n" "streamed" "$(measure --stream)"
+printf "%-10s %s\n" "lex-only" "$(measure --lex-only)"
@@ -0,0 +1,80 @@
+#!/bin/bash
+
+# Measures how long the JIT takes to reach peak performance on a single long loop.
+#
+# long_loop.slg never leaves the holdUp loop in main, so whatever code the loop starts
+# in is the code it finishes in. For every JIT optimization level, it is run once with a
+# single iteration (the time until the loop starts: parsing, compiling and starting up)
+# and once in full. The difference gives the steady-state time per iteration, which is
+# compared against the C reference at -O2.
+#
+# Usage: benchmarks/time_to_peak.sh [-O "0 1 2 3"] [-n runs]
+#
+# Environment:
+#   SLANG     Path to the slang binary           [Default: build/bin/slang]
+#   CC        C compiler for the reference       [Default: cc]
+#   OUT_DIR   Where the programs go              [Default: benchmarks/out]
+
+set -e
+
+BENCH_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+ROOT_DIR="$(dirname "$BENCH_DIR")"
+
+SLANG="${SLANG:-$ROOT_DIR/build/bin/slang}"
+CC="${CC:-cc}"
+OUT_DIR="${OUT_DIR:-$BENCH_DIR/out}"
+OPT_LEVELS="0 1 2 3"
+RUNS=3
+
+while getopts "O:n:h" flag; do
+    case "$flag" in
+    O) OPT_LEVELS="$OPTARG" ;;
+    n) RUNS="$OPTARG" ;;
+    *)
+        sed -n '3,17p' "${BASH_SOURCE[0]}" | sed 's/^# \{0,1\}//'
+        exit 1
+        ;;
+    esac
+done
+
+if [ ! -x "$SLANG" ]; then
+    echo "[ERROR] slang not found at $SLANG (build the project or set SLANG)" >&2
+    exit 1
+fi
+
+mkdir -p "$OUT_DIR"
+iterations=$(sed -n 's/.*cookUp iterations : int = \([0-9]*\).*/\1/p' \
+    "$BENCH_DIR/long_loop.slg")
+sed "s/cookUp iterations : int = $iterations/cookUp iterations : int = 1/" \
+    "$BENCH_DIR/long_loop.slg" >"$OUT_DIR/long_loop_start.slg"
+"$CC" -O2 "$BENCH_DIR/c/long_loop.c" -o "$OUT_DIR/long_loop_c"
+
+# Prints the best wall-clock time of running the command $RUNS times, in milliseconds.
+best_time_ms() {
+    local best=""
+    for _ in $(seq "$RUNS"); do
+        local start end elapsed
+        start=$(date +%s%N)
+        "$@" >/dev/null 2>&1
+        end=$(date +%s%N)
+        elapsed=$(((end - start) / 1000000))
+        if [ -z "$best" ] || [ "$elapsed" -lt "$best" ]; then
+            best=$elapsed
+        fi
+    done
+    echo "$best"
+}
+
+c_ms=$(best_time_ms "$OUT_DIR/long_loop_c")
+c_ns=$(awk -v t="$c_ms" -v n="$iterations" 'BEGIN { printf "%.2f", t * 1e6 / n }')
+
+printf "%-4s %14s %12s %10s %10s\n" "opt" "to loop (ms)" "total (ms)" "ns/iter" "vs c -O2"
+for level in $OPT_LEVELS; do
+    start_ms=$(best_time_ms "$SLANG" -j "-O$level" "$OUT_DIR/long_loop_start.slg")
+    total_ms=$(best_time_ms "$SLANG" -j "-O$level" "$BENCH_DIR/long_loop.slg")
+    ns=$(awk -v s="$start_ms" -v t="$total_ms" -v n="$iterations" \
+        'BEGIN { printf "%.2f", (t - s) * 1e6 / n }')
+    ratio=$(awk -v s="$ns" -v c="$c_ns" 'BEGIN { if (c == 0) c = 1; printf "%.2f", s / c }')
+    printf "%-4s %14s %12s %10s %10s\n" "-O$level" "$start_ms" "$total_ms" "$ns" "$ratio"
+done
+printf "%-4s %14s %12s %10s %10s\n" "c" "-" "$c_ms" "$c_ns" "1.00"
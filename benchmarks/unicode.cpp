@@ -0,0 +1,79 @@
+// Measures how fast identifiers and string literals are lexed, in ASCII and in UTF-8.
+//
+// Generates two programs of the same shape: one written in ASCII alone, and one whose
+// names and strings mix in other scripts (accented Latin, Greek, Cyrillic, CJK), as a
+// program written in another language would. Each is lexed token by token, and the best
+// of a few runs is reported as millions of tokens and megabytes of source per second.
+//
+// Usage: bench_unicode [-p pluhs] [-n runs]
+
+#include "lexer.hpp"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+bool debug_mode = false;
+DebugStream debug;
+
+// Returns a program of pluhs with long names and strings, taking its words from `words`.
+std::string generate(int pluhs, const std::vector<std::string>& words) {
+    std::string code = "spillingTeaAbout unicode\nplug yap(s : string) : npc\n";
+    auto word = [&](int i) { return words[i % words.size()]; };
+    for (int i = 0; i < pluhs; ++i) {
+        std::string name = word(i) + "_" + word(i / 3) + "_" + std::to_string(i);
+        std::string total = word(i + 1) + "_" + word(i + 2);
+        std::string step = word(i + 3) + "_" + word(i + 4);
+        code += "pluh " + name + "(" + total + " : int, " + step + " : int) : int {\n"
+                "    holdUp " + total + " < " + step + " {\n"
+                "        " + total + " = " + total + " + " + step + "\n"
+                "    }\n"
+                "    yap(\"" + word(i) + " " + word(i + 5) + " " + word(i + 6) +
+                " " + name + " " + word(i + 7) + "\")\n"
+                "    yeet " + total + "\n}\n";
+    }
+    return code;
+}
+
+int main(int argc, char* argv[]) {
+    int pluhs = 200000;
+    int runs = 3;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        if (flag == "-p") {
+            pluhs = std::stoi(argv[i + 1]);
+        } else if (flag == "-n") {
+            runs = std::stoi(argv[i + 1]);
+        } else {
+            std::cerr << "Usage: bench_unicode [-p pluhs] [-n runs]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<std::string> ascii = {"total",  "count", "value", "index",
+                                      "buffer", "limit", "step",  "result"};
+    std::vector<std::string> mixed = {"total", "größe",  "λόγος", "данные",
+                                      "名前",  "résumé", "step",  "température"};
+    std::printf("%-8s %12s %12s %12s\n", "input", "size (MB)", "Mtok/s", "MB/s");
+    for (const auto& [input, words] : {std::pair{"ascii", &ascii}, {"mixed", &mixed}}) {
+        std::string code = generate(pluhs, *words);
+        size_t tokens = 0;
+        double best = 0;
+        for (int run = 0; run < runs; ++run) {
+            auto begin = std::chrono::steady_clock::now();
+            Lexer lexer(code);
+            tokens = 0;
+            while (lexer.get_token().first != TokenType::END_OF_FILE) {
+                ++tokens;
+            }
+            double seconds = std::chrono::duration<double>(
+                                 std::chrono::steady_clock::now() - begin)
+                                 .count();
+            best = run == 0 ? seconds : std::min(best, seconds);
+        }
+        double megabytes = double(code.size()) / 1e6;
+        std::printf("%-8s %12.1f %12.2f %12.2f\n", input, megabytes,
+                    double(tokens) / best / 1e6, megabytes / best);
+    }
+}
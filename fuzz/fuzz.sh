@@ -0,0 +1,74 @@
+#!/bin/bash
+
+# Fuzzes the lexer and parser for slow inputs, then adds them to the regression corpus.
+#
+# Builds fuzz_frontend with clang, and runs it for $TIME seconds on a corpus seeded with
+# the examples and the regression corpus. Inputs whose time per byte grows with their
+# length (see fuzz_frontend.cpp), use more than $RSS_MB of memory or hang for $TIMEOUT
+# seconds are kept by libFuzzer, minimized, and saved into tests/corpus, where
+# test_parser checks they keep parsing in linear time.
+#
+# Usage: fuzz/fuzz.sh [-t seconds] [-j jobs] [-l max_len]
+#
+# Environment:
+#   CXX         clang++ to build the harness with   [Default: clang++]
+#   BUILD_DIR   Where the harness is built          [Default: build-fuzz]
+#   RSS_MB      Most memory an input may use        [Default: 512]
+#   TIMEOUT     Most seconds an input may take      [Default: 2]
+
+set -e
+
+FUZZ_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+ROOT_DIR="$(dirname "$FUZZ_DIR")"
+
+CXX="${CXX:-clang++}"
+BUILD_DIR="${BUILD_DIR:-$ROOT_DIR/build-fuzz}"
+RSS_MB="${RSS_MB:-512}"
+TIMEOUT="${TIMEOUT:-2}"
+TIME=60
+JOBS=1
+MAX_LEN=16384
+
+while getopts "t:j:l:h" flag; do
+    case "$flag" in
+    t) TIME="$OPTARG" ;;
+    j) JOBS="$OPTARG" ;;
+    l) MAX_LEN="$OPTARG" ;;
+    *)
+        sed -n '3,17p' "${BASH_SOURCE[0]}" | sed 's/^# \{0,1\}//'
+        exit 1
+        ;;
+    esac
+done
+
+cmake -S "$ROOT_DIR" -B "$BUILD_DIR" -DSLANG_FUZZ=ON -DCMAKE_CXX_COMPILER="$CXX" \
+    -DCMAKE_BUILD_TYPE=RelWithDebInfo >/dev/null
+cmake --build "$BUILD_DIR" --target fuzz_frontend -j"$(nproc)" >/dev/null
+FUZZER="$BUILD_DIR/bin/fuzz_frontend"
+
+# The working corpus grows as the fuzzer finds new coverage, the seeds stay untouched.
+CORPUS="$BUILD_DIR/corpus"
+ARTIFACTS="$BUILD_DIR/artifacts/"
+mkdir -p "$CORPUS" "$ARTIFACTS"
+cp "$ROOT_DIR"/examples/*.slg "$ROOT_DIR"/tests/corpus/* "$CORPUS"
+
+echo "[INFO] Fuzzing for $TIME seconds..."
+"$FUZZER" "$CORPUS" -max_total_time="$TIME" -jobs="$JOBS" -workers="$JOBS" \
+    -max_len="$MAX_LEN" -rss_limit_mb="$RSS_MB" -timeout="$TIMEOUT" \
+    -artifact_prefix="$ARTIFACTS" -use_value_profile=1 -print_final_stats=1 || true
+
+# Minimize every slow input found into the regression corpus. Minimizing keeps the
+# smallest input that's still too slow, so it's as readable as it can be.
+found=0
+for artifact in "$ARTIFACTS"crash-* "$ARTIFACTS"timeout-* "$ARTIFACTS"oom-*; do
+    [ -f "$artifact" ] || continue
+    name="$(basename "$artifact")"
+    minimized="$ROOT_DIR/tests/corpus/slow-${name#*-}.slg"
+    "$FUZZER" "$artifact" -minimize_crash=1 -runs=10000 -rss_limit_mb="$RSS_MB" \
+        -timeout="$TIMEOUT" -exact_artifact_path="$minimized" >/dev/null 2>&1 || true
+    [ -f "$minimized" ] || cp "$artifact" "$minimized"
+    echo "[INFO] Saved $(wc -c <"$minimized") byte slow input as $minimized"
+    rm "$artifact"
+    found=$((found + 1))
+done
+echo "[INFO] Found $found slow inputs"
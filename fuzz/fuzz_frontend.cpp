@@ -0,0 +1,92 @@
+/**
+ * @file fuzz_frontend.cpp
+ * @brief libFuzzer harness hunting for slow inputs to the lexer and parser
+ *
+ * Crashes aren't the only thing worth finding in the front end: an input that makes the
+ * lexer or parser go super-linear (or recurse without bound) is a denial of service for
+ * anything compiling untrusted programs. This harness times every input it's given
+ * against its first quarter, and aborts on inputs whose time per byte grows too much with
+ * their length, so libFuzzer keeps them as crashes that can be minimized and added to the
+ * regression corpus in tests/corpus (see fuzz.sh). It's the same rule test_parser checks
+ * the corpus with.
+ *
+ * Environment:
+ *   SLANG_FUZZ_MAX_GROWTH  Most the time per byte may grow by from an input's first
+ *                          quarter to the whole of it [Default: 1.5]
+ *   SLANG_FUZZ_MIN_BYTES   Smallest input that's timed, as tiny inputs are all noise
+ *                          [Default: 1024]
+ *
+ * @author Sagar Patel
+ * @date 10-18-2026
+ *
+ * Project: S-Lang Compiler
+ */
+
+#include "parser.hpp"
+#include <algorithm>
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+
+bool debug_mode = false;
+DebugStream debug;
+
+// Reads a numeric setting from the environment, falling back to a default.
+static double get_setting(const char* name, double fallback) {
+    const char* value = std::getenv(name);
+    return value ? std::atof(value) : fallback;
+}
+
+// Returns the CPU time this thread has used, in nanoseconds. Unlike the wall clock, it
+// doesn't count time spent preempted, which would make longer inputs look slower.
+static double thread_cpu_ns() {
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+// Parses code, returning the nanoseconds it took per byte (the best of a few runs, to
+// keep noise out).
+static double parse_ns_per_byte(const std::string& code) {
+    double best = 0;
+    for (int run = 0; run < 3; ++run) {
+        double start = thread_cpu_ns();
+        try {
+            Parser parser(code);
+            parser.parse_tea();
+        } catch (const std::exception&) {
+            // Syntax errors are expected, only the time they took matters.
+        }
+        double ns = thread_cpu_ns() - start;
+        best = run == 0 ? ns : std::min(best, ns);
+    }
+    return best / std::max<size_t>(1, code.size());
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    static const double max_growth = get_setting("SLANG_FUZZ_MAX_GROWTH", 1.5);
+    static const size_t min_bytes = get_setting("SLANG_FUZZ_MIN_BYTES", 1024);
+
+    std::string code(reinterpret_cast<const char*>(data), size);
+    if (size < min_bytes) {
+        // Too short to time reliably, but still worth covering.
+        try {
+            Parser parser(code);
+            parser.parse_tea();
+        } catch (const std::exception&) {
+        }
+        return 0;
+    }
+    // Cutting an input to its first quarter keeps whatever structure makes it slow, so
+    // the time per byte of a linear path stays flat and a quadratic one's grows 4 times.
+    double quarter = parse_ns_per_byte(code.substr(0, size / 4));
+    double whole = parse_ns_per_byte(code);
+    if (whole > quarter * max_growth) {
+        std::fprintf(stderr,
+                     "[ERROR] Slow input: %zu bytes took %.0f ns per byte, its first "
+                     "quarter %.0f\n",
+                     size, whole, quarter);
+        std::abort();
+    }
+    return 0;
+}
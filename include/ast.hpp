@@ -27,10 +27,14 @@
 #pragma once
 
 #include "debug_stream.hpp"
+#include <bit>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <set>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -54,29 +58,6 @@ class PluhDeclaration;
 class Prototype;
 class TeaSpill;
 
-/**
- * @brief Compares two std::unique_ptr objects for equality.
- *
- * This function template provides an overloaded equality operator (==) for
- * comparing two std::unique_ptr objects. It checks if the pointers are
- * non-null and then compares the objects they point to. If both pointers are
- * non-null, it dereferences them and compares the objects. If either or both
- * are null, it directly compares the pointer values.
- *
- * @param p1 The first std::unique_ptr to compare.
- * @param p2 The second std::unique_ptr to compare.
- *
- * @return true if both pointers are null, or if they are non-null and the
- *         objects they point to are equal; false otherwise.
- */
-template <typename T>
-inline bool operator==(const std::unique_ptr<T>& p1, const std::unique_ptr<T>& p2) {
-    if (p1 != nullptr && p2 != nullptr) {
-        return *p1 == *p2;
-    }
-    return p1 == p2;
-}
-
 /**
  * @brief Represents a generic literal value of a specified type.
  * This template class encapsulates a literal value of type T. It provides
@@ -134,31 +115,149 @@ class Literal {
 };
 
 /**
- * @brief Represents a variant type for different kinds of expressions.
- * This alias defines 'Expression' as a std::variant that holds
- * different types of Expression objects. Each type represents a different
- * kind of expression in SLang.
+ * @brief Represents an expression: a handle to any of the kinds of expression in SLang,
+ * packed into 8 bytes.
+ *
+ * Kinds:
+ * - Literal<int>, Literal<bool> and Literal<char>: stored inline.
+ * - Literal<double>: stored inline if it's exactly a float, otherwise boxed.
+ * - Literal<std::string>: boxed.
+ * - VariableExpression: boxed.
+ * - UnaryExpression: boxed.
+ * - BinaryExpression: boxed.
+ * - CallExpression: boxed.
  *
- * Types:
- * - Literal<int>: Represents an integer literal.
- * - Literal<double>: Represents a floating-point literal.
- * - Literal<bool>: Represents a boolean literal.
- * - Literal<char>: Represents a character literal.
- * - Literal<std::string>: Represents a string literal.
- * - std::unique_ptr<VariableExpression>: Represents an expression dealing with a
- * variable.
- * - std::unique_ptr<UnaryExpression>: Represents an expression with a single operand.
- * - std::unique_ptr<BinaryExpression>: Represents an expression with two operands.
- * - std::unique_ptr<CallExpression>: Represents a function call expression.
+ * A boxed node is owned through a pointer whose low 3 bits, always 0 as nodes are 8-byte
+ * aligned, hold its kind. An inline literal sets all 3 bits, keeps its kind in the bits
+ * above them and its value in the upper 32. A std::variant of the literals and
+ * std::unique_ptrs took 40 bytes, as it had room for a std::string inline, so this makes
+ * every node holding an expression smaller and saves allocating most literals.
  *
- * We use std::variant for type-safe expression handling :) ASTs can
- * get tricky with raw pointers!
+ * Use visit() to dispatch on the kind, like std::visit. The visitor gets a
+ * const Literal<T>& for a literal, and a reference to the node for anything else.
  */
-using Expression =
-    std::variant<Literal<int>, Literal<double>, Literal<bool>, Literal<char>,
-                 Literal<std::string>, std::unique_ptr<VariableExpression>,
-                 std::unique_ptr<UnaryExpression>, std::unique_ptr<BinaryExpression>,
-                 std::unique_ptr<CallExpression>>;
+class Expression {
+  public:
+    /**
+     * @brief The kinds of expression. The boxed kinds come first, so their values fit
+     * in the tag.
+     */
+    enum class Kind { Variable, Unary, Binary, Call, String, Float, Int, Bool, Char };
+
+  private:
+    uint64_t bits; // A tagged pointer to a boxed node, or an inline literal.
+
+    static const uint64_t tag_mask = 7;   // The bits holding the tag.
+    static const uint64_t inline_tag = 7; // The tag of an inline literal.
+
+    /**
+     * @brief Packs a boxed node and its kind.
+     *
+     * @param node The node, which the expression takes ownership of.
+     * @param kind The kind of the node.
+     *
+     * @return uint64_t -> The tagged pointer.
+     */
+    static uint64_t box(const void* node, Kind kind);
+
+    /**
+     * @brief Packs an inline literal.
+     *
+     * @param kind The kind of the literal.
+     * @param payload The bits of its value.
+     *
+     * @return uint64_t -> The inline literal.
+     */
+    static uint64_t inline_literal(Kind kind, uint32_t payload);
+
+    /**
+     * @brief Checks if this holds an inline literal.
+     */
+    bool is_inline() const;
+
+    /**
+     * @brief Gets the boxed node (nullptr once moved from).
+     */
+    void* get_pointer() const;
+
+    /**
+     * @brief Gets the bits of the value of an inline literal.
+     */
+    uint32_t get_payload() const;
+
+    /**
+     * @brief Deletes the boxed node, if there is one, and leaves the expression empty.
+     */
+    void reset();
+
+    template <typename Visitor>
+    friend decltype(auto) visit(Visitor&& visitor, Expression& expression);
+
+  public:
+    /**
+     * @brief Constructors that take ownership of an expression of each kind. They're
+     * implicit, so any expression converts to an Expression.
+     */
+    Expression(Literal<int> literal);
+    Expression(Literal<double> literal);
+    Expression(Literal<bool> literal);
+    Expression(Literal<char> literal);
+    Expression(Literal<std::string> literal);
+    Expression(std::unique_ptr<VariableExpression> node);
+    Expression(std::unique_ptr<UnaryExpression> node);
+    Expression(std::unique_ptr<BinaryExpression> node);
+    Expression(std::unique_ptr<CallExpression> node);
+
+    /**
+     * @brief Move constructor. Leaves the moved from expression empty.
+     */
+    Expression(Expression&& rhs) noexcept;
+
+    Expression(const Expression&) = delete;
+
+    /**
+     * @brief Destructor. Deletes the boxed node, if there is one.
+     */
+    ~Expression();
+
+    /**
+     * @brief Move assignment operator. Deletes the node this held, if it was boxed.
+     *
+     * @return A reference to the modified Expression object.
+     */
+    Expression& operator=(Expression&& rhs) noexcept;
+
+    Expression& operator=(const Expression&) = delete;
+
+    /**
+     * @brief Gets the kind of the expression.
+     *
+     * @return Kind -> The kind.
+     */
+    Kind get_kind() const;
+
+    /**
+     * @brief Gets the node, if the expression is a VariableExpression, UnaryExpression,
+     * BinaryExpression or CallExpression of type T, like std::get_if.
+     *
+     * @tparam T The type of node.
+     * @return T* -> The node, or nullptr if the expression is of another kind.
+     */
+    template <typename T>
+    T* get_if();
+
+    /**
+     * @brief Equality comparison operator.
+     *
+     * Compares the expressions of two handles, so two separately built trees are equal
+     * if they're of the same shape and values.
+     *
+     * @param rhs The right-hand side Expression object to compare with.
+     *
+     * @return true if both expressions are equal, false otherwise.
+     */
+    bool operator==(const Expression& rhs) const;
+};
 
 /**
  * @brief Represents an expression that encapsulates a variable.
@@ -807,11 +906,11 @@ class GhostStatement {
     GhostStatement(GhostStatement&&) = default;
 
     /**
-     * @brief Default constructor.
+     * @brief Constructor.
      *
      * Constructs a GhostStatement object, representing a break statement.
      */
-    explicit GhostStatement() = default;
+    explicit GhostStatement();
 
     /**
      * @brief Default move assignment operator.
@@ -852,11 +951,11 @@ class RizzStatement {
     RizzStatement(RizzStatement&&) = default;
 
     /**
-     * @brief Default constructor.
+     * @brief Constructor.
      *
      * Constructs a RizzStatement object, representing a continue statement.
      */
-    explicit RizzStatement() = default;
+    explicit RizzStatement();
 
     /**
      * @brief Default move assignment operator.
@@ -882,33 +981,142 @@ class RizzStatement {
 };
 
 /**
- * @brief Type alias representing a variant of different statement types in an
- * abstract syntax tree.
+ * @brief Represents a statement: a handle to any of the kinds of statement in SLang,
+ * packed into 8 bytes.
+ *
+ * Kinds:
+ * - CookedUpStatement: boxed.
+ * - AssignmentStatement: boxed.
+ * - CookedUpAssignmentStatement: boxed.
+ * - FrOngJustLikeThatStatement: boxed.
+ * - HoldUpStatement: boxed.
+ * - CompoundStatement: boxed.
+ * - YeetStatement: boxed.
+ * - GhostStatement and RizzStatement: stored inline, as they hold nothing.
  *
- * This type alias defines 'Statement' as a std::variant that can hold different
- * types of statement objects. Each statement type represents a different
- * kind of statement in a programming language.
+ * Packed the same way as an Expression: a boxed node's kind is in the low 3 bits of the
+ * pointer to it, and an inline statement sets all 3 and keeps its kind above them. A
+ * std::variant of std::unique_ptrs took 16 bytes.
  *
- * Types:
- * - std::unique_ptr<CookedUpStatement>: Represents a variable declaration statement.
- * - std::unique_ptr<AssignmentStatement>: Represents a variable assignment statement.
- * - std::unique_ptr<CookedUpAssignmentStatement>: Represents a combined variable
- * declaration and assignment statement.
- * - std::unique_ptr<FrOngJustLikeThatStatement>: Represents a conditional branching
- * statement.
- * - std::unique_ptr<HoldUpStatement>: Represents a conditional loop statement.
- * - std::unique_ptr<GhostStatement>: Represents a breaking statement in a loop.
- * - std::unique_ptr<RizzStatement>: Represents a skipping iteration statement in a loop.
- * - std::unique_ptr<YeetStatement>: Represents a return value to caller statement.
- * - std::unique_ptr<CompoundStatement>: Represents a compound statement.
+ * Use visit() to dispatch on the kind, like std::visit. The visitor gets a reference to
+ * the node.
  */
-using Statement =
-    std::variant<std::unique_ptr<CookedUpStatement>, std::unique_ptr<AssignmentStatement>,
-                 std::unique_ptr<CookedUpAssignmentStatement>,
-                 std::unique_ptr<FrOngJustLikeThatStatement>,
-                 std::unique_ptr<HoldUpStatement>, std::unique_ptr<GhostStatement>,
-                 std::unique_ptr<RizzStatement>, std::unique_ptr<YeetStatement>,
-                 std::unique_ptr<CompoundStatement>>;
+class Statement {
+  public:
+    /**
+     * @brief The kinds of statement. The boxed kinds come first, so their values fit in
+     * the tag.
+     */
+    enum class Kind {
+        CookedUp,
+        Assignment,
+        CookedUpAssignment,
+        FrOngJustLikeThat,
+        HoldUp,
+        Compound,
+        Yeet,
+        Ghost,
+        Rizz
+    };
+
+  private:
+    uint64_t bits; // A tagged pointer to a boxed node, or an inline statement.
+
+    static const uint64_t tag_mask = 7;   // The bits holding the tag.
+    static const uint64_t inline_tag = 7; // The tag of an inline statement.
+
+    /**
+     * @brief Packs a boxed node and its kind.
+     *
+     * @param node The node, which the statement takes ownership of.
+     * @param kind The kind of the node.
+     *
+     * @return uint64_t -> The tagged pointer.
+     */
+    static uint64_t box(const void* node, Kind kind);
+
+    /**
+     * @brief Checks if this holds an inline statement.
+     */
+    bool is_inline() const;
+
+    /**
+     * @brief Gets the boxed node (nullptr once moved from).
+     */
+    void* get_pointer() const;
+
+    /**
+     * @brief Deletes the boxed node, if there is one, and leaves the statement empty.
+     */
+    void reset();
+
+    template <typename Visitor>
+    friend decltype(auto) visit(Visitor&& visitor, Statement& statement);
+
+  public:
+    /**
+     * @brief Constructors that take ownership of a statement of each kind. They're
+     * implicit, so any statement converts to a Statement.
+     */
+    Statement(std::unique_ptr<CookedUpStatement> node);
+    Statement(std::unique_ptr<AssignmentStatement> node);
+    Statement(std::unique_ptr<CookedUpAssignmentStatement> node);
+    Statement(std::unique_ptr<FrOngJustLikeThatStatement> node);
+    Statement(std::unique_ptr<HoldUpStatement> node);
+    Statement(std::unique_ptr<CompoundStatement> node);
+    Statement(std::unique_ptr<YeetStatement> node);
+    Statement(GhostStatement node);
+    Statement(RizzStatement node);
+
+    /**
+     * @brief Move constructor. Leaves the moved from statement empty.
+     */
+    Statement(Statement&& rhs) noexcept;
+
+    Statement(const Statement&) = delete;
+
+    /**
+     * @brief Destructor. Deletes the boxed node, if there is one.
+     */
+    ~Statement();
+
+    /**
+     * @brief Move assignment operator. Deletes the node this held, if it was boxed.
+     *
+     * @return A reference to the modified Statement object.
+     */
+    Statement& operator=(Statement&& rhs) noexcept;
+
+    Statement& operator=(const Statement&) = delete;
+
+    /**
+     * @brief Gets the kind of the statement.
+     *
+     * @return Kind -> The kind.
+     */
+    Kind get_kind() const;
+
+    /**
+     * @brief Gets the node, if the statement is a boxed one of type T, like std::get_if.
+     *
+     * @tparam T The type of node.
+     * @return T* -> The node, or nullptr if the statement is of another kind.
+     */
+    template <typename T>
+    T* get_if();
+
+    /**
+     * @brief Equality comparison operator.
+     *
+     * Compares the statements of two handles, so two separately built trees are equal if
+     * they're of the same shape and values.
+     *
+     * @param rhs The right-hand side Statement object to compare with.
+     *
+     * @return true if both statements are equal, false otherwise.
+     */
+    bool operator==(const Statement& rhs) const;
+};
 
 /**
  * @brief Represents conditional branching statement in an abstract syntax tree.
@@ -1246,4 +1454,116 @@ class TeaSpill {
     TeaSpill& operator=(TeaSpill&&) = default;
 };
 
+template <typename T>
+T* Expression::get_if() {
+    Kind kind;
+    if constexpr (std::is_same_v<T, VariableExpression>) {
+        kind = Kind::Variable;
+    } else if constexpr (std::is_same_v<T, UnaryExpression>) {
+        kind = Kind::Unary;
+    } else if constexpr (std::is_same_v<T, BinaryExpression>) {
+        kind = Kind::Binary;
+    } else {
+        static_assert(std::is_same_v<T, CallExpression>, "get_if only gets boxed nodes");
+        kind = Kind::Call;
+    }
+    return get_kind() == kind ? static_cast<T*>(get_pointer()) : nullptr;
+}
+
+template <typename T>
+T* Statement::get_if() {
+    Kind kind;
+    if constexpr (std::is_same_v<T, CookedUpStatement>) {
+        kind = Kind::CookedUp;
+    } else if constexpr (std::is_same_v<T, AssignmentStatement>) {
+        kind = Kind::Assignment;
+    } else if constexpr (std::is_same_v<T, CookedUpAssignmentStatement>) {
+        kind = Kind::CookedUpAssignment;
+    } else if constexpr (std::is_same_v<T, FrOngJustLikeThatStatement>) {
+        kind = Kind::FrOngJustLikeThat;
+    } else if constexpr (std::is_same_v<T, HoldUpStatement>) {
+        kind = Kind::HoldUp;
+    } else if constexpr (std::is_same_v<T, CompoundStatement>) {
+        kind = Kind::Compound;
+    } else {
+        static_assert(std::is_same_v<T, YeetStatement>, "get_if only gets boxed nodes");
+        kind = Kind::Yeet;
+    }
+    return get_kind() == kind ? static_cast<T*>(get_pointer()) : nullptr;
+}
+
+/**
+ * @brief Calls a visitor with the expression a handle holds, like std::visit.
+ *
+ * @param visitor The visitor, with an overload for each kind of expression.
+ * @param expression The expression.
+ *
+ * @return What the visitor returns.
+ */
+template <typename Visitor>
+decltype(auto) visit(Visitor&& visitor, Expression& expression) {
+    void* node = expression.get_pointer();
+    uint32_t payload = expression.get_payload();
+    switch (expression.get_kind()) {
+    case Expression::Kind::Variable:
+        return visitor(*static_cast<VariableExpression*>(node));
+    case Expression::Kind::Unary:
+        return visitor(*static_cast<UnaryExpression*>(node));
+    case Expression::Kind::Binary:
+        return visitor(*static_cast<BinaryExpression*>(node));
+    case Expression::Kind::String:
+        return visitor(std::as_const(*static_cast<Literal<std::string>*>(node)));
+    case Expression::Kind::Float:
+        if (!expression.is_inline()) {
+            return visitor(std::as_const(*static_cast<Literal<double>*>(node)));
+        }
+        return visitor(Literal<double>(std::bit_cast<float>(payload)));
+    case Expression::Kind::Int:
+        return visitor(Literal<int>(static_cast<int>(payload)));
+    case Expression::Kind::Bool:
+        return visitor(Literal<bool>(payload != 0));
+    case Expression::Kind::Char:
+        return visitor(Literal<char>(static_cast<char>(payload)));
+    default:
+        return visitor(*static_cast<CallExpression*>(node));
+    }
+}
+
+/**
+ * @brief Calls a visitor with the statement a handle holds, like std::visit.
+ *
+ * @param visitor The visitor, with an overload for each kind of statement.
+ * @param statement The statement.
+ *
+ * @return What the visitor returns.
+ */
+template <typename Visitor>
+decltype(auto) visit(Visitor&& visitor, Statement& statement) {
+    void* node = statement.get_pointer();
+    switch (statement.get_kind()) {
+    case Statement::Kind::CookedUp:
+        return visitor(*static_cast<CookedUpStatement*>(node));
+    case Statement::Kind::Assignment:
+        return visitor(*static_cast<AssignmentStatement*>(node));
+    case Statement::Kind::CookedUpAssignment:
+        return visitor(*static_cast<CookedUpAssignmentStatement*>(node));
+    case Statement::Kind::FrOngJustLikeThat:
+        return visitor(*static_cast<FrOngJustLikeThatStatement*>(node));
+    case Statement::Kind::HoldUp:
+        return visitor(*static_cast<HoldUpStatement*>(node));
+    case Statement::Kind::Compound:
+        return visitor(*static_cast<CompoundStatement*>(node));
+    case Statement::Kind::Ghost: {
+        GhostStatement ghost;
+        return visitor(ghost);
+    }
+    case Statement::Kind::Rizz: {
+        RizzStatement rizz;
+        return visitor(rizz);
+    }
+    default:
+        return visitor(*static_cast<YeetStatement*>(node));
+    }
+}
+
 #endif
@@ -0,0 +1,123 @@
+/**
+ * @file batch.hpp
+ * @brief Batch Compilation for the S-Lang Compiler
+ *
+ * This file contains the definition of the BatchCompiler class, an embedding API for
+ * compiling many small programs (formulas) at once. Instead of paying for a context, a
+ * module and a compile pipeline per formula, a batch is split into a few modules that
+ * are generated and compiled on a pool of threads. Bare expressions can be compiled too,
+ * straight into a function of their variables.
+ *
+ * @author Sagar Patel
+ * @date 10-18-2026
+ *
+ * Project: S-Lang Compiler
+ */
+
+#ifndef BATCH_HPP
+#define BATCH_HPP
+#pragma once
+
+#include "codegen.hpp"
+#include "jit.hpp"
+#include "parser.hpp"
+#include "scheduler.hpp"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Handle to a formula compiled by a BatchCompiler.
+ */
+struct Formula {
+    uint64_t address;  // Address of the formula's entry pluh, 0 if it failed to compile.
+    std::string error; // Why the formula failed to compile, empty if it didn't.
+};
+
+/**
+ * @brief Compiles batches of formulas into a shared JIT session.
+ *
+ * A formula is a whole S-Lang program with an entry pluh (main by default). A batch is
+ * split into modules of up to formulas_per_module formulas, which are parsed and
+ * generated in parallel, a task per module on the scheduler (each module has its own
+ * LLVMContext). Every formula's pluhs are prefixed with a name unique to it, so formulas
+ * sharing a module never clash. The modules are then compiled in parallel, by the JIT
+ * on the same scheduler.
+ *
+ * A formula that fails to parse or generate only fails itself, the rest of its batch
+ * still compiles. Handles stay valid for as long as the BatchCompiler lives.
+ */
+class BatchCompiler {
+  private:
+    Scheduler& scheduler;       // Scheduler modules are generated and compiled on.
+    size_t formulas_per_module; // Most formulas put in one module.
+    std::string entry;          // Name of the entry pluh of every formula.
+    uint64_t formula_count;     // Formulas compiled so far, to name new ones.
+    Jit jit;                    // The session every batch is compiled into.
+    std::unordered_map<std::string, uint64_t>
+        expressions; // Compiled expressions by their normalized text and signature.
+
+    /**
+     * @brief Returns the key an expression is cached under: its tokens (with their
+     * types, so a string can't pass for a variable) along with the variables and the
+     * type of the result. Spacing and comments don't change the key.
+     */
+    static std::string
+    get_expression_key(const std::string& expression,
+                       const std::vector<std::pair<std::string, std::string>>& variables,
+                       const std::string& type_name);
+  public:
+    /**
+     * @brief Creates a batch compiler with its own JIT session.
+     *
+     * @param entry Name of the entry pluh of every formula.
+     * @param scheduler Scheduler to generate and compile modules on, or nullptr for the
+     * shared one. It must outlive the batch compiler.
+     * @param formulas_per_module Most formulas put in one module.
+     * @param opt_level Optimization level (0 to 3) formulas are compiled at.
+     *
+     * @throws jit_error If the JIT can't be created.
+     */
+    BatchCompiler(const std::string& entry = "main", Scheduler* scheduler = nullptr,
+                  size_t formulas_per_module = 512, unsigned opt_level = 2);
+
+    /**
+     * @brief Compiles a batch of formulas. Not to be called from a task of the
+     * batch compiler's scheduler, since it waits for the JIT to compile on it.
+     *
+     * @param sources The source code of each formula.
+     *
+     * @return std::vector<Formula> -> A handle per formula, in the same order.
+     *
+     * @throws jit_error If a generated module fails to compile.
+     */
+    std::vector<Formula> compile(const std::vector<std::string>& sources);
+
+    /**
+     * @brief Compiles a bare expression (eg. `a * b + 3`) into a function of its free
+     * variables, without wrapping it in a program.
+     *
+     * The function takes the variables as arguments, in order, and returns the value of
+     * the expression as the given type, eg. `double (*)(int, double)` for the variables
+     * a : int and b : float with a float result. Compiled expressions are cached, so
+     * compiling the same expression again (even spaced differently) returns the same
+     * code without compiling anything.
+     *
+     * @param expression The expression.
+     * @param variables The name and S-Lang type of each free variable.
+     * @param type_name The S-Lang type of the result.
+     *
+     * @return Formula -> A handle to the function.
+     */
+    Formula
+    compile_expression(const std::string& expression,
+                       const std::vector<std::pair<std::string, std::string>>& variables,
+                       const std::string& type_name = "float");
+
+    /**
+     * @brief Default destructor.
+     */
+    ~BatchCompiler() = default;
+};
+
+#endif
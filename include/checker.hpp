@@ -0,0 +1,133 @@
+/**
+ * @file checker.hpp
+ * @brief Semantic Checker for the S-Lang Compiler
+ *
+ * This file contains the definition of the Checker class, which checks a parsed program
+ * for the errors code generation would report (unknown names and types, wrong argument
+ * counts, incompatible types, ghost or rizz outside a loop, ...) without generating any
+ * code. It never touches LLVM, so checking a program costs about as much as parsing it.
+ *
+ * @author Sagar Patel
+ * @date 10-18-2026
+ *
+ * Project: S-Lang Compiler
+ */
+
+#ifndef CHECKER_HPP
+#define CHECKER_HPP
+#pragma once
+
+#include "ast.hpp"
+#include "exceptions.hpp"
+#include <unordered_map>
+#include <unordered_set>
+
+/**
+ * @brief Semantic checker for the S-Lang Compiler.
+ *
+ * The Checker walks the AST like Codegen does, but tracks the S-Lang type of every value
+ * (by name, eg. "int") instead of generating it. Errors are thrown as codegen_error with
+ * the same message Codegen would throw, so a program that passes the check only fails to
+ * generate on internal errors.
+ */
+class Checker {
+  private:
+    std::unordered_map<std::string, std::string>
+        current_scope_symbols; // Maps variable names to their types in the current scope.
+    std::unordered_map<std::string, Prototype*>
+        pluh_symbols;                              // Maps pluh names to their prototypes.
+    std::unordered_set<std::string> defined_pluhs; // Names of the pluhs with a body.
+    std::string return_type; // Return type of the pluh being checked.
+    int loop_depth;          // Number of holdUp loops around the current statement.
+
+    /**
+     * @brief Checks a type name is one of S-Lang's types.
+     *
+     * @throws codegen_error If it isn't.
+     */
+    void check_type_name(const std::string& name) const;
+
+    /**
+     * @brief Checks a value of one type can be converted to another (implicitly, as on
+     * assignment or when passing an argument).
+     *
+     * @throws codegen_error If it can't.
+     */
+    void check_cast(const std::string& from, const std::string& to) const;
+
+    /**
+     * @brief Returns the type both operands of a binary operation are converted to.
+     *
+     * @throws codegen_error If the operand types are incompatible.
+     */
+    std::string promote_operands(const std::string& lhs, const std::string& rhs) const;
+
+    /**
+     * @brief Checks a value of a type can be used as a condition.
+     *
+     * @throws codegen_error If it can't.
+     */
+    void check_condition(const std::string& type) const;
+  public:
+    /**
+     * @brief Constructs a checker with no pluhs declared.
+     */
+    Checker();
+
+    /**
+     * @brief Checks a whole program.
+     *
+     * @param module_node The program.
+     *
+     * @throws codegen_error On the first error found.
+     */
+    void check(TeaSpill& module_node);
+
+    /**
+     * @brief Returns the type of a literal.
+     */
+    std::string operator()(const Literal<int>& node);
+    std::string operator()(const Literal<double>& node);
+    std::string operator()(const Literal<bool>& node);
+    std::string operator()(const Literal<char>& node);
+    std::string operator()(const Literal<std::string>& node);
+
+    /**
+     * @brief Checks an expression, returning the type of its value.
+     *
+     * @throws codegen_error If the expression is invalid.
+     */
+    std::string operator()(VariableExpression& node);
+    std::string operator()(UnaryExpression& node);
+    std::string operator()(BinaryExpression& node);
+    std::string operator()(CallExpression& node);
+
+    /**
+     * @brief Checks a statement.
+     *
+     * @throws codegen_error If the statement is invalid.
+     */
+    void operator()(CookedUpStatement& node);
+    void operator()(CookedUpAssignmentStatement& node);
+    void operator()(AssignmentStatement& node);
+    void operator()(FrOngJustLikeThatStatement& node);
+    void operator()(HoldUpStatement& node);
+    void operator()(GhostStatement& node);
+    void operator()(RizzStatement& node);
+    void operator()(YeetStatement& node);
+    void operator()(CompoundStatement& node);
+
+    /**
+     * @brief Checks a pluh declaration.
+     *
+     * @throws codegen_error If the pluh is invalid.
+     */
+    void operator()(PluhDeclaration& node);
+
+    /**
+     * @brief Default destructor.
+     */
+    ~Checker() = default;
+};
+
+#endif
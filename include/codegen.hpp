@@ -23,6 +23,7 @@
 #include <llvm/ADT/APInt.h>
 #include <llvm/ADT/StringRef.h>
 #include <llvm/IR/BasicBlock.h>
+#include <llvm/IR/CFG.h>
 #include <llvm/IR/Constant.h>
 #include <llvm/IR/Constants.h>
 #include <llvm/IR/Function.h>
@@ -56,6 +57,13 @@ class Codegen {
                                               // loop's condition check.
     llvm::BasicBlock* current_loop_merge;     // Tracks the BasicBlock where the control
                                               // should merge after a loop.
+    std::unordered_map<std::string, llvm::Function*>
+        pluh_symbols; // Maps pluh names to their functions, which may be named
+                      // differently (eg. a redefinition in the REPL).
+    std::unordered_map<std::string, llvm::GlobalVariable*>
+        global_symbols; // Maps global variable names (eg. REPL session variables) to
+                        // their globals.
+    bool fuel_metering; // True to charge every pluh for the code it runs.
 
     /**
      * @brief Generates LLVM IR for a positive unary operation.
@@ -72,6 +80,8 @@ class Codegen {
      * @param rhs_value The right-hand side value of the unary operation.
      *
      * @return llvm::Value* -> The LLVM IR value of applying the negative unary operation.
+     *
+     * @throws codegen_error If the value isn't a number (eg. a string).
      */
     llvm::Value* negative_unary_op(llvm::Value* rhs_value);
 
@@ -261,6 +271,115 @@ class Codegen {
      * exists.
      */
     llvm::Type* get_type_from_typename(const std::string& name) const;
+
+    /**
+     * @brief Converts a value to the given LLVM type.
+     *
+     * Handles the implicit conversions S-Lang allows between its scalar types, such as
+     * int to float when a float variable is assigned an integer, or int to char.
+     *
+     * @param value The value to convert.
+     * @param type The type the value should be converted to.
+     *
+     * @return llvm::Value* -> The converted value (or the value itself if the types
+     * already match).
+     */
+    llvm::Value* cast_to_type(llvm::Value* value, llvm::Type* type);
+
+    /**
+     * @brief Promotes both operands of a binary operation to a common type.
+     *
+     * If either side is a float, both become floats. Otherwise, the narrower integer is
+     * sign extended to the width of the wider one.
+     *
+     * @param lhs_value The left-hand side value, updated in place.
+     * @param rhs_value The right-hand side value, updated in place.
+     */
+    void promote_operands(llvm::Value*& lhs_value, llvm::Value*& rhs_value);
+
+    /**
+     * @brief Converts a value into an i1 usable as a branch condition.
+     *
+     * @param value The value of a fr? or holdUp condition.
+     *
+     * @return llvm::Value* -> An i1 that is true when the value is non-zero.
+     */
+    llvm::Value* to_condition(llvm::Value* value);
+
+    /**
+     * @brief Creates an alloca in the entry block of a function.
+     *
+     * Keeping every alloca in the entry block lets LLVM's mem2reg promote the
+     * variables to registers.
+     *
+     * @param function The function the variable belongs to.
+     * @param name The name of the variable.
+     * @param type The type of the variable.
+     *
+     * @return llvm::AllocaInst* -> The stack slot of the variable.
+     */
+    llvm::AllocaInst* create_entry_alloca(llvm::Function* function,
+                                          const std::string& name, llvm::Type* type);
+
+    /**
+     * @brief Returns the LLVM function type of a pluh or plug.
+     *
+     * @param prototype The prototype of the pluh or plug.
+     *
+     * @return llvm::FunctionType* -> The function type.
+     */
+    llvm::FunctionType* get_function_type(Prototype& prototype);
+
+    /**
+     * @brief Generates the body of a pluh into the given (empty) function.
+     *
+     * @param node The PluhDeclaration node, which must have a body.
+     * @param function The function to generate the body into.
+     */
+    void generate_body(PluhDeclaration& node, llvm::Function* function);
+
+    /**
+     * @brief Charges a pluh fuel for the code it runs.
+     *
+     * Fuel is only checked at the entry of the pluh and on holdUp back edges, and each
+     * check subtracts the instruction count of the blocks it covers in one go: the entry
+     * pays for every block outside a loop, and a back edge for the whole loop it closes.
+     * A check that leaves less than zero fuel calls `slang.out_of_fuel`, which never
+     * returns.
+     *
+     * @param function The generated pluh.
+     */
+    void meter_fuel(llvm::Function* function);
+
+    /**
+     * @brief Looks up a variable in the current scope, then in the globals.
+     *
+     * @param name The name of the variable.
+     * @param type Set to the type of the value stored in the variable.
+     *
+     * @return llvm::Value* -> A pointer to the storage of the variable.
+     */
+    llvm::Value* get_variable(const std::string& name, llvm::Type*& type);
+
+    /**
+     * @brief Generates LLVM IR for the built-in yap pluh.
+     *
+     * yap prints each of its arguments on its own line using printf, choosing the
+     * format from the type of the argument.
+     *
+     * @param args The already generated arguments.
+     *
+     * @return llvm::Value* -> The value returned by the last printf call.
+     */
+    llvm::Value* yap_call(const std::vector<llvm::Value*>& args);
+
+    /**
+     * @brief Starts a fresh block after a yeet, ghost or rizz.
+     *
+     * Any statements following a terminator in the same compound statement are
+     * unreachable, but they still need a block to be generated into.
+     */
+    void continue_after_terminator();
   public:
     /**
      * @brief Overloaded function call operator for handling integer literals.
@@ -331,86 +450,131 @@ class Codegen {
      * @brief Overloaded function call operator for handling variable expressions.
      *
      * This operator generates LLVM IR code for a variable expression. It takes
-     * a unique pointer to a VariableExpression node representing the variable
-     * and retrieves the corresponding value from the symbol table or generates
-     * the necessary IR code to access it.
+     * the VariableExpression node representing the variable and retrieves the
+     * corresponding value from the symbol table or generates the necessary IR
+     * code to access it.
      *
-     * @param node A unique pointer to the VariableExpression node.
+     * @param node The VariableExpression node.
      *
      * @return llvm::Value* -> LLVM IR representation of the variable expression.
      */
-    llvm::Value* operator()(std::unique_ptr<VariableExpression>& node);
+    llvm::Value* operator()(VariableExpression& node);
 
     /**
      * @brief Overloaded function call operator for handling unary expressions.
      *
-     * This operator generates LLVM IR code for a unary expression. It takes a
-     * unique pointer to a UnaryExpression node, which contains an operator and
-     * a single operand, and generates the appropriate LLVM IR code to perform
-     * the unary operation.
+     * This operator generates LLVM IR code for a unary expression. It takes the
+     * UnaryExpression node, which contains an operator and a single operand, and
+     * generates the appropriate LLVM IR code to perform the unary operation.
      *
-     * @param node A unique pointer to the UnaryExpression node.
+     * @param node The UnaryExpression node.
      *
      * @return llvm::Value* -> LLVM IR representation of the unary expression.
      */
-    llvm::Value* operator()(std::unique_ptr<UnaryExpression>& node);
+    llvm::Value* operator()(UnaryExpression& node);
 
     /**
      * @brief Overloaded function call operator for handling binary expressions.
      *
-     * This operator generates LLVM IR code for a binary expression. It takes a
-     * unique pointer to a BinaryExpression node, which contains an operator and
-     * two operands, and generates the appropriate LLVM IR code to perform the
-     * binary operation.
+     * This operator generates LLVM IR code for a binary expression. It takes the
+     * BinaryExpression node, which contains an operator and two operands, and
+     * generates the appropriate LLVM IR code to perform the binary operation.
      *
-     * @param node A unique pointer to the BinaryExpression node.
+     * @param node The BinaryExpression node.
      *
      * @return llvm::Value* -> LLVM IR representation of the binary expression.
      */
-    llvm::Value* operator()(std::unique_ptr<BinaryExpression>& node);
+    llvm::Value* operator()(BinaryExpression& node);
 
     /**
      * @brief Overloaded function call operator for handling call expressions.
      *
      * This operator generates LLVM IR code for a function call expression. It
-     * takes a unique pointer to a CallExpression node, representing a function
-     * call, and generates the LLVM IR code to handle the function invocation,
-     * including argument passing and return value handling.
+     * takes the CallExpression node, representing a function call, and generates
+     * the LLVM IR code to handle the function invocation, including argument
+     * passing and return value handling.
      *
-     * @param node A unique pointer to the CallExpression node.
+     * @param node The CallExpression node.
      *
      * @return llvm::Value* -> LLVM IR representation of the function call expression.
      */
-    llvm::Value* operator()(std::unique_ptr<CallExpression>& node);
+    llvm::Value* operator()(CallExpression& node);
 
-    // TO DO: Documentation
-    void operator()(std::unique_ptr<CookedUpStatement>& node);
+    /**
+     * @brief Generates LLVM IR for a cookUp statement.
+     *
+     * Allocates a stack slot for the new variable and registers it in the current
+     * scope. The variable starts out zero initialized.
+     *
+     * @param node The CookedUpStatement node.
+     */
+    void operator()(CookedUpStatement& node);
 
-    // TO DO: Documentation
-    void operator()(std::unique_ptr<CookedUpAssignmentStatement>& node);
+    /**
+     * @brief Generates LLVM IR for a cookUp statement with an initial value.
+     *
+     * @param node The CookedUpAssignmentStatement node.
+     */
+    void operator()(CookedUpAssignmentStatement& node);
 
-    // TO DO: Documentation
-    void operator()(std::unique_ptr<AssignmentStatement>& node);
+    /**
+     * @brief Generates LLVM IR for an assignment statement.
+     *
+     * A variable name of "@" marks a bare pluh call whose result is discarded.
+     *
+     * @param node The AssignmentStatement node.
+     */
+    void operator()(AssignmentStatement& node);
 
-    // TO DO: Documentation
-    void operator()(std::unique_ptr<FrOngJustLikeThatStatement>& node);
+    /**
+     * @brief Generates LLVM IR for a fr?/ong?/justLikeThat? statement.
+     *
+     * @param node The FrOngJustLikeThatStatement node.
+     */
+    void operator()(FrOngJustLikeThatStatement& node);
 
-    // TO DO: Documentation
-    void operator()(std::unique_ptr<HoldUpStatement>& node);
+    /**
+     * @brief Generates LLVM IR for a holdUp loop.
+     *
+     * @param node The HoldUpStatement node.
+     */
+    void operator()(HoldUpStatement& node);
 
-    // TO DO: Documentation
-    void operator()(std::unique_ptr<GhostStatement>& node);
+    /**
+     * @brief Generates LLVM IR for a ghost (break) statement.
+     *
+     * @param node The GhostStatement node.
+     */
+    void operator()(GhostStatement& node);
 
-    // TO DO: Documentation
-    void operator()(std::unique_ptr<RizzStatement>& node);
+    /**
+     * @brief Generates LLVM IR for a rizz (continue) statement.
+     *
+     * @param node The RizzStatement node.
+     */
+    void operator()(RizzStatement& node);
 
-    // TO DO: Documentation
-    void operator()(std::unique_ptr<YeetStatement>& node);
+    /**
+     * @brief Generates LLVM IR for a yeet (return) statement.
+     *
+     * @param node The YeetStatement node.
+     */
+    void operator()(YeetStatement& node);
 
-    // TO DO: Documentation
-    void operator()(std::unique_ptr<CompoundStatement>& node);
+    /**
+     * @brief Generates LLVM IR for a compound statement.
+     *
+     * Variables declared inside the compound statement go out of scope at its end.
+     *
+     * @param node The CompoundStatement node.
+     */
+    void operator()(CompoundStatement& node);
 
-    // TO DO: Documentation
+    /**
+     * @brief Generates LLVM IR for a pluh (or declares a plug).
+     *
+     * @param node The PluhDeclaration node.
+     */
     void operator()(PluhDeclaration& node);
 
     /**
@@ -422,6 +586,144 @@ class Codegen {
      */
     Codegen();
 
+    /**
+     * @brief Meters every pluh generated from now on with a fuel counter.
+     *
+     * Metered code reads and writes the fuel left in the `slang.fuel` global (an i64)
+     * and calls `slang.out_of_fuel` when it runs out, both of which the host has to
+     * define (see Jit::run_with_fuel).
+     */
+    void enable_fuel_metering();
+
+    /**
+     * @brief Declares (or returns the existing declaration of) a pluh or plug.
+     *
+     * Calls to the pluh anywhere in this module will use the declared function. The
+     * REPL uses this to refer to pluhs compiled into earlier modules, and to give a
+     * redefined pluh a fresh symbol name.
+     *
+     * @param prototype The prototype of the pluh or plug.
+     * @param symbol_name The name of the function in the module. Defaults to the name
+     * of the pluh.
+     *
+     * @return llvm::Function* -> The declared function.
+     */
+    llvm::Function* declare_prototype(Prototype& prototype,
+                                      const std::string& symbol_name = "");
+
+    /**
+     * @brief Declares a global variable that every pluh in this module can use.
+     *
+     * @param name The name of the variable in S-Lang.
+     * @param type_name The S-Lang type of the variable.
+     * @param symbol_name The name of the global in the module.
+     * @param define True to define (and zero initialize) the global in this module,
+     * false if it's defined in another module.
+     */
+    void declare_global(const std::string& name, const std::string& type_name,
+                        const std::string& symbol_name, bool define);
+
+    /**
+     * @brief Generates a pluh as a new function with its own symbol name.
+     *
+     * Unlike visiting the PluhDeclaration, calls to the pluh (including recursive ones
+     * inside this body) keep going to whatever the pluh was declared as before. The REPL
+     * uses this for specialized clones, whose recursive calls must go back through the
+     * guard.
+     *
+     * @param node The PluhDeclaration node, which must have a body.
+     * @param symbol_name The name of the new function in the module.
+     *
+     * @return llvm::Function* -> The generated function.
+     */
+    llvm::Function* define_pluh(PluhDeclaration& node, const std::string& symbol_name);
+
+    /**
+     * @brief Generates a bare expression as a function of its free variables.
+     *
+     * The function takes the variables as arguments, in order, and returns the value
+     * of the expression converted to the given type. Calls in the expression can only
+     * go to yap and plugs declared in this module.
+     *
+     * @param expression The expression to generate.
+     * @param variables The name and S-Lang type of each free variable.
+     * @param type_name The S-Lang type of the result.
+     * @param symbol_name The name of the function in the module.
+     *
+     * @return llvm::Function* -> The generated function.
+     *
+     * @throws codegen_error If the expression is invalid (eg. an unknown variable).
+     */
+    llvm::Function*
+    define_expression(Expression& expression,
+                      const std::vector<std::pair<std::string, std::string>>& variables,
+                      const std::string& type_name, const std::string& symbol_name);
+
+    /**
+     * @brief Records the values a pluh's arguments are called with.
+     *
+     * Every call increments *calls. While *calls is below the window, the pluh also calls
+     * the hook with each profiled argument as `void hook(void* profile, i64 value)`.
+     * The counters and profiles are addresses in this process, so this is only valid for
+     * code JIT compiled into it.
+     *
+     * @param function The pluh to profile.
+     * @param calls Call counter of the pluh.
+     * @param profiles One profile per argument, or nullptr for arguments not profiled.
+     * @param window Number of calls to profile.
+     * @param hook_symbol The symbol of the hook.
+     */
+    void profile_arguments(llvm::Function* function, uint64_t* calls,
+                           const std::vector<void*>& profiles, uint64_t window,
+                           const std::string& hook_symbol);
+
+    /**
+     * @brief Replaces arguments of a pluh with constants, so the optimizer can fold
+     * them into its body. The arguments stay in the signature (their values are
+     * ignored), so the clone can be called just like the original.
+     *
+     * @param function The pluh to specialize.
+     * @param constants The index of each argument to replace and its value.
+     */
+    void specialize_arguments(llvm::Function* function,
+                              const std::vector<std::pair<unsigned, int64_t>>& constants);
+
+    /**
+     * @brief Defines a guard that calls a specialized clone of a pluh when the
+     * arguments match the constants it was specialized for, and the generic pluh
+     * otherwise, counting both outcomes.
+     *
+     * @param prototype The prototype of the pluh.
+     * @param guard_symbol The name of the guard in the module.
+     * @param special_symbol The name of the specialized clone.
+     * @param generic_symbol The name of the generic pluh.
+     * @param constants The index of each specialized argument and its value.
+     * @param hits Counter of calls that took the specialized clone.
+     * @param misses Counter of calls that fell back to the generic pluh.
+     */
+    void define_guard(Prototype& prototype, const std::string& guard_symbol,
+                      const std::string& special_symbol,
+                      const std::string& generic_symbol,
+                      const std::vector<std::pair<unsigned, int64_t>>& constants,
+                      uint64_t* hits, uint64_t* misses);
+
+    /**
+     * @brief Hands the generated module over to the caller (eg. the JIT).
+     *
+     * The module still belongs to this Codegen's LLVMContext, so take_context() must be
+     * called as well, and this Codegen can't generate anything afterwards.
+     *
+     * @return std::unique_ptr<llvm::Module> -> The generated module.
+     */
+    std::unique_ptr<llvm::Module> take_module();
+
+    /**
+     * @brief Hands the LLVMContext the module was generated in over to the caller.
+     *
+     * @return std::unique_ptr<llvm::LLVMContext> -> The context of the module.
+     */
+    std::unique_ptr<llvm::LLVMContext> take_context();
+
     /**
      * @brief Generates the LLVM IR from the given AST.
      *
@@ -435,6 +737,48 @@ class Codegen {
      */
     bool generate_ir(TeaSpill& module_node);
 
+    /**
+     * @brief Generates the LLVM IR of a program straight from its source, one
+     * declaration at a time.
+     *
+     * A first pass parses only the prototypes (skipping every body) and declares them.
+     * A second pass then parses each declaration, generates it and frees its AST before
+     * reading the next one, so the AST never takes more memory than the largest pluh,
+     * however big the program is. Both passes lex the code through a buffer of a chunk,
+     * so it's never copied whole either. The IR generated is the same as generate_ir's.
+     *
+     * With an output stream, each pluh is also written to it as soon as it's generated
+     * and then removed from the module, followed by the rest of the module (globals,
+     * plugs, ...) at the end, so the IR held in memory stays bounded as well. The
+     * written IR is equivalent to output_ir's, with the pluhs first.
+     *
+     * @param code The source code of the program.
+     * @param out Stream to write the IR to, or nullptr to keep it all in the module.
+     *
+     * @return True if the IR generation was successful, False otherwise.
+     */
+    bool generate_ir_streamed(const std::string& code, llvm::raw_ostream* out = nullptr);
+
+    /**
+     * @brief Generates the LLVM IR of one of many programs that share this module.
+     *
+     * Every pluh of the program is given a symbol name starting with the prefix, so
+     * programs can't clash with each other (plugs keep their names, since they refer to
+     * functions outside the module). Only the entry pluh can be called from outside the
+     * module, which lets the optimizer inline the others away. If the program fails to
+     * generate, everything it added is removed again, so the rest of the module stays
+     * valid.
+     *
+     * @param unit The root of the AST of the program.
+     * @param prefix Prefix of the symbol names of its pluhs (eg. "formula.7.").
+     * @param entry The name of the pluh called from outside the module.
+     *
+     * @throws codegen_error If the program has invalid code, or declares a plug with a
+     * different signature than another program in the module.
+     */
+    void generate_unit(TeaSpill& unit, const std::string& prefix,
+                       const std::string& entry);
+
     /**
      * @brief Outputs the generated LLVM IR as a string.
      *
@@ -84,4 +84,85 @@ class codegen_error : public std::exception {
     const char* what() const noexcept override { return message.c_str(); }
 };
 
-#endif
\ No newline at end of file
+/**
+ * @brief Exception for errors in the JIT.
+ *
+ * This exception is used to indicate errors while compiling or running code in the
+ * JIT, such as a module failing to compile or a symbol that cannot be found.
+ *
+ * @note Inherits from std::exception.
+ */
+class jit_error : public std::exception {
+  private:
+    std::string message;
+  public:
+    jit_error(const std::string& msg) : message(msg) {}
+    const char* what() const noexcept override { return message.c_str(); }
+};
+
+/**
+ * @brief Exception for a crashed executor.
+ *
+ * This exception is used to indicate that the process JIT'd code runs in (see
+ * slang-executor) died, eg. because the program crashed, while the compiler itself
+ * carried on.
+ *
+ * @note Inherits from std::exception.
+ */
+class executor_error : public std::exception {
+  private:
+    std::string message;
+  public:
+    executor_error(const std::string& msg) : message(msg) {}
+    const char* what() const noexcept override { return message.c_str(); }
+};
+
+/**
+ * @brief Exception for native compilation errors.
+ *
+ * This exception is used to indicate that a program couldn't be compiled into an
+ * object file or linked into an executable.
+ *
+ * @note Inherits from std::exception.
+ */
+class native_error : public std::exception {
+  private:
+    std::string message;
+  public:
+    native_error(const std::string& msg) : message(msg) {}
+    const char* what() const noexcept override { return message.c_str(); }
+};
+
+/**
+ * @brief Exception for code that ran out of fuel.
+ *
+ * This exception is used to indicate that metered code used up its fuel budget and
+ * was stopped before it finished.
+ *
+ * @note Inherits from std::exception.
+ */
+class out_of_fuel_error : public std::exception {
+  private:
+    std::string message;
+  public:
+    out_of_fuel_error(const std::string& msg) : message(msg) {}
+    const char* what() const noexcept override { return message.c_str(); }
+};
+
+/**
+ * @brief Exception for profiler errors.
+ *
+ * This exception is used to indicate that the sampling profiler couldn't be set up, eg.
+ * because another profiler is already running.
+ *
+ * @note Inherits from std::exception.
+ */
+class profiler_error : public std::exception {
+  private:
+    std::string message;
+  public:
+    profiler_error(const std::string& msg) : message(msg) {}
+    const char* what() const noexcept override { return message.c_str(); }
+};
+
+#endif
@@ -0,0 +1,187 @@
+/**
+ * @file interner.hpp
+ * @brief Concurrent String Interner for the S-Lang Compiler
+ *
+ * This file contains the definition of the Interner class, which keeps a single copy of
+ * every distinct string it's given (identifiers, string literal contents, ...). Interned
+ * strings compare equal exactly when they point to the same characters, so front end
+ * threads can share names without copying them or comparing them character by
+ * character, and without a lock around a shared symbol table.
+ *
+ * @author Sagar Patel
+ * @date 10-18-2026
+ *
+ * Project: S-Lang Compiler
+ */
+
+#ifndef INTERNER_HPP
+#define INTERNER_HPP
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Interns strings for any number of threads at once.
+ *
+ * Strings are hashed into one of a few shards, each an open addressing table of atomic
+ * pointers to the interned strings. Looking a string up never takes a lock: it probes
+ * the table of its shard, and a new string is published by compare-exchanging the first
+ * empty slot it finds, so two threads interning the same string agree on the winner.
+ * The characters themselves are copied into an append-only arena of the interning
+ * thread, so threads never contend to allocate.
+ *
+ * A shard that gets three quarters full grows under a lock of its own: the slots of the
+ * old table are frozen, copied into one twice the size, and the new one is published.
+ * Only threads interning into that shard while it grows wait for it. Old tables are kept
+ * until the interner is destroyed, since other threads may still be probing them.
+ *
+ * Interned strings are null terminated and live as long as the interner.
+ */
+class Interner {
+  private:
+    /**
+     * @brief An interned string, the header of its characters in an arena.
+     */
+    struct Entry {
+        uint64_t hash; // Hash of the string.
+        size_t length; // Length of the string, the characters follow the entry.
+
+        /**
+         * @brief Gets the interned string.
+         *
+         * @return std::string_view -> The string.
+         */
+        std::string_view text() const {
+            return {reinterpret_cast<const char*>(this + 1), length};
+        }
+    };
+
+    /**
+     * @brief An open addressing table of interned strings, a power of 2 slots big.
+     */
+    struct Table {
+        size_t mask; // Number of slots - 1.
+        std::unique_ptr<std::atomic<const Entry*>[]> slots; // Empty slots hold nullptr.
+        std::unique_ptr<Table> previous; // The table this one replaced, kept for readers.
+
+        /**
+         * @brief Creates a table of empty slots.
+         *
+         * @param capacity Number of slots, a power of 2.
+         */
+        explicit Table(size_t capacity);
+    };
+
+    /**
+     * @brief A part of the interner, holding the strings whose hash starts with its
+     * index. Aligned to a cache line so threads interning into different shards don't
+     * share one.
+     */
+    struct alignas(64) Shard {
+        std::atomic<Table*> table;    // The table strings are interned into.
+        std::atomic<size_t> count;    // Number of strings interned into the shard.
+        std::mutex grow_mutex;        // Held while the shard grows.
+        std::unique_ptr<Table> owned; // Owns the table, and through it the older ones.
+    };
+
+    /**
+     * @brief An append-only arena the strings of one thread are copied into.
+     */
+    class Arena {
+      private:
+        std::vector<std::unique_ptr<char[]>> blocks; // Every block allocated.
+        char* next;                                  // Next free byte of the last block.
+        char* end;                                   // End of the last block.
+      public:
+        /**
+         * @brief Creates an empty arena.
+         */
+        Arena();
+
+        /**
+         * @brief Copies a string into the arena as an entry.
+         *
+         * @param text The string.
+         * @param hash Hash of the string.
+         *
+         * @return Entry* -> The entry.
+         */
+        Entry* allocate(std::string_view text, uint64_t hash);
+
+        /**
+         * @brief Frees the last entry allocated, for a string another thread interned
+         * first.
+         *
+         * @param entry The entry, which must be the last allocated.
+         */
+        void rollback(Entry* entry);
+    };
+
+    static const Entry moved; // Marks the empty slots of a table being grown.
+
+    uint64_t id;                     // Unique id, to find each thread's arena.
+    unsigned shard_bits;             // The shard of a string is its top hash bits.
+    std::unique_ptr<Shard[]> shards; // The shards, 2 ^ shard_bits of them.
+    std::mutex arenas_mutex;         // Guards arenas.
+    std::deque<Arena> arenas;        // The arena of every thread that interned.
+
+    /**
+     * @brief Gets the arena of the calling thread, creating it on its first use.
+     *
+     * @return Arena& -> The arena.
+     */
+    Arena& get_arena();
+
+    /**
+     * @brief Grows a shard into a table twice the size, unless another thread already
+     * replaced the table.
+     *
+     * @param shard The shard.
+     * @param full The table found full.
+     */
+    void grow(Shard& shard, Table* full);
+  public:
+    /**
+     * @brief Creates an empty interner.
+     *
+     * @param shard_bits The interner has 2 ^ shard_bits shards.
+     * @param shard_capacity Initial slots of every shard, rounded up to a power of 2.
+     */
+    explicit Interner(unsigned shard_bits = 6, size_t shard_capacity = 256);
+
+    /**
+     * @brief Deleted copy constructor, interned strings point into the interner.
+     */
+    Interner(const Interner&) = delete;
+
+    /**
+     * @brief Interns a string. Thread safe and lock free unless the string's shard is
+     * growing.
+     *
+     * @param text The string.
+     *
+     * @return std::string_view -> The interned copy of the string, the same for every
+     * equal string.
+     */
+    std::string_view intern(std::string_view text);
+
+    /**
+     * @brief Gets the number of distinct strings interned so far.
+     *
+     * @return size_t -> The number of strings.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Default destructor, frees every interned string.
+     */
+    ~Interner() = default;
+};
+
+#endif
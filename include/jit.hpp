@@ -0,0 +1,269 @@
+/**
+ * @file jit.hpp
+ * @brief Just-In-Time Compiler for the S-Lang Compiler
+ *
+ * This file contains the definition of the Jit class, a thin wrapper around LLVM's ORC
+ * LLJIT. Modules produced by the Codegen are added to one long-lived JIT session, so
+ * code compiled earlier stays loaded and is never compiled again.
+ *
+ * @author Sagar Patel
+ * @date 10-18-2026
+ *
+ * Project: S-Lang Compiler
+ */
+
+#ifndef JIT_HPP
+#define JIT_HPP
+#pragma once
+
+#include "exceptions.hpp"
+#include "scheduler.hpp"
+#include <llvm/ExecutionEngine/JITEventListener.h>
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#include <llvm/ExecutionEngine/Orc/IndirectionUtils.h>
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <sys/types.h>
+#include <memory>
+#include <string>
+
+/**
+ * @brief JIT session for the S-Lang Compiler.
+ *
+ * Jit compiles modules into the running process. Symbols that aren't defined by any
+ * added module (eg. printf, or pluhs declared with plug) are resolved against the
+ * symbols of the process itself.
+ *
+ * Given an executor, Jit compiles in this process but runs the code in a child process
+ * (see app/executor.cpp) instead: linked code is copied into the child over a pair of
+ * pipes, and pluhs are called there. A program that crashes only takes the child down,
+ * and the session reports it with an executor_error. Fuel and stubs need the code in
+ * this process, so they aren't available out of process. While any session has an
+ * executor, SIGPIPE is ignored process wide (LLVM writes to the pipes with plain writes,
+ * which can't opt out of it), so writing to a crashed executor fails instead of killing
+ * the compiler. The disposition it had before is restored once the last one ends.
+ *
+ * Pluhs that may be swapped out while the process runs (hot reload) are called through
+ * indirection stubs: a stub is a tiny function that jumps through a pointer, so pointing
+ * it at new code redirects every later call while calls already running finish on the
+ * old code, which is never freed.
+ */
+class IgnoredSigpipe;
+
+class Jit {
+  private:
+    std::unique_ptr<IgnoredSigpipe> ignored_sigpipe; // Held while there's an executor,
+                                                     // outliving the session using it.
+    std::unique_ptr<llvm::orc::LLJIT> jit; // The underlying ORC JIT.
+    std::unique_ptr<llvm::orc::IndirectStubsManager> stubs; // Indirection stubs.
+    std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler>
+        eager_compiler;   // Compiles modules on any thread, for compile_module.
+    int64_t fuel;         // Fuel left for metered code (the `slang.fuel` global).
+    Scheduler* scheduler; // Scheduler modules are compiled on, if any.
+    std::mutex compiles_mutex;                    // Guards compiles.
+    std::vector<std::shared_ptr<Task>> compiles; // Compiles dispatched to the scheduler.
+    pid_t executor;       // Process the code runs in, or -1 for this one.
+    std::string executor_exit; // How the executor exited, once it has.
+
+    /**
+     * @brief Starts an executor process, connected to this one by a pair of pipes.
+     *
+     * @param path Path of the executor binary.
+     *
+     * @return std::unique_ptr<llvm::orc::ExecutorProcessControl> -> The connection.
+     *
+     * @throws jit_error If the executor can't be started.
+     */
+    std::unique_ptr<llvm::orc::ExecutorProcessControl> start_executor(
+        const std::string& path);
+
+    /**
+     * @brief Waits for the executor to exit (killing it if it hangs on) and records how
+     * it exited.
+     *
+     * @return std::string -> How the executor exited, eg. "killed by signal 11".
+     */
+    std::string reap_executor();
+  public:
+    /**
+     * @brief Creates a JIT session targeting the host.
+     *
+     * @param cache Optional cache (eg. a SnapshotCache) consulted before compiling a
+     * module and told about every module compiled. It must outlive the session.
+     * @param opt_level Optimization level (0 to 3) modules are compiled at. Code is only
+     * ever compiled once, at this level, so it runs at full speed from the start.
+     * @param scheduler Scheduler to compile modules on, in parallel, or nullptr to
+     * compile them on the thread that looks them up. Symbols must then not be looked up
+     * from one of its tasks.
+     * @param executor_path Path of the executor binary (slang-executor) to run the code
+     * in, or empty to run it in this process.
+     *
+     * @throws jit_error If the host target can't be initialized or the executor can't be
+     * started.
+     */
+    Jit(llvm::ObjectCache* cache = nullptr, unsigned opt_level = 2,
+        Scheduler* scheduler = nullptr, const std::string& executor_path = "");
+
+    /**
+     * @brief Adds a module to the session. The module is compiled on the first lookup
+     * of a symbol it defines.
+     *
+     * @param context The LLVMContext the module was generated in.
+     * @param module The module to add.
+     *
+     * @throws jit_error If the module can't be added (eg. a symbol is defined twice).
+     */
+    void add_module(std::unique_ptr<llvm::LLVMContext> context,
+                    std::unique_ptr<llvm::Module> module);
+
+    /**
+     * @brief Adds an object file compiled earlier (eg. a snapshot) to the session, as if
+     * the module it was compiled from had been added. It's linked on the first lookup of
+     * a symbol it defines.
+     *
+     * @param object The object file.
+     *
+     * @throws jit_error If the object can't be added (eg. a symbol is defined twice).
+     */
+    void add_object(std::unique_ptr<llvm::MemoryBuffer> object);
+
+    /**
+     * @brief Optimizes and compiles a module to machine code right away, on the calling
+     * thread, then adds it to the session. Only linking is left for the first lookup of
+     * a symbol it defines, so the symbols it refers to can be added later.
+     *
+     * Thread safe: modules can be compiled on several threads at once, eg. while the
+     * rest of the program is still being parsed (see Pipeline).
+     *
+     * @param context The LLVMContext the module was generated in.
+     * @param module The module to compile.
+     *
+     * @throws jit_error If the module fails to compile, or defines a symbol that's
+     * already defined.
+     */
+    void compile_module(std::unique_ptr<llvm::LLVMContext> context,
+                        std::unique_ptr<llvm::Module> module);
+
+    /**
+     * @brief Looks up the address of a symbol, compiling the module defining it if
+     * needed.
+     *
+     * @param symbol The name of the symbol.
+     *
+     * @return uint64_t -> The address of the symbol in the process the code runs in.
+     *
+     * @throws jit_error If the symbol can't be found or fails to compile.
+     */
+    uint64_t lookup(const std::string& symbol);
+
+    /**
+     * @brief Looks up the addresses of many symbols at once. With a scheduler, the
+     * modules defining them are compiled in parallel.
+     *
+     * @param symbols The names of the symbols.
+     *
+     * @return std::vector<uint64_t> -> The address of each symbol, in the same order.
+     *
+     * @throws jit_error If a symbol can't be found or fails to compile.
+     */
+    std::vector<uint64_t> lookup_all(const std::vector<std::string>& symbols);
+
+    /**
+     * @brief Defines a symbol at a fixed address in this process (eg. a host function
+     * JIT'd code calls back into).
+     *
+     * @param symbol The name of the symbol.
+     * @param address The address of the symbol.
+     *
+     * @throws jit_error If the symbol already exists.
+     */
+    void define_symbol(const std::string& symbol, uint64_t address);
+
+    /**
+     * @brief Defines a symbol as an indirection stub that jumps to the given address.
+     *
+     * @param symbol The name of the stub, which calls from any module resolve to.
+     * @param address The address the stub jumps to.
+     *
+     * @throws jit_error If the stub can't be created (eg. the symbol already exists, or
+     * the code runs in an executor).
+     */
+    void define_stub(const std::string& symbol, uint64_t address);
+
+    /**
+     * @brief Atomically points a stub at a new address.
+     *
+     * @param symbol The name of the stub.
+     * @param address The new address the stub jumps to.
+     *
+     * @throws jit_error If there's no such stub (or the code runs in an executor).
+     */
+    void update_stub(const std::string& symbol, uint64_t address);
+
+    /**
+     * @brief Calls a pluh that takes no arguments and returns an int (eg. main), in the
+     * process the code runs in.
+     *
+     * @param address The address of the pluh.
+     *
+     * @return int -> The value the pluh yeeted.
+     *
+     * @throws executor_error If the executor died (eg. the pluh crashed it).
+     */
+    int run(uint64_t address);
+
+    /**
+     * @brief Registers a listener told about every object linked into this process from
+     * now on, with the addresses its sections were loaded at (eg. a Profiler).
+     *
+     * @param listener The listener, which must outlive the session.
+     *
+     * @throws jit_error If the code runs in an executor.
+     */
+    void add_listener(llvm::JITEventListener& listener);
+
+    /**
+     * @brief Checks whether the code runs in an executor process.
+     *
+     * @return true if it does, false if it runs in this process.
+     */
+    bool is_out_of_process() const;
+
+    /**
+     * @brief Calls a metered pluh (see Codegen::enable_fuel_metering) that takes no
+     * arguments and returns an int, with a fuel budget.
+     *
+     * If the pluh runs out of fuel, it's stopped where it is and control comes straight
+     * back here. Metered code never holds resources that need cleaning up, so nothing
+     * leaks, but whatever it wrote to globals before it stopped stays written.
+     *
+     * @param address The address of the pluh.
+     * @param fuel The fuel the pluh may use, updated to the fuel it left over.
+     *
+     * @return int -> The value the pluh yeeted.
+     *
+     * @throws out_of_fuel_error If the pluh runs out of fuel.
+     * @throws jit_error If the code runs in an executor.
+     */
+    int run_with_fuel(uint64_t address, int64_t& fuel);
+
+    /**
+     * @brief Runs the optimization pipeline the JIT compiles modules with over a module,
+     * eg. to compile it ahead of time the same way.
+     *
+     * @param module The module to optimize.
+     * @param machine The machine the module will be compiled for.
+     * @param opt_level Optimization level (1 to 3).
+     */
+    static void optimize(llvm::Module& module, llvm::TargetMachine* machine,
+                         unsigned opt_level);
+
+    /**
+     * @brief Destructor, waits for the compiles still running on the scheduler and for
+     * the executor, if any, to exit.
+     */
+    ~Jit();
+};
+
+#endif
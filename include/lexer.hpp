@@ -7,8 +7,8 @@
  * into a stream of tokens. These tokens are then used by the parser to create
  * an abstract syntax tree.
  *
- * Usage involves creating an instance of Lexer with source code and calling the
- * `get_token` method to retrieve tokens one at a time.
+ * Usage involves creating an instance of Lexer with source code (or a file descriptor
+ * to read it from) and calling the `get_token` method to retrieve tokens one at a time.
  *
  * @author Sagar Patel
  * @date 12-17-2023
@@ -22,8 +22,12 @@
 
 #include "debug_stream.hpp"
 #include "exceptions.hpp"
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
 
 /**
  * @brief Enum class representing different types of tokens in S-Lang.
@@ -58,8 +62,18 @@ enum class TokenType {
     COMPLEX,
 };
 
-// A Token alias, consisting of a TokenType and its associated string value.
-using Token = std::pair<TokenType, std::string>;
+/**
+ * @brief A token: its TokenType and its text, as a std::pair, plus the value of a number
+ * literal, which the lexer converts as it lexes it.
+ *
+ * Tokens compare by their type and text only.
+ */
+struct Token : std::pair<TokenType, std::string> {
+    using std::pair<TokenType, std::string>::pair;
+
+    uint64_t int_value = 0;   // Value of an INT token.
+    double float_value = 0.0; // Value of a FLOAT token.
+};
 
 /**
  * @brief The Lexer class for the S-Lang compiler.
@@ -68,13 +82,36 @@ using Token = std::pair<TokenType, std::string>;
  * It reads the input source code string and outputs tokens that represent
  * the smallest individual units of the code, identifiable by the TokenType
  * enum.
+ *
+ * Number literals are decimal (`1337`, `3.25`, `.5`, `6.02e23`, `2f`), hexadecimal
+ * (`0xFF`) or binary (`0b1010`), and their digits may be grouped with underscores
+ * (`1_000_000`). A literal with a point, an exponent or an `f` suffix is a FLOAT. Values
+ * are converted with std::from_chars as they're lexed, so they're carried by the token
+ * and never depend on the locale.
+ *
+ * Code is UTF-8. Identifiers start with a letter of any script (a Unicode XID_Start
+ * character) and continue with XID_Continue characters, underscores and question marks,
+ * and string literals may hold any character. Both are validated as they're lexed, but
+ * runs of ASCII are skipped a vector at a time (see unicode.hpp), so only non-ASCII
+ * characters are decoded. Char literals hold a single ASCII character.
+ *
+ * Given a file descriptor (eg. stdin), the lexer reads the code a chunk at a time into a
+ * buffer it refills once it runs out, keeping only what the current token still needs.
+ * Tokens and comments may span any number of chunks, and the buffer stays about a chunk
+ * long however much input there is, unless a single number literal is longer.
  */
 class Lexer {
   private:
-    std::string code;         // Source code as a string
+    std::string code;         // Source code as a string (or the chunks read of it)
     int current_char;         // Current character being processed
     bool else_if_enabled;     // Flag for parsing ELSE IF statements
     std::string::iterator it; // Iterator for stepping through code string
+    int line;                 // Line get_line last counted up to.
+    std::string::iterator line_counted; // Where get_line stopped counting newlines.
+    int fd;                   // File descriptor the code is read from, or -1.
+    std::string_view source;  // Code not copied into the buffer yet, when lexing a view.
+    size_t chunk_size;        // Most bytes read from fd at once.
+    bool exhausted;           // Whether all of the code is in the buffer.
     const std::unordered_map<std::string, TokenType> table =
         { // Keyword table (kept Tokens more readable for easier debugging)
             {"pluh", TokenType::DEF},
@@ -91,13 +128,92 @@ class Lexer {
             {"facts", TokenType::BOOL},
             {"cap", TokenType::BOOL},
             {"spillingTeaAbout", TokenType::PROGRAM}};
+
+    Token lex_token(); // Lexes the next token, for get_token to count.
+
+    /**
+     * @brief Reads the next character, refilling the buffer first if it ran out.
+     *
+     * @return int -> The character, or '\0' at the end of the code.
+     */
+    int next_char();
+
+    /**
+     * @brief Drops what's been lexed from the buffer, then reads chunks of the input
+     * until there are at least `ahead` characters from `it` on, or the input ends.
+     *
+     * @param ahead Number of characters needed.
+     *
+     * @throws process_file_error If the input can't be read.
+     */
+    void refill(size_t ahead);
+
+    /**
+     * @brief Decodes the UTF-8 character at an offset from `it`, reading more of the
+     * input first if it may be cut off.
+     *
+     * @param offset Offset of the character from `it`: -1 for current_char, or 0.
+     * @param code_point Set to the code point of the character, if it's valid.
+     *
+     * @return size_t -> The length of the character, or 0 if it isn't valid UTF-8.
+     */
+    size_t decode(std::ptrdiff_t offset, char32_t& code_point);
+
+    /**
+     * @brief Lexes an identifier starting at current_char.
+     *
+     * @return std::string -> The identifier.
+     *
+     * @throws invalid_literal_error If it has invalid UTF-8.
+     */
+    std::string lex_identifier();
+
+    /**
+     * @brief Lexes the contents of a string literal, current_char being its opening
+     * quote, and moves past its closing quote.
+     *
+     * @return std::string -> The contents.
+     *
+     * @throws invalid_literal_error If it never ends, or has invalid UTF-8.
+     */
+    std::string lex_string();
+
+    /**
+     * @brief Lexes a number literal starting at current_char, converting its value.
+     *
+     * @return Token -> An INT or FLOAT token.
+     *
+     * @throws invalid_literal_error If the literal is malformed or out of range.
+     */
+    Token lex_number();
   public:
+    static const size_t default_chunk_size = 1 << 16; // Bytes read from a fd at once.
+
     /**
      * @brief Constructs a new Lexer object with given source code.
      *
      * @param code The source code as a string.
      */
-    Lexer(const std::string& code);
+    Lexer(std::string code);
+
+    /**
+     * @brief Constructs a new Lexer object reading source code from a file descriptor,
+     * a chunk at a time. The descriptor isn't closed by the lexer.
+     *
+     * @param fd The file descriptor, eg. 0 for stdin.
+     * @param chunk_size Most bytes read at once.
+     */
+    Lexer(int fd, size_t chunk_size = default_chunk_size);
+
+    /**
+     * @brief Constructs a new Lexer object over source code it doesn't own, copying it
+     * into the buffer a chunk at a time as if it was read from a file descriptor. Many
+     * lexers can share the code this way without ever holding a copy of all of it.
+     *
+     * @param code The source code, which has to outlive the lexer.
+     * @param chunk_size Most bytes copied at once.
+     */
+    Lexer(std::string_view code, size_t chunk_size);
 
     /**
      * @brief Default move constructor.
@@ -123,9 +239,23 @@ class Lexer {
      * the current position in the code string.
      *
      * @return The upcoming Token in the source code.
+     *
+     * @throws invalid_literal_error If a char, string or number literal is malformed.
+     * @throws process_file_error If the code is read from a file descriptor that can't
+     * be read.
      */
     Token get_token();
 
+    /**
+     * @brief Gets the line the lexer is on, ie. the line of the end of the last token.
+     *
+     * Lines are counted from where the last call stopped, so lexing doesn't pay for
+     * them unless they're asked for.
+     *
+     * @return int -> The line, starting from 1.
+     */
+    int get_line();
+
     /**
      * @brief Default destructor.
      */
@@ -0,0 +1,111 @@
+/**
+ * @file native.hpp
+ * @brief Ahead-of-Time Compiler for the S-Lang Compiler
+ *
+ * This file contains the definition of the NativeCompiler class, which turns a module
+ * produced by the Codegen into an object file and links it into an executable, instead
+ * of running it in a JIT session.
+ *
+ * @author Sagar Patel
+ * @date 10-18-2026
+ *
+ * Project: S-Lang Compiler
+ */
+
+#ifndef NATIVE_HPP
+#define NATIVE_HPP
+#pragma once
+
+#include "exceptions.hpp"
+#include <llvm/IR/Module.h>
+#include <llvm/Target/TargetMachine.h>
+#include <memory>
+#include <string>
+
+/**
+ * @brief Compiles modules into executables for the host.
+ *
+ * Modules are optimized with the JIT's pipeline and compiled for the host CPU. By
+ * default the object is linked by the system's C compiler against libc, like a C
+ * program. Given the static runtime (runtime/slang_rt.c, built as libslang_rt.a), it's
+ * linked by ld into a static executable against that instead: a program then starts
+ * straight at main, without the dynamic loader or libc's initialization, but can only
+ * call what the runtime provides (yap, not other plugged libc functions).
+ *
+ * Built with lld (see SLANG_LLD in CMakeLists.txt), static executables are linked in
+ * this process through lld's library interface, so compiling one never starts another
+ * process. Otherwise ld is run for them, and the default link always runs the C
+ * compiler, which knows where libc and its startup files are.
+ */
+class NativeCompiler {
+  private:
+    unsigned opt_level;       // Optimization level (0 to 3).
+    std::string runtime_path; // Path of the static runtime, or empty to link with libc.
+    std::unique_ptr<llvm::TargetMachine> machine; // Compiles for the host.
+    double link_seconds;      // How long the last link took.
+  public:
+    /**
+     * @brief Creates a compiler for the host.
+     *
+     * @param opt_level Optimization level (0 to 3) to compile modules at.
+     * @param runtime_path Path of the static runtime archive (libslang_rt.a) to link
+     * executables against, or empty to link them against libc.
+     *
+     * @throws native_error If there's no target for the host.
+     */
+    NativeCompiler(unsigned opt_level = 2, const std::string& runtime_path = "");
+
+    /**
+     * @brief Optimizes a module and compiles it into an object file.
+     *
+     * @param module The module, which is optimized in place.
+     * @param object_path Path of the object file to write.
+     *
+     * @throws native_error If the object file can't be written.
+     */
+    void emit_object(llvm::Module& module, const std::string& object_path);
+
+    /**
+     * @brief Links an object file into an executable.
+     *
+     * @param object_path Path of the object file, with a main pluh.
+     * @param executable_path Path of the executable to write.
+     *
+     * @throws native_error If the linker can't be found or fails (eg. on a symbol the
+     * static runtime doesn't provide).
+     */
+    void link(const std::string& object_path, const std::string& executable_path);
+
+    /**
+     * @brief Compiles a module into an executable, through a temporary object file.
+     *
+     * @param module The module, with a main pluh.
+     * @param executable_path Path of the executable to write.
+     *
+     * @throws native_error If the module can't be compiled or linked.
+     */
+    void compile(llvm::Module& module, const std::string& executable_path);
+
+    /**
+     * @brief Checks whether executables are linked against the static runtime.
+     *
+     * @return true if they are, false if they're linked against libc.
+     */
+    bool is_static() const;
+
+    /**
+     * @brief Gets the linker executables are linked with.
+     *
+     * @return std::string -> "lld (in process)", "ld" or "cc".
+     */
+    std::string get_linker() const;
+
+    /**
+     * @brief Gets how long the last link took.
+     *
+     * @return double -> The time in seconds, or 0 if nothing was linked yet.
+     */
+    double get_link_time() const;
+};
+
+#endif
@@ -23,12 +23,18 @@
 
 #include "ast.hpp"
 #include "lexer.hpp"
+#include <string>
+#include <unordered_map>
 
 /**
  * @brief The Parser class for the S-Lang compiler.
  *
  * Parser is responsible for processing the tokens code into an AST (Abstract Syntax
- * Tree).
+ * Tree). Syntax errors are reported by throwing parse_logic_error (or
+ * invalid_literal_error for malformed literals), so callers such as the REPL can recover
+ * from them. Input nested more than 1000 levels deep, or an expression whose tree is
+ * more than 10000 levels deep, is a syntax error too, so hostile input can't overflow the
+ * stack.
  */
 class Parser {
   private:
@@ -37,6 +43,18 @@ class Parser {
     Token current_token; // Stores the current token being processed by the
                          // parser.
     int get_op_precedence() const; // Returns precedence of current op token.
+    int nesting; // Levels of expressions and statements being parsed, to bound the
+                 // recursion of the parser on deeply nested input.
+    uint64_t expression_depth; // Depth of the expression parsed last, counting its
+                               // root, tracked as it's built for the stats.
+    std::unordered_map<std::string, int> pluh_lines; // Line each pluh's name is on.
+
+    /**
+     * @brief Skips over the body of a pluh without parsing it, by matching its braces.
+     *
+     * @throws parse_logic_error If the body doesn't start with { or never ends.
+     */
+    void skip_curly_compound();
   public:
     /**
      * @brief Constructor for the Parser class.
@@ -47,21 +65,44 @@ class Parser {
      */
     Parser(std::string code);
 
+    /**
+     * @brief Constructor for the Parser class reading the source code from a file
+     * descriptor, a chunk at a time (see Lexer).
+     *
+     * @param fd The file descriptor, eg. 0 for stdin. It isn't closed by the parser.
+     * @param chunk_size Most bytes read at once.
+     *
+     * @throws process_file_error If the code can't be read.
+     */
+    Parser(int fd, size_t chunk_size = Lexer::default_chunk_size);
+
+    /**
+     * @brief Constructor for the Parser class over source code it doesn't own, copied a
+     * chunk at a time (see Lexer), so parsing never holds a second copy of it.
+     *
+     * @param code The source code, which has to outlive the parser.
+     * @param chunk_size Most bytes copied at once.
+     */
+    Parser(std::string_view code, size_t chunk_size);
+
     /**
      * @brief Parses an integer literal from the source code.
      *
-     * This method identifies and extracts an integer literal, converting it
-     * into a Literal<int> object.
+     * This method takes the value the lexer converted the current integer literal to
+     * into a Literal<int> object. Ints are 32 bits, but a hex or binary literal may set
+     * the sign bit (eg. 0xFFFFFFFF is -1).
      *
      * @return A Literal<int> representing the parsed integer value.
+     *
+     * @throws invalid_literal_error If the value doesn't fit in an int.
      */
     Literal<int> parse_int();
 
     /**
      * @brief Parses a floating-point literal from the source code.
      *
-     * This method identifies and extracts a floating-point literal, converting
-     * it into a Literal<double> object.
+     * This method takes the value the lexer converted the current floating-point
+     * literal to into a Literal<double> object.
      *
      * @return A Literal<double> representing the parsed floating-point value.
      */
@@ -162,7 +203,8 @@ class Parser {
      * @brief Parses a list of arguments in a function call.
      *
      * This method deals with parsing the arguments passed in a function call,
-     * handling comma-separated expressions within parentheses.
+     * handling comma-separated expressions within parentheses. It leaves
+     * expression_depth at the depth of the call.
      *
      * @return A vector of Expression objects, each representing a parsed
      * argument in the call list.
@@ -316,6 +358,27 @@ class Parser {
      */
     PluhDeclaration parse_plug();
 
+    /**
+     * @brief Parses the next declaration (pluh or plug) in the code.
+     *
+     * Lets a caller handle a program one declaration at a time, and free each one
+     * before the next is parsed, instead of holding the whole AST (see
+     * Codegen::generate_ir_streamed).
+     *
+     * @return The parsed declaration, or std::nullopt at the end of the file.
+     */
+    std::optional<PluhDeclaration> parse_next_declaration();
+
+    /**
+     * @brief Parses the prototypes of all remaining declarations, skipping the bodies of
+     * pluhs.
+     *
+     * Much cheaper than parsing the declarations, since no AST is built for any body.
+     *
+     * @return The prototypes, in the order they were declared.
+     */
+    std::vector<Prototype> parse_prototypes();
+
     /**
      * @brief Parses all declarations in the code.
      *
@@ -329,6 +392,13 @@ class Parser {
      */
     std::vector<std::variant<PluhDeclaration>> parse_declarations();
 
+    /**
+     * @brief Parses the header of the program ('spillingTeaAbout <name>').
+     *
+     * @return The name of the program.
+     */
+    std::string parse_tea_header();
+
     /**
      * @brief Parses the entire program, forming the root of the Abstract Syntax Tree.
      *
@@ -339,6 +409,23 @@ class Parser {
      * @return A TeaSpill object that represents the entire parsed program.
      */
     TeaSpill parse_tea();
+
+    /**
+     * @brief Gets the token the parser is currently looking at.
+     *
+     * Useful for callers that use the individual parse methods as entry points (eg. the
+     * REPL), to check what comes next or that all of the input was consumed.
+     *
+     * @return The current Token.
+     */
+    const Token& get_current_token() const;
+
+    /**
+     * @brief Gets the line each pluh and plug parsed so far is declared on.
+     *
+     * @return const std::unordered_map<std::string, int>& -> The line of each name.
+     */
+    const std::unordered_map<std::string, int>& get_pluh_lines() const;
 };
 
 #endif
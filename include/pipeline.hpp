@@ -0,0 +1,128 @@
+/**
+ * @file pipeline.hpp
+ * @brief Pipelined Compilation for the S-Lang Compiler
+ *
+ * This file contains the definition of the Pipeline class, which compiles one large
+ * program on several threads at once. One thread parses the program a declaration at a
+ * time while worker threads generate, optimize and compile the declarations parsed
+ * before, so parsing declaration N+1 overlaps with compiling declaration N.
+ *
+ * @author Sagar Patel
+ * @date 10-18-2026
+ *
+ * Project: S-Lang Compiler
+ */
+
+#ifndef PIPELINE_HPP
+#define PIPELINE_HPP
+#pragma once
+
+#include "codegen.hpp"
+#include "jit.hpp"
+#include "parser.hpp"
+#include "scheduler.hpp"
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Something a thread of the pipeline spent time on, for its timeline.
+ */
+struct TimelineEvent {
+    std::string thread; // The thread, eg. "parser" or "worker 2".
+    std::string name;   // What the thread did, eg. "parse fib" or "compile module 3".
+    double start_us;    // When it started, in microseconds since the pipeline started.
+    double end_us;      // When it ended, in microseconds since the pipeline started.
+};
+
+/**
+ * @brief Compiles a program into a JIT session on a pipeline of threads.
+ *
+ * A first pass parses only the prototypes of the program. Then the calling thread
+ * parses each declaration and submits a task generating it to the scheduler. Every
+ * worker of the scheduler has its own Codegen (and so its own LLVMContext) with every
+ * prototype declared, generates the pluhs of the tasks it runs into it, and once it
+ * holds pluhs_per_module of them optimizes and compiles the module to machine code with
+ * Jit::compile_module before starting a new one. The modules left over are compiled by
+ * tasks depending on every generating task. The modules are only linked together when
+ * the program is looked up, so pluhs can call each other across modules.
+ *
+ * Parsing waits whenever queue_size declarations are parsed but not generated yet, so
+ * that's the most held at once. Since pluhs are only optimized with the other pluhs of
+ * their module, calls across modules can't be inlined.
+ */
+class Pipeline {
+  private:
+    Scheduler& scheduler;    // Scheduler the declarations are generated on.
+    size_t queue_size;       // Most parsed declarations waiting to be generated.
+    size_t pluhs_per_module; // Pluhs a worker generates before compiling its module.
+    bool fuel_metering;      // Whether the generated pluhs are metered.
+    std::chrono::steady_clock::time_point start; // When the last compile started.
+    std::mutex timeline_mutex;                   // Guards the timeline.
+    std::vector<TimelineEvent> timeline;         // What each thread did, in order.
+
+    /**
+     * @brief Records what a thread spent time on since a given point.
+     *
+     * @param thread The thread.
+     * @param name What it did.
+     * @param since When it started.
+     */
+    void record(const std::string& thread, const std::string& name,
+                std::chrono::steady_clock::time_point since);
+  public:
+    /**
+     * @brief Creates a pipeline.
+     *
+     * @param scheduler Scheduler to generate and compile on, or nullptr for the shared
+     * one. It must outlive the pipeline.
+     * @param queue_size Most parsed declarations waiting to be generated.
+     * @param pluhs_per_module Pluhs a worker generates before compiling its module.
+     */
+    Pipeline(Scheduler* scheduler = nullptr, size_t queue_size = 64,
+             size_t pluhs_per_module = 32);
+
+    /**
+     * @brief Meters every pluh compiled from now on with a fuel counter (see
+     * Codegen::enable_fuel_metering).
+     */
+    void enable_fuel_metering();
+
+    /**
+     * @brief Compiles a program into a JIT session. Its pluhs can be looked up once
+     * this returns. Not to be called from a task of the pipeline's scheduler, since it
+     * waits for the tasks it submits.
+     *
+     * @param code The source code of the program.
+     * @param jit The session to compile into.
+     *
+     * @throws parse_logic_error If the program has a syntax error.
+     * @throws codegen_error If the program has invalid code.
+     * @throws jit_error If a module fails to compile.
+     */
+    void compile(const std::string& code, Jit& jit);
+
+    /**
+     * @brief Gets what each thread spent time on during the last compile.
+     *
+     * @return const std::vector<TimelineEvent>& -> The events, in the order they ended.
+     */
+    const std::vector<TimelineEvent>& get_timeline() const;
+
+    /**
+     * @brief Writes the timeline of the last compile in the Chrome trace event format,
+     * which chrome://tracing and Perfetto show as one track per thread.
+     *
+     * @param out The stream to write to.
+     */
+    void write_timeline(std::ostream& out) const;
+
+    /**
+     * @brief Default destructor.
+     */
+    ~Pipeline() = default;
+};
+
+#endif
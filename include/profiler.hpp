@@ -0,0 +1,175 @@
+/**
+ * @file profiler.hpp
+ * @brief Sampling Profiler for the S-Lang Compiler
+ *
+ * This file contains the definition of the Profiler class, which samples the stack of
+ * pluh calls of JIT'd code on a timer signal and writes the samples as collapsed stacks,
+ * the input of flamegraph tools.
+ *
+ * @author Sagar Patel
+ * @date 10-18-2026
+ *
+ * Project: S-Lang Compiler
+ */
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+#pragma once
+
+#include "exceptions.hpp"
+#include <llvm/ExecutionEngine/JITEventListener.h>
+#include <atomic>
+#include <csignal>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief Sampling profiler for JIT'd code.
+ *
+ * Registered with a Jit (see Jit::add_listener), the profiler learns the address range
+ * of every pluh the session links. Between start and stop, the thread that called start
+ * gets a SIGPROF for every 1/frequency seconds of CPU time it uses, and the signal
+ * handler records the interrupted address and walks the frame pointers from there, so
+ * pluhs have to be compiled with frame pointers (the "frame-pointer"="all" attribute).
+ * The handler only writes into samples allocated up front, so it never allocates, locks
+ * or calls anything that isn't async signal safe; once the buffer is full, further
+ * samples are counted as dropped.
+ *
+ * Samples are only resolved into pluh names when they're written: every frame in JIT'd
+ * code becomes its pluh, followed by the line it's declared on when known. A sample
+ * taken outside JIT'd code (eg. in printf, for yap) keeps its innermost frame under the
+ * name of the native function, and the frames of the host around the program are
+ * dropped. Pluhs the optimizer inlined into their callers are counted in the callers.
+ *
+ * Only one profiler may run at a time.
+ */
+class Profiler : public llvm::JITEventListener {
+  private:
+    static const int max_depth = 64; // Deepest stack a sample records.
+
+    /**
+     * @brief A sampled stack: the interrupted address first, then the return address of
+     * every frame, outermost last.
+     */
+    struct Sample {
+        int depth;                   // Number of addresses.
+        uint64_t frames[max_depth]; // The addresses.
+    };
+
+    /**
+     * @brief A pluh linked into the session.
+     */
+    struct Symbol {
+        uint64_t end;     // Address just past its code.
+        std::string name; // Its name.
+    };
+
+    unsigned frequency;                  // Samples per second of CPU time.
+    std::unique_ptr<Sample[]> samples;   // Samples taken, the first `taken` valid.
+    size_t capacity;                     // Number of samples there's room for.
+    std::atomic<size_t> taken;           // Number of samples taken (past capacity too).
+    uintptr_t stack_low;                 // Lowest address of the sampled thread's stack.
+    uintptr_t stack_high;                // Address just past its stack.
+    std::mutex symbols_mutex;            // Guards symbols.
+    std::map<uint64_t, Symbol> symbols;  // Pluhs by the address they start at.
+    std::unordered_map<std::string, int> lines; // Line each pluh is declared on.
+    bool running;                        // Whether start was called without stop.
+    struct sigaction previous_action;    // How SIGPROF was handled before start.
+
+    /**
+     * @brief Records the stack of the interrupted code, from the signal handler.
+     *
+     * @param context The ucontext_t the signal interrupted.
+     */
+    void record(void* context);
+
+    /**
+     * @brief Gets the name of the pluh (or native function) at an address.
+     *
+     * @param address The address.
+     * @param native True to name native functions too, rather than skip them.
+     *
+     * @return std::string -> The name, or empty to skip the frame.
+     */
+    std::string resolve(uint64_t address, bool native);
+
+    /**
+     * @brief Handles SIGPROF, recording a sample for the running profiler if the signal
+     * interrupted the thread it samples.
+     */
+    static void on_signal(int signal, siginfo_t* info, void* context);
+  public:
+    /**
+     * @brief Creates a profiler.
+     *
+     * @param frequency Samples per second of CPU time. The kernel may deliver the
+     * signals at a lower rate than asked for (at most one per clock tick).
+     * @param capacity Most samples kept, about 1 KB each.
+     *
+     * @throws profiler_error If the frequency or capacity is 0.
+     */
+    Profiler(unsigned frequency = 1000, size_t capacity = 1 << 16);
+
+    /**
+     * @brief Names the lines pluhs are declared on, to label their frames with.
+     *
+     * @param lines Line of each pluh (see Parser::get_pluh_lines).
+     */
+    void set_lines(const std::unordered_map<std::string, int>& lines);
+
+    /**
+     * @brief Starts sampling the calling thread.
+     *
+     * @throws profiler_error If another profiler is running, the timer or the signal
+     * handler can't be set up, or the platform isn't Linux.
+     */
+    void start();
+
+    /**
+     * @brief Stops sampling, and puts back the way SIGPROF was handled before start. Has
+     * to be called on the thread that started it, and does nothing if the profiler isn't
+     * running.
+     */
+    void stop();
+
+    /**
+     * @brief Writes the samples as collapsed stacks: a line per distinct stack, with the
+     * frames from the outermost in, separated by semicolons, then the number of samples
+     * of that stack (eg. `main:9;step:3 42`, with the line each pluh is declared on).
+     *
+     * @param out Stream to write to.
+     */
+    void write_collapsed(std::ostream& out);
+
+    /**
+     * @brief Gets the number of samples taken and kept.
+     *
+     * @return size_t -> The number of samples.
+     */
+    size_t get_sample_count() const;
+
+    /**
+     * @brief Gets the number of samples dropped, once there was no room left.
+     *
+     * @return size_t -> The number of samples.
+     */
+    size_t get_dropped_count() const;
+
+    /**
+     * @brief Records the range of every function in an object linked into the session.
+     */
+    void notifyObjectLoaded(ObjectKey key, const llvm::object::ObjectFile& object,
+                            const llvm::RuntimeDyld::LoadedObjectInfo& info) override;
+
+    /**
+     * @brief Destructor, stops sampling (so it has to run on the thread that started
+     * it).
+     */
+    ~Profiler() override;
+};
+
+#endif
@@ -0,0 +1,275 @@
+/**
+ * @file repl.hpp
+ * @brief Interactive REPL for the S-Lang Compiler
+ *
+ * This file contains the definition of the Repl class behind `slang repl`. Every entry
+ * (a pluh, a plug, a cookUp, a statement or an expression) is parsed with the Parser,
+ * compiled by the Codegen into its own module and added to a long-lived JIT session, so
+ * earlier entries are never compiled again.
+ *
+ * @author Sagar Patel
+ * @date 10-18-2026
+ *
+ * Project: S-Lang Compiler
+ */
+
+#ifndef REPL_HPP
+#define REPL_HPP
+#pragma once
+
+#include "codegen.hpp"
+#include "jit.hpp"
+#include "parser.hpp"
+#include <array>
+#include <unordered_map>
+
+/**
+ * @brief Interactive session for the S-Lang Compiler.
+ *
+ * Repl keeps track of every pluh, plug and session variable (a top level cookUp)
+ * defined so far. Each new module declares them so it can use them, while their code
+ * stays in the modules that defined them.
+ *
+ * Pluhs are called through JIT indirection stubs, so defining a pluh again with the
+ * same arguments and return type hot reloads it: the stub is swapped to the new code and
+ * every caller, including pluhs compiled earlier, calls the new definition from then on.
+ * A definition with a different signature can't be swapped in, so it shadows the old one
+ * for the entries that follow instead (the old one keeps its symbol so both can live in
+ * the JIT).
+ *
+ * Pluhs also profile the values their int, char and bool arguments are called with
+ * during their first calls. Once a pluh is hot, every argument that held the same value
+ * in most of those calls is folded into a specialized clone, and the stub is pointed at
+ * a guard that calls the clone when the arguments match and the generic pluh otherwise.
+ */
+class Repl {
+  private:
+    /**
+     * @brief A pluh or plug defined in an earlier entry.
+     */
+    /**
+     * @brief The most frequent values of one argument (a space-saving sketch, so the
+     * count of a value that held in most calls is exact enough to act on).
+     */
+    struct ArgumentProfile {
+        std::array<std::pair<int64_t, uint64_t>, 4> values; // Values and their counts.
+        size_t used;                                        // Number of values kept.
+        uint64_t samples;                                   // Number of values seen.
+    };
+
+    /**
+     * @brief The value profile of one compiled pluh. JIT'd code writes to it, so it's
+     * never freed while the session lives.
+     */
+    struct PluhProfile {
+        uint64_t calls; // Number of calls so far.
+        std::vector<std::unique_ptr<ArgumentProfile>>
+            arguments; // One per argument, nullptr if not profiled.
+        bool decided; // True once the pluh was considered for specialization.
+    };
+
+    /**
+     * @brief A specialized clone installed behind a pluh's stub.
+     */
+    struct Specialization {
+        std::string name; // The pluh specialized.
+        std::vector<std::pair<unsigned, int64_t>> constants; // Arguments and values.
+        uint64_t hits;   // Calls that took the clone.
+        uint64_t misses; // Calls that fell back to the generic pluh.
+    };
+
+    /**
+     * @brief A session variable defined in an earlier entry.
+     */
+    struct GlobalSymbol {
+        std::string type_name;   // The S-Lang type of the variable.
+        std::string symbol_name; // The name of the global in the JIT.
+    };
+
+    /**
+     * @brief The signature and JIT symbol of a pluh or plug, as an entry saw it.
+     */
+    struct PluhBinding {
+        std::string name;                // The name of the pluh in S-Lang.
+        std::vector<Argument> arguments; // The arguments of the pluh.
+        std::string return_type;         // The return type of the pluh.
+        std::string symbol_name;         // The name of the pluh in the JIT.
+    };
+
+    /**
+     * @brief What each pluh and session variable name referred to when an entry was
+     * compiled.
+     */
+    struct Bindings {
+        std::vector<PluhBinding> pluhs;                            // Pluhs and plugs.
+        std::vector<std::pair<std::string, GlobalSymbol>> globals; // Session variables.
+    };
+
+    /**
+     * @brief A pluh or plug defined in an earlier entry.
+     */
+    struct PluhSymbol {
+        std::vector<Argument> arguments; // The arguments of the pluh.
+        std::string return_type;         // The return type of the pluh.
+        std::string symbol_name;         // The name of the pluh in the JIT.
+        bool is_stub; // True if symbol_name is a stub that can be hot reloaded.
+        std::string code_name; // The name of the generic code behind the stub.
+        std::string source;    // The source the pluh was defined from.
+        PluhProfile* profile;  // The value profile of the code, or nullptr.
+        Bindings bindings; // What the generic code was compiled against, so a clone of
+                           // it refers to the same variables and pluhs.
+    };
+
+    static constexpr uint64_t profile_window = 1000; // Calls profiled per pluh.
+    static constexpr double specialize_ratio = 0.9;  // Share of calls a value needs.
+
+    Jit jit;           // The JIT session every entry is compiled into.
+    std::ostream& out; // Where the REPL writes prompts, latencies and errors.
+    std::unordered_map<std::string, PluhSymbol> pluhs;     // Pluhs by S-Lang name.
+    std::unordered_map<std::string, GlobalSymbol> globals; // Variables by S-Lang name.
+    std::unordered_map<std::string, int> definitions; // Times each name was defined.
+    int entry_count;                                  // Number of entries compiled.
+    double swap_us; // How long the last hot reload took to swap in, or -1 if the last
+                    // entry didn't reload anything.
+    std::vector<std::unique_ptr<PluhProfile>> profiles; // Every profile ever handed out.
+    std::vector<std::unique_ptr<Specialization>> specializations; // Every one taken.
+
+    /**
+     * @brief Records one argument value in a profile. JIT'd code calls this through the
+     * `slang.profile_value` symbol.
+     */
+    static void record_value(void* profile, int64_t value);
+
+    /**
+     * @brief Parses the definition of a pluh again from the source it was defined from.
+     */
+    PluhDeclaration parse_definition(const std::string& source, const std::string& name);
+
+    /**
+     * @brief Specializes every pluh that turned hot since the last entry.
+     */
+    void specialize_hot_pluhs();
+
+    /**
+     * @brief Returns a JIT symbol name for a new definition of a name, so a
+     * redefinition doesn't clash with the old one (eg. fib, then fib.2).
+     */
+    std::string new_symbol_name(const std::string& name);
+
+    /**
+     * @brief Returns what each pluh and session variable name refers to now.
+     */
+    Bindings get_bindings() const;
+
+    /**
+     * @brief Declares pluhs and session variables in a module.
+     *
+     * @param codegen The Codegen generating the module.
+     * @param bindings The pluhs and session variables to declare, usually those of
+     * get_bindings().
+     */
+    void declare_session(Codegen& codegen, const Bindings& bindings);
+
+    /**
+     * @brief Compiles a pluh entry and keeps it for later entries, hot reloading it if
+     * it was defined before with the same signature.
+     *
+     * @param pluh The pluh to define.
+     * @param source The source the pluh was parsed from (the entry, or a whole program),
+     * kept for specializing it later.
+     */
+    void define_pluh(PluhDeclaration& pluh, const std::string& source);
+
+    /**
+     * @brief Keeps a plug entry for later entries. Plugs are resolved against the
+     * process, so there's nothing to compile.
+     */
+    void define_plug(PluhDeclaration& plug);
+
+    /**
+     * @brief Defines a session variable for a top level cookUp and compiles its
+     * initializer.
+     *
+     * @return uint64_t -> The address of the compiled initializer.
+     */
+    uint64_t compile_global(Statement& statement);
+
+    /**
+     * @brief Wraps a statement in an anonymous npc pluh and compiles it.
+     *
+     * @param statement The statement to wrap.
+     * @param new_global The name the entry stores a new session variable under, if it
+     * defines one. It's declared apart from the session, so the entry still sees any
+     * earlier variable with the same name.
+     * @param global The new session variable, or nullptr if the entry defines none.
+     *
+     * @return uint64_t -> The address of the compiled pluh.
+     */
+    uint64_t compile_statement(Statement statement, const std::string& new_global = "",
+                               const GlobalSymbol* global = nullptr);
+
+    /**
+     * @brief Wraps an expression in a yap (unless it's a call that yields nothing) and
+     * compiles it.
+     *
+     * @return uint64_t -> The address of the compiled pluh.
+     */
+    uint64_t compile_expression(Expression expression);
+
+    /**
+     * @brief Reports how long an entry took to compile and to run.
+     */
+    void report_latency(double compile_ms, double run_ms);
+  public:
+    /**
+     * @brief Creates a new REPL session.
+     *
+     * @param out The stream prompts, latencies and errors are written to. Output of the
+     * entries themselves (eg. yap) goes to stdout.
+     */
+    Repl(std::ostream& out = std::cout);
+
+    /**
+     * @brief Compiles and runs a single entry.
+     *
+     * @param entry The source code of the entry.
+     *
+     * @return bool -> True if the entry compiled and ran, false if it was reported as an
+     * error.
+     */
+    bool eval(const std::string& entry);
+
+    /**
+     * @brief Reads entries from the input until it ends or `:quit` is entered. An entry
+     * continues over several lines until its braces and parentheses are balanced,
+     * `:reload <file> <pluh>` hot reloads one pluh from a file and `:profile` reports the
+     * specializations taken.
+     *
+     * @param in The stream entries are read from.
+     */
+    void run(std::istream& in);
+
+    /**
+     * @brief Hot reloads a single pluh from a source file (a whole `spillingTeaAbout`
+     * program), leaving the rest of the program alone.
+     *
+     * @param source The source code of the program.
+     * @param name The name of the pluh to reload.
+     *
+     * @return bool -> True if the pluh compiled and was swapped in, false if it was
+     * reported as an error.
+     */
+    bool reload(const std::string& source, const std::string& name);
+
+    /**
+     * @brief Reports every specialization taken and how often its guard hit.
+     */
+    void print_specializations();
+
+    /**
+     * @brief Default destructor.
+     */
+    ~Repl() = default;
+};
+
+#endif
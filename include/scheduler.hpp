@@ -0,0 +1,303 @@
+/**
+ * @file scheduler.hpp
+ * @brief Work-Stealing Task Scheduler for the S-Lang Compiler
+ *
+ * This file contains the definition of the Scheduler class, the one executor every
+ * parallel phase of the compiler runs on (generating batches, pipelined parsing and code
+ * generation, JIT compiles, snapshot writes). Sharing it keeps the compiler at one
+ * thread per core however many phases run at once, instead of a pool per phase.
+ *
+ * @author Sagar Patel
+ * @date 10-18-2026
+ *
+ * Project: S-Lang Compiler
+ */
+
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A unit of work submitted to a Scheduler.
+ *
+ * A task runs once every task it depends on has finished. If one of them threw, the
+ * task doesn't run and fails with the same exception.
+ */
+class Task {
+  private:
+    std::function<void()> work;     // What the task does.
+    std::atomic<size_t> blockers;   // Unfinished dependencies, +1 until submitted.
+    std::atomic<bool> done;         // Whether the task has finished.
+    std::mutex mutex;               // Guards dependents and error.
+    std::vector<std::shared_ptr<Task>> dependents; // Tasks waiting for this one.
+    std::exception_ptr error;       // What the task (or a dependency) threw, if anything.
+    std::shared_ptr<Task> self;     // Keeps the task alive while it's queued.
+
+    friend class Scheduler;
+  public:
+    /**
+     * @brief Creates a task that isn't submitted yet.
+     *
+     * @param work What the task does.
+     */
+    explicit Task(std::function<void()> work);
+
+    /**
+     * @brief Checks whether the task has finished (run, thrown or been skipped).
+     *
+     * @return true if it has, false otherwise.
+     */
+    bool is_done() const {
+        return done.load(std::memory_order_acquire);
+    }
+};
+
+/**
+ * @brief What a worker of a Scheduler has done so far.
+ */
+struct WorkerStats {
+    uint64_t tasks;      // Tasks run.
+    uint64_t steals;     // Tasks taken from another worker's deque.
+    double busy_seconds; // Time spent running tasks.
+};
+
+/**
+ * @brief Runs tasks on a fixed set of worker threads, balancing them by work stealing.
+ *
+ * Every worker has a Chase-Lev deque of ready tasks. A worker pushes the tasks it
+ * submits (and the tasks they unblock) onto the bottom of its own deque and pops them
+ * back from the bottom, so related work stays on one core, while idle workers steal
+ * from the top of the others' deques. Only the owner touches the bottom of a deque, so
+ * pushing and popping take no lock, and thieves race each other with a single
+ * compare-exchange. Tasks submitted from outside the workers go to a shared queue.
+ * Idle workers sleep until a task is queued.
+ *
+ * Waiting for a task on a worker runs other tasks meanwhile, so tasks can wait for the
+ * tasks they submit without running out of workers. A task shouldn't block in any
+ * other way (eg. looking a symbol up in a Jit compiling on the same scheduler).
+ */
+class Scheduler {
+  private:
+    /**
+     * @brief A Chase-Lev work-stealing deque of ready tasks.
+     */
+    class WorkDeque {
+      private:
+        /**
+         * @brief A circular array of tasks, a power of 2 slots big.
+         */
+        struct Array {
+            int64_t mask;                                     // Number of slots - 1.
+            std::unique_ptr<std::atomic<Task*>[]> slots;      // The tasks.
+
+            /**
+             * @brief Creates an array of the given number of slots.
+             */
+            explicit Array(int64_t capacity);
+        };
+
+        alignas(64) std::atomic<int64_t> top;    // Next task to steal.
+        alignas(64) std::atomic<int64_t> bottom; // Next slot to push to.
+        std::atomic<Array*> array;               // The current array.
+        std::vector<std::unique_ptr<Array>> arrays; // Every array, kept for thieves.
+      public:
+        /**
+         * @brief Creates an empty deque.
+         */
+        WorkDeque();
+
+        /**
+         * @brief Pushes a task onto the bottom. Only called by the owner.
+         */
+        void push(Task* task);
+
+        /**
+         * @brief Pops the task at the bottom. Only called by the owner.
+         *
+         * @return Task* -> The task, or nullptr if the deque is empty.
+         */
+        Task* pop();
+
+        /**
+         * @brief Steals the task at the top. Called by any thread.
+         *
+         * @return Task* -> The task, or nullptr if the deque is empty or another thread
+         * took it first.
+         */
+        Task* steal();
+    };
+
+    /**
+     * @brief A worker thread, its deque and what it has done.
+     */
+    struct Worker {
+        WorkDeque deque;               // Ready tasks of the worker.
+        std::atomic<uint64_t> tasks;   // Tasks run.
+        std::atomic<uint64_t> steals;  // Tasks stolen from other workers.
+        std::atomic<uint64_t> busy_ns; // Time spent running tasks.
+        std::thread thread;            // The thread.
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers; // The workers.
+    std::mutex injection_mutex;                   // Guards injected.
+    std::deque<Task*> injected;          // Tasks submitted from outside the workers.
+    std::atomic<int64_t> queued;         // Tasks waiting in any deque or injected.
+    std::atomic<int> sleeping;           // Workers sleeping, or about to.
+    std::mutex sleep_mutex;              // Guards sleeping workers waking up.
+    std::condition_variable wake;        // Wakes sleeping workers.
+    std::atomic<int> waiting;            // Threads outside the workers waiting for tasks.
+    std::mutex wait_mutex;               // Guards threads waiting for tasks.
+    std::condition_variable finished;    // Wakes threads waiting for tasks.
+    std::atomic<bool> stopping;          // Whether the workers should exit.
+    std::chrono::steady_clock::time_point start; // When the scheduler started.
+
+    /**
+     * @brief Queues a task that's ready to run, on the calling worker's deque if
+     * called from a worker.
+     */
+    void schedule(Task* task);
+
+    /**
+     * @brief Finds a ready task: from the worker's own deque first, then the shared
+     * queue, then by stealing from the other workers.
+     *
+     * @param worker Index of the calling worker, or -1 if it isn't one.
+     *
+     * @return Task* -> The task, or nullptr if none was found.
+     */
+    Task* find_task(int worker);
+
+    /**
+     * @brief Runs a task, then unblocks the tasks depending on it.
+     *
+     * @param task The task.
+     * @param worker Index of the calling worker.
+     */
+    void run(Task* task, int worker);
+
+    /**
+     * @brief Marks a task finished and unblocks the tasks depending on it.
+     */
+    void finish(Task* task);
+
+    /**
+     * @brief The loop every worker runs until the scheduler stops.
+     *
+     * @param worker Index of the worker.
+     */
+    void work(int worker);
+  public:
+    /**
+     * @brief Creates a scheduler and starts its workers.
+     *
+     * @param workers Number of worker threads, or 0 for one per core.
+     */
+    explicit Scheduler(unsigned workers = 0);
+
+    /**
+     * @brief Deleted copy constructor, workers point to their scheduler.
+     */
+    Scheduler(const Scheduler&) = delete;
+
+    /**
+     * @brief Gets the scheduler shared by the whole process, creating it on first use.
+     *
+     * @return Scheduler& -> The shared scheduler.
+     */
+    static Scheduler& get_shared();
+
+    /**
+     * @brief Sets the number of workers of the shared scheduler (eg. from `--jobs`).
+     * Only has an effect before the shared scheduler is first used.
+     *
+     * @param workers Number of worker threads, or 0 for one per core.
+     */
+    static void set_shared_workers(unsigned workers);
+
+    /**
+     * @brief Checks whether the shared scheduler has been created.
+     *
+     * @return true if it has, false otherwise.
+     */
+    static bool has_shared();
+
+    /**
+     * @brief Submits a task, to run once its dependencies have finished.
+     *
+     * @param work What the task does.
+     * @param dependencies Tasks that must finish first.
+     *
+     * @return std::shared_ptr<Task> -> The task, to wait for or depend on.
+     */
+    std::shared_ptr<Task>
+    submit(std::function<void()> work,
+           const std::vector<std::shared_ptr<Task>>& dependencies = {});
+
+    /**
+     * @brief Waits for a task to finish, running other tasks meanwhile if called from
+     * a worker.
+     *
+     * @param task The task.
+     *
+     * @throws Whatever the task threw.
+     */
+    void wait(const std::shared_ptr<Task>& task);
+
+    /**
+     * @brief Waits for every task of a list to finish.
+     *
+     * @param tasks The tasks.
+     *
+     * @throws Whatever the first task (in order) that threw threw.
+     */
+    void wait(const std::vector<std::shared_ptr<Task>>& tasks);
+
+    /**
+     * @brief Gets the number of workers.
+     *
+     * @return unsigned -> The number of workers.
+     */
+    unsigned get_workers() const;
+
+    /**
+     * @brief Gets the index of the calling thread among the workers.
+     *
+     * @return int -> The index, or -1 if the calling thread isn't one of the workers.
+     */
+    int get_current_worker() const;
+
+    /**
+     * @brief Gets what every worker has done so far.
+     *
+     * @return std::vector<WorkerStats> -> The stats of each worker, in order.
+     */
+    std::vector<WorkerStats> get_worker_stats() const;
+
+    /**
+     * @brief Prints the tasks, steals and utilization (time busy over time alive) of
+     * every worker.
+     *
+     * @param out The stream to print to.
+     */
+    void print_utilization(std::ostream& out) const;
+
+    /**
+     * @brief Destructor, runs the tasks still queued then stops the workers.
+     */
+    ~Scheduler();
+};
+
+#endif
@@ -19,11 +19,18 @@
 #pragma once
 
 #include "ast.hpp"
+#include "checker.hpp"
 #include "codegen.hpp"
 #include "debug_stream.hpp"
+#include "jit.hpp"
 #include "lexer.hpp"
+#include "native.hpp"
 #include "parser.hpp"
+#include "pipeline.hpp"
+#include "profiler.hpp"
+#include "snapshot.hpp"
 #include <fstream>
+#include <memory>
 #include <sstream>
 
 /**
@@ -32,25 +39,87 @@
  * The Slang class encapsulates the entire process of compiling S-Lang source code.
  * It integrates the lexer, parser, AST handling, and code generation phases.
  * It provides an interface to input source code, generate IR, and output the results.
+ *
+ * Each phase runs only once something needs it, so lexing, parsing or checking a program
+ * never creates any LLVM object; the Codegen (with its LLVMContext and Module) is only
+ * built when the IR is first asked for.
  */
 class Slang {
   private:
-    std::string code;    // Source code to be compiled.
-    Parser parser;       // Lexer for tokenizing the source code.
-    Codegen irgen;       // Codegen for generating IR from the AST.
-    std::string llvm_ir; // The generated IR in string form.
+    std::string code;               // Source code to be compiled.
+    std::unique_ptr<TeaSpill> tea;  // The parsed program, once parsed.
+    std::unique_ptr<Codegen> irgen; // Codegen for generating IR, once it's needed.
+    std::string llvm_ir;            // The generated IR in string form.
+    int64_t fuel;                   // Fuel budget of main, or -1 if it isn't metered.
+    bool stream;                    // Whether IR is generated a declaration at a time.
+
+    /**
+     * @brief Generate the IR of the program, if it hasn't been generated yet.
+     *
+     * @param out Stream to write the IR to as it's streamed, instead of keeping it, or
+     * nullptr to keep it. Only used when streaming.
+     *
+     * @note Exits with a status of 1 if the IR can't be generated.
+     */
+    void generate(llvm::raw_ostream* out = nullptr);
+
+    /**
+     * @brief Run the main pluh of a program compiled into a JIT session, with the fuel
+     * budget if there is one.
+     *
+     * @param jit The session the program was added to.
+     * @param profiler Profiler to sample main with, or nullptr.
+     *
+     * @return int -> The value yeeted by main.
+     *
+     * @throws jit_error If there's no main pluh.
+     * @throws out_of_fuel_error If main runs out of fuel.
+     * @throws executor_error If main crashed the executor.
+     */
+    int run_main(Jit& jit, Profiler* profiler = nullptr);
   public:
     /**
      * @brief Construct a new Slang instance with given source code.
      *
      * @param code The source code as a string.
+     * @param fuel Fuel budget main runs with in the JIT (roughly the number of LLVM
+     * instructions it may run), or -1 to run it unmetered.
+     * @param stream True to generate the IR one declaration at a time, freeing each
+     * one's AST before parsing the next, so huge programs compile in bounded memory.
+     * Written to a file, each pluh's IR is freed too once it's written.
+     */
+    Slang(std::string code, int64_t fuel = -1, bool stream = false);
+
+    /**
+     * @brief Lex the whole source code, without parsing it.
+     *
+     * @return size_t -> The number of tokens lexed, not counting the end of the file.
+     *
+     * @throws invalid_literal_error If the code has an invalid literal.
+     */
+    size_t lex() const;
+
+    /**
+     * @brief Parse the source code, if it hasn't been parsed yet.
+     *
+     * @return TeaSpill& -> The parsed program.
+     *
+     * @throws parse_logic_error If the code has a syntax error.
+     */
+    TeaSpill& parse();
+
+    /**
+     * @brief Parse and check the source code for every error generating its IR would
+     * report, without generating it.
+     *
+     * @throws codegen_error If the program is invalid.
      */
-    Slang(const std::string& code);
+    void check();
 
     /**
      * @brief Print the Intermediate Representation (IR) of the compiled source code.
      */
-    void print_IR() const;
+    void print_IR();
 
     /**
      * @brief Write the compiled output to a file.
@@ -59,6 +128,68 @@ class Slang {
      */
     void write_to_file(const std::string& filename);
 
+    /**
+     * @brief JIT compile the program and run its main pluh.
+     *
+     * Can only be called once, since the JIT takes over the generated module.
+     *
+     * @param snapshot_dir Directory to keep snapshots of the compiled code in, so later
+     * runs of the same program skip parsing, generating and compiling it. Empty to always
+     * compile.
+     * @param opt_level Optimization level (0 to 3) to compile the program at.
+     * @param executor_path Path of the executor binary to run the program in, isolated
+     * from the compiler, or empty to run it in this process. Fuel needs it empty.
+     * @param profile_file File to write a profile of main to, as collapsed stacks for
+     * flamegraphs (see Profiler), or empty to not profile it. Needs the program in this
+     * process.
+     *
+     * @return int -> The value yeeted by main.
+     *
+     * @throws jit_error If the program can't be compiled or has no main pluh.
+     * @throws out_of_fuel_error If main runs out of fuel.
+     * @throws executor_error If the program crashed the executor.
+     * @throws profiler_error If the program can't be profiled.
+     */
+    int run_jit(const std::string& snapshot_dir = "", unsigned opt_level = 2,
+                const std::string& executor_path = "",
+                const std::string& profile_file = "");
+
+    /**
+     * @brief JIT compile the program on a pipeline of threads and run its main pluh.
+     *
+     * Parsing overlaps with generating, optimizing and compiling the declarations
+     * parsed before, on the workers of the shared scheduler (see Pipeline).
+     *
+     * @param opt_level Optimization level (0 to 3) to compile the program at.
+     * @param timeline_file File to write the timeline of the threads to (in the Chrome
+     * trace event format), or empty for none.
+     *
+     * @return int -> The value yeeted by main.
+     *
+     * @throws parse_logic_error If the program has a syntax error.
+     * @throws codegen_error If the program has invalid code.
+     * @throws jit_error If the program can't be compiled or has no main pluh.
+     * @throws out_of_fuel_error If main runs out of fuel.
+     */
+    int run_pipelined(unsigned opt_level = 2, const std::string& timeline_file = "");
+
+    /**
+     * @brief Compile the program ahead of time into an executable for the host, which
+     * runs its main pluh and exits with the value it yeets.
+     *
+     * Can only be called once, since compiling takes over the generated module. How long
+     * linking took is reported on stderr.
+     *
+     * @param executable_path Path of the executable to write.
+     * @param opt_level Optimization level (0 to 3) to compile the program at.
+     * @param runtime_path Path of the static runtime archive (libslang_rt.a) to link a
+     * static executable against, or empty to link against libc (see NativeCompiler).
+     *
+     * @throws native_error If the program can't be compiled or linked.
+     */
+    void compile_executable(const std::string& executable_path, unsigned opt_level = 2,
+                            const std::string& runtime_path = "");
+
     /**
      * @brief Default destructor.
      */
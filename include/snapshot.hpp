@@ -0,0 +1,136 @@
+/**
+ * @file snapshot.hpp
+ * @brief JIT Code Snapshots for the S-Lang Compiler
+ *
+ * This file contains the definition of the SnapshotCache class, which lets the JIT
+ * persist the machine code it compiles. A snapshot is the object file of a module (its
+ * machine code, constants and symbol table, along with the relocations still to be
+ * applied) behind a versioned header with a checksum, so a later run can load it instead
+ * of compiling the module again.
+ *
+ * @author Sagar Patel
+ * @date 10-18-2026
+ *
+ * Project: S-Lang Compiler
+ */
+
+#ifndef SNAPSHOT_HPP
+#define SNAPSHOT_HPP
+#pragma once
+
+#include "scheduler.hpp"
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Object cache that stores JIT snapshots in a directory.
+ *
+ * Snapshots are keyed by a hash of the source code, the compiler options, the module,
+ * the LLVM version and the host CPU and its features, so a snapshot is never loaded for
+ * different code or on a CPU it wasn't compiled for. Loading maps the file into memory,
+ * checks the header and the checksum of the object, and hands the mapped object to the
+ * JIT linker as it is, which applies the relocations just as it would for freshly
+ * compiled code. Nothing else is parsed or verified.
+ *
+ * Given a scheduler, snapshots are written by tasks on it, so compiling never waits for
+ * the disk. The cache waits for the writes still running when it's destroyed.
+ */
+class SnapshotCache : public llvm::ObjectCache {
+  private:
+    std::string directory; // Directory the snapshots are stored in.
+    uint64_t source_hash;  // Hash of the source code the modules come from.
+    std::string options;   // Compiler options that change the generated code.
+    std::string host;      // The host CPU and its features.
+    Scheduler* scheduler;  // Scheduler snapshots are written on, or nullptr.
+    std::atomic<int> hits;   // Number of snapshots loaded.
+    std::atomic<int> misses; // Number of modules that had to be compiled.
+    std::mutex writes_mutex; // Guards writes.
+    std::vector<std::shared_ptr<Task>> writes; // Snapshot writes submitted.
+
+    /**
+     * @brief Returns the key of the snapshot for a module, a hash of everything the
+     * module's machine code depends on.
+     */
+    uint64_t get_key(const std::string& module_name) const;
+
+    /**
+     * @brief Returns the path of the snapshot with a key.
+     */
+    std::string get_snapshot_path(uint64_t key) const;
+
+    /**
+     * @brief Writes a snapshot to its path.
+     *
+     * @param path The path of the snapshot.
+     * @param key The key of the snapshot.
+     * @param object The object file.
+     */
+    static void write_snapshot(const std::string& path, uint64_t key,
+                               llvm::StringRef object);
+  public:
+    /**
+     * @brief Creates a cache of snapshots for modules compiled from the given source.
+     *
+     * @param directory Directory the snapshots are stored in (created if needed).
+     * @param source The source code the modules are compiled from.
+     * @param options Compiler options that change the generated code (eg. the
+     * optimization level).
+     * @param scheduler Scheduler to write snapshots on, or nullptr to write them before
+     * returning from notifyObjectCompiled. It must outlive the cache.
+     */
+    SnapshotCache(const std::string& directory, const std::string& source,
+                  const std::string& options = "", Scheduler* scheduler = nullptr);
+
+    /**
+     * @brief Writes the snapshot of a freshly compiled module.
+     *
+     * @param module The module that was compiled.
+     * @param object The object file it was compiled to.
+     */
+    void notifyObjectCompiled(const llvm::Module* module,
+                              llvm::MemoryBufferRef object) override;
+
+    /**
+     * @brief Loads the snapshot of a module, if there's a valid one.
+     *
+     * @param module The module about to be compiled.
+     *
+     * @return std::unique_ptr<llvm::MemoryBuffer> -> The object file of the module, or
+     * nullptr to compile it.
+     */
+    std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module* module) override;
+
+    /**
+     * @brief Loads the snapshot of a module by name, without the module, so a run whose
+     * program has a snapshot can skip parsing and generating it too.
+     *
+     * @param module_name The identifier of the module.
+     *
+     * @return std::unique_ptr<llvm::MemoryBuffer> -> The object file of the module, or
+     * nullptr if there's no valid snapshot of it.
+     */
+    std::unique_ptr<llvm::MemoryBuffer> load(const std::string& module_name);
+
+    /**
+     * @brief Returns the number of snapshots loaded.
+     */
+    int get_hits() const;
+
+    /**
+     * @brief Returns the number of modules that had to be compiled.
+     */
+    int get_misses() const;
+
+    /**
+     * @brief Destructor, waits for the snapshot writes still running.
+     */
+    ~SnapshotCache() override;
+};
+
+#endif
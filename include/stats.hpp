@@ -0,0 +1,197 @@
+/**
+ * @file stats.hpp
+ * @brief Compiler Statistics for the S-Lang Compiler
+ *
+ * This file contains the definition of the Statistic class, a counter in the style of
+ * LLVM's STATISTIC. Every stage of the compiler keeps statistics on the work it does
+ * (tokens lexed, AST nodes built, symbols looked up, instructions optimized away, ...),
+ * which `slang --stats` prints once the program is compiled. They show how the shape of
+ * the source drives the cost of compiling it, and which optimization passes actually
+ * change anything.
+ *
+ * @author Sagar Patel
+ * @date 10-18-2026
+ *
+ * Project: S-Lang Compiler
+ */
+
+#ifndef STATS_HPP
+#define STATS_HPP
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+/**
+ * @brief A named counter of some work the compiler does.
+ *
+ * Statistics are meant to be defined once, at namespace scope, next to the code that
+ * counts them:
+ *
+ *     static Statistic lookups("codegen", "lookups", "Number of symbols looked up");
+ *     ...
+ *     ++lookups;
+ *
+ * They only count once statistics are enabled with Statistic::enable(), so the cost of
+ * a disabled statistic is a single relaxed load. Counting is thread safe, since batches
+ * are compiled on several threads at once.
+ */
+class Statistic {
+  private:
+    std::string group;           // Stage of the compiler the statistic belongs to.
+    std::string name;            // Name of the statistic, unique in its group.
+    std::string description;     // What the statistic counts.
+    std::atomic<uint64_t> value; // Value counted so far.
+
+    static std::atomic<bool> enabled; // Whether statistics are being counted.
+  public:
+    /**
+     * @brief Creates a statistic and registers it, so it gets printed.
+     *
+     * @param group Stage of the compiler the statistic belongs to, eg. "lexer".
+     * @param name Name of the statistic, unique in its group.
+     * @param description What the statistic counts.
+     */
+    Statistic(const std::string& group, const std::string& name,
+              const std::string& description);
+
+    /**
+     * @brief Deleted copy constructor, statistics are registered by address.
+     */
+    Statistic(const Statistic&) = delete;
+
+    /**
+     * @brief Returns the statistic with the given group and name, creating it if it
+     * doesn't exist yet.
+     *
+     * Used for statistics only known at runtime, eg. one per optimization pass. The
+     * statistic lives as long as the program.
+     *
+     * @param group Stage of the compiler the statistic belongs to.
+     * @param name Name of the statistic, unique in its group.
+     * @param description What the statistic counts.
+     *
+     * @return Statistic& -> The statistic.
+     */
+    static Statistic& get(const std::string& group, const std::string& name,
+                          const std::string& description);
+
+    /**
+     * @brief Starts counting every statistic.
+     */
+    static void enable();
+
+    /**
+     * @brief Checks whether statistics are being counted.
+     *
+     * @return true if they are, false otherwise.
+     */
+    static bool is_enabled() {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Resets every statistic to 0.
+     */
+    static void reset();
+
+    /**
+     * @brief Prints every statistic that counted something, grouped by stage.
+     *
+     * @param out The stream to print to.
+     */
+    static void print(std::ostream& out);
+
+    /**
+     * @brief Prints every statistic that counted something as a JSON object, with
+     * "group.name" keys.
+     *
+     * @param out The stream to print to.
+     */
+    static void print_json(std::ostream& out);
+
+    /**
+     * @brief Adds 1 to the statistic.
+     *
+     * @return Statistic& -> The statistic.
+     */
+    Statistic& operator++() {
+        return *this += 1;
+    }
+
+    /**
+     * @brief Adds an amount to the statistic.
+     *
+     * @param amount The amount to add.
+     *
+     * @return Statistic& -> The statistic.
+     */
+    Statistic& operator+=(uint64_t amount) {
+        if (is_enabled()) {
+            value.fetch_add(amount, std::memory_order_relaxed);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Raises the statistic to a value, if it's lower, for statistics that keep a
+     * maximum rather than a count.
+     *
+     * @param candidate The value to raise the statistic to.
+     */
+    void update_max(uint64_t candidate) {
+        if (!is_enabled()) {
+            return;
+        }
+        uint64_t current = value.load(std::memory_order_relaxed);
+        while (current < candidate &&
+               !value.compare_exchange_weak(current, candidate,
+                                            std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief Gets the value counted so far.
+     *
+     * @return uint64_t -> The value.
+     */
+    uint64_t get_value() const {
+        return value.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Gets the group of the statistic.
+     *
+     * @return const std::string& -> The group.
+     */
+    const std::string& get_group() const {
+        return group;
+    }
+
+    /**
+     * @brief Gets the name of the statistic.
+     *
+     * @return const std::string& -> The name.
+     */
+    const std::string& get_name() const {
+        return name;
+    }
+
+    /**
+     * @brief Gets what the statistic counts.
+     *
+     * @return const std::string& -> The description.
+     */
+    const std::string& get_description() const {
+        return description;
+    }
+
+    /**
+     * @brief Destructor, unregisters the statistic.
+     */
+    ~Statistic();
+};
+
+#endif
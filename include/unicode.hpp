@@ -0,0 +1,94 @@
+/**
+ * @file unicode.hpp
+ * @brief UTF-8 Decoding and Identifier Classification for the S-Lang Compiler
+ *
+ * This file contains the functions the Lexer uses to lex identifiers and string literals
+ * written in UTF-8: decoding and validating a character, classifying it as a start or
+ * continuation of an identifier (the Unicode XID_Start and XID_Continue properties), and
+ * skipping runs of ASCII a vector at a time, so only non-ASCII characters take the slow
+ * path.
+ *
+ * @author Sagar Patel
+ * @date 10-19-2026
+ *
+ * Project: S-Lang Compiler
+ */
+
+#ifndef UNICODE_HPP
+#define UNICODE_HPP
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief An inclusive range of code points.
+ */
+struct CodePointRange {
+    char32_t first; // First code point in the range.
+    char32_t last;  // Last code point in the range.
+};
+
+// Sorted ranges of the code points past ASCII with each property (see
+// src/unicode_tables.cpp, generated by src/unicode_tables.py).
+extern const CodePointRange xid_start_ranges[];
+extern const size_t xid_start_ranges_count;
+extern const CodePointRange xid_continue_ranges[];
+extern const size_t xid_continue_ranges_count;
+
+/**
+ * @brief Decodes the UTF-8 character starting at a byte.
+ *
+ * Overlong encodings, surrogates, code points past U+10FFFF and characters cut off by
+ * the end of the input are all invalid.
+ *
+ * @param p The first byte of the character.
+ * @param end The end of the input.
+ * @param code_point Set to the code point of the character, if it's valid.
+ *
+ * @return size_t -> The length of the character in bytes (1 to 4), or 0 if it's invalid.
+ */
+size_t decode_utf8(const char* p, const char* end, char32_t& code_point);
+
+/**
+ * @brief Checks if a code point may start an identifier: an ASCII letter or any other
+ * XID_Start character (eg. é, λ or 名).
+ *
+ * @param code_point The code point.
+ * @return true if it may start an identifier, false otherwise.
+ */
+bool is_xid_start(char32_t code_point);
+
+/**
+ * @brief Checks if a code point may continue an identifier: an ASCII letter, digit or
+ * underscore, or any other XID_Continue character (eg. combining accents, or digits of
+ * other scripts).
+ *
+ * @param code_point The code point.
+ * @return true if it may continue an identifier, false otherwise.
+ */
+bool is_xid_continue(char32_t code_point);
+
+/**
+ * @brief Skips the ASCII letters, digits, underscores and question marks that continue
+ * an identifier, 16 bytes at a time where SSE2 is available.
+ *
+ * @param p The first byte to look at.
+ * @param end The end of the input.
+ *
+ * @return const char* -> The first byte that isn't one of them (eg. a space or the
+ * first byte of a non-ASCII character), or end.
+ */
+const char* skip_identifier_ascii(const char* p, const char* end);
+
+/**
+ * @brief Skips the bytes of a string literal that need no further look, 16 bytes at a
+ * time where SSE2 is available.
+ *
+ * @param p The first byte to look at.
+ * @param end The end of the input.
+ *
+ * @return const char* -> The first double quote, NUL or non-ASCII byte, or end.
+ */
+const char* skip_string_ascii(const char* p, const char* end);
+
+#endif
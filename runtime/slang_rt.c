@@ -0,0 +1,333 @@
+/**
+ * @file slang_rt.c
+ * @brief Freestanding runtime for S-Lang executables linked with --static-runtime
+ *
+ * A compiled program only needs a way in (main), a way out (exit) and yap, which prints
+ * through printf (or puts and putchar, once LLVM simplifies the calls). This file
+ * provides just those, on raw system calls, so the program links into a static
+ * executable without libc: no dynamic loader, no relocations to apply at startup, no
+ * static constructors and no stdio to initialize. Output is buffered and written when
+ * the buffer fills up and when main returns.
+ *
+ * printf only understands what yap prints (%d, %i, %u, %c, %s, %f and %%), and prints
+ * floats exactly like glibc's %f. Programs that plug other libc functions need the
+ * default link instead.
+ *
+ * @author Sagar Patel
+ * @date 10-18-2026
+ *
+ * Project: S-Lang Compiler
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+int main(void);
+
+/* -------------------------------------------------------------------------------------
+ * System calls
+ * ------------------------------------------------------------------------------------- */
+
+#if defined(__x86_64__)
+#define SYS_WRITE 1
+#define SYS_EXIT_GROUP 231
+
+static long syscall3(long number, long a, long b, long c) {
+    long result;
+    __asm__ volatile("syscall"
+                     : "=a"(result)
+                     : "a"(number), "D"(a), "S"(b), "d"(c)
+                     : "rcx", "r11", "memory");
+    return result;
+}
+
+/* The kernel leaves the stack pointer at argc. Clear the frame pointer so debuggers
+ * stop here, and align the stack as the ABI expects on a call. */
+__asm__(".text\n"
+        ".global _start\n"
+        "_start:\n"
+        "    xor %ebp, %ebp\n"
+        "    and $-16, %rsp\n"
+        "    call slang_rt_start\n"
+        "    hlt\n");
+#elif defined(__aarch64__)
+#define SYS_WRITE 64
+#define SYS_EXIT_GROUP 94
+
+static long syscall3(long number, long a, long b, long c) {
+    register long x8 __asm__("x8") = number;
+    register long x0 __asm__("x0") = a;
+    register long x1 __asm__("x1") = b;
+    register long x2 __asm__("x2") = c;
+    __asm__ volatile("svc 0" : "+r"(x0) : "r"(x8), "r"(x1), "r"(x2) : "memory");
+    return x0;
+}
+
+/* The stack is already 16-byte aligned at entry. */
+__asm__(".text\n"
+        ".global _start\n"
+        "_start:\n"
+        "    mov x29, #0\n"
+        "    mov x30, #0\n"
+        "    bl slang_rt_start\n");
+#else
+#error "slang_rt.c only supports x86-64 and AArch64 Linux"
+#endif
+
+/* -------------------------------------------------------------------------------------
+ * Memory, which LLVM may call for copies and zeroing even if the program never does.
+ * ------------------------------------------------------------------------------------- */
+
+void* memcpy(void* destination, const void* source, size_t size) {
+    unsigned char* to = destination;
+    const unsigned char* from = source;
+    while (size--)
+        *to++ = *from++;
+    return destination;
+}
+
+void* memmove(void* destination, const void* source, size_t size) {
+    unsigned char* to = destination;
+    const unsigned char* from = source;
+    if (to < from) {
+        while (size--)
+            *to++ = *from++;
+    } else {
+        while (size--)
+            to[size] = from[size];
+    }
+    return destination;
+}
+
+void* memset(void* destination, int value, size_t size) {
+    unsigned char* to = destination;
+    while (size--)
+        *to++ = (unsigned char)value;
+    return destination;
+}
+
+int memcmp(const void* left, const void* right, size_t size) {
+    const unsigned char* a = left;
+    const unsigned char* b = right;
+    for (; size; --size, ++a, ++b) {
+        if (*a != *b)
+            return *a - *b;
+    }
+    return 0;
+}
+
+/* -------------------------------------------------------------------------------------
+ * Buffered output
+ * ------------------------------------------------------------------------------------- */
+
+static char buffer[4096];
+static size_t buffered;
+
+static void flush(void) {
+    size_t written = 0;
+    while (written < buffered) {
+        long result = syscall3(SYS_WRITE, 1, (long)(buffer + written),
+                               (long)(buffered - written));
+        if (result <= 0)
+            break;
+        written += (size_t)result;
+    }
+    buffered = 0;
+}
+
+static void put(char c) {
+    if (buffered == sizeof(buffer))
+        flush();
+    buffer[buffered++] = c;
+}
+
+static int put_string(const char* string) {
+    int count = 0;
+    for (; *string; ++string, ++count)
+        put(*string);
+    return count;
+}
+
+/* Prints the digits of a number, returning how many were printed. */
+static int put_unsigned(uint64_t value) {
+    char digits[20];
+    int count = 0;
+    do {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    for (int i = count - 1; i >= 0; --i)
+        put(digits[i]);
+    return count;
+}
+
+/* -------------------------------------------------------------------------------------
+ * %f, exact to the last bit like glibc's: the integer part is expanded into decimal
+ * digits with a big number, and the fraction into a 124-bit fixed-point number, which
+ * holds the fraction of any double at or above 2^-71 exactly (smaller ones round to 0).
+ * The sixth digit rounds half to even.
+ * ------------------------------------------------------------------------------------- */
+
+#define FRACTION_BITS 124
+
+static int put_double(double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    int negative = (int)(bits >> 63);
+    int exponent = (int)((bits >> 52) & 0x7ff);
+    uint64_t mantissa = bits & ((UINT64_C(1) << 52) - 1);
+    int count = 0;
+    if (negative) {
+        put('-');
+        ++count;
+    }
+    if (exponent == 0x7ff)
+        return count + put_string(mantissa ? "nan" : "inf");
+    if (exponent) {
+        mantissa |= UINT64_C(1) << 52;
+    } else {
+        exponent = 1;
+    }
+    exponent -= 1075; /* value = mantissa * 2^exponent */
+
+    /* Decimal digits of the integer part, least significant first. */
+    char digits[320];
+    int length = 0;
+    uint64_t integer = mantissa;
+    if (exponent < 0)
+        integer = exponent > -64 ? mantissa >> -exponent : 0;
+    do {
+        digits[length++] = (char)(integer % 10);
+        integer /= 10;
+    } while (integer);
+    for (int shift = 0; shift < exponent; ++shift) {
+        int carry = 0;
+        for (int i = 0; i < length; ++i) {
+            int digit = digits[i] * 2 + carry;
+            digits[i] = (char)(digit % 10);
+            carry = digit / 10;
+        }
+        if (carry)
+            digits[length++] = (char)carry;
+    }
+
+    unsigned __int128 fraction = 0;
+    if (exponent < 0) {
+        int shift = -exponent;
+        uint64_t low = shift < 64 ? mantissa & ((UINT64_C(1) << shift) - 1) : mantissa;
+        if (shift <= FRACTION_BITS)
+            fraction = (unsigned __int128)low << (FRACTION_BITS - shift);
+        else if (shift - FRACTION_BITS < 64)
+            fraction = low >> (shift - FRACTION_BITS);
+    }
+    const unsigned __int128 one = (unsigned __int128)1 << FRACTION_BITS;
+    char decimals[6];
+    for (int i = 0; i < 6; ++i) {
+        fraction *= 10;
+        decimals[i] = (char)(fraction >> FRACTION_BITS);
+        fraction &= one - 1;
+    }
+    const unsigned __int128 half = one >> 1;
+    if (fraction > half || (fraction == half && (decimals[5] & 1))) {
+        int i = 5;
+        for (; i >= 0 && decimals[i] == 9; --i)
+            decimals[i] = 0;
+        if (i >= 0) {
+            ++decimals[i];
+        } else {
+            int j = 0;
+            for (; j < length && digits[j] == 9; ++j)
+                digits[j] = 0;
+            if (j == length)
+                digits[length++] = 0;
+            ++digits[j];
+        }
+    }
+
+    for (int i = length - 1; i >= 0; --i)
+        put((char)('0' + digits[i]));
+    put('.');
+    for (int i = 0; i < 6; ++i)
+        put((char)('0' + decimals[i]));
+    return count + length + 7;
+}
+
+/* -------------------------------------------------------------------------------------
+ * stdio, as far as yap goes
+ * ------------------------------------------------------------------------------------- */
+
+int printf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int count = 0;
+    for (; *format; ++format) {
+        if (*format != '%' || !format[1]) {
+            put(*format);
+            ++count;
+            continue;
+        }
+        switch (*++format) {
+        case 'd':
+        case 'i': {
+            int value = va_arg(args, int);
+            if (value < 0) {
+                put('-');
+                ++count;
+            }
+            count += put_unsigned(value < 0 ? -(uint64_t)value : (uint64_t)value);
+            break;
+        }
+        case 'u':
+            count += put_unsigned(va_arg(args, unsigned));
+            break;
+        case 'c':
+            put((char)va_arg(args, int));
+            ++count;
+            break;
+        case 's':
+            count += put_string(va_arg(args, const char*));
+            break;
+        case 'f':
+            count += put_double(va_arg(args, double));
+            break;
+        case '%':
+            put('%');
+            ++count;
+            break;
+        default:
+            put('%');
+            put(*format);
+            count += 2;
+        }
+    }
+    va_end(args);
+    return count;
+}
+
+int puts(const char* string) {
+    int count = put_string(string);
+    put('\n');
+    return count + 1;
+}
+
+int putchar(int c) {
+    put((char)c);
+    return (unsigned char)c;
+}
+
+/* -------------------------------------------------------------------------------------
+ * Entry and exit
+ * ------------------------------------------------------------------------------------- */
+
+__attribute__((noreturn)) void exit(int status) {
+    flush();
+    syscall3(SYS_EXIT_GROUP, status, 0, 0);
+    for (;;) {
+    }
+}
+
+/* Called by _start. Programs never look at their arguments or environment. */
+void slang_rt_start(void) {
+    exit(main());
+}
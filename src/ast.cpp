@@ -1,4 +1,50 @@
 #include "ast.hpp"
+#include "stats.hpp"
+#include <cmath>
+#include <limits>
+
+// AST nodes built of each type.
+static Statistic literals_built("ast", "nodes.literals", "Number of literals built");
+static Statistic variables_built("ast", "nodes.variables",
+                                 "Number of variable expressions built");
+static Statistic unary_built("ast", "nodes.unary", "Number of unary expressions built");
+static Statistic binary_built("ast", "nodes.binary",
+                              "Number of binary expressions built");
+static Statistic calls_built("ast", "nodes.calls", "Number of call expressions built");
+static Statistic prototypes_built("ast", "nodes.prototypes",
+                                  "Number of prototypes built");
+static Statistic cook_ups_built("ast", "nodes.cook_ups",
+                                "Number of cookUp statements built");
+static Statistic assignments_built("ast", "nodes.assignments",
+                                   "Number of assignment statements built");
+static Statistic
+    cook_up_assignments_built("ast", "nodes.cook_up_assignments",
+                              "Number of cookUp assignment statements built");
+static Statistic yeets_built("ast", "nodes.yeets", "Number of yeet statements built");
+static Statistic ghosts_built("ast", "nodes.ghosts", "Number of ghost statements built");
+static Statistic rizzes_built("ast", "nodes.rizzes", "Number of rizz statements built");
+static Statistic frs_built("ast", "nodes.frs", "Number of fr? statements built");
+static Statistic hold_ups_built("ast", "nodes.hold_ups",
+                                "Number of holdUp statements built");
+static Statistic compounds_built("ast", "nodes.compounds",
+                                 "Number of compound statements built");
+static Statistic pluhs_built("ast", "nodes.pluhs", "Number of pluh declarations built");
+static Statistic programs_built("ast", "nodes.programs", "Number of programs built");
+
+// Nodes are boxed behind pointers whose low 3 bits hold their kind.
+static_assert(alignof(Literal<double>) >= 8 && alignof(Literal<std::string>) >= 8 &&
+              alignof(VariableExpression) >= 8 && alignof(UnaryExpression) >= 8 &&
+              alignof(BinaryExpression) >= 8 && alignof(CallExpression) >= 8);
+static_assert(alignof(CookedUpStatement) >= 8 && alignof(AssignmentStatement) >= 8 &&
+              alignof(CookedUpAssignmentStatement) >= 8 &&
+              alignof(FrOngJustLikeThatStatement) >= 8 && alignof(HoldUpStatement) >= 8 &&
+              alignof(CompoundStatement) >= 8 && alignof(YeetStatement) >= 8);
+
+// Compares the nodes of the same type that two handles box.
+template <typename T>
+static bool boxed_equal(const void* lhs, const void* rhs) {
+    return *static_cast<const T*>(lhs) == *static_cast<const T*>(rhs);
+}
 
 template <typename T>
 Literal<T>::Literal(T value) : value(value) {}
@@ -9,15 +55,162 @@ T Literal<T>::get_value() const {
 }
 
 VariableExpression::VariableExpression(const std::string& name) : name(name) {
+    ++variables_built;
     debug << "[DEBUG] Variable Expression Initialized: " << name << std::endl;
 }
 
+// Literals are counted as they're put in an Expression, since those that are inline are
+// built afresh for each visit.
+Expression::Expression(Literal<int> literal)
+    : bits(inline_literal(Kind::Int, static_cast<uint32_t>(literal.get_value()))) {
+    ++literals_built;
+}
+
+Expression::Expression(Literal<double> literal) : bits(0) {
+    double value = literal.get_value();
+    if (std::fabs(value) <= std::numeric_limits<float>::max() &&
+        static_cast<float>(value) == value) {
+        float narrow = static_cast<float>(value);
+        bits = inline_literal(Kind::Float, std::bit_cast<uint32_t>(narrow));
+    } else {
+        bits = box(new Literal<double>(std::move(literal)), Kind::Float);
+    }
+    ++literals_built;
+}
+
+Expression::Expression(Literal<bool> literal)
+    : bits(inline_literal(Kind::Bool, literal.get_value())) {
+    ++literals_built;
+}
+
+Expression::Expression(Literal<char> literal)
+    : bits(inline_literal(Kind::Char, static_cast<unsigned char>(literal.get_value()))) {
+    ++literals_built;
+}
+
+Expression::Expression(Literal<std::string> literal)
+    : bits(box(new Literal<std::string>(std::move(literal)), Kind::String)) {
+    ++literals_built;
+}
+
+Expression::Expression(std::unique_ptr<VariableExpression> node)
+    : bits(box(node.release(), Kind::Variable)) {}
+
+Expression::Expression(std::unique_ptr<UnaryExpression> node)
+    : bits(box(node.release(), Kind::Unary)) {}
+
+Expression::Expression(std::unique_ptr<BinaryExpression> node)
+    : bits(box(node.release(), Kind::Binary)) {}
+
+Expression::Expression(std::unique_ptr<CallExpression> node)
+    : bits(box(node.release(), Kind::Call)) {}
+
+Expression::Expression(Expression&& rhs) noexcept : bits(std::exchange(rhs.bits, 0)) {}
+
+Expression::~Expression() {
+    reset();
+}
+
+Expression& Expression::operator=(Expression&& rhs) noexcept {
+    if (this != &rhs) {
+        reset();
+        bits = std::exchange(rhs.bits, 0);
+    }
+    return *this;
+}
+
+uint64_t Expression::box(const void* node, Kind kind) {
+    return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(node)) |
+           static_cast<uint64_t>(kind);
+}
+
+uint64_t Expression::inline_literal(Kind kind, uint32_t payload) {
+    return (static_cast<uint64_t>(payload) << 32) | (static_cast<uint64_t>(kind) << 3) |
+           inline_tag;
+}
+
+bool Expression::is_inline() const {
+    return (bits & tag_mask) == inline_tag;
+}
+
+void* Expression::get_pointer() const {
+    if (is_inline()) {
+        return nullptr;
+    }
+    return reinterpret_cast<void*>(static_cast<uintptr_t>(bits & ~tag_mask));
+}
+
+uint32_t Expression::get_payload() const {
+    return static_cast<uint32_t>(bits >> 32);
+}
+
+void Expression::reset() {
+    void* node = get_pointer();
+    switch (get_kind()) {
+    case Kind::Variable:
+        delete static_cast<VariableExpression*>(node);
+        break;
+    case Kind::Unary:
+        delete static_cast<UnaryExpression*>(node);
+        break;
+    case Kind::Binary:
+        delete static_cast<BinaryExpression*>(node);
+        break;
+    case Kind::Call:
+        delete static_cast<CallExpression*>(node);
+        break;
+    case Kind::String:
+        delete static_cast<Literal<std::string>*>(node);
+        break;
+    case Kind::Float:
+        delete static_cast<Literal<double>*>(node);
+        break;
+    default:
+        break;
+    }
+    bits = 0;
+}
+
+Expression::Kind Expression::get_kind() const {
+    if (is_inline()) {
+        return static_cast<Kind>((bits & ~tag_mask) >> 3 & 0xF);
+    }
+    return static_cast<Kind>(bits & tag_mask);
+}
+
+bool Expression::operator==(const Expression& rhs) const {
+    // Inline literals are equal if their bits are, and a float is only ever boxed if
+    // it isn't exactly a float, so boxed and inline floats are never equal.
+    if (bits == rhs.bits) {
+        return true;
+    }
+    if (get_kind() != rhs.get_kind() || is_inline() || rhs.is_inline() ||
+        get_pointer() == nullptr || rhs.get_pointer() == nullptr) {
+        return false;
+    }
+    switch (get_kind()) {
+    case Kind::Variable:
+        return boxed_equal<VariableExpression>(get_pointer(), rhs.get_pointer());
+    case Kind::Unary:
+        return boxed_equal<UnaryExpression>(get_pointer(), rhs.get_pointer());
+    case Kind::Binary:
+        return boxed_equal<BinaryExpression>(get_pointer(), rhs.get_pointer());
+    case Kind::Call:
+        return boxed_equal<CallExpression>(get_pointer(), rhs.get_pointer());
+    case Kind::String:
+        return boxed_equal<Literal<std::string>>(get_pointer(), rhs.get_pointer());
+    default:
+        return boxed_equal<Literal<double>>(get_pointer(), rhs.get_pointer());
+    }
+}
+
 std::string VariableExpression::get_name() const {
     return name;
 }
 
 UnaryExpression::UnaryExpression(const std::string& op, Expression rhs)
     : op(op), rhs(std::move(rhs)) {
+    ++unary_built;
     debug << "[DEBUG] Unary Expression Initialized: " << op << std::endl;
 }
 
@@ -31,6 +224,7 @@ Expression& UnaryExpression::get_rhs() {
 
 BinaryExpression::BinaryExpression(const std::string& op, Expression lhs, Expression rhs)
     : op(op), lhs(std::move(lhs)), rhs(std::move(rhs)) {
+    ++binary_built;
     debug << "[DEBUG] Binary Expression Initialized: " << op << std::endl;
 }
 
@@ -49,6 +243,7 @@ Expression& BinaryExpression::get_rhs() {
 CallExpression::CallExpression(const std::string& callee,
                                std::vector<Expression> arguments)
     : callee(callee), arguments(std::move(arguments)) {
+    ++calls_built;
     debug << "[DEBUG] Call Expression Initialized: " << callee << std::endl;
 }
 
@@ -64,6 +259,7 @@ Prototype::Prototype(const std::string& name,
                      std::vector<std::pair<std::string, std::string>> arguments,
                      const std::string& return_type)
     : name(name), arguments(arguments), return_type(return_type) {
+    ++prototypes_built;
     debug << "[DEBUG] Prototype Initialized: " << name << std::endl;
 }
 
@@ -82,6 +278,7 @@ std::string Prototype::get_return_type() const {
 CookedUpStatement::CookedUpStatement(const std::string& var_name,
                                      const std::string& var_type)
     : var_name(var_name), var_type(var_type) {
+    ++cook_ups_built;
     debug << "[DEBUG] cookUp Statement Initialized: " << var_name << std::endl;
 }
 
@@ -96,6 +293,7 @@ std::string CookedUpStatement::get_var_type() const {
 AssignmentStatement::AssignmentStatement(const std::string& var_name,
                                          Expression assignment_expression)
     : var_name(var_name), assignment_expression(std::move(assignment_expression)) {
+    ++assignments_built;
     debug << "[DEBUG] Assignment Statement Initialized: " << var_name << std::endl;
 }
 
@@ -113,6 +311,7 @@ CookedUpAssignmentStatement::CookedUpAssignmentStatement(const std::string& var_
     : var_name(var_name),
       var_type(var_type),
       assignment_expression(std::move(assignment_expression)) {
+    ++cook_up_assignments_built;
     debug << "[DEBUG] cookUp AssignmentStatement Initialized: " << var_name << std::endl;
 }
 
@@ -129,6 +328,7 @@ Expression& CookedUpAssignmentStatement::get_assignment_expression() {
 }
 
 YeetStatement::YeetStatement(Expression yeet_expr) : yeet_expr(std::move(yeet_expr)) {
+    ++yeets_built;
     debug << "[DEBUG] Yeet Statement Initialized" << std::endl;
 }
 
@@ -136,12 +336,146 @@ Expression& YeetStatement::get_yeet_expr() {
     return yeet_expr;
 }
 
+// Ghost and rizz statements are inline in a Statement, which builds them afresh for each
+// visit, so they're counted as they're put in one instead.
+GhostStatement::GhostStatement() {}
+
+RizzStatement::RizzStatement() {}
+
+Statement::Statement(std::unique_ptr<CookedUpStatement> node)
+    : bits(box(node.release(), Kind::CookedUp)) {}
+
+Statement::Statement(std::unique_ptr<AssignmentStatement> node)
+    : bits(box(node.release(), Kind::Assignment)) {}
+
+Statement::Statement(std::unique_ptr<CookedUpAssignmentStatement> node)
+    : bits(box(node.release(), Kind::CookedUpAssignment)) {}
+
+Statement::Statement(std::unique_ptr<FrOngJustLikeThatStatement> node)
+    : bits(box(node.release(), Kind::FrOngJustLikeThat)) {}
+
+Statement::Statement(std::unique_ptr<HoldUpStatement> node)
+    : bits(box(node.release(), Kind::HoldUp)) {}
+
+Statement::Statement(std::unique_ptr<CompoundStatement> node)
+    : bits(box(node.release(), Kind::Compound)) {}
+
+Statement::Statement(std::unique_ptr<YeetStatement> node)
+    : bits(box(node.release(), Kind::Yeet)) {}
+
+Statement::Statement(GhostStatement)
+    : bits((static_cast<uint64_t>(Kind::Ghost) << 3) | inline_tag) {
+    ++ghosts_built;
+    debug << "[DEBUG] Ghost Statement Initialized" << std::endl;
+}
+
+Statement::Statement(RizzStatement)
+    : bits((static_cast<uint64_t>(Kind::Rizz) << 3) | inline_tag) {
+    ++rizzes_built;
+    debug << "[DEBUG] Rizz Statement Initialized" << std::endl;
+}
+
+Statement::Statement(Statement&& rhs) noexcept : bits(std::exchange(rhs.bits, 0)) {}
+
+Statement::~Statement() {
+    reset();
+}
+
+Statement& Statement::operator=(Statement&& rhs) noexcept {
+    if (this != &rhs) {
+        reset();
+        bits = std::exchange(rhs.bits, 0);
+    }
+    return *this;
+}
+
+uint64_t Statement::box(const void* node, Kind kind) {
+    return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(node)) |
+           static_cast<uint64_t>(kind);
+}
+
+bool Statement::is_inline() const {
+    return (bits & tag_mask) == inline_tag;
+}
+
+void* Statement::get_pointer() const {
+    if (is_inline()) {
+        return nullptr;
+    }
+    return reinterpret_cast<void*>(static_cast<uintptr_t>(bits & ~tag_mask));
+}
+
+void Statement::reset() {
+    void* node = get_pointer();
+    switch (get_kind()) {
+    case Kind::CookedUp:
+        delete static_cast<CookedUpStatement*>(node);
+        break;
+    case Kind::Assignment:
+        delete static_cast<AssignmentStatement*>(node);
+        break;
+    case Kind::CookedUpAssignment:
+        delete static_cast<CookedUpAssignmentStatement*>(node);
+        break;
+    case Kind::FrOngJustLikeThat:
+        delete static_cast<FrOngJustLikeThatStatement*>(node);
+        break;
+    case Kind::HoldUp:
+        delete static_cast<HoldUpStatement*>(node);
+        break;
+    case Kind::Compound:
+        delete static_cast<CompoundStatement*>(node);
+        break;
+    case Kind::Yeet:
+        delete static_cast<YeetStatement*>(node);
+        break;
+    default:
+        break;
+    }
+    bits = 0;
+}
+
+Statement::Kind Statement::get_kind() const {
+    if (is_inline()) {
+        return static_cast<Kind>((bits & ~tag_mask) >> 3);
+    }
+    return static_cast<Kind>(bits & tag_mask);
+}
+
+bool Statement::operator==(const Statement& rhs) const {
+    // Inline statements are equal if their bits are.
+    if (bits == rhs.bits) {
+        return true;
+    }
+    if (get_kind() != rhs.get_kind() || is_inline() || rhs.is_inline() ||
+        get_pointer() == nullptr || rhs.get_pointer() == nullptr) {
+        return false;
+    }
+    switch (get_kind()) {
+    case Kind::CookedUp:
+        return boxed_equal<CookedUpStatement>(get_pointer(), rhs.get_pointer());
+    case Kind::Assignment:
+        return boxed_equal<AssignmentStatement>(get_pointer(), rhs.get_pointer());
+    case Kind::CookedUpAssignment:
+        return boxed_equal<CookedUpAssignmentStatement>(get_pointer(), rhs.get_pointer());
+    case Kind::FrOngJustLikeThat:
+        return boxed_equal<FrOngJustLikeThatStatement>(get_pointer(), rhs.get_pointer());
+    case Kind::HoldUp:
+        return boxed_equal<HoldUpStatement>(get_pointer(), rhs.get_pointer());
+    case Kind::Compound:
+        return boxed_equal<CompoundStatement>(get_pointer(), rhs.get_pointer());
+    default:
+        return boxed_equal<YeetStatement>(get_pointer(), rhs.get_pointer());
+    }
+}
+
 FrOngJustLikeThatStatement::FrOngJustLikeThatStatement(Expression condition,
                                                        Statement then_statement,
                                                        Statement else_statement)
     : condition(std::move(condition)),
       then_statement(std::move(then_statement)),
       else_statement(std::move(else_statement)) {
+    ++frs_built;
     debug << "[DEBUG] Fr?Ong?justLikeThat? Statement Initialized" << std::endl;
 }
 
@@ -159,6 +493,7 @@ Statement& FrOngJustLikeThatStatement::get_else_statement() {
 
 HoldUpStatement::HoldUpStatement(Expression condition, Statement body)
     : condition(std::move(condition)), body(std::move(body)) {
+    ++hold_ups_built;
     debug << "[DEBUG] holdUp Statement Initialized" << std::endl;
 }
 
@@ -172,6 +507,7 @@ Statement& HoldUpStatement::get_body() {
 
 CompoundStatement::CompoundStatement(std::vector<Statement> statements)
     : statements(std::move(statements)) {
+    ++compounds_built;
     debug << "[DEBUG] Compound Statement Initialized" << std::endl;
 }
 
@@ -181,6 +517,7 @@ std::vector<Statement>& CompoundStatement::get_statements() {
 
 PluhDeclaration::PluhDeclaration(Prototype p, std::optional<Statement> body)
     : p(std::move(p)), body(std::move(body)) {
+    ++pluhs_built;
     debug << "[DEBUG] Pluh Declaration Initialized: " << p.get_name() << std::endl;
 }
 
@@ -195,6 +532,7 @@ std::optional<Statement>& PluhDeclaration::get_body() {
 TeaSpill::TeaSpill(const std::string& name,
                    std::vector<std::variant<PluhDeclaration>> declarations)
     : name(name), declarations(std::move(declarations)) {
+    ++programs_built;
     debug << "[DEBUG] spillingTeaAbout: " << name << std::endl;
 }
 
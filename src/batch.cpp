@@ -0,0 +1,133 @@
+#include "batch.hpp"
+#include "debug_stream.hpp"
+#include <algorithm>
+
+BatchCompiler::BatchCompiler(const std::string& entry, Scheduler* scheduler,
+                             size_t formulas_per_module, unsigned opt_level)
+    : scheduler(scheduler ? *scheduler : Scheduler::get_shared()),
+      formulas_per_module(std::max<size_t>(1, formulas_per_module)),
+      entry(entry),
+      formula_count(0),
+      jit(nullptr, opt_level, &this->scheduler) {
+    debug << "[DEBUG] Batch compiler initialized on " << this->scheduler.get_workers()
+          << " workers." << std::endl;
+}
+
+std::vector<Formula> BatchCompiler::compile(const std::vector<std::string>& sources) {
+    std::vector<Formula> formulas(sources.size(), Formula{0, ""});
+    if (sources.empty()) {
+        return formulas;
+    }
+    uint64_t first_formula = formula_count;
+    formula_count += sources.size();
+    auto prefix = [first_formula](size_t index) {
+        return "formula." + std::to_string(first_formula + index) + ".";
+    };
+
+    // Enough modules to keep every worker busy, without going over the module size.
+    size_t module_count = std::max<size_t>(
+        std::min<size_t>(scheduler.get_workers(), sources.size()),
+        (sources.size() + formulas_per_module - 1) / formulas_per_module);
+    size_t module_size = (sources.size() + module_count - 1) / module_count;
+    module_count = (sources.size() + module_size - 1) / module_size;
+
+    // A task per module. Each module has its own Codegen (and so its own LLVMContext),
+    // so they never share state.
+    std::vector<std::unique_ptr<Codegen>> modules(module_count);
+    std::vector<std::shared_ptr<Task>> tasks = {};
+    for (size_t m = 0; m < module_count; ++m) {
+        tasks.push_back(scheduler.submit([&, m]() {
+            modules[m] = std::make_unique<Codegen>();
+            size_t end = std::min(sources.size(), (m + 1) * module_size);
+            for (size_t i = m * module_size; i < end; ++i) {
+                try {
+                    Parser parser(sources[i]);
+                    TeaSpill tea = parser.parse_tea();
+                    bool has_entry = std::any_of(
+                        tea.get_declarations().begin(), tea.get_declarations().end(),
+                        [this](auto& declaration) {
+                            auto& pluh = std::get<PluhDeclaration>(declaration);
+                            return pluh.get_prototype().get_name() == entry &&
+                                   pluh.get_body().has_value();
+                        });
+                    if (!has_entry) {
+                        throw codegen_error("No " + entry + " pluh to call");
+                    }
+                    modules[m]->generate_unit(tea, prefix(i), entry);
+                } catch (const std::exception& e) {
+                    formulas[i].error = e.what();
+                }
+            }
+        }));
+    }
+    scheduler.wait(tasks);
+
+    // Look every entry up at once, so the JIT compiles the modules in parallel.
+    std::vector<std::string> symbols = {};
+    std::vector<size_t> compiled = {};
+    for (size_t i = 0; i < sources.size(); ++i) {
+        if (formulas[i].error.empty()) {
+            symbols.push_back(prefix(i) + entry);
+            compiled.push_back(i);
+        }
+    }
+    for (auto& codegen : modules) {
+        jit.add_module(codegen->take_context(), codegen->take_module());
+    }
+    if (symbols.empty()) {
+        return formulas;
+    }
+    std::vector<uint64_t> addresses = jit.lookup_all(symbols);
+    for (size_t k = 0; k < compiled.size(); ++k) {
+        formulas[compiled[k]].address = addresses[k];
+    }
+    debug << "[DEBUG] Compiled " << compiled.size() << " of " << sources.size()
+          << " formulas into " << module_count << " modules." << std::endl;
+    return formulas;
+}
+
+std::string BatchCompiler::get_expression_key(
+    const std::string& expression,
+    const std::vector<std::pair<std::string, std::string>>& variables,
+    const std::string& type_name) {
+    std::string key = type_name + "(";
+    for (auto& [name, type] : variables) {
+        key += name + ":" + type + ",";
+    }
+    key += ")";
+    Lexer lexer(expression);
+    for (Token token = lexer.get_token(); token.first != TokenType::END_OF_FILE;
+         token = lexer.get_token()) {
+        key += " " + std::to_string(static_cast<int>(token.first)) + ":" + token.second;
+    }
+    return key;
+}
+
+Formula BatchCompiler::compile_expression(
+    const std::string& expression,
+    const std::vector<std::pair<std::string, std::string>>& variables,
+    const std::string& type_name) {
+    try {
+        std::string key = get_expression_key(expression, variables, type_name);
+        auto cached = expressions.find(key);
+        if (cached != expressions.end()) {
+            return {cached->second, ""};
+        }
+
+        Parser parser(expression);
+        Expression parsed = parser.parse_expression();
+        if (parser.get_current_token().first != TokenType::END_OF_FILE) {
+            throw parse_logic_error("Unexpected " + parser.get_current_token().second +
+                                    " after the expression");
+        }
+        std::string symbol = "expression." + std::to_string(expressions.size());
+        Codegen codegen;
+        codegen.define_expression(parsed, variables, type_name, symbol);
+        jit.add_module(codegen.take_context(), codegen.take_module());
+        uint64_t address = jit.lookup(symbol);
+        expressions[key] = address;
+        return {address, ""};
+    } catch (const std::exception& e) {
+        return {0, e.what()};
+    }
+}
@@ -0,0 +1,251 @@
+#include "checker.hpp"
+
+// S-Lang's integer types (bool, char and int), by their width in bits.
+static const std::unordered_map<std::string, int> integer_widths = {
+    {"bool", 1}, {"char", 8}, {"int", 32}};
+
+static bool is_integer(const std::string& type) {
+    return integer_widths.count(type) != 0;
+}
+
+Checker::Checker() : return_type("npc"), loop_depth(0) {
+    debug << "[DEBUG] Checker initialized." << std::endl;
+}
+
+void Checker::check_type_name(const std::string& name) const {
+    if (name != "int" && name != "float" && name != "bool" && name != "char" &&
+        name != "string" && name != "npc") {
+        throw codegen_error("Unknown type name: " + name);
+    }
+}
+
+void Checker::check_cast(const std::string& from, const std::string& to) const {
+    // Mirrors Codegen::cast_to_type: numbers (and bools and chars) convert between each
+    // other, strings and npc only to themselves.
+    if (from == to || ((is_integer(from) || from == "float") &&
+                       (is_integer(to) || to == "float"))) {
+        return;
+    }
+    throw codegen_error("Cannot convert between incompatible types!");
+}
+
+std::string Checker::promote_operands(const std::string& lhs,
+                                      const std::string& rhs) const {
+    if (lhs == rhs) {
+        return lhs;
+    }
+    if (lhs == "float" || rhs == "float") {
+        check_cast(lhs, "float");
+        check_cast(rhs, "float");
+        return "float";
+    }
+    if (is_integer(lhs) && is_integer(rhs)) {
+        return integer_widths.at(lhs) < integer_widths.at(rhs) ? rhs : lhs;
+    }
+    throw codegen_error("Operands of a binary operation have incompatible types!");
+}
+
+void Checker::check_condition(const std::string& type) const {
+    if (!is_integer(type) && type != "float") {
+        throw codegen_error("Condition must be an int, float, char or bool!");
+    }
+}
+
+void Checker::check(TeaSpill& module_node) {
+    debug << "[DEBUG] Checking: " << module_node.get_name() << std::endl;
+
+    // Declare every pluh up front so they can call each other in any order. Like
+    // Codegen, the first declaration of a name is the one that counts.
+    for (auto& declaration : module_node.get_declarations()) {
+        Prototype& prototype = std::get<PluhDeclaration>(declaration).get_prototype();
+        for (auto& [arg_name, arg_type] : prototype.get_arguments()) {
+            check_type_name(arg_type);
+        }
+        check_type_name(prototype.get_return_type());
+        pluh_symbols.try_emplace(prototype.get_name(), &prototype);
+    }
+    for (auto& declaration : module_node.get_declarations()) {
+        std::visit(*this, declaration);
+    }
+}
+
+std::string Checker::operator()(const Literal<int>&) {
+    return "int";
+}
+
+std::string Checker::operator()(const Literal<double>&) {
+    return "float";
+}
+
+std::string Checker::operator()(const Literal<bool>&) {
+    return "bool";
+}
+
+std::string Checker::operator()(const Literal<char>&) {
+    return "char";
+}
+
+std::string Checker::operator()(const Literal<std::string>&) {
+    return "string";
+}
+
+std::string Checker::operator()(VariableExpression& node) {
+    auto symbol = current_scope_symbols.find(node.get_name());
+    if (symbol == current_scope_symbols.end()) {
+        throw codegen_error("Unknown variable: " + node.get_name());
+    }
+    return symbol->second;
+}
+
+std::string Checker::operator()(UnaryExpression& node) {
+    std::string type = visit(*this, node.get_rhs());
+    std::string op = node.get_op();
+    if (op == "+") {
+        return type;
+    } else if (op == "-") {
+        if (!is_integer(type) && type != "float") {
+            throw codegen_error("Cannot negate a value of type " + type);
+        }
+        return type;
+    } else if (op == "!") {
+        check_condition(type);
+        return "bool";
+    }
+    throw codegen_error("Unknown unary operator: " + op);
+}
+
+std::string Checker::operator()(BinaryExpression& node) {
+    std::string lhs_type = visit(*this, node.get_lhs());
+    std::string rhs_type = visit(*this, node.get_rhs());
+    std::string type = promote_operands(lhs_type, rhs_type);
+
+    std::string op = node.get_op();
+    bool comparison = op == "==" || op == "!=" || op == "<" || op == ">" || op == "<=" ||
+                      op == ">=";
+    if (!comparison && op != "+" && op != "-" && op != "*" && op != "/" && op != "%") {
+        throw codegen_error("Unknown binary operator: " + op);
+    }
+    // Only numbers have arithmetic, and npc values can't even be compared.
+    if (type == "npc" || (type == "string" && !comparison)) {
+        throw codegen_error("Operands of a binary operation have incompatible types!");
+    }
+    return comparison ? "bool" : type;
+}
+
+std::string Checker::operator()(CallExpression& node) {
+    std::vector<std::string> arg_types = {};
+    for (auto& arg : node.get_arguments()) {
+        arg_types.push_back(visit(*this, arg));
+    }
+
+    auto symbol = pluh_symbols.find(node.get_callee());
+    if (symbol == pluh_symbols.end()) {
+        // yap prints any value, and returns what printf does.
+        if (node.get_callee() == "yap") {
+            for (auto& type : arg_types) {
+                if (type == "npc") {
+                    throw codegen_error("yap cannot print a value of this type!");
+                }
+            }
+            return "int";
+        }
+        throw codegen_error("Unknown pluh called: " + node.get_callee());
+    }
+    Prototype& callee = *symbol->second;
+    if (callee.get_arguments().size() != arg_types.size()) {
+        throw codegen_error("Wrong number of arguments passed to pluh: " +
+                            node.get_callee());
+    }
+    for (size_t i = 0; i < arg_types.size(); ++i) {
+        check_cast(arg_types[i], callee.get_arguments()[i].second);
+    }
+    return callee.get_return_type();
+}
+
+void Checker::operator()(CookedUpStatement& node) {
+    check_type_name(node.get_var_type());
+    current_scope_symbols[node.get_var_name()] = node.get_var_type();
+}
+
+void Checker::operator()(CookedUpAssignmentStatement& node) {
+    check_type_name(node.get_var_type());
+    // Check the value before the variable exists, so 'cookUp x : int = x' refers to any
+    // outer x.
+    check_cast(visit(*this, node.get_assignment_expression()),
+               node.get_var_type());
+    current_scope_symbols[node.get_var_name()] = node.get_var_type();
+}
+
+void Checker::operator()(AssignmentStatement& node) {
+    std::string type = visit(*this, node.get_assignment_expression());
+
+    // A bare pluh call is parsed as an assignment to "@", so just drop the result.
+    if (node.get_var_name() == "@") {
+        return;
+    }
+    auto symbol = current_scope_symbols.find(node.get_var_name());
+    if (symbol == current_scope_symbols.end()) {
+        throw codegen_error("Unknown variable: " + node.get_var_name());
+    }
+    check_cast(type, symbol->second);
+}
+
+void Checker::operator()(FrOngJustLikeThatStatement& node) {
+    check_condition(visit(*this, node.get_condition()));
+    visit(*this, node.get_then_statement());
+    visit(*this, node.get_else_statement());
+}
+
+void Checker::operator()(HoldUpStatement& node) {
+    check_condition(visit(*this, node.get_condition()));
+    ++loop_depth;
+    visit(*this, node.get_body());
+    --loop_depth;
+}
+
+void Checker::operator()(GhostStatement&) {
+    if (loop_depth == 0) {
+        throw codegen_error("ghost used outside of a holdUp loop!");
+    }
+}
+
+void Checker::operator()(RizzStatement&) {
+    if (loop_depth == 0) {
+        throw codegen_error("rizz used outside of a holdUp loop!");
+    }
+}
+
+void Checker::operator()(YeetStatement& node) {
+    check_cast(visit(*this, node.get_yeet_expr()), return_type);
+}
+
+void Checker::operator()(CompoundStatement& node) {
+    // Variables cooked up inside the braces go out of scope at the closing brace.
+    auto outer_scope_symbols = current_scope_symbols;
+    for (auto& statement : node.get_statements()) {
+        visit(*this, statement);
+    }
+    current_scope_symbols = std::move(outer_scope_symbols);
+}
+
+void Checker::operator()(PluhDeclaration& node) {
+    // plugs only declare an external pluh, there's no body to check.
+    if (!node.get_body().has_value()) {
+        return;
+    }
+    const std::string& name = node.get_prototype().get_name();
+    if (!defined_pluhs.insert(name).second) {
+        throw codegen_error("Pluh defined more than once: " + name);
+    }
+    debug << "[DEBUG] Checking pluh: " << name << std::endl;
+
+    // The body sees the arguments of the declaration that counts, like in Codegen.
+    Prototype& prototype = *pluh_symbols.at(name);
+    current_scope_symbols.clear();
+    for (auto& [arg_name, arg_type] : prototype.get_arguments()) {
+        current_scope_symbols[arg_name] = arg_type;
+    }
+    return_type = prototype.get_return_type();
+    loop_depth = 0;
+    visit(*this, node.get_body().value());
+}
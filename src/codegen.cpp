@@ -1,3 +1,1055 @@
 #include "codegen.hpp"
+#include "parser.hpp"
+#include "stats.hpp"
+#include <unordered_set>
 
-// TO DO
+static Statistic pluhs_generated("codegen", "pluhs", "Number of pluhs generated");
+static Statistic symbol_lookups("codegen", "symbol_lookups",
+                                "Number of variables and pluhs looked up");
+static Statistic constant_folds("codegen", "constant_folds",
+                                "Number of operations folded into constants");
+static Statistic instructions_generated("codegen", "instructions",
+                                        "Number of IR instructions generated");
+
+Codegen::Codegen()
+    : context(std::make_unique<llvm::LLVMContext>()),
+      builder(std::make_unique<llvm::IRBuilder<>>(*context)),
+      module(std::make_unique<llvm::Module>("slang", *context)),
+      current_loop_condition(nullptr),
+      current_loop_merge(nullptr),
+      fuel_metering(false) {
+    debug << "[DEBUG] Codegen initialized." << std::endl;
+}
+
+void Codegen::enable_fuel_metering() {
+    fuel_metering = true;
+}
+
+llvm::Type* Codegen::get_type_from_typename(const std::string& name) const {
+    // Map every S-Lang type name onto its LLVM counterpart.
+    if (name == "int") {
+        return builder->getInt32Ty();
+    } else if (name == "float") {
+        return builder->getDoubleTy();
+    } else if (name == "bool") {
+        return builder->getInt1Ty();
+    } else if (name == "char") {
+        return builder->getInt8Ty();
+    } else if (name == "string") {
+        return builder->getInt8PtrTy();
+    } else if (name == "npc") {
+        return builder->getVoidTy();
+    }
+    throw codegen_error("Unknown type name: " + name);
+}
+
+llvm::Value* Codegen::cast_to_type(llvm::Value* value, llvm::Type* type) {
+    llvm::Type* value_type = value->getType();
+    if (value_type == type) {
+        return value;
+    }
+
+    // int/char/bool -> float
+    if (value_type->isIntegerTy() && type->isDoubleTy()) {
+        return builder->CreateSIToFP(value, type, "casttmp");
+    }
+    // float -> int/char
+    if (value_type->isDoubleTy() && type->isIntegerTy()) {
+        return builder->CreateFPToSI(value, type, "casttmp");
+    }
+    // Anything integer -> bool compares against zero instead of truncating.
+    if (value_type->isIntegerTy() && type->isIntegerTy(1)) {
+        return builder->CreateICmpNE(value, llvm::ConstantInt::get(value_type, 0),
+                                     "booltmp");
+    }
+    // Integers of different widths (eg. char -> int).
+    if (value_type->isIntegerTy() && type->isIntegerTy()) {
+        if (value_type->isIntegerTy(1)) {
+            return builder->CreateZExt(value, type, "casttmp");
+        }
+        return builder->CreateSExtOrTrunc(value, type, "casttmp");
+    }
+    throw codegen_error("Cannot convert between incompatible types!");
+}
+
+void Codegen::promote_operands(llvm::Value*& lhs_value, llvm::Value*& rhs_value) {
+    llvm::Type* lhs_type = lhs_value->getType();
+    llvm::Type* rhs_type = rhs_value->getType();
+    if (lhs_type == rhs_type) {
+        return;
+    }
+
+    // If either side is a float, the whole operation happens in floating point.
+    if (lhs_type->isDoubleTy() || rhs_type->isDoubleTy()) {
+        lhs_value = cast_to_type(lhs_value, builder->getDoubleTy());
+        rhs_value = cast_to_type(rhs_value, builder->getDoubleTy());
+        return;
+    }
+
+    // Otherwise widen the narrower integer.
+    if (lhs_type->isIntegerTy() && rhs_type->isIntegerTy()) {
+        if (lhs_type->getIntegerBitWidth() < rhs_type->getIntegerBitWidth()) {
+            lhs_value = cast_to_type(lhs_value, rhs_type);
+        } else {
+            rhs_value = cast_to_type(rhs_value, lhs_type);
+        }
+        return;
+    }
+    throw codegen_error("Operands of a binary operation have incompatible types!");
+}
+
+llvm::Value* Codegen::to_condition(llvm::Value* value) {
+    llvm::Type* type = value->getType();
+    if (type->isIntegerTy(1)) {
+        return value;
+    }
+    if (type->isDoubleTy()) {
+        return builder->CreateFCmpONE(value, llvm::ConstantFP::get(type, 0.0), "condtmp");
+    }
+    if (type->isIntegerTy()) {
+        return builder->CreateICmpNE(value, llvm::ConstantInt::get(type, 0), "condtmp");
+    }
+    throw codegen_error("Condition must be an int, float, char or bool!");
+}
+
+llvm::AllocaInst* Codegen::create_entry_alloca(llvm::Function* function,
+                                               const std::string& name,
+                                               llvm::Type* type) {
+    llvm::IRBuilder<> entry_builder(&function->getEntryBlock(),
+                                    function->getEntryBlock().begin());
+    return entry_builder.CreateAlloca(type, nullptr, name);
+}
+
+llvm::Value* Codegen::get_variable(const std::string& name, llvm::Type*& type) {
+    ++symbol_lookups;
+    auto symbol = current_scope_symbols.find(name);
+    if (symbol != current_scope_symbols.end()) {
+        type = symbol->second->getAllocatedType();
+        return symbol->second;
+    }
+    auto global = global_symbols.find(name);
+    if (global != global_symbols.end()) {
+        type = global->second->getValueType();
+        return global->second;
+    }
+    throw codegen_error("Unknown variable: " + name);
+}
+
+llvm::FunctionType* Codegen::get_function_type(Prototype& prototype) {
+    std::vector<llvm::Type*> arg_types = {};
+    for (auto& [arg_name, arg_type] : prototype.get_arguments()) {
+        arg_types.push_back(get_type_from_typename(arg_type));
+    }
+    return llvm::FunctionType::get(get_type_from_typename(prototype.get_return_type()),
+                                   arg_types, false);
+}
+
+llvm::Function* Codegen::declare_prototype(Prototype& prototype,
+                                           const std::string& symbol_name) {
+    // Reuse the declaration if this pluh was already declared (eg. forward declared
+    // before its body was generated).
+    auto existing = pluh_symbols.find(prototype.get_name());
+    if (existing != pluh_symbols.end()) {
+        return existing->second;
+    }
+
+    llvm::Function* function = llvm::Function::Create(
+        get_function_type(prototype), llvm::Function::ExternalLinkage,
+        symbol_name.empty() ? prototype.get_name() : symbol_name, module.get());
+    pluh_symbols[prototype.get_name()] = function;
+
+    // Name the arguments after the ones in the source to make the IR readable.
+    unsigned index = 0;
+    for (auto& arg : function->args()) {
+        arg.setName(prototype.get_arguments()[index++].first);
+    }
+    debug << "[DEBUG] Declared pluh: " << prototype.get_name() << std::endl;
+    return function;
+}
+
+void Codegen::declare_global(const std::string& name, const std::string& type_name,
+                             const std::string& symbol_name, bool define) {
+    llvm::Type* type = get_type_from_typename(type_name);
+    llvm::GlobalVariable* global = new llvm::GlobalVariable(
+        *module, type, false, llvm::GlobalValue::ExternalLinkage,
+        define ? llvm::Constant::getNullValue(type) : nullptr, symbol_name);
+    global_symbols[name] = global;
+    debug << "[DEBUG] Declared global: " << name << std::endl;
+}
+
+llvm::Value* Codegen::yap_call(const std::vector<llvm::Value*>& args) {
+    llvm::FunctionCallee printf_func = module->getOrInsertFunction(
+        "printf",
+        llvm::FunctionType::get(builder->getInt32Ty(), {builder->getInt8PtrTy()}, true));
+
+    llvm::Value* result = builder->getInt32(0);
+    for (llvm::Value* arg : args) {
+        llvm::Type* type = arg->getType();
+        std::vector<llvm::Value*> printf_args = {};
+        if (type->isIntegerTy(1)) {
+            // Bools print as their S-Lang spelling.
+            printf_args.push_back(builder->CreateGlobalStringPtr("%s\n", "yap_fmt_bool"));
+            printf_args.push_back(builder->CreateSelect(
+                arg, builder->CreateGlobalStringPtr("facts", "yap_facts"),
+                builder->CreateGlobalStringPtr("cap", "yap_cap")));
+        } else if (type->isIntegerTy(8)) {
+            printf_args.push_back(builder->CreateGlobalStringPtr("%c\n", "yap_fmt_char"));
+            printf_args.push_back(builder->CreateSExt(arg, builder->getInt32Ty()));
+        } else if (type->isIntegerTy()) {
+            printf_args.push_back(builder->CreateGlobalStringPtr("%d\n", "yap_fmt_int"));
+            printf_args.push_back(arg);
+        } else if (type->isDoubleTy()) {
+            printf_args.push_back(
+                builder->CreateGlobalStringPtr("%f\n", "yap_fmt_float"));
+            printf_args.push_back(arg);
+        } else if (type->isPointerTy()) {
+            printf_args.push_back(
+                builder->CreateGlobalStringPtr("%s\n", "yap_fmt_string"));
+            printf_args.push_back(arg);
+        } else {
+            throw codegen_error("yap cannot print a value of this type!");
+        }
+        result = builder->CreateCall(printf_func, printf_args, "yaptmp");
+    }
+    return result;
+}
+
+void Codegen::continue_after_terminator() {
+    llvm::Function* function = builder->GetInsertBlock()->getParent();
+    llvm::BasicBlock* after_block =
+        llvm::BasicBlock::Create(*context, "unreachable", function);
+    builder->SetInsertPoint(after_block);
+}
+
+llvm::Value* Codegen::positive_unary_op(llvm::Value* rhs_value) {
+    return rhs_value;
+}
+
+llvm::Value* Codegen::negative_unary_op(llvm::Value* rhs_value) {
+    llvm::Type* type = rhs_value->getType();
+    if (!type->isIntegerTy() && !type->isDoubleTy()) {
+        throw codegen_error(std::string("Cannot negate a value of type ") +
+                            (type->isPointerTy() ? "string" : "npc"));
+    }
+    if (type->isDoubleTy()) {
+        return builder->CreateFNeg(rhs_value, "negtmp");
+    }
+    return builder->CreateNeg(rhs_value, "negtmp");
+}
+
+llvm::Value* Codegen::negate_unary_op(llvm::Value* rhs_value) {
+    if (rhs_value->getType()->isIntegerTy(1)) {
+        return builder->CreateNot(rhs_value, "nottmp");
+    }
+    // For anything else, !x is true exactly when x is zero.
+    return builder->CreateNot(to_condition(rhs_value), "nottmp");
+}
+
+llvm::Value* Codegen::add_binary_op(llvm::Value* lhs_value, llvm::Value* rhs_value) {
+    if (lhs_value->getType()->isDoubleTy()) {
+        return builder->CreateFAdd(lhs_value, rhs_value, "addtmp");
+    }
+    return builder->CreateAdd(lhs_value, rhs_value, "addtmp");
+}
+
+llvm::Value* Codegen::sub_binary_op(llvm::Value* lhs_value, llvm::Value* rhs_value) {
+    if (lhs_value->getType()->isDoubleTy()) {
+        return builder->CreateFSub(lhs_value, rhs_value, "subtmp");
+    }
+    return builder->CreateSub(lhs_value, rhs_value, "subtmp");
+}
+
+llvm::Value* Codegen::mult_binary_op(llvm::Value* lhs_value, llvm::Value* rhs_value) {
+    if (lhs_value->getType()->isDoubleTy()) {
+        return builder->CreateFMul(lhs_value, rhs_value, "multmp");
+    }
+    return builder->CreateMul(lhs_value, rhs_value, "multmp");
+}
+
+llvm::Value* Codegen::div_binary_op(llvm::Value* lhs_value, llvm::Value* rhs_value) {
+    if (lhs_value->getType()->isDoubleTy()) {
+        return builder->CreateFDiv(lhs_value, rhs_value, "divtmp");
+    }
+    return builder->CreateSDiv(lhs_value, rhs_value, "divtmp");
+}
+
+llvm::Value* Codegen::modulus_binary_op(llvm::Value* lhs_value, llvm::Value* rhs_value) {
+    if (lhs_value->getType()->isDoubleTy()) {
+        return builder->CreateFRem(lhs_value, rhs_value, "modtmp");
+    }
+    return builder->CreateSRem(lhs_value, rhs_value, "modtmp");
+}
+
+llvm::Value* Codegen::eq_binary_op(llvm::Value* lhs_value, llvm::Value* rhs_value) {
+    if (lhs_value->getType()->isDoubleTy()) {
+        return builder->CreateFCmpOEQ(lhs_value, rhs_value, "eqtmp");
+    }
+    return builder->CreateICmpEQ(lhs_value, rhs_value, "eqtmp");
+}
+
+llvm::Value* Codegen::neq_binary_op(llvm::Value* lhs_value, llvm::Value* rhs_value) {
+    if (lhs_value->getType()->isDoubleTy()) {
+        return builder->CreateFCmpONE(lhs_value, rhs_value, "neqtmp");
+    }
+    return builder->CreateICmpNE(lhs_value, rhs_value, "neqtmp");
+}
+
+llvm::Value* Codegen::lessthan_binary_op(llvm::Value* lhs_value, llvm::Value* rhs_value) {
+    if (lhs_value->getType()->isDoubleTy()) {
+        return builder->CreateFCmpOLT(lhs_value, rhs_value, "lttmp");
+    }
+    return builder->CreateICmpSLT(lhs_value, rhs_value, "lttmp");
+}
+
+llvm::Value* Codegen::greaterthan_binary_op(llvm::Value* lhs_value,
+                                            llvm::Value* rhs_value) {
+    if (lhs_value->getType()->isDoubleTy()) {
+        return builder->CreateFCmpOGT(lhs_value, rhs_value, "gttmp");
+    }
+    return builder->CreateICmpSGT(lhs_value, rhs_value, "gttmp");
+}
+
+llvm::Value* Codegen::leq_binary_op(llvm::Value* lhs_value, llvm::Value* rhs_value) {
+    if (lhs_value->getType()->isDoubleTy()) {
+        return builder->CreateFCmpOLE(lhs_value, rhs_value, "leqtmp");
+    }
+    return builder->CreateICmpSLE(lhs_value, rhs_value, "leqtmp");
+}
+
+llvm::Value* Codegen::geq_binary_op(llvm::Value* lhs_value, llvm::Value* rhs_value) {
+    if (lhs_value->getType()->isDoubleTy()) {
+        return builder->CreateFCmpOGE(lhs_value, rhs_value, "geqtmp");
+    }
+    return builder->CreateICmpSGE(lhs_value, rhs_value, "geqtmp");
+}
+
+llvm::Value* Codegen::operator()(const Literal<int>& node) {
+    return builder->getInt32(node.get_value());
+}
+
+llvm::Value* Codegen::operator()(const Literal<double>& node) {
+    return llvm::ConstantFP::get(builder->getDoubleTy(), node.get_value());
+}
+
+llvm::Value* Codegen::operator()(const Literal<bool>& node) {
+    return builder->getInt1(node.get_value());
+}
+
+llvm::Value* Codegen::operator()(const Literal<char>& node) {
+    return builder->getInt8(node.get_value());
+}
+
+llvm::Value* Codegen::operator()(const Literal<std::string>& node) {
+    return builder->CreateGlobalStringPtr(node.get_value(), "strtmp");
+}
+
+llvm::Value* Codegen::operator()(VariableExpression& node) {
+    // Look the variable up and load its value.
+    llvm::Type* type = nullptr;
+    llvm::Value* variable = get_variable(node.get_name(), type);
+    return builder->CreateLoad(type, variable, node.get_name());
+}
+
+llvm::Value* Codegen::operator()(UnaryExpression& node) {
+    llvm::Value* rhs_value = visit(*this, node.get_rhs());
+    std::string op = node.get_op();
+    llvm::Value* result = nullptr;
+    if (op == "+") {
+        result = positive_unary_op(rhs_value);
+    } else if (op == "-") {
+        result = negative_unary_op(rhs_value);
+    } else if (op == "!") {
+        result = negate_unary_op(rhs_value);
+    } else {
+        throw codegen_error("Unknown unary operator: " + op);
+    }
+    // The builder folds operations on constants as it goes.
+    if (llvm::isa<llvm::Constant>(rhs_value)) {
+        ++constant_folds;
+    }
+    return result;
+}
+
+llvm::Value* Codegen::operator()(BinaryExpression& node) {
+    llvm::Value* lhs_value = visit(*this, node.get_lhs());
+    llvm::Value* rhs_value = visit(*this, node.get_rhs());
+    promote_operands(lhs_value, rhs_value);
+
+    std::string op = node.get_op();
+    // Only numbers have arithmetic, and npc values can't even be compared.
+    llvm::Type* type = lhs_value->getType();
+    bool arithmetic = op == "+" || op == "-" || op == "*" || op == "/" || op == "%";
+    if (type->isVoidTy() || (arithmetic && !type->isIntegerTy() && !type->isDoubleTy())) {
+        throw codegen_error("Operands of a binary operation have incompatible types!");
+    }
+    llvm::Value* result = nullptr;
+    if (op == "+") {
+        result = add_binary_op(lhs_value, rhs_value);
+    } else if (op == "-") {
+        result = sub_binary_op(lhs_value, rhs_value);
+    } else if (op == "*") {
+        result = mult_binary_op(lhs_value, rhs_value);
+    } else if (op == "/") {
+        result = div_binary_op(lhs_value, rhs_value);
+    } else if (op == "%") {
+        result = modulus_binary_op(lhs_value, rhs_value);
+    } else if (op == "==") {
+        result = eq_binary_op(lhs_value, rhs_value);
+    } else if (op == "!=") {
+        result = neq_binary_op(lhs_value, rhs_value);
+    } else if (op == "<") {
+        result = lessthan_binary_op(lhs_value, rhs_value);
+    } else if (op == ">") {
+        result = greaterthan_binary_op(lhs_value, rhs_value);
+    } else if (op == "<=") {
+        result = leq_binary_op(lhs_value, rhs_value);
+    } else if (op == ">=") {
+        result = geq_binary_op(lhs_value, rhs_value);
+    } else {
+        throw codegen_error("Unknown binary operator: " + op);
+    }
+    if (llvm::isa<llvm::Constant>(lhs_value) && llvm::isa<llvm::Constant>(rhs_value)) {
+        ++constant_folds;
+    }
+    return result;
+}
+
+llvm::Value* Codegen::operator()(CallExpression& node) {
+    // Generate every argument first, left to right.
+    std::vector<llvm::Value*> args = {};
+    for (auto& arg : node.get_arguments()) {
+        args.push_back(visit(*this, arg));
+    }
+
+    // yap is built into the language rather than declared by the program.
+    ++symbol_lookups;
+    auto symbol = pluh_symbols.find(node.get_callee());
+    if (symbol == pluh_symbols.end()) {
+        if (node.get_callee() == "yap") {
+            return yap_call(args);
+        }
+        throw codegen_error("Unknown pluh called: " + node.get_callee());
+    }
+    llvm::Function* callee = symbol->second;
+    if (callee->arg_size() != args.size()) {
+        throw codegen_error("Wrong number of arguments passed to pluh: " +
+                            node.get_callee());
+    }
+
+    // Convert every argument to the type the pluh expects.
+    unsigned index = 0;
+    for (auto& param : callee->args()) {
+        args[index] = cast_to_type(args[index], param.getType());
+        ++index;
+    }
+
+    // Void calls can't be named in LLVM IR.
+    if (callee->getReturnType()->isVoidTy()) {
+        return builder->CreateCall(callee, args);
+    }
+    return builder->CreateCall(callee, args, "calltmp");
+}
+
+void Codegen::operator()(CookedUpStatement& node) {
+    llvm::Function* function = builder->GetInsertBlock()->getParent();
+    llvm::Type* type = get_type_from_typename(node.get_var_type());
+    llvm::AllocaInst* alloca = create_entry_alloca(function, node.get_var_name(), type);
+
+    // Variables start out zero initialized.
+    builder->CreateStore(llvm::Constant::getNullValue(type), alloca);
+    current_scope_symbols[node.get_var_name()] = alloca;
+}
+
+void Codegen::operator()(CookedUpAssignmentStatement& node) {
+    llvm::Function* function = builder->GetInsertBlock()->getParent();
+    llvm::Type* type = get_type_from_typename(node.get_var_type());
+
+    // Generate the value before the variable exists, so 'cookUp x : int = x' refers to
+    // any outer x.
+    llvm::Value* value = visit(*this, node.get_assignment_expression());
+    llvm::AllocaInst* alloca = create_entry_alloca(function, node.get_var_name(), type);
+    builder->CreateStore(cast_to_type(value, type), alloca);
+    current_scope_symbols[node.get_var_name()] = alloca;
+}
+
+void Codegen::operator()(AssignmentStatement& node) {
+    llvm::Value* value = visit(*this, node.get_assignment_expression());
+
+    // A bare pluh call is parsed as an assignment to "@", so just drop the result.
+    if (node.get_var_name() == "@") {
+        return;
+    }
+
+    llvm::Type* type = nullptr;
+    llvm::Value* variable = get_variable(node.get_var_name(), type);
+    builder->CreateStore(cast_to_type(value, type), variable);
+}
+
+void Codegen::operator()(FrOngJustLikeThatStatement& node) {
+    llvm::Value* condition = to_condition(visit(*this, node.get_condition()));
+    llvm::Function* function = builder->GetInsertBlock()->getParent();
+
+    llvm::BasicBlock* then_block = llvm::BasicBlock::Create(*context, "fr", function);
+    llvm::BasicBlock* else_block = llvm::BasicBlock::Create(*context, "justlikethat");
+    llvm::BasicBlock* merge_block = llvm::BasicBlock::Create(*context, "frcont");
+    builder->CreateCondBr(condition, then_block, else_block);
+
+    // Then branch (jump to the merge block unless the branch already yeeted).
+    builder->SetInsertPoint(then_block);
+    visit(*this, node.get_then_statement());
+    if (!builder->GetInsertBlock()->getTerminator()) {
+        builder->CreateBr(merge_block);
+    }
+
+    // Else branch, which also holds any ong? chain.
+    function->getBasicBlockList().push_back(else_block);
+    builder->SetInsertPoint(else_block);
+    visit(*this, node.get_else_statement());
+    if (!builder->GetInsertBlock()->getTerminator()) {
+        builder->CreateBr(merge_block);
+    }
+
+    function->getBasicBlockList().push_back(merge_block);
+    builder->SetInsertPoint(merge_block);
+}
+
+void Codegen::operator()(HoldUpStatement& node) {
+    llvm::Function* function = builder->GetInsertBlock()->getParent();
+    llvm::BasicBlock* condition_block =
+        llvm::BasicBlock::Create(*context, "holdup", function);
+    llvm::BasicBlock* body_block = llvm::BasicBlock::Create(*context, "holdupbody");
+    llvm::BasicBlock* merge_block = llvm::BasicBlock::Create(*context, "holdupcont");
+
+    builder->CreateBr(condition_block);
+    builder->SetInsertPoint(condition_block);
+    llvm::Value* condition = to_condition(visit(*this, node.get_condition()));
+    builder->CreateCondBr(condition, body_block, merge_block);
+
+    // Remember the enclosing loop so nested loops don't clobber ghost/rizz targets.
+    llvm::BasicBlock* outer_loop_condition = current_loop_condition;
+    llvm::BasicBlock* outer_loop_merge = current_loop_merge;
+    current_loop_condition = condition_block;
+    current_loop_merge = merge_block;
+
+    function->getBasicBlockList().push_back(body_block);
+    builder->SetInsertPoint(body_block);
+    visit(*this, node.get_body());
+    if (!builder->GetInsertBlock()->getTerminator()) {
+        builder->CreateBr(condition_block);
+    }
+
+    current_loop_condition = outer_loop_condition;
+    current_loop_merge = outer_loop_merge;
+
+    function->getBasicBlockList().push_back(merge_block);
+    builder->SetInsertPoint(merge_block);
+}
+
+void Codegen::operator()(GhostStatement&) {
+    if (!current_loop_merge) {
+        throw codegen_error("ghost used outside of a holdUp loop!");
+    }
+    builder->CreateBr(current_loop_merge);
+    continue_after_terminator();
+}
+
+void Codegen::operator()(RizzStatement&) {
+    if (!current_loop_condition) {
+        throw codegen_error("rizz used outside of a holdUp loop!");
+    }
+    builder->CreateBr(current_loop_condition);
+    continue_after_terminator();
+}
+
+void Codegen::operator()(YeetStatement& node) {
+    llvm::Value* value = visit(*this, node.get_yeet_expr());
+    llvm::Function* function = builder->GetInsertBlock()->getParent();
+    builder->CreateRet(cast_to_type(value, function->getReturnType()));
+    continue_after_terminator();
+}
+
+void Codegen::operator()(CompoundStatement& node) {
+    // Variables cooked up inside the braces go out of scope at the closing brace.
+    auto outer_scope_symbols = current_scope_symbols;
+    for (auto& statement : node.get_statements()) {
+        visit(*this, statement);
+    }
+    current_scope_symbols = std::move(outer_scope_symbols);
+}
+
+void Codegen::operator()(PluhDeclaration& node) {
+    llvm::Function* function = declare_prototype(node.get_prototype());
+
+    // plugs only declare an external pluh, there's no body to generate.
+    if (!node.get_body().has_value()) {
+        return;
+    }
+    if (!function->empty()) {
+        throw codegen_error("Pluh defined more than once: " +
+                            node.get_prototype().get_name());
+    }
+    generate_body(node, function);
+}
+
+llvm::Function* Codegen::define_pluh(PluhDeclaration& node,
+                                     const std::string& symbol_name) {
+    llvm::Function* function = llvm::Function::Create(
+        get_function_type(node.get_prototype()), llvm::Function::ExternalLinkage,
+        symbol_name, module.get());
+    unsigned index = 0;
+    for (auto& arg : function->args()) {
+        arg.setName(node.get_prototype().get_arguments()[index++].first);
+    }
+    generate_body(node, function);
+    return function;
+}
+
+void Codegen::generate_body(PluhDeclaration& node, llvm::Function* function) {
+    debug << "[DEBUG] Generating pluh: " << node.get_prototype().get_name() << std::endl;
+
+    llvm::BasicBlock* entry_block = llvm::BasicBlock::Create(*context, "entry", function);
+    builder->SetInsertPoint(entry_block);
+
+    // Arguments are copied into stack slots so they can be reassigned like any other
+    // variable.
+    current_scope_symbols.clear();
+    for (auto& arg : function->args()) {
+        std::string arg_name = arg.getName().str();
+        llvm::AllocaInst* alloca = create_entry_alloca(function, arg_name, arg.getType());
+        builder->CreateStore(&arg, alloca);
+        current_scope_symbols[arg_name] = alloca;
+    }
+
+    visit(*this, node.get_body().value());
+
+    // Fall off the end of the pluh: npc pluhs return, others return a zero value (only
+    // reachable when every yeet sits inside a fr?).
+    if (!builder->GetInsertBlock()->getTerminator()) {
+        if (function->getReturnType()->isVoidTy()) {
+            builder->CreateRetVoid();
+        } else {
+            builder->CreateRet(llvm::Constant::getNullValue(function->getReturnType()));
+        }
+    }
+    ++pluhs_generated;
+    instructions_generated += function->getInstructionCount();
+    if (fuel_metering) {
+        meter_fuel(function);
+    }
+
+    std::string error;
+    llvm::raw_string_ostream error_stream(error);
+    if (llvm::verifyFunction(*function, &error_stream)) {
+        throw codegen_error("Invalid IR generated for pluh " +
+                            node.get_prototype().get_name() + ": " + error_stream.str());
+    }
+}
+
+llvm::Function* Codegen::define_expression(
+    Expression& expression,
+    const std::vector<std::pair<std::string, std::string>>& variables,
+    const std::string& type_name, const std::string& symbol_name) {
+    std::vector<llvm::Type*> arg_types = {};
+    for (auto& [name, type] : variables) {
+        arg_types.push_back(get_type_from_typename(type));
+    }
+    llvm::Type* result_type = get_type_from_typename(type_name);
+    llvm::Function* function = llvm::Function::Create(
+        llvm::FunctionType::get(result_type, arg_types, false),
+        llvm::Function::ExternalLinkage, symbol_name, module.get());
+
+    llvm::BasicBlock* entry_block = llvm::BasicBlock::Create(*context, "entry", function);
+    builder->SetInsertPoint(entry_block);
+    current_scope_symbols.clear();
+    for (auto& arg : function->args()) {
+        const std::string& name = variables[arg.getArgNo()].first;
+        arg.setName(name);
+        llvm::AllocaInst* alloca = create_entry_alloca(function, name, arg.getType());
+        builder->CreateStore(&arg, alloca);
+        current_scope_symbols[name] = alloca;
+    }
+
+    try {
+        llvm::Value* value = visit(*this, expression);
+        if (result_type->isVoidTy()) {
+            builder->CreateRetVoid();
+        } else {
+            builder->CreateRet(cast_to_type(value, result_type));
+        }
+    } catch (...) {
+        function->eraseFromParent();
+        throw;
+    }
+
+    std::string error;
+    llvm::raw_string_ostream error_stream(error);
+    if (llvm::verifyFunction(*function, &error_stream)) {
+        function->eraseFromParent();
+        throw codegen_error("Invalid IR generated for expression: " + error_stream.str());
+    }
+    instructions_generated += function->getInstructionCount();
+    return function;
+}
+
+void Codegen::meter_fuel(llvm::Function* function) {
+    // Blocks are laid out in source order, so an edge to a block at or before its source
+    // is a holdUp back edge (the end of the loop body, or a rizz), and every block laid
+    // out between the two is part of that loop.
+    std::vector<llvm::BasicBlock*> blocks = {};
+    std::unordered_map<llvm::BasicBlock*, size_t> positions;
+    for (auto& block : *function) {
+        positions[&block] = blocks.size();
+        blocks.push_back(&block);
+    }
+    std::vector<uint64_t> costs(blocks.size() + 1, 0); // Prefix sums of the block sizes.
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        costs[i + 1] = costs[i] + blocks[i]->sizeWithoutDebug();
+    }
+    std::vector<std::pair<llvm::BasicBlock*, llvm::BasicBlock*>> back_edges = {};
+    std::vector<bool> in_loop(blocks.size(), false);
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        for (llvm::BasicBlock* successor : llvm::successors(blocks[i])) {
+            size_t target = positions[successor];
+            if (target <= i) {
+                back_edges.push_back({blocks[i], successor});
+                std::fill(in_loop.begin() + target, in_loop.begin() + i + 1, true);
+            }
+        }
+    }
+    uint64_t entry_cost = 0;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        if (!in_loop[i]) {
+            entry_cost += blocks[i]->sizeWithoutDebug();
+        }
+    }
+
+    llvm::Type* fuel_type = builder->getInt64Ty();
+    llvm::Constant* fuel = module->getOrInsertGlobal("slang.fuel", fuel_type);
+    llvm::Function* out_of_fuel = llvm::cast<llvm::Function>(
+        module
+            ->getOrInsertFunction("slang.out_of_fuel",
+                                  llvm::FunctionType::get(builder->getVoidTy(), false))
+            .getCallee());
+    // The trap never touches memory the pluh can see, so the optimizer is free to keep
+    // the fuel in a register across a loop and only write it back when the loop exits.
+    out_of_fuel->setDoesNotReturn();
+    out_of_fuel->setDoesNotThrow();
+    out_of_fuel->setOnlyAccessesInaccessibleMemory();
+    out_of_fuel->addFnAttr(llvm::Attribute::Cold);
+
+    llvm::BasicBlock* trap_block =
+        llvm::BasicBlock::Create(*context, "outoffuel", function);
+    builder->SetInsertPoint(trap_block);
+    builder->CreateCall(out_of_fuel);
+    builder->CreateUnreachable();
+
+    // Ends the current block with a check charging the given cost, then goes on to next.
+    auto charge = [&](uint64_t cost, llvm::BasicBlock* next) {
+        llvm::Value* left =
+            builder->CreateSub(builder->CreateLoad(fuel_type, fuel, "fuel"),
+                               builder->getInt64(cost), "fuelleft");
+        builder->CreateStore(left, fuel);
+        builder->CreateCondBr(builder->CreateICmpSLT(left, builder->getInt64(0)),
+                              trap_block, next);
+    };
+
+    for (auto& [source, target] : back_edges) {
+        uint64_t cost = costs[positions[source] + 1] - costs[positions[target]];
+        llvm::BasicBlock* check_block =
+            llvm::BasicBlock::Create(*context, "fuel", function, source->getNextNode());
+        source->getTerminator()->replaceSuccessorWith(target, check_block);
+        target->replacePhiUsesWith(source, check_block);
+        builder->SetInsertPoint(check_block);
+        charge(cost, target);
+    }
+
+    // Split the entry block after its allocas, which have to stay in the entry block for
+    // mem2reg to promote them.
+    llvm::BasicBlock* entry_block = &function->getEntryBlock();
+    auto split_point = entry_block->getFirstInsertionPt();
+    while (llvm::isa<llvm::AllocaInst>(*split_point)) {
+        ++split_point;
+    }
+    llvm::BasicBlock* body_block = entry_block->splitBasicBlock(split_point, "body");
+    entry_block->getTerminator()->eraseFromParent();
+    builder->SetInsertPoint(entry_block);
+    charge(entry_cost, body_block);
+}
+
+void Codegen::profile_arguments(llvm::Function* function, uint64_t* calls,
+                                const std::vector<void*>& profiles, uint64_t window,
+                                const std::string& hook_symbol) {
+    // Split the entry block after its allocas, which have to stay in the entry block for
+    // mem2reg to promote them.
+    llvm::BasicBlock* entry_block = &function->getEntryBlock();
+    auto split_point = entry_block->getFirstInsertionPt();
+    while (llvm::isa<llvm::AllocaInst>(*split_point)) {
+        ++split_point;
+    }
+    llvm::BasicBlock* body_block = entry_block->splitBasicBlock(split_point, "body");
+    entry_block->getTerminator()->eraseFromParent();
+    llvm::BasicBlock* profile_block =
+        llvm::BasicBlock::Create(*context, "profile", function, body_block);
+
+    // Count the call, and only profile the first calls within the window.
+    builder->SetInsertPoint(entry_block);
+    llvm::Type* counter_type = builder->getInt64Ty();
+    llvm::Value* calls_ptr =
+        builder->CreateIntToPtr(builder->getInt64(reinterpret_cast<uint64_t>(calls)),
+                                counter_type->getPointerTo());
+    llvm::Value* count = builder->CreateLoad(counter_type, calls_ptr, "calls");
+    builder->CreateStore(builder->CreateAdd(count, builder->getInt64(1)), calls_ptr);
+    builder->CreateCondBr(builder->CreateICmpULT(count, builder->getInt64(window)),
+                          profile_block, body_block);
+
+    builder->SetInsertPoint(profile_block);
+    llvm::FunctionCallee hook = module->getOrInsertFunction(
+        hook_symbol,
+        llvm::FunctionType::get(builder->getVoidTy(),
+                                {builder->getInt8PtrTy(), counter_type}, false));
+    for (auto& arg : function->args()) {
+        void* profile = profiles[arg.getArgNo()];
+        if (!profile) {
+            continue;
+        }
+        llvm::Value* value = arg.getType()->isIntegerTy(1)
+                                 ? builder->CreateZExt(&arg, counter_type)
+                                 : builder->CreateSExt(&arg, counter_type);
+        llvm::Value* profile_ptr = builder->CreateIntToPtr(
+            builder->getInt64(reinterpret_cast<uint64_t>(profile)),
+            builder->getInt8PtrTy());
+        builder->CreateCall(hook, {profile_ptr, value});
+    }
+    builder->CreateBr(body_block);
+}
+
+void Codegen::specialize_arguments(
+    llvm::Function* function,
+    const std::vector<std::pair<unsigned, int64_t>>& constants) {
+    for (auto& [index, value] : constants) {
+        llvm::Argument* arg = function->getArg(index);
+        arg->replaceAllUsesWith(llvm::ConstantInt::get(arg->getType(), value));
+    }
+}
+
+void Codegen::define_guard(Prototype& prototype, const std::string& guard_symbol,
+                           const std::string& special_symbol,
+                           const std::string& generic_symbol,
+                           const std::vector<std::pair<unsigned, int64_t>>& constants,
+                           uint64_t* hits, uint64_t* misses) {
+    llvm::FunctionType* function_type = get_function_type(prototype);
+    llvm::Function* guard = llvm::Function::Create(
+        function_type, llvm::Function::ExternalLinkage, guard_symbol, module.get());
+    llvm::FunctionCallee special =
+        module->getOrInsertFunction(special_symbol, function_type);
+    llvm::FunctionCallee generic =
+        module->getOrInsertFunction(generic_symbol, function_type);
+
+    llvm::BasicBlock* entry_block = llvm::BasicBlock::Create(*context, "entry", guard);
+    llvm::BasicBlock* hit_block = llvm::BasicBlock::Create(*context, "hit", guard);
+    llvm::BasicBlock* miss_block = llvm::BasicBlock::Create(*context, "miss", guard);
+
+    builder->SetInsertPoint(entry_block);
+    llvm::Value* matches = builder->getTrue();
+    for (auto& [index, value] : constants) {
+        llvm::Argument* arg = guard->getArg(index);
+        matches = builder->CreateAnd(
+            matches,
+            builder->CreateICmpEQ(arg, llvm::ConstantInt::get(arg->getType(), value)));
+    }
+    builder->CreateCondBr(matches, hit_block, miss_block);
+
+    std::vector<llvm::Value*> args = {};
+    for (auto& arg : guard->args()) {
+        args.push_back(&arg);
+    }
+    // Count the outcome, then tail call the pluh that handles it.
+    auto forward = [&](llvm::BasicBlock* block, llvm::FunctionCallee callee,
+                       uint64_t* counter) {
+        builder->SetInsertPoint(block);
+        llvm::Type* counter_type = builder->getInt64Ty();
+        llvm::Value* counter_ptr = builder->CreateIntToPtr(
+            builder->getInt64(reinterpret_cast<uint64_t>(counter)),
+            counter_type->getPointerTo());
+        builder->CreateStore(
+            builder->CreateAdd(builder->CreateLoad(counter_type, counter_ptr),
+                               builder->getInt64(1)),
+            counter_ptr);
+        llvm::CallInst* call = builder->CreateCall(callee, args);
+        call->setTailCall();
+        if (function_type->getReturnType()->isVoidTy()) {
+            builder->CreateRetVoid();
+        } else {
+            builder->CreateRet(call);
+        }
+    };
+    forward(hit_block, special, hits);
+    forward(miss_block, generic, misses);
+}
+
+bool Codegen::generate_ir(TeaSpill& module_node) {
+    debug << "[DEBUG] Generating IR for: " << module_node.get_name() << std::endl;
+    try {
+        module->setModuleIdentifier(module_node.get_name());
+
+        // Declare every pluh up front so they can call each other in any order.
+        for (auto& declaration : module_node.get_declarations()) {
+            std::visit([this](PluhDeclaration& pluh) {
+                declare_prototype(pluh.get_prototype());
+            }, declaration);
+        }
+
+        for (auto& declaration : module_node.get_declarations()) {
+            std::visit(*this, declaration);
+        }
+
+        std::string error;
+        llvm::raw_string_ostream error_stream(error);
+        if (llvm::verifyModule(*module, &error_stream)) {
+            throw codegen_error("Invalid module generated: " + error_stream.str());
+        }
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "[ERROR] " << e.what() << std::endl;
+        return false;
+    }
+}
+
+bool Codegen::generate_ir_streamed(const std::string& code, llvm::raw_ostream* out) {
+    debug << "[DEBUG] Streaming IR generation." << std::endl;
+    try {
+        // First pass: only the prototypes, so pluhs can call each other in any order
+        // without any body being parsed yet.
+        {
+            Parser outline(std::string_view(code), Lexer::default_chunk_size);
+            module->setModuleIdentifier(outline.parse_tea_header());
+            for (auto& prototype : outline.parse_prototypes()) {
+                declare_prototype(prototype);
+            }
+        }
+
+        // Only the header has to come before the pluhs, the rest is written at the end.
+        if (out) {
+            *out << "; ModuleID = '" << module->getModuleIdentifier() << "'\n"
+                 << "source_filename = \"" << module->getSourceFileName() << "\"\n\n";
+        }
+
+        // Second pass: each declaration is parsed, generated and freed before the next
+        // one is read, so the AST never holds more than one pluh.
+        Parser parser(std::string_view(code), Lexer::default_chunk_size);
+        parser.parse_tea_header();
+        std::vector<llvm::Function*> written = {};
+        std::unordered_set<std::string> defined = {};
+        llvm::Module scratch("stream", *context);
+        while (auto declaration = parser.parse_next_declaration()) {
+            const std::string& name = declaration->get_prototype().get_name();
+            // Written pluhs lose their bodies, so redefinitions are caught here instead.
+            if (declaration->get_body().has_value() && !defined.insert(name).second) {
+                throw codegen_error("Pluh defined more than once: " + name);
+            }
+            (*this)(*declaration);
+            if (!out || !declaration->get_body().has_value()) {
+                continue;
+            }
+            // The pluh is written out and only its declaration is kept, so the module
+            // doesn't grow with the program either.
+            llvm::Function* function = pluh_symbols.at(name);
+            // Printed from a module of its own, since printing it from this one would
+            // number every global and declaration in it first, for every pluh.
+            function->removeFromParent();
+            scratch.getFunctionList().push_back(function);
+            function->print(*out);
+            *out << "\n";
+            function->removeFromParent();
+            module->getFunctionList().push_back(function);
+            function->deleteBody();
+            written.push_back(function);
+        }
+
+        // Once every body is gone nothing calls the written pluhs anymore, so their
+        // declarations can go too, leaving globals, plugs and attributes to write.
+        for (llvm::Function* function : written) {
+            pluh_symbols.erase(function->getName().str());
+            function->eraseFromParent();
+        }
+        std::string error;
+        llvm::raw_string_ostream error_stream(error);
+        if (llvm::verifyModule(*module, &error_stream)) {
+            throw codegen_error("Invalid module generated: " + error_stream.str());
+        }
+        if (out) {
+            std::string rest;
+            llvm::raw_string_ostream rest_stream(rest);
+            module->print(rest_stream, nullptr);
+            rest_stream.flush();
+            *out << rest.substr(rest.find('\n', rest.find("source_filename")) + 1);
+        }
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "[ERROR] " << e.what() << std::endl;
+        return false;
+    }
+}
+
+void Codegen::generate_unit(TeaSpill& unit, const std::string& prefix,
+                            const std::string& entry) {
+    // Names only resolve within the program, so another program's pluhs are invisible.
+    pluh_symbols.clear();
+    std::vector<llvm::Function*> defined = {};
+    try {
+        for (auto& declaration : unit.get_declarations()) {
+            PluhDeclaration& pluh = std::get<PluhDeclaration>(declaration);
+            Prototype& prototype = pluh.get_prototype();
+            if (pluh.get_body().has_value()) {
+                llvm::Function* function =
+                    declare_prototype(prototype, prefix + prototype.get_name());
+                if (prototype.get_name() != entry) {
+                    function->setLinkage(llvm::Function::InternalLinkage);
+                }
+                defined.push_back(function);
+                continue;
+            }
+            // Programs share the declaration of a plug, which needs its real name.
+            llvm::Function* plug = module->getFunction(prototype.get_name());
+            if (!plug) {
+                declare_prototype(prototype);
+            } else if (plug->getFunctionType() != get_function_type(prototype)) {
+                throw codegen_error("Plug declared with another signature before: " +
+                                    prototype.get_name());
+            } else {
+                pluh_symbols[prototype.get_name()] = plug;
+            }
+        }
+        for (auto& declaration : unit.get_declarations()) {
+            std::visit(*this, declaration);
+        }
+    } catch (const std::exception& e) {
+        for (llvm::Function* function : defined) {
+            function->dropAllReferences();
+        }
+        for (llvm::Function* function : defined) {
+            function->eraseFromParent();
+        }
+        pluh_symbols.clear();
+        builder->ClearInsertionPoint();
+        current_loop_condition = nullptr;
+        current_loop_merge = nullptr;
+        throw;
+    }
+}
+
+std::string Codegen::output_ir() {
+    std::string ir;
+    llvm::raw_string_ostream ir_stream(ir);
+    module->print(ir_stream, nullptr);
+    return ir_stream.str();
+}
+
+std::unique_ptr<llvm::Module> Codegen::take_module() {
+    return std::move(module);
+}
+
+std::unique_ptr<llvm::LLVMContext> Codegen::take_context() {
+    builder.reset();
+    return std::move(context);
+}
@@ -0,0 +1,168 @@
+#include "interner.hpp"
+#include "stats.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <utility>
+
+static Statistic strings_interned("interner", "strings",
+                                  "Number of distinct strings interned");
+static Statistic lost_races("interner", "lost_races",
+                            "Number of strings another thread interned first");
+static Statistic shards_grown("interner", "grows", "Number of times a shard grew");
+
+// Size of the blocks arenas allocate, strings longer than a block get one of their own.
+static const size_t block_size = 64 * 1024;
+
+// Fills the empty slots of a table while it's copied into a bigger one, so no string
+// can be interned into it after it's copied. A slot is only ever empty before it holds
+// an entry or this marker, so a string missing before the marker is missing.
+const Interner::Entry Interner::moved = {0, 0};
+
+// Gives every interner an id, so a thread's arenas are never mixed up between an
+// interner and one created later at the same address.
+static std::atomic<uint64_t> interner_count = 0;
+
+Interner::Table::Table(size_t capacity)
+    : mask(capacity - 1),
+      slots(std::make_unique<std::atomic<const Entry*>[]>(capacity)),
+      previous(nullptr) {
+    for (size_t i = 0; i < capacity; ++i) {
+        slots[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+Interner::Arena::Arena() : blocks(), next(nullptr), end(nullptr) {}
+
+Interner::Entry* Interner::Arena::allocate(std::string_view text, uint64_t hash) {
+    // Entries are aligned, and their characters are null terminated.
+    size_t size = sizeof(Entry) + text.size() + 1;
+    size = (size + alignof(Entry) - 1) / alignof(Entry) * alignof(Entry);
+    if (static_cast<size_t>(end - next) < size) {
+        size_t capacity = std::max(block_size, size);
+        blocks.push_back(std::make_unique<char[]>(capacity));
+        next = blocks.back().get();
+        end = next + capacity;
+    }
+    Entry* entry = new (next) Entry{hash, text.size()};
+    char* characters = reinterpret_cast<char*>(entry + 1);
+    std::memcpy(characters, text.data(), text.size());
+    characters[text.size()] = '\0';
+    next += size;
+    return entry;
+}
+
+void Interner::Arena::rollback(Entry* entry) {
+    next = reinterpret_cast<char*>(entry);
+}
+
+Interner::Interner(unsigned shard_bits, size_t shard_capacity)
+    : id(interner_count++),
+      shard_bits(shard_bits),
+      shards(std::make_unique<Shard[]>(size_t(1) << shard_bits)),
+      arenas_mutex(),
+      arenas() {
+    size_t capacity = std::bit_ceil(std::max<size_t>(shard_capacity, 4));
+    for (size_t i = 0; i < (size_t(1) << shard_bits); ++i) {
+        shards[i].owned = std::make_unique<Table>(capacity);
+        shards[i].table.store(shards[i].owned.get(), std::memory_order_release);
+        shards[i].count.store(0, std::memory_order_relaxed);
+    }
+}
+
+Interner::Arena& Interner::get_arena() {
+    // The arenas of this thread, by the id of their interner. Entries of destroyed
+    // interners are never looked up again, since ids aren't reused.
+    thread_local std::vector<std::pair<uint64_t, Arena*>> thread_arenas = {};
+    for (auto& [owner, arena] : thread_arenas) {
+        if (owner == id) {
+            return *arena;
+        }
+    }
+    std::lock_guard<std::mutex> lock(arenas_mutex);
+    Arena& arena = arenas.emplace_back();
+    thread_arenas.emplace_back(id, &arena);
+    return arena;
+}
+
+void Interner::grow(Shard& shard, Table* full) {
+    std::lock_guard<std::mutex> lock(shard.grow_mutex);
+    if (shard.table.load(std::memory_order_acquire) != full) {
+        return;
+    }
+    ++shards_grown;
+    auto bigger = std::make_unique<Table>((full->mask + 1) * 2);
+    for (size_t i = 0; i <= full->mask; ++i) {
+        // Freeze the slot: mark it moved if it's empty, or copy its entry.
+        const Entry* entry = nullptr;
+        while (!entry &&
+               !full->slots[i].compare_exchange_weak(entry, &moved,
+                                                     std::memory_order_acq_rel,
+                                                     std::memory_order_acquire)) {
+        }
+        if (!entry) {
+            continue;
+        }
+        size_t slot = entry->hash & bigger->mask;
+        while (bigger->slots[slot].load(std::memory_order_relaxed)) {
+            slot = (slot + 1) & bigger->mask;
+        }
+        bigger->slots[slot].store(entry, std::memory_order_relaxed);
+    }
+    bigger->previous = std::move(shard.owned);
+    shard.owned = std::move(bigger);
+    shard.table.store(shard.owned.get(), std::memory_order_release);
+}
+
+std::string_view Interner::intern(std::string_view text) {
+    uint64_t hash = std::hash<std::string_view>{}(text);
+    Shard& shard = shards[shard_bits ? hash >> (64 - shard_bits) : 0];
+    Entry* created = nullptr; // Our copy of the string, once we need one.
+    while (true) {
+        Table* table = shard.table.load(std::memory_order_acquire);
+        size_t slot = hash & table->mask;
+        for (size_t probes = 0; probes <= table->mask; ++probes) {
+            const Entry* entry = table->slots[slot].load(std::memory_order_acquire);
+            if (!entry) {
+                if (!created) {
+                    created = get_arena().allocate(text, hash);
+                }
+                if (table->slots[slot].compare_exchange_strong(
+                        entry, created, std::memory_order_acq_rel,
+                        std::memory_order_acquire)) {
+                    ++strings_interned;
+                    size_t count = shard.count.fetch_add(1, std::memory_order_relaxed);
+                    if ((count + 1) * 4 > (table->mask + 1) * 3) {
+                        grow(shard, table);
+                    }
+                    return created->text();
+                }
+                // Another thread took the slot first, it may have interned the string.
+            }
+            if (entry == &moved) {
+                break;
+            }
+            if (entry->hash == hash && entry->text() == text) {
+                if (created) {
+                    ++lost_races;
+                    get_arena().rollback(created);
+                }
+                return entry->text();
+            }
+            slot = (slot + 1) & table->mask;
+        }
+        // The table is being copied into a bigger one (or is full, which growing
+        // fixes): wait for the bigger one and intern into it.
+        grow(shard, table);
+    }
+}
+
+size_t Interner::size() const {
+    size_t count = 0;
+    for (size_t i = 0; i < (size_t(1) << shard_bits); ++i) {
+        count += shards[i].count.load(std::memory_order_relaxed);
+    }
+    return count;
+}
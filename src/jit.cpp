@@ -0,0 +1,585 @@
+#include "jit.hpp"
+#include "debug_stream.hpp"
+#include "stats.hpp"
+#include <llvm/ExecutionEngine/JITLink/EHFrameSupport.h>
+#include <llvm/ExecutionEngine/Orc/CompileUtils.h>
+#include <llvm/ExecutionEngine/Orc/EPCDynamicLibrarySearchGenerator.h>
+#include <llvm/ExecutionEngine/Orc/EPCEHFrameRegistrar.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/ObjectLinkingLayer.h>
+#include <llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h>
+#include <llvm/ExecutionEngine/Orc/SimpleRemoteEPC.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/TargetSelect.h>
+#include <algorithm>
+#include <chrono>
+#include <csetjmp>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+static Statistic instructions_before("jit", "instructions.before",
+                                      "Number of IR instructions before optimization");
+static Statistic instructions_after("jit", "instructions.after",
+                                    "Number of IR instructions after optimization");
+static Statistic modules_compiled("jit", "modules", "Number of modules compiled");
+static Statistic cache_hits("jit", "cache_hits",
+                            "Number of modules loaded from the cache");
+static Statistic remote_calls("jit", "remote_calls",
+                              "Number of pluhs called in the executor process");
+
+// Where metered code on this thread jumps back to when it runs out of fuel.
+static thread_local std::jmp_buf* fuel_trap = nullptr;
+
+// Called by metered code that ran out of fuel (as `slang.out_of_fuel`).
+static void out_of_fuel() {
+    std::longjmp(*fuel_trap, 1);
+}
+
+/**
+ * @brief Ignores SIGPIPE for as long as it lives, so writing to the pipe of a crashed
+ * executor fails with EPIPE instead of killing the compiler.
+ *
+ * The disposition of a signal is process wide, so it's shared by every session with an
+ * executor: the first one saves the disposition, and the last one restores it.
+ */
+class IgnoredSigpipe {
+  private:
+    static inline std::mutex mutex = {};     // Guards holders and saved.
+    static inline int holders = 0;           // Number of IgnoredSigpipe alive.
+    static inline struct sigaction saved {}; // Disposition before the first one.
+  public:
+    IgnoredSigpipe() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (holders++ == 0) {
+            struct sigaction ignore {};
+            ignore.sa_handler = SIG_IGN;
+            sigemptyset(&ignore.sa_mask);
+            sigaction(SIGPIPE, &ignore, &saved);
+        }
+    }
+    ~IgnoredSigpipe() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--holders == 0) {
+            sigaction(SIGPIPE, &saved, nullptr);
+        }
+    }
+};
+
+/**
+ * @brief Compiles modules for the JIT, optimizing them first.
+ *
+ * The cache is consulted before optimizing, so a snapshot hit skips both the
+ * optimization pipeline and code generation. A TargetMachine can only compile one
+ * module at a time, so compiling on a scheduler every module gets its own.
+ */
+class OptimizingCompiler : public llvm::orc::IRCompileLayer::IRCompiler {
+  private:
+    llvm::orc::JITTargetMachineBuilder target_builder; // Creates machines to compile for.
+    std::unique_ptr<llvm::TargetMachine> target_machine; // Shared, if single threaded.
+    llvm::ObjectCache* cache; // Optional cache of compiled objects.
+    unsigned opt_level;       // Optimization level (0 to 3).
+  public:
+    OptimizingCompiler(llvm::orc::JITTargetMachineBuilder target_builder,
+                       std::unique_ptr<llvm::TargetMachine> target_machine,
+                       llvm::ObjectCache* cache, unsigned opt_level)
+        : IRCompiler(
+              llvm::orc::irManglingOptionsFromTargetOptions(target_builder.getOptions())),
+          target_builder(std::move(target_builder)),
+          target_machine(std::move(target_machine)),
+          cache(cache),
+          opt_level(opt_level) {}
+
+    llvm::Expected<std::unique_ptr<llvm::MemoryBuffer>>
+    operator()(llvm::Module& module) override {
+        if (cache) {
+            if (auto object = cache->getObject(&module)) {
+                ++cache_hits;
+                return object;
+            }
+        }
+        std::unique_ptr<llvm::TargetMachine> own_machine = nullptr;
+        llvm::TargetMachine* machine = target_machine.get();
+        if (!machine) {
+            auto created = target_builder.createTargetMachine();
+            if (!created) {
+                return created.takeError();
+            }
+            own_machine = std::move(*created);
+            machine = own_machine.get();
+        }
+        ++modules_compiled;
+        instructions_before += module.getInstructionCount();
+        if (opt_level > 0) {
+            Jit::optimize(module, machine, opt_level);
+        }
+        instructions_after += module.getInstructionCount();
+        auto object = llvm::orc::SimpleCompiler(*machine)(module);
+        if (object && cache) {
+            cache->notifyObjectCompiled(&module, (*object)->getMemBufferRef());
+        }
+        return object;
+    }
+};
+
+void Jit::optimize(llvm::Module& module, llvm::TargetMachine* machine,
+                   unsigned opt_level) {
+    llvm::LoopAnalysisManager loop_analyses;
+    llvm::FunctionAnalysisManager function_analyses;
+    llvm::CGSCCAnalysisManager cgscc_analyses;
+    llvm::ModuleAnalysisManager module_analyses;
+    // Count the passes that changed something, skipping the managers, adaptors and
+    // wrappers that only run other passes.
+    llvm::PassInstrumentationCallbacks callbacks;
+    if (Statistic::is_enabled()) {
+        callbacks.registerAfterPassCallback([](llvm::StringRef pass, llvm::Any,
+                                               const llvm::PreservedAnalyses& kept) {
+            const char* wrappers[] = {"PassManager", "PassAdaptor", "Invalidate",
+                                      "RepeatedPass", "WrapperPass"};
+            if (kept.areAllPreserved() ||
+                std::any_of(std::begin(wrappers), std::end(wrappers),
+                            [&pass](const char* wrapper) {
+                                return pass.contains(wrapper);
+                            })) {
+                return;
+            }
+            ++Statistic::get("passes", pass.str(),
+                             "Number of times " + pass.str() + " changed the IR");
+        });
+    }
+    llvm::PassBuilder pass_builder(machine, llvm::PipelineTuningOptions(), llvm::None,
+                                   &callbacks);
+    pass_builder.registerModuleAnalyses(module_analyses);
+    pass_builder.registerCGSCCAnalyses(cgscc_analyses);
+    pass_builder.registerFunctionAnalyses(function_analyses);
+    pass_builder.registerLoopAnalyses(loop_analyses);
+    pass_builder.crossRegisterProxies(loop_analyses, function_analyses,
+                                      cgscc_analyses, module_analyses);
+
+    const llvm::OptimizationLevel levels[] = {
+        llvm::OptimizationLevel::O0, llvm::OptimizationLevel::O1,
+        llvm::OptimizationLevel::O2, llvm::OptimizationLevel::O3};
+    llvm::ModulePassManager passes =
+        pass_builder.buildPerModuleDefaultPipeline(levels[opt_level]);
+    passes.run(module, module_analyses);
+}
+
+// Creates a pipe whose ends are closed on exec, atomically where pipe2 is available.
+static int cloexec_pipe(int fds[2]) {
+#if defined(__linux__)
+    return pipe2(fds, O_CLOEXEC);
+#else
+    if (pipe(fds) != 0) {
+        return -1;
+    }
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return 0;
+#endif
+}
+
+std::unique_ptr<llvm::orc::ExecutorProcessControl> Jit::start_executor(
+    const std::string& path) {
+    // The host's ends are closed on exec, the executor's ends are kept open for it.
+    int to_executor[2];
+    int from_executor[2];
+    if (cloexec_pipe(to_executor) != 0) {
+        throw jit_error(std::string("Could not create pipes: ") + std::strerror(errno));
+    }
+    if (cloexec_pipe(from_executor) != 0) {
+        int error = errno;
+        close(to_executor[0]);
+        close(to_executor[1]);
+        throw jit_error(std::string("Could not create pipes: ") + std::strerror(error));
+    }
+    executor = fork();
+    if (executor < 0) {
+        int error = errno;
+        close(to_executor[0]);
+        close(to_executor[1]);
+        close(from_executor[0]);
+        close(from_executor[1]);
+        throw jit_error(std::string("Could not start the executor: ") +
+                        std::strerror(error));
+    }
+    if (executor == 0) {
+        fcntl(to_executor[0], F_SETFD, 0);
+        fcntl(from_executor[1], F_SETFD, 0);
+        std::string in_fd = std::to_string(to_executor[0]);
+        std::string out_fd = std::to_string(from_executor[1]);
+        execl(path.c_str(), path.c_str(), in_fd.c_str(), out_fd.c_str(), nullptr);
+        _exit(127);
+    }
+    close(to_executor[0]);
+    close(from_executor[1]);
+
+    // The transport owns the host's ends from here on, and closes them on disconnecting.
+    ignored_sigpipe = std::make_unique<IgnoredSigpipe>();
+    using llvm::orc::SimpleRemoteEPC;
+    auto control = SimpleRemoteEPC::Create<llvm::orc::FDSimpleRemoteEPCTransport>(
+        std::make_unique<llvm::orc::DynamicThreadPoolTaskDispatcher>(),
+        SimpleRemoteEPC::Setup(), from_executor[0], to_executor[1]);
+    if (!control) {
+        std::string error = toString(control.takeError());
+        throw jit_error("Could not start the executor " + path + " (" + reap_executor() +
+                        "): " + error);
+    }
+    debug << "[DEBUG] Executor " << path << " started as process " << executor
+          << std::endl;
+    return std::move(*control);
+}
+
+std::string Jit::reap_executor() {
+    if (executor <= 0) {
+        return executor_exit;
+    }
+    // A crashed executor is gone by the time its pipes close, give one that isn't a
+    // moment before killing it.
+    int status = 0;
+    pid_t reaped = 0;
+    for (int tries = 0; tries < 100 && reaped == 0; ++tries) {
+        reaped = waitpid(executor, &status, WNOHANG);
+        if (reaped == 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    if (reaped == 0) {
+        kill(executor, SIGKILL);
+        reaped = waitpid(executor, &status, 0);
+    }
+    executor = 0;
+    if (reaped < 0) {
+        executor_exit = "lost";
+    } else if (WIFSIGNALED(status)) {
+        executor_exit = "killed by signal " + std::to_string(WTERMSIG(status)) + " (" +
+                        strsignal(WTERMSIG(status)) + ")";
+    } else {
+        executor_exit = "exited with status " + std::to_string(WEXITSTATUS(status));
+    }
+    return executor_exit;
+}
+
+Jit::Jit(llvm::ObjectCache* cache, unsigned opt_level, Scheduler* scheduler,
+         const std::string& executor_path)
+    : fuel(0),
+      scheduler(scheduler),
+      compiles_mutex(),
+      compiles(),
+      executor(-1),
+      executor_exit("") {
+    if (opt_level > 3) {
+        throw jit_error("Invalid optimization level: " + std::to_string(opt_level));
+    }
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+
+    auto target_builder = llvm::orc::JITTargetMachineBuilder::detectHost();
+    if (!target_builder) {
+        throw jit_error("Could not detect the host: " +
+                        toString(target_builder.takeError()));
+    }
+    const llvm::CodeGenOpt::Level codegen_levels[] = {
+        llvm::CodeGenOpt::None, llvm::CodeGenOpt::Less, llvm::CodeGenOpt::Default,
+        llvm::CodeGenOpt::Aggressive};
+    target_builder->setCodeGenOptLevel(codegen_levels[opt_level]);
+
+    // Without a machine of its own, the compiler creates one per module, so it can
+    // compile on any number of threads at once.
+    eager_compiler = std::make_unique<OptimizingCompiler>(*target_builder, nullptr, cache,
+                                                          opt_level);
+
+    llvm::orc::LLJITBuilder builder;
+    builder.setJITTargetMachineBuilder(std::move(*target_builder));
+    if (!executor_path.empty()) {
+        // Code is linked by JITLink into memory the executor allocates, and its unwind
+        // info is registered there.
+        builder.setExecutorProcessControl(start_executor(executor_path));
+        builder.setObjectLinkingLayerCreator(
+            [](llvm::orc::ExecutionSession& session, const llvm::Triple&)
+                -> llvm::Expected<std::unique_ptr<llvm::orc::ObjectLayer>> {
+                auto layer = std::make_unique<llvm::orc::ObjectLinkingLayer>(
+                    session, session.getExecutorProcessControl().getMemMgr());
+                auto registrar = llvm::orc::EPCEHFrameRegistrar::Create(session);
+                if (!registrar) {
+                    return registrar.takeError();
+                }
+                layer->addPlugin(std::make_unique<llvm::orc::EHFrameRegistrationPlugin>(
+                    session, std::move(*registrar)));
+                return layer;
+            });
+    }
+    builder.setCompileFunctionCreator(
+        [cache, opt_level, scheduler](llvm::orc::JITTargetMachineBuilder target_builder)
+            -> llvm::Expected<std::unique_ptr<llvm::orc::IRCompileLayer::IRCompiler>> {
+            std::unique_ptr<llvm::TargetMachine> target_machine = nullptr;
+            if (!scheduler) {
+                auto created = target_builder.createTargetMachine();
+                if (!created) {
+                    return created.takeError();
+                }
+                target_machine = std::move(*created);
+            }
+            return std::make_unique<OptimizingCompiler>(
+                std::move(target_builder), std::move(target_machine), cache, opt_level);
+        });
+    auto created = builder.create();
+    if (!created) {
+        throw jit_error("Could not create the JIT: " + toString(created.takeError()));
+    }
+    jit = std::move(*created);
+
+    // Materializing a module (compiling and linking it) is a task of the session, run
+    // on the looking up thread unless dispatched elsewhere.
+    if (scheduler) {
+        jit->getExecutionSession().setDispatchTask(
+            [this](std::unique_ptr<llvm::orc::Task> task) {
+                std::shared_ptr<llvm::orc::Task> shared = std::move(task);
+                auto compile = this->scheduler->submit([shared]() { shared->run(); });
+                std::lock_guard<std::mutex> lock(compiles_mutex);
+                std::erase_if(compiles, [](auto& done) { return done->is_done(); });
+                compiles.push_back(std::move(compile));
+            });
+    }
+
+    // Let JIT'd code call into the process it runs in (eg. printf for yap, or plugs).
+    if (is_out_of_process()) {
+        // Losing the executor is reported by run, the session only needs to log it.
+        jit->getExecutionSession().setErrorReporter([](llvm::Error error) {
+            debug << "[DEBUG] Executor: " << toString(std::move(error)) << std::endl;
+        });
+        auto generator = llvm::orc::EPCDynamicLibrarySearchGenerator::GetForTargetProcess(
+            jit->getExecutionSession());
+        if (!generator) {
+            throw jit_error("Could not search the executor for symbols: " +
+                            toString(generator.takeError()));
+        }
+        jit->getMainJITDylib().addGenerator(std::move(*generator));
+        debug << "[DEBUG] JIT initialized for " << jit->getTargetTriple().str()
+              << ", running code out of process" << std::endl;
+        return;
+    }
+    auto generator = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(
+        jit->getDataLayout().getGlobalPrefix());
+    if (!generator) {
+        throw jit_error("Could not search the process for symbols: " +
+                        toString(generator.takeError()));
+    }
+    jit->getMainJITDylib().addGenerator(std::move(*generator));
+
+    auto stubs_builder = llvm::orc::createLocalIndirectStubsManagerBuilder(
+        jit->getTargetTriple());
+    if (!stubs_builder) {
+        throw jit_error("Indirection stubs aren't supported on " +
+                        jit->getTargetTriple().str());
+    }
+    stubs = stubs_builder();
+
+    define_symbol("slang.fuel", reinterpret_cast<uint64_t>(&fuel));
+    define_symbol("slang.out_of_fuel", reinterpret_cast<uint64_t>(&out_of_fuel));
+    debug << "[DEBUG] JIT initialized for " << jit->getTargetTriple().str() << std::endl;
+}
+
+void Jit::add_module(std::unique_ptr<llvm::LLVMContext> context,
+                     std::unique_ptr<llvm::Module> module) {
+    module->setDataLayout(jit->getDataLayout());
+    if (llvm::Error error = jit->addIRModule(
+            llvm::orc::ThreadSafeModule(std::move(module), std::move(context)))) {
+        throw jit_error("Could not add module: " + toString(std::move(error)));
+    }
+}
+
+void Jit::add_object(std::unique_ptr<llvm::MemoryBuffer> object) {
+    if (llvm::Error error = jit->addObjectFile(std::move(object))) {
+        throw jit_error("Could not add object: " + toString(std::move(error)));
+    }
+}
+
+void Jit::compile_module(std::unique_ptr<llvm::LLVMContext> context,
+                         std::unique_ptr<llvm::Module> module) {
+    // Owns both, so the module goes before its context however this returns.
+    llvm::orc::ThreadSafeModule owned(std::move(module), std::move(context));
+    llvm::Module& ir = *owned.getModuleUnlocked();
+    ir.setDataLayout(jit->getDataLayout());
+    // Adding an object that redefines a symbol crashes LLVM 14 rather than failing, so
+    // clashes are looked for first. Looking up flags doesn't materialize anything.
+    llvm::orc::SymbolLookupSet defined = {};
+    for (const llvm::GlobalValue& value : ir.global_values()) {
+        if (!value.isDeclaration() && !value.hasLocalLinkage()) {
+            defined.add(jit->mangleAndIntern(value.getName()),
+                        llvm::orc::SymbolLookupFlags::WeaklyReferencedSymbol);
+        }
+    }
+    auto clashes = jit->getExecutionSession().lookupFlags(
+        llvm::orc::LookupKind::Static,
+        {{&jit->getMainJITDylib(), llvm::orc::JITDylibLookupFlags::MatchAllSymbols}},
+        std::move(defined));
+    if (!clashes) {
+        throw jit_error("Could not add module: " + toString(clashes.takeError()));
+    }
+    if (!clashes->empty()) {
+        throw jit_error("Could not add module: Duplicate definition of symbol '" +
+                        (*clashes->begin()->first).str() + "'");
+    }
+    auto object = (*eager_compiler)(ir);
+    if (!object) {
+        throw jit_error("Could not compile module: " + toString(object.takeError()));
+    }
+    if (llvm::Error error = jit->addObjectFile(std::move(*object))) {
+        throw jit_error("Could not add module: " + toString(std::move(error)));
+    }
+}
+
+uint64_t Jit::lookup(const std::string& symbol) {
+    auto address = jit->lookup(symbol);
+    if (!address) {
+        throw jit_error("Could not find " + symbol + ": " +
+                        toString(address.takeError()));
+    }
+    return address->getAddress();
+}
+
+std::vector<uint64_t> Jit::lookup_all(const std::vector<std::string>& symbols) {
+    // One lookup for every symbol, so the session can compile all the modules involved
+    // at once instead of one after another.
+    llvm::orc::SymbolLookupSet lookup_set;
+    std::vector<llvm::orc::SymbolStringPtr> names = {};
+    for (const auto& symbol : symbols) {
+        names.push_back(jit->mangleAndIntern(symbol));
+        lookup_set.add(names.back());
+    }
+    auto found = jit->getExecutionSession().lookup(
+        llvm::orc::makeJITDylibSearchOrder(&jit->getMainJITDylib()),
+        std::move(lookup_set));
+    if (!found) {
+        throw jit_error("Could not find symbols: " + toString(found.takeError()));
+    }
+    std::vector<uint64_t> addresses = {};
+    for (const auto& name : names) {
+        addresses.push_back((*found)[name].getAddress());
+    }
+    return addresses;
+}
+
+void Jit::define_symbol(const std::string& symbol, uint64_t address) {
+    if (llvm::Error error = jit->getMainJITDylib().define(llvm::orc::absoluteSymbols(
+            {{jit->mangleAndIntern(symbol),
+              llvm::JITEvaluatedSymbol(address, llvm::JITSymbolFlags::Exported)}}))) {
+        throw jit_error("Could not define " + symbol + ": " + toString(std::move(error)));
+    }
+}
+
+void Jit::define_stub(const std::string& symbol, uint64_t address) {
+    if (!stubs) {
+        throw jit_error("Could not create stub " + symbol +
+                        ": Stubs need the code in this process");
+    }
+    if (llvm::Error error =
+            stubs->createStub(symbol, address, llvm::JITSymbolFlags::Exported)) {
+        throw jit_error("Could not create stub " + symbol + ": " +
+                        toString(std::move(error)));
+    }
+    llvm::JITEvaluatedSymbol stub = stubs->findStub(symbol, true);
+    if (llvm::Error error = jit->getMainJITDylib().define(
+            llvm::orc::absoluteSymbols({{jit->mangleAndIntern(symbol), stub}}))) {
+        throw jit_error("Could not define stub " + symbol + ": " +
+                        toString(std::move(error)));
+    }
+}
+
+void Jit::update_stub(const std::string& symbol, uint64_t address) {
+    // A single pointer-sized store, so a concurrent call sees either the old code or
+    // the new one.
+    if (!stubs) {
+        throw jit_error("Could not update stub " + symbol +
+                        ": Stubs need the code in this process");
+    }
+    if (llvm::Error error = stubs->updatePointer(symbol, address)) {
+        throw jit_error("Could not update stub " + symbol + ": " +
+                        toString(std::move(error)));
+    }
+}
+
+int Jit::run(uint64_t address) {
+    if (!is_out_of_process()) {
+        return reinterpret_cast<int (*)()>(address)();
+    }
+    if (executor == 0) {
+        throw executor_error("The executor is gone (" + executor_exit + ")");
+    }
+    // Called like a main without arguments, which a pluh without parameters ignores.
+    ++remote_calls;
+    auto result = jit->getExecutionSession().getExecutorProcessControl().runAsMain(
+        llvm::orc::ExecutorAddr(address), {});
+    if (!result) {
+        llvm::consumeError(result.takeError());
+        throw executor_error("The executor crashed (" + reap_executor() + ")");
+    }
+    return *result;
+}
+
+void Jit::add_listener(llvm::JITEventListener& listener) {
+    // In process, objects are linked by RuntimeDyld.
+    auto* layer =
+        llvm::dyn_cast<llvm::orc::RTDyldObjectLinkingLayer>(&jit->getObjLinkingLayer());
+    if (!layer) {
+        throw jit_error("Listeners need the code in this process");
+    }
+    layer->registerJITEventListener(listener);
+}
+
+bool Jit::is_out_of_process() const {
+    return executor != -1;
+}
+
+int Jit::run_with_fuel(uint64_t address, int64_t& fuel) {
+    if (is_out_of_process()) {
+        throw jit_error("Fuel metering needs the code in this process");
+    }
+    auto pluh = reinterpret_cast<int (*)()>(address);
+    std::jmp_buf trap;
+    std::jmp_buf* outer_trap = fuel_trap;
+    fuel_trap = &trap;
+    this->fuel = fuel;
+    // Nothing with a destructor may be created between here and the call, since
+    // running out of fuel longjmps straight back over it.
+    if (setjmp(trap) != 0) {
+        fuel_trap = outer_trap;
+        fuel = 0;
+        throw out_of_fuel_error("Ran out of fuel");
+    }
+    int result = pluh();
+    fuel_trap = outer_trap;
+    fuel = this->fuel;
+    return result;
+}
+
+Jit::~Jit() {
+    // Compiles may dispatch more compiles, so wait until there are none left.
+    while (true) {
+        std::vector<std::shared_ptr<Task>> pending = {};
+        {
+            std::lock_guard<std::mutex> lock(compiles_mutex);
+            pending.swap(compiles);
+        }
+        if (pending.empty()) {
+            break;
+        }
+        for (auto& compile : pending) {
+            try {
+                scheduler->wait(compile);
+            } catch (const std::exception&) {
+                // Errors were reported to whoever looked the module up.
+            }
+        }
+    }
+    // Ending the session closes the pipes, which the executor exits on.
+    if (is_out_of_process()) {
+        jit = nullptr;
+        reap_executor();
+    }
+}
@@ -1,16 +1,129 @@
 #include "lexer.hpp"
+#include "stats.hpp"
+#include "unicode.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <iterator>
+#include <unistd.h>
+
+// Tokens lexed of each kind, indexed by TokenType.
+static Statistic tokens_lexed[] = {
+    {"lexer", "tokens.int", "Number of int literal tokens lexed"},
+    {"lexer", "tokens.float", "Number of float literal tokens lexed"},
+    {"lexer", "tokens.bool", "Number of bool literal tokens lexed"},
+    {"lexer", "tokens.char", "Number of char literal tokens lexed"},
+    {"lexer", "tokens.string", "Number of string literal tokens lexed"},
+    {"lexer", "tokens.def", "Number of pluh tokens lexed"},
+    {"lexer", "tokens.extern", "Number of plug tokens lexed"},
+    {"lexer", "tokens.operator", "Number of operator tokens lexed"},
+    {"lexer", "tokens.program", "Number of spillingTeaAbout tokens lexed"},
+    {"lexer", "tokens.let", "Number of cookUp tokens lexed"},
+    {"lexer", "tokens.identifier", "Number of identifier tokens lexed"},
+    {"lexer", "tokens.if", "Number of fr? and ong? tokens lexed"},
+    {"lexer", "tokens.else", "Number of justLikeThat? tokens lexed"},
+    {"lexer", "tokens.while", "Number of holdUp tokens lexed"},
+    {"lexer", "tokens.break", "Number of ghost tokens lexed"},
+    {"lexer", "tokens.continue", "Number of rizz tokens lexed"},
+    {"lexer", "tokens.return", "Number of yeet tokens lexed"},
+    {"lexer", "tokens.end_of_file", "Number of end of file tokens lexed"},
+    {"lexer", "tokens.exit", "Number of exit tokens lexed"},
+    {"lexer", "tokens.complex", "Number of punctuation tokens lexed"}};
+
+static Statistic chunks_read("lexer", "chunks", "Number of chunks of input read");
 
 /**
  * Constructor for Lexer class
  */
-Lexer::Lexer(const std::string& code)
+Lexer::Lexer(std::string code)
     : code(std::move(code)),
       current_char(' '),
+      else_if_enabled(false),
       it(this->code.begin()),
-      else_if_enabled(false) {
+      line(1),
+      line_counted(this->code.begin()),
+      fd(-1),
+      source(),
+      chunk_size(0),
+      exhausted(true) {
     debug << "[DEBUG] Lexer initialized." << std::endl;
 }
 
+/**
+ * Constructor for Lexer class reading from a file descriptor
+ */
+Lexer::Lexer(int fd, size_t chunk_size)
+    : code(),
+      current_char(' '),
+      else_if_enabled(false),
+      it(code.begin()),
+      line(1),
+      line_counted(code.begin()),
+      fd(fd),
+      source(),
+      chunk_size(std::max<size_t>(chunk_size, 1)),
+      exhausted(false) {
+    debug << "[DEBUG] Lexer initialized, reading from fd " << fd << "." << std::endl;
+}
+
+/**
+ * Constructor for Lexer class copying from code it doesn't own
+ */
+Lexer::Lexer(std::string_view code, size_t chunk_size)
+    : code(),
+      current_char(' '),
+      else_if_enabled(false),
+      it(this->code.begin()),
+      line(1),
+      line_counted(this->code.begin()),
+      fd(-1),
+      source(code),
+      chunk_size(std::max<size_t>(chunk_size, 1)),
+      exhausted(false) {
+    debug << "[DEBUG] Lexer initialized, over " << code.size() << " bytes." << std::endl;
+}
+
+int Lexer::next_char() {
+    if (it == code.end() && !exhausted) {
+        refill(1);
+    }
+    // Read unsigned, so bytes of non-ASCII characters can be classified with <cctype>.
+    return static_cast<unsigned char>(*(it++));
+}
+
+void Lexer::refill(size_t ahead) {
+    // Only the current character (read from just before it, eg. the start of a number
+    // literal) is still needed of what was lexed, but the lines in the rest are counted.
+    std::string::iterator keep = it == code.begin() ? it : it - 1;
+    if (keep > line_counted) {
+        line += std::count(line_counted, keep, '\n');
+    }
+    size_t offset = it - keep;
+    code.erase(code.begin(), keep);
+    // A pipe may return less than a chunk at a time.
+    while (code.size() < offset + ahead && !exhausted) {
+        size_t size = code.size();
+        code.resize(size + chunk_size);
+        ssize_t bytes = 0;
+        if (fd < 0) {
+            bytes = source.copy(code.data() + size, chunk_size);
+            source.remove_prefix(bytes);
+        } else {
+            bytes = read(fd, code.data() + size, chunk_size);
+        }
+        code.resize(size + std::max<ssize_t>(bytes, 0));
+        if (bytes < 0 && errno != EINTR) {
+            throw process_file_error(std::string("Error reading input: ") +
+                                     std::strerror(errno));
+        }
+        exhausted = bytes == 0;
+        ++chunks_read;
+    }
+    it = code.begin() + offset;
+    line_counted = code.begin();
+}
+
 /**
  * @brief Checks if the given character is an operator.
  *
@@ -29,8 +142,8 @@ bool is_operator(const int& op) {
  * @brief Checks if the next character is valid for the current operator.
  *
  * This function checks if the next character is valid to follow the provided
- * operator. For example, '<' can be followed by '=' or '\0', but '*' can only
- * be followed by '\0'.
+ * operator. For example, '<' can be followed by '=', but '*' can't be followed by
+ * anything. The end of the input ('\0') never continues an operator.
  *
  * @param op The current operator.
  * @param next_char The next character to be checked.
@@ -43,14 +156,7 @@ bool is_valid_next_char(char op, char next_char) {
     case '>':
     case '=':
     case '!':
-        return next_char == '\0' || next_char == '=';
-    case '+':
-    case '-':
-    case '*':
-    case '/':
-    case '%':
-    case '^':
-        return next_char == '\0';
+        return next_char == '=';
     default:
         return false;
     }
@@ -67,168 +173,350 @@ bool is_valid_next_char(char op, char next_char) {
  * @return true if the provided string is a keyword, false otherwise.
  */
 bool Lexer::is_keyword(const std::string& keyword) {
+    // Match ahead on a copy of the iterator, so a partial match (eg. an identifier
+    // starting with "Ca") doesn't skip any of the input.
+    if (!exhausted && static_cast<size_t>(code.end() - it) < keyword.size()) {
+        refill(keyword.size());
+    }
     int tmp = this->current_char;
+    std::string::iterator next = it;
     for (const auto& ch : keyword) {
         if ((tmp != ch) || (tmp == '\0') || (tmp == '\n') || (tmp == '\r')) {
             return false;
         }
-        tmp = *(it++);
+        tmp = *(next++);
     }
     current_char = tmp;
+    it = next;
     return true;
 }
 
 Token Lexer::get_token() {
-    try {
-        // Skip any whitespace characters (like spaces, tabs, newline) to find
-        // the start of the next token.
+    Token token = lex_token();
+    ++tokens_lexed[static_cast<int>(token.first)];
+    return token;
+}
+
+int Lexer::get_line() {
+    // current_char was read from just before it, and isn't part of any token yet.
+    std::string::iterator end = std::min(it == code.begin() ? it : it - 1, code.end());
+    if (end > line_counted) {
+        line += std::count(line_counted, end, '\n');
+        line_counted = end;
+    }
+    return line;
+}
+
+size_t Lexer::decode(std::ptrdiff_t offset, char32_t& code_point) {
+    if (!exhausted && code.end() - it < offset + 4) {
+        refill(offset + 4);
+    }
+    return decode_utf8(&*(it + offset), code.data() + code.size(), code_point);
+}
+
+std::string Lexer::lex_identifier() {
+    // current_char was read from just before it, and starts the identifier. Runs of
+    // ASCII are skipped a vector at a time, and only other characters are decoded.
+    std::string identifier = "";
+    --it;
+    while (true) {
+        const char* run = code.data() + (it - code.begin());
+        const char* end = skip_identifier_ascii(run, code.data() + code.size());
+        identifier.append(run, end);
+        it += end - run;
+        if (it == code.end()) {
+            if (exhausted) {
+                break;
+            }
+            refill(1);
+            continue;
+        }
+        if (static_cast<unsigned char>(*it) < 0x80) {
+            break;
+        }
+        char32_t code_point = 0;
+        size_t length = decode(0, code_point);
+        if (length == 0) {
+            throw invalid_literal_error("Invalid UTF-8 in identifier: " + identifier);
+        }
+        if (!is_xid_continue(code_point)) {
+            break;
+        }
+        identifier.append(it, it + length);
+        it += length;
+    }
+    current_char = next_char();
+    return identifier;
+}
+
+std::string Lexer::lex_string() {
+    // it is just past the opening quote. Runs of ASCII are copied a vector at a time,
+    // and only other characters are decoded, to be validated.
+    std::string str_val = "";
+    while (true) {
+        const char* run = code.data() + (it - code.begin());
+        const char* end = skip_string_ascii(run, code.data() + code.size());
+        str_val.append(run, end);
+        it += end - run;
+        if (it == code.end() && !exhausted) {
+            refill(1);
+            continue;
+        }
+        if (it == code.end() || *it == '\0') {
+            throw invalid_literal_error("Invalid string token: " + str_val);
+        }
+        if (*it == '"') {
+            break;
+        }
+        char32_t code_point = 0;
+        size_t length = decode(0, code_point);
+        if (length == 0) {
+            throw invalid_literal_error("Invalid UTF-8 in string: " + str_val);
+        }
+        str_val.append(it, it + length);
+        it += length;
+    }
+    ++it;
+    current_char = next_char();
+    return str_val;
+}
+
+Token Lexer::lex_number() {
+    // A literal can't run straight into a name or another point (eg. 12abc or 1.2.3).
+    auto continues = [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '.';
+    };
+    // The literal is scanned in place, so all of it has to be in the buffer: the input is
+    // read up to the first character that can't be part of it.
+    for (size_t scanned = 0; !exhausted;) {
+        std::string::iterator p = it + scanned;
+        while (p != code.end() &&
+               (continues(*p) || ((*p == '+' || *p == '-') &&
+                                  (p[-1] == 'e' || p[-1] == 'E')))) {
+            ++p;
+        }
+        if (p != code.end()) {
+            break;
+        }
+        scanned = p - it;
+        refill(scanned + 1);
+    }
+
+    // current_char was read from just before it, and starts the literal. The literal is
+    // scanned in place, then converted in one go.
+    const char* start = &*(it - 1);
+    const char* end = code.data() + code.size();
+    const char* p = start;
+    int base = 10;
+    if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X' || p[1] == 'b' || p[1] == 'B')) {
+        base = (p[1] == 'x' || p[1] == 'X') ? 16 : 2;
+        p += 2;
+    }
+    auto is_digit = [base](char c) {
+        return base == 16 ? std::isxdigit(static_cast<unsigned char>(c)) != 0
+               : base == 2 ? c == '0' || c == '1'
+                           : c >= '0' && c <= '9';
+    };
+    // Scans a run of digits, where an underscore may separate two digits. Returns
+    // whether there were any.
+    bool separated = false;
+    auto scan_digits = [&]() {
+        const char* run = p;
+        while (p < end && (is_digit(*p) || (*p == '_' && p > run && p + 1 < end &&
+                                            is_digit(p[1])))) {
+            separated |= *p == '_';
+            ++p;
+        }
+        return p > run;
+    };
+
+    bool is_float = false;
+    bool valid = scan_digits();
+    if (base == 10) {
+        if (p < end && *p == '.') {
+            is_float = true;
+            ++p;
+            valid = scan_digits() || valid;
+        }
+        if (valid && p < end && (*p == 'e' || *p == 'E')) {
+            const char* exponent = p++;
+            if (p < end && (*p == '+' || *p == '-')) {
+                ++p;
+            }
+            if (!scan_digits()) {
+                p = exponent;
+                valid = false;
+            }
+            is_float = true;
+        }
+    }
+    const char* digits_end = p;
+    if (valid && base == 10 && p < end && (*p == 'f' || *p == 'F')) {
+        is_float = true;
+        ++p;
+    }
+    if (p < end && continues(*p)) {
+        valid = false;
+        while (p < end && continues(*p)) {
+            ++p;
+        }
+    }
+    std::string spelling(start, p);
+    it = code.begin() + (p - code.data());
+    current_char = next_char();
+    if (!valid) {
+        throw invalid_literal_error("Invalid number literal: " + spelling);
+    }
+
+    // from_chars takes the digits alone, so separators are dropped first (rarely).
+    const char* first = start + (base == 10 ? 0 : 2);
+    std::string digits = "";
+    if (separated) {
+        std::copy_if(first, digits_end, std::back_inserter(digits),
+                     [](char c) { return c != '_'; });
+        first = digits.data();
+        digits_end = digits.data() + digits.size();
+    }
+    Token token(is_float ? TokenType::FLOAT : TokenType::INT, std::move(spelling));
+    std::from_chars_result result = {};
+    if (is_float) {
+        result = std::from_chars(first, digits_end, token.float_value);
+    } else {
+        result = std::from_chars(first, digits_end, token.int_value, base);
+    }
+    if (result.ec == std::errc::result_out_of_range) {
+        throw invalid_literal_error("Number literal out of range: " + token.second);
+    }
+    if (result.ec != std::errc() || result.ptr != digits_end) {
+        throw invalid_literal_error("Invalid number literal: " + token.second);
+    }
+    debug << "[DEBUG] " << (is_float ? "Float: " : "Integer: ") << token.second
+          << std::endl;
+    return token;
+}
+
+Token Lexer::lex_token() {
+    // Skip any whitespace characters (like spaces, tabs, newline) and comments to find
+    // the start of the next token. This loops rather than recursing after every
+    // comment, so a run of comments can't overflow the stack.
+    while (true) {
         while (std::isspace(current_char)) {
-            current_char = *(it++);
+            current_char = next_char();
         }
 
         // If the current token starts with "Cancelled", it's a single-line
         // comment. Skip the entire line.
         if (is_keyword("Cancelled")) {
             debug << "[DEBUG] Comment: Ignoring line." << std::endl;
-            do {
-                current_char = *(it++);
-            } while (current_char != '\0' && current_char != '\n' &&
-                     current_char != '\r');
-            if (current_char != '\0') {
-                return get_token();
+            while (current_char != '\0' && current_char != '\n' && current_char != '\r') {
+                current_char = next_char();
             }
+            continue;
         }
 
         // If the current token starts with "Blocked", it's a multi-line
         // comment. Skip text until "Unblocked" is found.
         if (is_keyword("Blocked")) {
             debug << "[DEBUG] Comment: Ignoring block." << std::endl;
-            do {
-                current_char = *(it++);
-            } while (current_char != '\0' && (!is_keyword("Unblocked")));
-            if (current_char != '\0') {
-                return get_token(); // After skipping, get the next token if not
-                                    // at end of file
+            while (current_char != '\0' && !is_keyword("Unblocked")) {
+                current_char = next_char();
             }
+            continue;
         }
+        break;
+    }
 
-        if (else_if_enabled) {
-            else_if_enabled = false;
-            return {TokenType::IF, "ong?"};
-        }
-
-        // Handle character literals, which are enclosed in single quotes.
-        if (current_char == '\'') {
-            current_char = *(it++);
-            debug << "[DEBUG] Char: " << std::string(1, current_char) << std::endl;
-            char char_value = current_char;
-            if (*(it++) != '\'') {
-                throw invalid_literal_error("Invalid char token: " +
-                                            std::string(1, current_char));
-            }
-            current_char = *((it++)++);
-            debug << "[DEBUG] Char: " << char_value << std::endl;
-            std::string tmp_str(1, char_value);
-            return {TokenType::CHAR, tmp_str};
-            // Handle string literals, which are enclosed in double quotes.
-        } else if (current_char == '\"') {
-            std::string str_val = "";
-            current_char = *(it++);
-            while (current_char != '\"') {
-                if (current_char == '\0') {
-                    throw invalid_literal_error("Invalid string token: " + str_val);
-                }
-                str_val += current_char;
-                current_char = *(it++);
-            }
-            current_char = *(it++);
-            debug << "[DEBUG] String: " << str_val << std::endl;
-            return {TokenType::STRING, str_val};
-        }
-
-        // Handle numeric literals, both integer and floating-point.
-        if (std::isdigit(current_char) || current_char == '.') {
-            std::string num_str;
-            bool decimal_found = false; // Flag for only allowing 1 decimal point
-            do {
-                if (current_char == '\0') {
-                    throw invalid_literal_error("Invalid number token: " + num_str);
-                }
-                if (current_char == '.') {
-                    if (decimal_found) { // Ensure there's only one decimal
-                                         // point.
-                        throw invalid_literal_error(
-                            "More than one decimal point in number: " + num_str);
-                    }
-                    decimal_found = true;
-                }
-                num_str += current_char;
-                current_char = *(it++);
-            } while (std::isdigit(current_char) || current_char == '.');
-
-            // Determine if the number is a float or an integer.
-            if (decimal_found) {
-                debug << "[DEBUG] Float: " << num_str << std::endl;
-                return {TokenType::FLOAT, num_str};
-            }
-            debug << "[DEBUG] Integer: " << num_str << std::endl;
-            return {TokenType::INT, num_str};
-        }
-
-        // Handle identifiers (eg. keywords + variable names), which start with
-        // an alphabet and may contain alphanumeric characters or underscores.
-        std::string identifier = "";
-        if (std::isalpha(current_char)) {
-            identifier = current_char;
-            while (std::isalnum(current_char = *(it++)) || current_char == '_' ||
-                   current_char == '?') {
-                identifier += current_char;
-            }
-            TokenType kind = TokenType::IDENTIFIER;
-            if (identifier == "ong?") {
-                else_if_enabled = true;
-                return {TokenType::ELSE, "ong?"};
-            }
-            if (table.find(identifier) != table.end()) {
-                kind = table.at(identifier);
-            }
-            debug << "[DEBUG] Identifier: " << identifier << std::endl;
-            return {kind, identifier};
-        }
+    if (else_if_enabled) {
+        else_if_enabled = false;
+        return {TokenType::IF, "ong?"};
+    }
 
-        // Handles End of File
+    // Handle character literals, which are enclosed in single quotes.
+    if (current_char == '\'') {
+        current_char = next_char();
         if (current_char == '\0') {
-            debug << "[DEBUG] End of File." << std::endl;
-            return {TokenType::END_OF_FILE, ""};
+            throw invalid_literal_error("Invalid char token at end of file");
+        }
+        debug << "[DEBUG] Char: " << std::string(1, current_char) << std::endl;
+        char char_value = current_char;
+        if (next_char() != '\'') {
+            throw invalid_literal_error("Invalid char token: " +
+                                        std::string(1, current_char));
         }
+        current_char = next_char();
+        debug << "[DEBUG] Char: " << char_value << std::endl;
+        std::string tmp_str(1, char_value);
+        return {TokenType::CHAR, tmp_str};
+        // Handle string literals, which are enclosed in double quotes.
+    } else if (current_char == '\"') {
+        std::string str_val = lex_string();
+        debug << "[DEBUG] String: " << str_val << std::endl;
+        return {TokenType::STRING, str_val};
+    }
 
-        // Handles Operators
-        std::string op = "";
-        int prev_char = current_char;
-        current_char = *(it++);
+    // Handle numeric literals, both integer and floating-point.
+    if (std::isdigit(current_char) || current_char == '.') {
+        return lex_number();
+    }
 
-        // Check if the previous character is a valid operator
-        if (!is_operator(prev_char)) {
-            std::string s(1, char(prev_char));
-            debug << "[DEBUG] Complex: " << s << std::endl;
-            return {TokenType::COMPLEX, std::string(1, prev_char)};
+    // A non-ASCII character either starts an identifier or is punctuation, which the
+    // parser rejects whole.
+    if (current_char >= 0x80) {
+        char32_t code_point = 0;
+        size_t length = decode(-1, code_point);
+        if (length == 0) {
+            throw invalid_literal_error("Invalid UTF-8 character");
+        }
+        if (!is_xid_start(code_point)) {
+            std::string character(it - 1, it - 1 + length);
+            it += length - 1;
+            current_char = next_char();
+            debug << "[DEBUG] Complex: " << character << std::endl;
+            return {TokenType::COMPLEX, character};
         }
+    }
 
-        op = prev_char;
-        // Build the complete operator token if necessary (eg. '++', '+=', '==',
-        // etc.)
-        while (is_valid_next_char(op.back(), current_char)) {
-            op += current_char;
-            current_char = *(it++);
+    // Handle identifiers (eg. keywords + variable names), which start with a letter (of
+    // any script) and may contain letters, digits, underscores and question marks.
+    if (std::isalpha(current_char) || current_char >= 0x80) {
+        std::string identifier = lex_identifier();
+        TokenType kind = TokenType::IDENTIFIER;
+        if (identifier == "ong?") {
+            else_if_enabled = true;
+            return {TokenType::ELSE, "ong?"};
+        }
+        if (table.find(identifier) != table.end()) {
+            kind = table.at(identifier);
         }
-        debug << "[DEBUG] Operator: " << op << std::endl;
-        return {TokenType::OPERATOR, op};
+        debug << "[DEBUG] Identifier: " << identifier << std::endl;
+        return {kind, identifier};
+    }
+
+    // Handles End of File
+    if (current_char == '\0') {
+        debug << "[DEBUG] End of File." << std::endl;
+        return {TokenType::END_OF_FILE, ""};
+    }
+
+    // Handles Operators
+    std::string op = "";
+    int prev_char = current_char;
+    current_char = next_char();
+
+    // Check if the previous character is a valid operator
+    if (!is_operator(prev_char)) {
+        std::string s(1, char(prev_char));
+        debug << "[DEBUG] Complex: " << s << std::endl;
+        return {TokenType::COMPLEX, std::string(1, prev_char)};
+    }
 
-    } catch (const std::exception& e) {
-        std::cerr << "[ERROR] " << e.what() << std::endl;
-        exit(1);
-    } catch (...) {
-        std::cerr << "[ERROR] Unknown error occurred!" << std::endl;
-        exit(1);
+    op = prev_char;
+    // Build the complete operator token if necessary (eg. '++', '+=', '==',
+    // etc.)
+    while (is_valid_next_char(op.back(), current_char)) {
+        op += current_char;
+        current_char = next_char();
     }
+    debug << "[DEBUG] Operator: " << op << std::endl;
+    return {TokenType::OPERATOR, op};
 }
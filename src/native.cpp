@@ -0,0 +1,173 @@
+#include "native.hpp"
+#include "debug_stream.hpp"
+#include "jit.hpp"
+#include "stats.hpp"
+#include <llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FileUtilities.h>
+#include <llvm/Support/Program.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/raw_ostream.h>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#ifdef SLANG_HAVE_LLD
+#include <lld/Common/CommonLinkerContext.h>
+#include <lld/Common/Driver.h>
+#endif
+
+static Statistic objects_emitted("native", "objects", "Number of object files emitted");
+static Statistic executables_linked("native", "executables",
+                                    "Number of executables linked");
+static Statistic links_in_process("native", "links.in_process",
+                                  "Number of executables linked by lld in process");
+
+// Runs a linker as a process of its own.
+static void run_linker(const std::vector<std::string>& args) {
+    auto linker = llvm::sys::findProgramByName(args.front());
+    if (!linker) {
+        throw native_error("Could not find the linker (" + args.front() +
+                           "): " + linker.getError().message());
+    }
+    std::vector<llvm::StringRef> arg_refs(args.begin(), args.end());
+    std::string message = "";
+    int status = llvm::sys::ExecuteAndWait(*linker, arg_refs, llvm::None, {}, 0, 0,
+                                           &message);
+    if (status != 0) {
+        if (message.empty()) {
+            message = "exited with status " + std::to_string(status);
+        }
+        throw native_error("Linking failed (" + args.front() + ": " + message + ").");
+    }
+}
+
+#ifdef SLANG_HAVE_LLD
+// lld keeps the state of a link in globals, so links take turns.
+static std::mutex lld_mutex;
+
+// Runs lld's ELF driver on the calling thread, as if it were ld.lld.
+static void run_lld(const std::vector<std::string>& args) {
+    std::vector<const char*> argv = {};
+    for (const auto& arg : args) {
+        argv.push_back(arg.c_str());
+    }
+    std::string errors = "";
+    llvm::raw_string_ostream error_stream(errors);
+    std::lock_guard<std::mutex> lock(lld_mutex);
+    bool linked = lld::elf::link(argv, llvm::outs(), error_stream, false, false);
+    // Frees what the link allocated, so the next one starts clean.
+    lld::CommonLinkerContext::destroy();
+    if (!linked) {
+        throw native_error("Linking failed (lld: " + error_stream.str() + ").");
+    }
+    ++links_in_process;
+}
+#endif
+
+NativeCompiler::NativeCompiler(unsigned opt_level, const std::string& runtime_path)
+    : opt_level(opt_level),
+      runtime_path(runtime_path),
+      machine(nullptr),
+      link_seconds(0) {
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+    auto builder = llvm::orc::JITTargetMachineBuilder::detectHost();
+    if (!builder) {
+        throw native_error(toString(builder.takeError()));
+    }
+    // The system's C compiler links position independent executables, the static
+    // runtime doesn't.
+    builder->setRelocationModel(is_static() ? llvm::Reloc::Static : llvm::Reloc::PIC_);
+    const llvm::CodeGenOpt::Level levels[] = {
+        llvm::CodeGenOpt::None, llvm::CodeGenOpt::Less, llvm::CodeGenOpt::Default,
+        llvm::CodeGenOpt::Aggressive};
+    builder->setCodeGenOptLevel(levels[opt_level]);
+    auto created = builder->createTargetMachine();
+    if (!created) {
+        throw native_error(toString(created.takeError()));
+    }
+    machine = std::move(*created);
+}
+
+void NativeCompiler::emit_object(llvm::Module& module, const std::string& object_path) {
+    auto start = std::chrono::steady_clock::now();
+    module.setDataLayout(machine->createDataLayout());
+    module.setTargetTriple(machine->getTargetTriple().str());
+    if (opt_level > 0) {
+        Jit::optimize(module, machine.get(), opt_level);
+    }
+
+    std::error_code error;
+    llvm::raw_fd_ostream out(object_path, error);
+    if (error) {
+        throw native_error("Could not write " + object_path + ": " + error.message());
+    }
+    llvm::legacy::PassManager passes;
+    if (machine->addPassesToEmitFile(passes, out, nullptr, llvm::CGFT_ObjectFile)) {
+        throw native_error("The host can't emit object files.");
+    }
+    passes.run(module);
+    out.flush();
+    ++objects_emitted;
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    debug << "[DEBUG] Object emitted in "
+          << std::chrono::duration<double, std::milli>(elapsed).count() << " ms."
+          << std::endl;
+}
+
+void NativeCompiler::link(const std::string& object_path,
+                          const std::string& executable_path) {
+    auto start = std::chrono::steady_clock::now();
+    // The runtime brings its own _start, so nothing of libc (or its startup files) is
+    // linked in, and unused runtime functions are dropped.
+    if (is_static()) {
+        std::vector<std::string> args = {"ld", "-static", "-nostdlib", "--gc-sections",
+                                         "-o", executable_path, object_path,
+                                         runtime_path};
+#ifdef SLANG_HAVE_LLD
+        args.front() = "ld.lld";
+        run_lld(args);
+#else
+        run_linker(args);
+#endif
+    } else {
+        run_linker({"cc", object_path, "-o", executable_path, "-lm"});
+    }
+    ++executables_linked;
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    link_seconds = std::chrono::duration<double>(elapsed).count();
+    debug << "[DEBUG] Executable linked by " << get_linker() << " in "
+          << link_seconds * 1000 << " ms." << std::endl;
+}
+
+void NativeCompiler::compile(llvm::Module& module, const std::string& executable_path) {
+    llvm::SmallString<128> object_path;
+    if (std::error_code error =
+            llvm::sys::fs::createTemporaryFile("slang", "o", object_path)) {
+        throw native_error("Could not create an object file: " + error.message());
+    }
+    // Removes the object file however compiling ends.
+    llvm::FileRemover remover(object_path);
+    emit_object(module, object_path.str().str());
+    link(object_path.str().str(), executable_path);
+}
+
+bool NativeCompiler::is_static() const {
+    return !runtime_path.empty();
+}
+
+std::string NativeCompiler::get_linker() const {
+    if (!is_static()) {
+        return "cc";
+    }
+#ifdef SLANG_HAVE_LLD
+    return "lld (in process)";
+#else
+    return "ld";
+#endif
+}
+
+double NativeCompiler::get_link_time() const {
+    return link_seconds;
+}
@@ -0,0 +1,177 @@
+#include "pipeline.hpp"
+#include "debug_stream.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <unordered_map>
+#include <unordered_set>
+
+Pipeline::Pipeline(Scheduler* scheduler, size_t queue_size, size_t pluhs_per_module)
+    : scheduler(scheduler ? *scheduler : Scheduler::get_shared()),
+      queue_size(std::max<size_t>(1, queue_size)),
+      pluhs_per_module(std::max<size_t>(1, pluhs_per_module)),
+      fuel_metering(false) {
+    debug << "[DEBUG] Pipeline initialized on " << this->scheduler.get_workers()
+          << " workers." << std::endl;
+}
+
+void Pipeline::enable_fuel_metering() {
+    fuel_metering = true;
+}
+
+void Pipeline::record(const std::string& thread, const std::string& name,
+                      std::chrono::steady_clock::time_point since) {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(timeline_mutex);
+    timeline.push_back(
+        {thread, name, std::chrono::duration<double, std::micro>(since - start).count(),
+         std::chrono::duration<double, std::micro>(now - start).count()});
+}
+
+void Pipeline::compile(const std::string& code, Jit& jit) {
+    start = std::chrono::steady_clock::now();
+    timeline.clear();
+
+    // Every worker declares every prototype, so pluhs can call each other whichever
+    // modules they end up in.
+    Parser outline(code);
+    outline.parse_tea_header();
+    std::vector<Prototype> prototypes = outline.parse_prototypes();
+    record("parser", "parse prototypes", start);
+
+    // The module each worker is generating, only touched by tasks on that worker.
+    struct Module {
+        std::unique_ptr<Codegen> codegen; // Codegen of the module, if started.
+        size_t pluhs;                     // Pluhs generated into it.
+    };
+    std::vector<Module> modules(scheduler.get_workers());
+    std::atomic<size_t> module_count = 0;
+    auto compile_module = [&](Module& module, const std::string& thread) {
+        // The worker starts a new module even if this one fails to compile.
+        auto since = std::chrono::steady_clock::now();
+        std::unique_ptr<Codegen> codegen = std::move(module.codegen);
+        module.pluhs = 0;
+        jit.compile_module(codegen->take_context(), codegen->take_module());
+        record(thread, "compile module " + std::to_string(module_count++), since);
+    };
+
+    // Declarations parsed and not generated yet, to keep parsing from running ahead.
+    std::mutex pending_mutex;
+    std::condition_variable generated;
+    size_t pending = 0;
+    std::atomic<bool> failed = false;
+    auto done_generating = [&]() {
+        std::lock_guard<std::mutex> lock(pending_mutex);
+        --pending;
+        generated.notify_one();
+    };
+
+    std::vector<std::shared_ptr<Task>> tasks = {};
+    std::exception_ptr parse_error = nullptr;
+    try {
+        Parser parser(code);
+        parser.parse_tea_header();
+        std::unordered_set<std::string> defined = {};
+        while (!failed) {
+            auto since = std::chrono::steady_clock::now();
+            auto declaration = parser.parse_next_declaration();
+            if (!declaration) {
+                break;
+            }
+            std::string name = declaration->get_prototype().get_name();
+            // Workers only see their own pluhs, so redefinitions are caught here.
+            if (declaration->get_body().has_value() && !defined.insert(name).second) {
+                throw codegen_error("Pluh defined more than once: " + name);
+            }
+            record("parser", "parse " + name, since);
+            // Plugs are declared with the other prototypes already.
+            if (!declaration->get_body().has_value()) {
+                continue;
+            }
+            {
+                std::unique_lock<std::mutex> lock(pending_mutex);
+                generated.wait(lock, [&]() { return pending < queue_size; });
+                ++pending;
+            }
+            auto pluh = std::make_shared<PluhDeclaration>(std::move(*declaration));
+            tasks.push_back(scheduler.submit([&, pluh, name]() {
+                int worker = scheduler.get_current_worker();
+                std::string thread = "worker " + std::to_string(worker);
+                Module& module = modules[worker];
+                try {
+                    auto since = std::chrono::steady_clock::now();
+                    if (!module.codegen) {
+                        module.codegen = std::make_unique<Codegen>();
+                        if (fuel_metering) {
+                            module.codegen->enable_fuel_metering();
+                        }
+                        for (auto& prototype : prototypes) {
+                            module.codegen->declare_prototype(prototype);
+                        }
+                    }
+                    (*module.codegen)(*pluh);
+                    record(thread, "generate " + name, since);
+                    if (++module.pluhs == pluhs_per_module) {
+                        compile_module(module, thread);
+                    }
+                } catch (...) {
+                    // The module may be half generated, so the worker drops it.
+                    module.codegen = nullptr;
+                    module.pluhs = 0;
+                    failed = true;
+                    done_generating();
+                    throw;
+                }
+                done_generating();
+            }));
+        }
+    } catch (...) {
+        parse_error = std::current_exception();
+    }
+
+    // Compile the modules left over once every pluh is generated.
+    if (!parse_error) {
+        for (Module& module : modules) {
+            tasks.push_back(scheduler.submit(
+                [&]() {
+                    if (module.codegen) {
+                        compile_module(module, "worker " + std::to_string(
+                                                   scheduler.get_current_worker()));
+                    }
+                },
+                std::vector<std::shared_ptr<Task>>(tasks.begin(), tasks.end())));
+        }
+    }
+    // Errors in pluhs come before wherever the parser stopped.
+    scheduler.wait(tasks);
+    if (parse_error) {
+        std::rethrow_exception(parse_error);
+    }
+    debug << "[DEBUG] Pipeline compiled " << module_count << " modules." << std::endl;
+}
+
+const std::vector<TimelineEvent>& Pipeline::get_timeline() const {
+    return timeline;
+}
+
+void Pipeline::write_timeline(std::ostream& out) const {
+    // Every thread gets a track, named by a metadata event.
+    std::unordered_map<std::string, size_t> tracks = {};
+    const char* separator = "\n  ";
+    out << "{\"traceEvents\": [";
+    for (const auto& event : timeline) {
+        auto [track, added] = tracks.try_emplace(event.thread, tracks.size() + 1);
+        if (added) {
+            out << separator << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, "
+                << "\"tid\": " << track->second << ", \"args\": {\"name\": \""
+                << event.thread << "\"}}";
+            separator = ",\n  ";
+        }
+        out << separator << "{\"name\": \"" << event.name << "\", \"ph\": \"X\", "
+            << "\"pid\": 1, \"tid\": " << track->second << ", \"ts\": " << event.start_us
+            << ", \"dur\": " << event.end_us - event.start_us << "}";
+        separator = ",\n  ";
+    }
+    out << "\n]}" << std::endl;
+}
@@ -0,0 +1,250 @@
+#include "profiler.hpp"
+#include "stats.hpp"
+#include <llvm/Object/SymbolSize.h>
+#include <cerrno>
+#include <cstring>
+#include <dlfcn.h>
+#include <pthread.h>
+#include <sys/time.h>
+#if defined(__linux__)
+#include <ucontext.h>
+#endif
+#include <vector>
+
+static Statistic samples_kept("profiler", "samples", "Number of stacks sampled");
+static Statistic samples_dropped("profiler", "dropped",
+                                 "Number of samples dropped for lack of room");
+
+// The running profiler, if any, read by the signal handler.
+static std::atomic<Profiler*> active_profiler = nullptr;
+
+// Whether this thread is the one the running profiler samples.
+static thread_local bool sampled_thread = false;
+
+Profiler::Profiler(unsigned frequency, size_t capacity)
+    : frequency(frequency),
+      samples(nullptr),
+      capacity(capacity),
+      taken(0),
+      stack_low(0),
+      stack_high(0),
+      symbols_mutex(),
+      symbols(),
+      lines(),
+      running(false),
+      previous_action() {
+    if (frequency == 0 || capacity == 0) {
+        throw profiler_error("The frequency and capacity of a profiler must not be 0");
+    }
+    // Left uninitialized, so only the pages samples are written to are ever touched.
+    samples = std::make_unique_for_overwrite<Sample[]>(capacity);
+}
+
+void Profiler::set_lines(const std::unordered_map<std::string, int>& lines) {
+    this->lines = lines;
+}
+
+void Profiler::on_signal(int, siginfo_t*, void* context) {
+    Profiler* profiler = active_profiler.load(std::memory_order_relaxed);
+    if (!profiler || !sampled_thread) {
+        return;
+    }
+    int saved_errno = errno;
+    profiler->record(context);
+    errno = saved_errno;
+}
+
+void Profiler::record(void* context) {
+    size_t index = taken.fetch_add(1, std::memory_order_relaxed);
+    if (index >= capacity) {
+        return;
+    }
+    Sample& sample = samples[index];
+#if defined(__linux__) && defined(__x86_64__)
+    auto* state = static_cast<ucontext_t*>(context);
+    uintptr_t pc = state->uc_mcontext.gregs[REG_RIP];
+    uintptr_t frame = state->uc_mcontext.gregs[REG_RBP];
+    uintptr_t sp = state->uc_mcontext.gregs[REG_RSP];
+#elif defined(__linux__) && defined(__aarch64__)
+    auto* state = static_cast<ucontext_t*>(context);
+    uintptr_t pc = state->uc_mcontext.pc;
+    uintptr_t frame = state->uc_mcontext.regs[29];
+    uintptr_t sp = state->uc_mcontext.sp;
+#else
+    (void)context;
+    uintptr_t pc = 0;
+    uintptr_t frame = 0;
+    uintptr_t sp = 0;
+#endif
+    sample.frames[0] = pc;
+    int depth = 1;
+    // Every frame starts with its caller's frame pointer, then its return address. Only
+    // frames on this thread's stack, above the interrupted code, are followed, so native
+    // code using the register for something else can't send the walk off the stack.
+    uintptr_t low = std::max(sp, stack_low);
+    while (depth < max_depth && frame >= low &&
+           frame + 2 * sizeof(uintptr_t) <= stack_high && frame % sizeof(uintptr_t) == 0) {
+        const uintptr_t* words = reinterpret_cast<const uintptr_t*>(frame);
+        if (words[1] == 0) {
+            break;
+        }
+        sample.frames[depth++] = words[1];
+        // The stack grows down, so callers' frames are always higher.
+        if (words[0] <= frame) {
+            break;
+        }
+        frame = words[0];
+    }
+    sample.depth = depth;
+}
+
+void Profiler::start() {
+#if !defined(__linux__)
+    // Finding the sampled thread's stack and its registers in the handler is Linux only.
+    throw profiler_error("The sampling profiler isn't supported on this platform");
+#else
+    Profiler* none = nullptr;
+    if (!active_profiler.compare_exchange_strong(none, this)) {
+        throw profiler_error("Another profiler is already running");
+    }
+    pthread_attr_t attributes;
+    void* stack = nullptr;
+    size_t stack_size = 0;
+    if (pthread_getattr_np(pthread_self(), &attributes) != 0) {
+        active_profiler = nullptr;
+        throw profiler_error("Could not find the stack of the sampled thread");
+    }
+    pthread_attr_getstack(&attributes, &stack, &stack_size);
+    pthread_attr_destroy(&attributes);
+    stack_low = reinterpret_cast<uintptr_t>(stack);
+    stack_high = stack_low + stack_size;
+    sampled_thread = true;
+
+    struct sigaction action = {};
+    action.sa_sigaction = &Profiler::on_signal;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    long interval = 1000000 / frequency;
+    itimerval timer = {{interval / 1000000, std::max(interval % 1000000, 1L)},
+                       {interval / 1000000, std::max(interval % 1000000, 1L)}};
+    bool handled = sigaction(SIGPROF, &action, &previous_action) == 0;
+    if (!handled || setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+        std::string error = std::strerror(errno);
+        if (handled) {
+            sigaction(SIGPROF, &previous_action, nullptr);
+        }
+        sampled_thread = false;
+        active_profiler = nullptr;
+        throw profiler_error("Could not start sampling: " + error);
+    }
+    running = true;
+#endif
+}
+
+void Profiler::stop() {
+    if (!running) {
+        return;
+    }
+#if defined(__linux__)
+    itimerval off = {};
+    setitimer(ITIMER_PROF, &off, nullptr);
+    // A signal still pending is taken while blocked, so it can't reach the previous
+    // handler (by default, killing the process) once that's put back.
+    sigset_t profiling;
+    sigset_t blocked;
+    sigemptyset(&profiling);
+    sigaddset(&profiling, SIGPROF);
+    pthread_sigmask(SIG_BLOCK, &profiling, &blocked);
+    timespec no_wait = {};
+    while (sigtimedwait(&profiling, nullptr, &no_wait) == SIGPROF) {
+    }
+    sigaction(SIGPROF, &previous_action, nullptr);
+    pthread_sigmask(SIG_SETMASK, &blocked, nullptr);
+    sampled_thread = false;
+    active_profiler = nullptr;
+    running = false;
+    samples_kept += get_sample_count();
+    samples_dropped += get_dropped_count();
+#endif
+}
+
+std::string Profiler::resolve(uint64_t address, bool native) {
+    {
+        std::lock_guard<std::mutex> lock(symbols_mutex);
+        auto next = symbols.upper_bound(address);
+        if (next != symbols.begin() && address < std::prev(next)->second.end) {
+            const std::string& name = std::prev(next)->second.name;
+            auto line = lines.find(name);
+            return line == lines.end() ? name : name + ":" + std::to_string(line->second);
+        }
+    }
+    if (!native) {
+        return "";
+    }
+    Dl_info info;
+    if (dladdr(reinterpret_cast<void*>(address), &info) != 0 && info.dli_sname) {
+        return info.dli_sname;
+    }
+    return "[unknown]";
+}
+
+void Profiler::write_collapsed(std::ostream& out) {
+    std::map<std::string, size_t> stacks = {};
+    for (size_t index = 0; index < get_sample_count(); ++index) {
+        const Sample& sample = samples[index];
+        std::vector<std::string> names = {};
+        for (int frame = 0; frame < sample.depth; ++frame) {
+            // A return address points past its call, which may be the next pluh's start.
+            uint64_t address = frame == 0 ? sample.frames[0] : sample.frames[frame] - 1;
+            std::string name = resolve(address, frame == 0);
+            if (!name.empty()) {
+                names.push_back(std::move(name));
+            }
+        }
+        std::string stack = "";
+        for (auto name = names.rbegin(); name != names.rend(); ++name) {
+            stack += (stack.empty() ? "" : ";") + *name;
+        }
+        if (!stack.empty()) {
+            ++stacks[stack];
+        }
+    }
+    for (const auto& [stack, count] : stacks) {
+        out << stack << " " << count << "\n";
+    }
+}
+
+size_t Profiler::get_sample_count() const {
+    return std::min(taken.load(), capacity);
+}
+
+size_t Profiler::get_dropped_count() const {
+    return taken.load() - get_sample_count();
+}
+
+void Profiler::notifyObjectLoaded(ObjectKey, const llvm::object::ObjectFile& object,
+                                  const llvm::RuntimeDyld::LoadedObjectInfo& info) {
+    std::lock_guard<std::mutex> lock(symbols_mutex);
+    for (const auto& [symbol, size] : llvm::object::computeSymbolSizes(object)) {
+        auto type = llvm::expectedToOptional(symbol.getType());
+        auto name = llvm::expectedToOptional(symbol.getName());
+        auto section = llvm::expectedToOptional(symbol.getSection());
+        auto address = llvm::expectedToOptional(symbol.getAddress());
+        if (!type || *type != llvm::object::SymbolRef::ST_Function || !name || !section ||
+            *section == object.section_end() || !address || size == 0) {
+            continue;
+        }
+        // Symbols of an object file are relative to their section, which was loaded
+        // somewhere of its own.
+        uint64_t section_address = info.getSectionLoadAddress(**section);
+        if (section_address == 0) {
+            continue;
+        }
+        uint64_t start = section_address + *address - (*section)->getAddress();
+        symbols[start] = {start + size, name->str()};
+    }
+}
+
+Profiler::~Profiler() {
+    stop();
+}
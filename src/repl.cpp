@@ -0,0 +1,468 @@
+#include "repl.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+
+Repl::Repl(std::ostream& out) : out(out), entry_count(0), swap_us(-1) {
+    jit.define_symbol("slang.profile_value", reinterpret_cast<uint64_t>(&record_value));
+    debug << "[DEBUG] Repl initialized." << std::endl;
+}
+
+void Repl::record_value(void* profile, int64_t value) {
+    auto* argument = static_cast<ArgumentProfile*>(profile);
+    ++argument->samples;
+    for (size_t i = 0; i < argument->used; ++i) {
+        if (argument->values[i].first == value) {
+            ++argument->values[i].second;
+            return;
+        }
+    }
+    if (argument->used < argument->values.size()) {
+        argument->values[argument->used++] = {value, 1};
+        return;
+    }
+    // Every slot is taken, so the least frequent value makes room and the new one
+    // inherits its count (which bounds how much any count can be overestimated).
+    auto least = std::min_element(
+        argument->values.begin(), argument->values.end(),
+        [](const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; });
+    *least = {value, least->second + 1};
+}
+
+PluhDeclaration Repl::parse_definition(const std::string& source,
+                                       const std::string& name) {
+    Parser parser(source);
+    if (parser.get_current_token().first != TokenType::PROGRAM) {
+        return parser.parse_pluh();
+    }
+    TeaSpill tea = parser.parse_tea();
+    for (auto& declaration : tea.get_declarations()) {
+        PluhDeclaration& pluh = std::get<PluhDeclaration>(declaration);
+        if (pluh.get_prototype().get_name() == name && pluh.get_body().has_value()) {
+            return std::move(pluh);
+        }
+    }
+    throw parse_logic_error("No pluh named " + name + " to reload");
+}
+
+void Repl::specialize_hot_pluhs() {
+    for (auto& [name, pluh] : pluhs) {
+        PluhProfile* profile = pluh.profile;
+        if (!profile || profile->decided || profile->calls < profile_window) {
+            continue;
+        }
+        profile->decided = true;
+
+        // Specialize on every argument that held the same value in most calls.
+        std::vector<std::pair<unsigned, int64_t>> constants = {};
+        for (unsigned index = 0; index < profile->arguments.size(); ++index) {
+            ArgumentProfile* argument = profile->arguments[index].get();
+            if (!argument || argument->used == 0) {
+                continue;
+            }
+            auto most = std::max_element(
+                argument->values.begin(), argument->values.begin() + argument->used,
+                [](const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; });
+            if (most->second >= specialize_ratio * argument->samples) {
+                constants.push_back({index, most->first});
+            }
+        }
+        if (constants.empty()) {
+            continue;
+        }
+
+        try {
+            PluhDeclaration definition = parse_definition(pluh.source, name);
+            auto specialization =
+                std::make_unique<Specialization>(Specialization{name, constants, 0, 0});
+            std::string special_name = new_symbol_name(name + ".special");
+            std::string guard_name = new_symbol_name(name + ".guard");
+
+            // The clone refers to the variables and pluhs the generic code was
+            // compiled against, not to any defined since with the same names.
+            // Recursive calls in it go through the stub, and so through the guard,
+            // since their arguments can differ.
+            Codegen codegen;
+            Prototype self(name, pluh.arguments, pluh.return_type);
+            codegen.declare_prototype(self, pluh.symbol_name);
+            declare_session(codegen, pluh.bindings);
+            llvm::Function* special = codegen.define_pluh(definition, special_name);
+            codegen.specialize_arguments(special, constants);
+            codegen.define_guard(definition.get_prototype(), guard_name, special_name,
+                                 pluh.code_name, constants, &specialization->hits,
+                                 &specialization->misses);
+            jit.add_module(codegen.take_context(), codegen.take_module());
+            jit.update_stub(pluh.symbol_name, jit.lookup(guard_name));
+
+            out << "Specialized " << name << " for";
+            for (auto& [index, value] : constants) {
+                out << " " << pluh.arguments[index].first << " = " << value;
+            }
+            out << std::endl;
+            specializations.push_back(std::move(specialization));
+        } catch (const std::exception& e) {
+            out << "[ERROR] Could not specialize " << name << ": " << e.what()
+                << std::endl;
+        }
+    }
+}
+
+void Repl::print_specializations() {
+    if (specializations.empty()) {
+        out << "No specializations taken" << std::endl;
+    }
+    for (auto& specialization : specializations) {
+        uint64_t calls = specialization->hits + specialization->misses;
+        out << specialization->name << "(";
+        for (size_t i = 0; i < specialization->constants.size(); ++i) {
+            out << (i ? ", " : "") << "#" << specialization->constants[i].first << " = "
+                << specialization->constants[i].second;
+        }
+        out << "): " << specialization->hits << " hits, " << specialization->misses
+            << " misses (" << std::fixed << std::setprecision(1)
+            << (calls ? 100.0 * specialization->hits / calls : 0.0) << "% hit rate)"
+            << std::endl;
+    }
+}
+
+std::string Repl::new_symbol_name(const std::string& name) {
+    int count = ++definitions[name];
+    return count == 1 ? name : name + "." + std::to_string(count);
+}
+
+Repl::Bindings Repl::get_bindings() const {
+    Bindings bindings = {};
+    for (auto& [name, pluh] : pluhs) {
+        bindings.pluhs.push_back(
+            {name, pluh.arguments, pluh.return_type, pluh.symbol_name});
+    }
+    for (auto& [name, global] : globals) {
+        bindings.globals.push_back({name, global});
+    }
+    return bindings;
+}
+
+void Repl::declare_session(Codegen& codegen, const Bindings& bindings) {
+    for (auto& pluh : bindings.pluhs) {
+        Prototype prototype(pluh.name, pluh.arguments, pluh.return_type);
+        codegen.declare_prototype(prototype, pluh.symbol_name);
+    }
+    for (auto& [name, global] : bindings.globals) {
+        codegen.declare_global(name, global.type_name, global.symbol_name, false);
+    }
+}
+
+void Repl::define_pluh(PluhDeclaration& pluh, const std::string& source) {
+    Prototype& prototype = pluh.get_prototype();
+    std::string code_name = new_symbol_name(prototype.get_name() + ".code");
+
+    // Declare the new pluh first so recursive calls go straight to it rather than
+    // through the stub.
+    Codegen codegen;
+    llvm::Function* function = codegen.declare_prototype(prototype, code_name);
+    Bindings bindings = get_bindings();
+    declare_session(codegen, bindings);
+    codegen(pluh);
+
+    // Profile the arguments that could be folded into a specialized clone.
+    auto profile = std::make_unique<PluhProfile>(PluhProfile{0, {}, false});
+    std::vector<void*> argument_profiles = {};
+    for (auto& [arg_name, arg_type] : prototype.get_arguments()) {
+        std::unique_ptr<ArgumentProfile> argument = nullptr;
+        if (arg_type == "int" || arg_type == "char" || arg_type == "bool") {
+            argument = std::make_unique<ArgumentProfile>();
+        }
+        argument_profiles.push_back(argument.get());
+        profile->arguments.push_back(std::move(argument));
+    }
+    PluhProfile* profile_ptr = nullptr;
+    if (std::any_of(argument_profiles.begin(), argument_profiles.end(),
+                    [](void* argument) { return argument != nullptr; })) {
+        codegen.profile_arguments(function, &profile->calls, argument_profiles,
+                                  profile_window, "slang.profile_value");
+        profile_ptr = profile.get();
+        profiles.push_back(std::move(profile));
+    }
+
+    jit.add_module(codegen.take_context(), codegen.take_module());
+    // Compile it now so the latency of the entry includes it.
+    uint64_t address = jit.lookup(code_name);
+
+    auto existing = pluhs.find(prototype.get_name());
+    if (existing != pluhs.end() && existing->second.is_stub &&
+        existing->second.arguments == prototype.get_arguments() &&
+        existing->second.return_type == prototype.get_return_type()) {
+        auto start = std::chrono::steady_clock::now();
+        jit.update_stub(existing->second.symbol_name, address);
+        auto swapped = std::chrono::steady_clock::now();
+        swap_us = std::chrono::duration<double, std::micro>(swapped - start).count();
+        existing->second.code_name = code_name;
+        existing->second.source = source;
+        existing->second.profile = profile_ptr;
+        existing->second.bindings = std::move(bindings);
+        debug << "[DEBUG] Hot reloaded pluh: " << prototype.get_name() << std::endl;
+        return;
+    }
+
+    std::string stub_name = new_symbol_name(prototype.get_name());
+    jit.define_stub(stub_name, address);
+    pluhs[prototype.get_name()] = {prototype.get_arguments(), prototype.get_return_type(),
+                                   stub_name, true, code_name, source, profile_ptr,
+                                   std::move(bindings)};
+}
+
+void Repl::define_plug(PluhDeclaration& plug) {
+    Prototype& prototype = plug.get_prototype();
+    pluhs[prototype.get_name()] = {prototype.get_arguments(), prototype.get_return_type(),
+                                   prototype.get_name(), false, "", "", nullptr, {}};
+}
+
+uint64_t Repl::compile_global(Statement& statement) {
+    std::string name = "";
+    std::string type_name = "";
+    Statement initializer = std::make_unique<CompoundStatement>(std::vector<Statement>{});
+    // The initializer stores to the new variable under a name no entry can spell, so
+    // like in a pluh, 'cookUp x : int = x + 1' reads any earlier x.
+    std::string store_name = "";
+    if (auto* cookup = statement.get_if<CookedUpStatement>()) {
+        name = cookup->get_var_name();
+        type_name = cookup->get_var_type();
+    } else {
+        auto& cookup_assign = *statement.get_if<CookedUpAssignmentStatement>();
+        name = cookup_assign.get_var_name();
+        type_name = cookup_assign.get_var_type();
+        store_name = "@" + name;
+        initializer = std::make_unique<AssignmentStatement>(
+            store_name, std::move(cookup_assign.get_assignment_expression()));
+    }
+
+    // Only shadow any earlier variable with the same name once this one compiled.
+    GlobalSymbol global = {type_name, new_symbol_name(name)};
+    uint64_t address = compile_statement(std::move(initializer), store_name, &global);
+    globals[name] = global;
+    return address;
+}
+
+uint64_t Repl::compile_statement(Statement statement, const std::string& new_global,
+                                 const GlobalSymbol* global) {
+    std::string entry_name = "repl.entry." + std::to_string(++entry_count);
+
+    std::vector<Statement> statements = {};
+    statements.push_back(std::move(statement));
+    PluhDeclaration entry(Prototype(entry_name, {}, "npc"),
+                          std::make_unique<CompoundStatement>(std::move(statements)));
+
+    Codegen codegen;
+    declare_session(codegen, get_bindings());
+    if (global) {
+        codegen.declare_global(new_global, global->type_name, global->symbol_name, true);
+    }
+    codegen.declare_prototype(entry.get_prototype());
+    codegen(entry);
+
+    jit.add_module(codegen.take_context(), codegen.take_module());
+    return jit.lookup(entry_name);
+}
+
+uint64_t Repl::compile_expression(Expression expression) {
+    // Print the value of the expression, unless there's no value to print.
+    bool has_value = true;
+    if (auto* call = expression.get_if<CallExpression>()) {
+        auto pluh = pluhs.find(call->get_callee());
+        if (pluh == pluhs.end()) {
+            has_value = call->get_callee() != "yap";
+        } else {
+            has_value = pluh->second.return_type != "npc";
+        }
+    }
+    if (has_value) {
+        std::vector<Expression> args = {};
+        args.push_back(std::move(expression));
+        expression = std::make_unique<CallExpression>("yap", std::move(args));
+    }
+    return compile_statement(
+        std::make_unique<AssignmentStatement>("@", std::move(expression)));
+}
+
+void Repl::report_latency(double compile_ms, double run_ms) {
+    out << std::fixed << std::setprecision(2) << "(compiled in " << compile_ms << " ms, ";
+    if (swap_us >= 0) {
+        out << "swapped in " << swap_us << " us, ";
+        swap_us = -1;
+    }
+    out << "ran in " << run_ms << " ms)" << std::endl;
+}
+
+bool Repl::eval(const std::string& entry) {
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+    try {
+        Parser parser(entry);
+        uint64_t address = 0;
+
+        // The whole entry has to be consumed, otherwise "1 2" would silently run "1".
+        auto expect_end = [&parser]() {
+            if (parser.get_current_token().first != TokenType::END_OF_FILE) {
+                throw parse_logic_error("Unexpected input after entry: " +
+                                        parser.get_current_token().second);
+            }
+        };
+
+        // Entries are told apart by their first token, and the second one tells an
+        // assignment from an expression starting with a variable.
+        Lexer lexer(entry);
+        Token first = lexer.get_token();
+        Token second = lexer.get_token();
+        bool is_statement =
+            (first.first == TokenType::IDENTIFIER && second.second == "=") ||
+            first.first == TokenType::IF || first.first == TokenType::WHILE ||
+            first.first == TokenType::BREAK || first.first == TokenType::CONTINUE ||
+            first.first == TokenType::RETURN || first.second == "{";
+
+        if (first.first == TokenType::DEF) {
+            PluhDeclaration pluh = parser.parse_pluh();
+            expect_end();
+            define_pluh(pluh, entry);
+        } else if (first.first == TokenType::EXTERN) {
+            PluhDeclaration plug = parser.parse_plug();
+            expect_end();
+            define_plug(plug);
+        } else if (first.first == TokenType::LET) {
+            Statement statement = parser.parse_statement();
+            expect_end();
+            address = compile_global(statement);
+        } else if (is_statement) {
+            Statement statement = parser.parse_statement();
+            expect_end();
+            address = compile_statement(std::move(statement));
+        } else {
+            Expression expression = parser.parse_expression();
+            expect_end();
+            address = compile_expression(std::move(expression));
+        }
+        auto compiled = clock::now();
+
+        if (address) {
+            reinterpret_cast<void (*)()>(address)();
+            std::fflush(stdout);
+        }
+        auto ran = clock::now();
+        report_latency(
+            std::chrono::duration<double, std::milli>(compiled - start).count(),
+            std::chrono::duration<double, std::milli>(ran - compiled).count());
+        specialize_hot_pluhs();
+        return true;
+    } catch (const std::exception& e) {
+        out << "[ERROR] " << e.what() << std::endl;
+        swap_us = -1;
+        return false;
+    }
+}
+
+bool Repl::reload(const std::string& source, const std::string& name) {
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+    try {
+        Parser parser(source);
+        TeaSpill tea = parser.parse_tea();
+        for (auto& declaration : tea.get_declarations()) {
+            PluhDeclaration& pluh = std::get<PluhDeclaration>(declaration);
+            if (pluh.get_prototype().get_name() != name || !pluh.get_body().has_value()) {
+                continue;
+            }
+            define_pluh(pluh, source);
+            report_latency(std::chrono::duration<double, std::milli>(clock::now() - start)
+                               .count(),
+                           0);
+            return true;
+        }
+        throw parse_logic_error("No pluh named " + name + " to reload");
+    } catch (const std::exception& e) {
+        out << "[ERROR] " << e.what() << std::endl;
+        swap_us = -1;
+        return false;
+    }
+}
+
+void Repl::run(std::istream& in) {
+    std::string entry = "";
+    int depth = 0; // Unclosed braces and parentheses in the entry so far.
+    bool in_block_comment = false; // True inside a Blocked ... Unblocked comment.
+    std::string line = "";
+    out << "slang> " << std::flush;
+    while (std::getline(in, line)) {
+        if (entry.empty() && (line == ":quit" || line == ":q")) {
+            return;
+        }
+        if (entry.empty() && line == ":profile") {
+            print_specializations();
+            out << "slang> " << std::flush;
+            continue;
+        }
+        if (entry.empty() && line.rfind(":reload ", 0) == 0) {
+            std::stringstream command(line.substr(8));
+            std::string file_path = "";
+            std::string name = "";
+            command >> file_path >> name;
+            std::ifstream file(file_path);
+            if (!file.is_open()) {
+                out << "[ERROR] Error opening file!" << std::endl;
+            } else {
+                std::stringstream source;
+                source << file.rdbuf();
+                reload(source.str(), name);
+            }
+            out << "slang> " << std::flush;
+            continue;
+        }
+        // Quoted text and comments don't count, and comments start a token like in the
+        // lexer (so a name ending in "Blocked" isn't one).
+        bool in_literal = false;
+        char quote = '\0';
+        for (size_t i = 0; i < line.size(); ++i) {
+            char c = line[i];
+            auto starts_token = [&]() {
+                unsigned char before = i == 0 ? ' ' : line[i - 1];
+                return !(std::isalnum(before) || before == '_' || before == '?' ||
+                         before >= 0x80);
+            };
+            if (in_block_comment) {
+                if (line.compare(i, 9, "Unblocked") == 0) {
+                    in_block_comment = false;
+                    i += 8;
+                }
+            } else if (in_literal) {
+                in_literal = c != quote;
+            } else if (c == '"' || c == '\'') {
+                in_literal = true;
+                quote = c;
+            } else if (line.compare(i, 9, "Cancelled") == 0 && starts_token()) {
+                break;
+            } else if (line.compare(i, 7, "Blocked") == 0 && starts_token()) {
+                in_block_comment = true;
+                i += 6;
+            } else if (c == '{' || c == '(') {
+                ++depth;
+            } else if (c == '}' || c == ')') {
+                --depth;
+            }
+        }
+        entry += line + "\n";
+
+        if (depth > 0 || in_block_comment) {
+            out << "  ...> " << std::flush;
+            continue;
+        }
+        if (entry.find_first_not_of(" \t\r\n") != std::string::npos) {
+            eval(entry);
+        }
+        entry.clear();
+        depth = 0;
+        in_block_comment = false;
+        out << "slang> " << std::flush;
+    }
+    out << std::endl;
+}
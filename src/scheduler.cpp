@@ -0,0 +1,393 @@
+#include "scheduler.hpp"
+#include "stats.hpp"
+#include <algorithm>
+#include <iomanip>
+
+static Statistic tasks_run("scheduler", "tasks", "Number of tasks run");
+static Statistic tasks_stolen("scheduler", "steals",
+                              "Number of tasks stolen from another worker");
+
+// The scheduler the calling thread is a worker of, if any, and its index in it.
+static thread_local const Scheduler* current_scheduler = nullptr;
+static thread_local int current_worker = -1;
+
+// The scheduler shared by the whole process, and how many workers it gets.
+static std::mutex shared_mutex;
+static std::unique_ptr<Scheduler> shared = nullptr;
+static unsigned shared_workers = 0;
+
+// Slots of a deque's first array, it doubles whenever it fills up.
+static const int64_t initial_capacity = 256;
+
+Task::Task(std::function<void()> work)
+    : work(std::move(work)),
+      blockers(1),
+      done(false),
+      mutex(),
+      dependents(),
+      error(nullptr),
+      self(nullptr) {}
+
+Scheduler::WorkDeque::Array::Array(int64_t capacity)
+    : mask(capacity - 1),
+      slots(std::make_unique<std::atomic<Task*>[]>(capacity)) {}
+
+Scheduler::WorkDeque::WorkDeque() : top(0), bottom(0), array(nullptr), arrays() {
+    arrays.push_back(std::make_unique<Array>(initial_capacity));
+    array.store(arrays.back().get(), std::memory_order_relaxed);
+}
+
+// The deque follows "Correct and Efficient Work-Stealing for Weak Memory Models" (Lê et
+// al., PPoPP 2013), the C11 version of the Chase-Lev deque.
+
+void Scheduler::WorkDeque::push(Task* task) {
+    int64_t b = bottom.load(std::memory_order_relaxed);
+    int64_t t = top.load(std::memory_order_acquire);
+    Array* a = array.load(std::memory_order_relaxed);
+    if (b - t > a->mask) {
+        // Full: copy the tasks into an array twice the size. Thieves may still be
+        // reading the old one, so it's kept until the deque is destroyed.
+        auto bigger = std::make_unique<Array>((a->mask + 1) * 2);
+        for (int64_t i = t; i < b; ++i) {
+            bigger->slots[i & bigger->mask].store(
+                a->slots[i & a->mask].load(std::memory_order_relaxed),
+                std::memory_order_relaxed);
+        }
+        a = bigger.get();
+        arrays.push_back(std::move(bigger));
+        array.store(a, std::memory_order_release);
+    }
+    a->slots[b & a->mask].store(task, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom.store(b + 1, std::memory_order_relaxed);
+}
+
+Task* Scheduler::WorkDeque::pop() {
+    int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+    Array* a = array.load(std::memory_order_relaxed);
+    bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top.load(std::memory_order_relaxed);
+    if (t > b) {
+        // Empty.
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    Task* task = a->slots[b & a->mask].load(std::memory_order_relaxed);
+    if (t == b) {
+        // The last task: race the thieves for it.
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                         std::memory_order_relaxed)) {
+            task = nullptr;
+        }
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+    return task;
+}
+
+Task* Scheduler::WorkDeque::steal() {
+    int64_t t = top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom.load(std::memory_order_acquire);
+    if (t >= b) {
+        return nullptr;
+    }
+    Array* a = array.load(std::memory_order_acquire);
+    Task* task = a->slots[t & a->mask].load(std::memory_order_relaxed);
+    if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                     std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    return task;
+}
+
+Scheduler::Scheduler(unsigned workers)
+    : workers(),
+      injection_mutex(),
+      injected(),
+      queued(0),
+      sleeping(0),
+      sleep_mutex(),
+      wake(),
+      waiting(0),
+      wait_mutex(),
+      finished(),
+      stopping(false),
+      start(std::chrono::steady_clock::now()) {
+    if (workers == 0) {
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // Every deque exists before any worker starts stealing from it.
+    for (unsigned i = 0; i < workers; ++i) {
+        this->workers.push_back(std::make_unique<Worker>());
+    }
+    for (unsigned i = 0; i < workers; ++i) {
+        this->workers[i]->thread = std::thread(&Scheduler::work, this, i);
+    }
+}
+
+Scheduler& Scheduler::get_shared() {
+    std::lock_guard<std::mutex> lock(shared_mutex);
+    if (!shared) {
+        shared = std::make_unique<Scheduler>(shared_workers);
+    }
+    return *shared;
+}
+
+void Scheduler::set_shared_workers(unsigned workers) {
+    std::lock_guard<std::mutex> lock(shared_mutex);
+    shared_workers = workers;
+}
+
+bool Scheduler::has_shared() {
+    std::lock_guard<std::mutex> lock(shared_mutex);
+    return shared != nullptr;
+}
+
+void Scheduler::schedule(Task* task) {
+    int worker = get_current_worker();
+    if (worker >= 0) {
+        workers[worker]->deque.push(task);
+    } else {
+        std::lock_guard<std::mutex> lock(injection_mutex);
+        injected.push_back(task);
+    }
+    // Sequentially consistent with the sleepers' count, so either a sleeper sees the
+    // task queued or this sees the sleeper and wakes it.
+    queued.fetch_add(1);
+    if (sleeping.load() > 0) {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        wake.notify_one();
+    }
+}
+
+Task* Scheduler::find_task(int worker) {
+    if (worker >= 0) {
+        if (Task* task = workers[worker]->deque.pop()) {
+            queued.fetch_sub(1);
+            return task;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(injection_mutex);
+        if (!injected.empty()) {
+            Task* task = injected.front();
+            injected.pop_front();
+            queued.fetch_sub(1);
+            return task;
+        }
+    }
+    // Start stealing at a different victim on every worker, so thieves spread out.
+    size_t count = workers.size();
+    size_t first = worker >= 0 ? worker + 1 : 0;
+    for (size_t i = 0; i < count; ++i) {
+        size_t victim = (first + i) % count;
+        if (static_cast<int>(victim) == worker) {
+            continue;
+        }
+        if (Task* task = workers[victim]->deque.steal()) {
+            queued.fetch_sub(1);
+            if (worker >= 0) {
+                workers[worker]->steals.fetch_add(1, std::memory_order_relaxed);
+            }
+            ++tasks_stolen;
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+void Scheduler::run(Task* task, int worker) {
+    auto begin = std::chrono::steady_clock::now();
+    std::exception_ptr failed = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        failed = task->error;
+    }
+    if (!failed) {
+        try {
+            task->work();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(task->mutex);
+            task->error = std::current_exception();
+        }
+    }
+    task->work = nullptr; // Free what the work captured as soon as it's done.
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - begin);
+    workers[worker]->busy_ns.fetch_add(elapsed.count(), std::memory_order_relaxed);
+    workers[worker]->tasks.fetch_add(1, std::memory_order_relaxed);
+    ++tasks_run;
+    finish(task);
+}
+
+void Scheduler::finish(Task* task) {
+    std::vector<std::shared_ptr<Task>> dependents = {};
+    std::exception_ptr error = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->done.store(true);
+        dependents.swap(task->dependents);
+        error = task->error;
+    }
+    for (auto& dependent : dependents) {
+        if (error) {
+            std::lock_guard<std::mutex> lock(dependent->mutex);
+            if (!dependent->error) {
+                dependent->error = error;
+            }
+        }
+        if (dependent->blockers.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            schedule(dependent.get());
+        }
+    }
+    // Sequentially consistent with the waiters' count, as for sleeping workers.
+    if (waiting.load() > 0) {
+        std::lock_guard<std::mutex> lock(wait_mutex);
+        finished.notify_all();
+    }
+    // Last, since it may free the task.
+    task->self = nullptr;
+}
+
+void Scheduler::work(int worker) {
+    current_scheduler = this;
+    current_worker = worker;
+    while (true) {
+        if (Task* task = find_task(worker)) {
+            run(task, worker);
+            continue;
+        }
+        if (stopping.load() && queued.load() <= 0) {
+            return;
+        }
+        sleeping.fetch_add(1);
+        {
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            wake.wait(lock, [this]() { return queued.load() > 0 || stopping.load(); });
+        }
+        sleeping.fetch_sub(1);
+    }
+}
+
+std::shared_ptr<Task>
+Scheduler::submit(std::function<void()> work,
+                  const std::vector<std::shared_ptr<Task>>& dependencies) {
+    auto task = std::make_shared<Task>(std::move(work));
+    task->self = task;
+    task->blockers.store(dependencies.size() + 1);
+    for (const auto& dependency : dependencies) {
+        std::exception_ptr error = nullptr;
+        bool pending = false;
+        {
+            std::lock_guard<std::mutex> lock(dependency->mutex);
+            pending = !dependency->done.load();
+            if (pending) {
+                dependency->dependents.push_back(task);
+            }
+            error = dependency->error;
+        }
+        if (!pending) {
+            if (error) {
+                std::lock_guard<std::mutex> lock(task->mutex);
+                if (!task->error) {
+                    task->error = error;
+                }
+            }
+            task->blockers.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+    if (task->blockers.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        schedule(task.get());
+    }
+    return task;
+}
+
+void Scheduler::wait(const std::shared_ptr<Task>& task) {
+    int worker = get_current_worker();
+    if (worker >= 0) {
+        // Keep the worker busy, the task may be waiting behind others in its deque.
+        while (!task->is_done()) {
+            if (Task* other = find_task(worker)) {
+                run(other, worker);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    } else {
+        waiting.fetch_add(1);
+        {
+            std::unique_lock<std::mutex> lock(wait_mutex);
+            finished.wait(lock, [&task]() { return task->done.load(); });
+        }
+        waiting.fetch_sub(1);
+    }
+    std::lock_guard<std::mutex> lock(task->mutex);
+    if (task->error) {
+        std::rethrow_exception(task->error);
+    }
+}
+
+void Scheduler::wait(const std::vector<std::shared_ptr<Task>>& tasks) {
+    std::exception_ptr error = nullptr;
+    for (const auto& task : tasks) {
+        try {
+            wait(task);
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+unsigned Scheduler::get_workers() const {
+    return workers.size();
+}
+
+int Scheduler::get_current_worker() const {
+    return current_scheduler == this ? current_worker : -1;
+}
+
+std::vector<WorkerStats> Scheduler::get_worker_stats() const {
+    std::vector<WorkerStats> stats = {};
+    for (const auto& worker : workers) {
+        stats.push_back({worker->tasks.load(std::memory_order_relaxed),
+                         worker->steals.load(std::memory_order_relaxed),
+                         worker->busy_ns.load(std::memory_order_relaxed) / 1e9});
+    }
+    return stats;
+}
+
+void Scheduler::print_utilization(std::ostream& out) const {
+    double alive = std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                       .count();
+    out << "===" << std::string(72, '-') << "===" << std::endl;
+    out << std::string(26, ' ') << "... Scheduler Utilization ..." << std::endl;
+    out << "===" << std::string(72, '-') << "===" << std::endl << std::endl;
+    out << std::right << std::setw(8) << "worker" << std::setw(10) << "tasks"
+        << std::setw(10) << "steals" << std::setw(12) << "busy (ms)" << std::setw(14)
+        << "utilization" << std::endl;
+    std::vector<WorkerStats> stats = get_worker_stats();
+    for (size_t i = 0; i < stats.size(); ++i) {
+        out << std::setw(8) << i << std::setw(10) << stats[i].tasks << std::setw(10)
+            << stats[i].steals << std::setw(12) << std::fixed << std::setprecision(1)
+            << stats[i].busy_seconds * 1000 << std::setw(13)
+            << stats[i].busy_seconds / alive * 100 << "%" << std::endl;
+    }
+    out << std::defaultfloat;
+}
+
+Scheduler::~Scheduler() {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping.store(true);
+        wake.notify_all();
+    }
+    for (auto& worker : workers) {
+        worker->thread.join();
+    }
+}
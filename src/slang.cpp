@@ -1,26 +1,76 @@
 #include "slang.hpp"
+#include <iomanip>
 
-Slang::Slang(const std::string& code) : code(std::move(code)), parser(this->code) {
+Slang::Slang(std::string code, int64_t fuel, bool stream)
+    : code(std::move(code)), tea(nullptr), irgen(nullptr), fuel(fuel), stream(stream) {
     debug << "[DEBUG] Slang initialized." << std::endl;
-    TeaSpill slang_program = parser.parse_tea();
-    debug << "[DEBUG] Tea parsed." << std::endl;
-    Codegen irgen;
-    debug << "[DEBUG] Codegen initialized." << std::endl;
-    if (irgen.generate_ir(slang_program)) {
+}
+
+size_t Slang::lex() const {
+    Lexer lexer(code);
+    size_t tokens = 0;
+    while (lexer.get_token().first != TokenType::END_OF_FILE) {
+        ++tokens;
+    }
+    debug << "[DEBUG] Tokens lexed: " << tokens << std::endl;
+    return tokens;
+}
+
+TeaSpill& Slang::parse() {
+    if (!tea) {
+        Parser parser(code);
+        tea = std::make_unique<TeaSpill>(parser.parse_tea());
+        debug << "[DEBUG] Tea parsed." << std::endl;
+    }
+    return *tea;
+}
+
+void Slang::check() {
+    Checker checker;
+    checker.check(parse());
+    debug << "[DEBUG] Tea checked." << std::endl;
+}
+
+void Slang::generate(llvm::raw_ostream* out) {
+    if (irgen) {
+        return;
+    }
+    irgen = std::make_unique<Codegen>();
+    if (fuel >= 0) {
+        irgen->enable_fuel_metering();
+    }
+    // Streaming never builds the whole AST, so it doesn't go through parse().
+    if (stream ? irgen->generate_ir_streamed(code, out) : irgen->generate_ir(parse())) {
         std::cerr << "[INFO] IR generated successfully." << std::endl;
     } else {
         std::cerr << "[ERROR] IR generation failed." << std::endl;
         exit(1);
     }
-    llvm_ir = irgen.output_ir();
+    if (!out) {
+        llvm_ir = irgen->output_ir();
+    }
 }
 
-void Slang::print_IR() const {
+void Slang::print_IR() {
+    generate();
     std::cout << llvm_ir << std::endl;
     return;
 }
 
 void Slang::write_to_file(const std::string& filename) {
+    // Streamed IR goes straight into the file, unless it was already generated (eg. to
+    // be printed).
+    if (stream && !irgen) {
+        std::error_code error;
+        llvm::raw_fd_ostream out(filename, error);
+        if (error) {
+            std::cerr << "[ERROR] " << error.message() << std::endl;
+            exit(1);
+        }
+        generate(&out);
+        return;
+    }
+    generate();
     try {
         std::ofstream out(filename);
         out << llvm_ir;
@@ -29,3 +79,106 @@ void Slang::write_to_file(const std::string& filename) {
         exit(1);
     }
 }
+
+int Slang::run_jit(const std::string& snapshot_dir, unsigned opt_level,
+                   const std::string& executor_path, const std::string& profile_file) {
+    // The cache and the profiler have to outlive the JIT, which tells them about the
+    // code it compiles and links.
+    std::unique_ptr<Profiler> profiler =
+        profile_file.empty() ? nullptr : std::make_unique<Profiler>();
+    std::unique_ptr<SnapshotCache> cache = nullptr;
+    if (!snapshot_dir.empty()) {
+        cache = std::make_unique<SnapshotCache>(
+            snapshot_dir, code,
+            "-O" + std::to_string(opt_level) + (fuel >= 0 ? " metered" : "") +
+                (profiler ? " profiled" : ""),
+            &Scheduler::get_shared());
+    }
+    Jit jit(cache.get(), opt_level, nullptr, executor_path);
+    if (profiler) {
+        jit.add_listener(*profiler);
+        // Only the declarations are parsed, for their lines.
+        Parser outline(code);
+        outline.parse_tea_header();
+        outline.parse_prototypes();
+        profiler->set_lines(outline.get_pluh_lines());
+    }
+    // With a snapshot of the program, the front end doesn't run past the header, which
+    // names the module the snapshot was compiled from.
+    std::unique_ptr<llvm::MemoryBuffer> snapshot =
+        cache && !irgen ? cache->load(Parser(code).parse_tea_header()) : nullptr;
+    if (snapshot) {
+        jit.add_object(std::move(snapshot));
+    } else {
+        generate();
+        std::unique_ptr<llvm::Module> module = irgen->take_module();
+        // The profiler walks the stack through the frame pointers.
+        if (profiler) {
+            for (llvm::Function& function : *module) {
+                function.addFnAttr("frame-pointer", "all");
+            }
+        }
+        jit.add_module(irgen->take_context(), std::move(module));
+    }
+    int result = run_main(jit, profiler.get());
+    if (cache) {
+        debug << "[DEBUG] Snapshots loaded: " << cache->get_hits()
+              << ", compiled: " << cache->get_misses() << std::endl;
+    }
+    if (profiler) {
+        std::ofstream out(profile_file);
+        profiler->write_collapsed(out);
+        std::cerr << "[INFO] Wrote " << profiler->get_sample_count() << " samples to "
+                  << profile_file;
+        if (profiler->get_dropped_count() > 0) {
+            std::cerr << " (" << profiler->get_dropped_count() << " dropped)";
+        }
+        std::cerr << "." << std::endl;
+    }
+    return result;
+}
+
+int Slang::run_pipelined(unsigned opt_level, const std::string& timeline_file) {
+    Pipeline pipeline;
+    if (fuel >= 0) {
+        pipeline.enable_fuel_metering();
+    }
+    Jit jit(nullptr, opt_level, &Scheduler::get_shared());
+    pipeline.compile(code, jit);
+    if (!timeline_file.empty()) {
+        std::ofstream out(timeline_file);
+        pipeline.write_timeline(out);
+    }
+    return run_main(jit);
+}
+
+void Slang::compile_executable(const std::string& executable_path, unsigned opt_level,
+                               const std::string& runtime_path) {
+    generate();
+    NativeCompiler compiler(opt_level, runtime_path);
+    // Declared first, so the module is freed before the context it belongs to.
+    std::unique_ptr<llvm::LLVMContext> context = irgen->take_context();
+    std::unique_ptr<llvm::Module> module = irgen->take_module();
+    compiler.compile(*module, executable_path);
+    std::cerr << std::fixed << std::setprecision(2) << "[INFO] Linked " << executable_path
+              << " in " << compiler.get_link_time() * 1000 << " ms ("
+              << compiler.get_linker() << ")." << std::endl;
+}
+
+int Slang::run_main(Jit& jit, Profiler* profiler) {
+    uint64_t main_pluh = jit.lookup("main");
+    // Only the program is sampled, not compiling it. On an error, the profiler stops
+    // once it's destroyed.
+    if (profiler) {
+        profiler->start();
+    }
+    int64_t fuel_left = fuel;
+    int result = fuel < 0 ? jit.run(main_pluh) : jit.run_with_fuel(main_pluh, fuel_left);
+    if (profiler) {
+        profiler->stop();
+    }
+    if (fuel >= 0) {
+        debug << "[DEBUG] Fuel used: " << fuel - fuel_left << " of " << fuel << std::endl;
+    }
+    return result;
+}
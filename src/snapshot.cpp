@@ -0,0 +1,201 @@
+#include "snapshot.hpp"
+#include "debug_stream.hpp"
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Support/xxhash.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// Version of the snapshot format, bumped whenever the header changes.
+static const uint32_t snapshot_version = 1;
+
+/**
+ * @brief Header of a snapshot file, followed by the object file.
+ *
+ * It's 64 bytes, so the object starts as aligned as the mapped file.
+ */
+struct SnapshotHeader {
+    char magic[8];         // "SLSNAP" and two zeros.
+    uint32_t version;      // Format version, snapshot_version.
+    uint32_t header_size;  // Size of this header.
+    uint64_t key;          // Hash of the key the snapshot was written for.
+    uint64_t object_size;  // Size of the object file.
+    uint64_t checksum;     // xxHash64 of the object file.
+    uint8_t reserved[24];  // Zeros.
+};
+static_assert(sizeof(SnapshotHeader) == 64, "Snapshot headers are 64 bytes");
+
+/**
+ * @brief The object file of a snapshot, keeping the whole file (mapped or read) alive.
+ */
+class SnapshotBuffer : public llvm::MemoryBuffer {
+  private:
+    std::unique_ptr<llvm::MemoryBuffer> file; // The snapshot file.
+  public:
+    SnapshotBuffer(std::unique_ptr<llvm::MemoryBuffer> file, llvm::StringRef object)
+        : file(std::move(file)) {
+        init(object.begin(), object.end(), false);
+    }
+
+    llvm::StringRef getBufferIdentifier() const override {
+        return file->getBufferIdentifier();
+    }
+
+    BufferKind getBufferKind() const override {
+        return file->getBufferKind();
+    }
+};
+
+SnapshotCache::SnapshotCache(const std::string& directory, const std::string& source,
+                             const std::string& options, Scheduler* scheduler)
+    : directory(directory),
+      source_hash(llvm::xxHash64(source)),
+      options(options),
+      scheduler(scheduler),
+      hits(0),
+      misses(0),
+      writes({}) {
+    // The JIT compiles for the host CPU and its features, so snapshots are only valid
+    // on the same CPU. The features are sorted since StringMap has no stable order.
+    llvm::StringMap<bool> features;
+    llvm::sys::getHostCPUFeatures(features);
+    std::vector<std::string> enabled = {};
+    for (auto& feature : features) {
+        if (feature.getValue()) {
+            enabled.push_back(feature.getKey().str());
+        }
+    }
+    std::sort(enabled.begin(), enabled.end());
+    host = llvm::sys::getProcessTriple() + "|" + llvm::sys::getHostCPUName().str();
+    for (const auto& feature : enabled) {
+        host += "+" + feature;
+    }
+
+    llvm::sys::fs::create_directories(directory);
+    debug << "[DEBUG] Snapshot cache in " << directory << " for " << host << std::endl;
+}
+
+uint64_t SnapshotCache::get_key(const std::string& module_name) const {
+    std::string key = llvm::utohexstr(source_hash) + "|" + options + "|" + module_name +
+                      "|" + host + "|" + LLVM_VERSION_STRING;
+    return llvm::xxHash64(key);
+}
+
+std::string SnapshotCache::get_snapshot_path(uint64_t key) const {
+    llvm::SmallString<128> path(directory);
+    llvm::sys::path::append(path, "slang-" + llvm::utohexstr(key) + ".snap");
+    return path.str().str();
+}
+
+void SnapshotCache::write_snapshot(const std::string& path, uint64_t key,
+                                   llvm::StringRef object) {
+    SnapshotHeader header = {};
+    std::memcpy(header.magic, "SLSNAP", 6);
+    header.version = snapshot_version;
+    header.header_size = sizeof(SnapshotHeader);
+    header.key = key;
+    header.object_size = object.size();
+    header.checksum = llvm::xxHash64(object);
+
+    // Write to a temporary file of this writer's own first, so a concurrent run never
+    // loads half a snapshot and two runs writing the same one don't mix their bytes.
+    int fd = -1;
+    llvm::SmallString<128> temp_path;
+    std::error_code error = llvm::sys::fs::createUniqueFile(path + ".%%%%%%%%.tmp", fd,
+                                                            temp_path);
+    if (error) {
+        debug << "[DEBUG] Could not write snapshot: " << error.message() << std::endl;
+        return;
+    }
+    {
+        llvm::raw_fd_ostream out(fd, true);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out << object;
+        out.close();
+        if (out.has_error()) {
+            error = out.error();
+            out.clear_error();
+        }
+    }
+    if (error || (error = llvm::sys::fs::rename(temp_path, path))) {
+        debug << "[DEBUG] Could not write snapshot: " << error.message() << std::endl;
+        llvm::sys::fs::remove(temp_path);
+        return;
+    }
+    debug << "[DEBUG] Wrote snapshot: " << path << std::endl;
+}
+
+void SnapshotCache::notifyObjectCompiled(const llvm::Module* module,
+                                         llvm::MemoryBufferRef object) {
+    ++misses;
+    uint64_t key = get_key(module->getModuleIdentifier());
+    std::string path = get_snapshot_path(key);
+    if (!scheduler) {
+        write_snapshot(path, key, object.getBuffer());
+        return;
+    }
+
+    // The object is only valid during the call, so the task writes a copy.
+    auto write = scheduler->submit([path, key, copy = object.getBuffer().str()]() {
+        write_snapshot(path, key, copy);
+    });
+    std::lock_guard<std::mutex> lock(writes_mutex);
+    std::erase_if(writes, [](const auto& task) { return task->is_done(); });
+    writes.push_back(std::move(write));
+}
+
+std::unique_ptr<llvm::MemoryBuffer> SnapshotCache::getObject(const llvm::Module* module) {
+    return load(module->getModuleIdentifier());
+}
+
+std::unique_ptr<llvm::MemoryBuffer> SnapshotCache::load(const std::string& module_name) {
+    uint64_t key = get_key(module_name);
+    std::string path = get_snapshot_path(key);
+
+    // Large files are mapped rather than read.
+    auto file = llvm::MemoryBuffer::getFile(path, false, false);
+    if (!file) {
+        return nullptr;
+    }
+
+    // The checksum is the only check: a snapshot that's whole and was written for this
+    // key is loaded as it is, anything else (truncated, from another version of the
+    // format, ...) is ignored and the module compiled instead.
+    llvm::StringRef contents = (*file)->getBuffer();
+    SnapshotHeader header = {};
+    if (contents.size() >= sizeof(header)) {
+        std::memcpy(&header, contents.data(), sizeof(header));
+    }
+    llvm::StringRef object = contents.drop_front(sizeof(header));
+    if (contents.size() < sizeof(header) || std::memcmp(header.magic, "SLSNAP", 6) != 0 ||
+        header.version != snapshot_version || header.header_size != sizeof(header) ||
+        header.key != key || header.object_size != object.size() ||
+        header.checksum != llvm::xxHash64(object)) {
+        debug << "[DEBUG] Ignoring invalid snapshot: " << path << std::endl;
+        return nullptr;
+    }
+    ++hits;
+    debug << "[DEBUG] Loaded snapshot: " << path << std::endl;
+    return std::make_unique<SnapshotBuffer>(std::move(*file), object);
+}
+
+int SnapshotCache::get_hits() const {
+    return hits;
+}
+
+int SnapshotCache::get_misses() const {
+    return misses;
+}
+
+SnapshotCache::~SnapshotCache() {
+    // Writes never throw, failing to write a snapshot just means compiling again later.
+    if (scheduler) {
+        scheduler->wait(writes);
+    }
+}
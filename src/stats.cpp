@@ -0,0 +1,110 @@
+#include "stats.hpp"
+#include <algorithm>
+#include <deque>
+#include <iomanip>
+#include <iterator>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+std::atomic<bool> Statistic::enabled = false;
+
+// Every statistic, in the order they were registered. Function local so statistics
+// defined at namespace scope in other files can register before main. Recursive, since
+// statistics created at runtime register themselves while it's held.
+struct Registry {
+    std::recursive_mutex mutex;
+    std::vector<Statistic*> statistics;
+    std::deque<Statistic> dynamic; // Statistics created at runtime, never moved.
+};
+
+static Registry& get_registry() {
+    static Registry registry;
+    return registry;
+}
+
+// Returns the statistics that counted something, sorted by group and then by name.
+static std::vector<Statistic*> get_counted() {
+    Registry& registry = get_registry();
+    std::vector<Statistic*> counted = {};
+    {
+        std::lock_guard<std::recursive_mutex> lock(registry.mutex);
+        std::copy_if(registry.statistics.begin(), registry.statistics.end(),
+                     std::back_inserter(counted),
+                     [](Statistic* statistic) { return statistic->get_value() != 0; });
+    }
+    std::sort(counted.begin(), counted.end(), [](Statistic* lhs, Statistic* rhs) {
+        return std::tie(lhs->get_group(), lhs->get_name()) <
+               std::tie(rhs->get_group(), rhs->get_name());
+    });
+    return counted;
+}
+
+Statistic::Statistic(const std::string& group, const std::string& name,
+                     const std::string& description)
+    : group(group),
+      name(name),
+      description(description),
+      value(0) {
+    Registry& registry = get_registry();
+    std::lock_guard<std::recursive_mutex> lock(registry.mutex);
+    registry.statistics.push_back(this);
+}
+
+Statistic::~Statistic() {
+    Registry& registry = get_registry();
+    std::lock_guard<std::recursive_mutex> lock(registry.mutex);
+    registry.statistics.erase(
+        std::find(registry.statistics.begin(), registry.statistics.end(), this));
+}
+
+Statistic& Statistic::get(const std::string& group, const std::string& name,
+                          const std::string& description) {
+    Registry& registry = get_registry();
+    std::lock_guard<std::recursive_mutex> lock(registry.mutex);
+    for (Statistic* statistic : registry.statistics) {
+        if (statistic->group == group && statistic->name == name) {
+            return *statistic;
+        }
+    }
+    return registry.dynamic.emplace_back(group, name, description);
+}
+
+void Statistic::enable() {
+    enabled.store(true, std::memory_order_relaxed);
+}
+
+void Statistic::reset() {
+    Registry& registry = get_registry();
+    std::lock_guard<std::recursive_mutex> lock(registry.mutex);
+    for (Statistic* statistic : registry.statistics) {
+        statistic->value.store(0, std::memory_order_relaxed);
+    }
+}
+
+void Statistic::print(std::ostream& out) {
+    std::vector<Statistic*> counted = get_counted();
+    size_t group_width = 0;
+    for (Statistic* statistic : counted) {
+        group_width = std::max(group_width, statistic->get_group().size());
+    }
+    out << "===" << std::string(72, '-') << "===" << std::endl;
+    out << std::string(26, ' ') << "... Statistics Collected ..." << std::endl;
+    out << "===" << std::string(72, '-') << "===" << std::endl << std::endl;
+    for (Statistic* statistic : counted) {
+        out << std::right << std::setw(10) << statistic->get_value() << " " << std::left
+            << std::setw(group_width) << statistic->group << " - "
+            << statistic->description << std::endl;
+    }
+    out << std::right;
+}
+
+void Statistic::print_json(std::ostream& out) {
+    std::vector<Statistic*> counted = get_counted();
+    out << "{";
+    for (size_t i = 0; i < counted.size(); ++i) {
+        out << (i ? ",\n" : "\n") << "  \"" << counted[i]->group << "."
+            << counted[i]->name << "\": " << counted[i]->get_value();
+    }
+    out << "\n}" << std::endl;
+}
@@ -0,0 +1,125 @@
+#include "unicode.hpp"
+#include <algorithm>
+#include <cctype>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+size_t decode_utf8(const char* p, const char* end, char32_t& code_point) {
+    auto byte = [p](size_t i) { return static_cast<unsigned char>(p[i]); };
+    size_t length = 0;
+    char32_t least = 0; // Smallest code point of this length, below which it's overlong.
+    if (byte(0) < 0x80) {
+        code_point = byte(0);
+        return 1;
+    } else if ((byte(0) & 0xE0) == 0xC0) {
+        length = 2;
+        least = 0x80;
+        code_point = byte(0) & 0x1F;
+    } else if ((byte(0) & 0xF0) == 0xE0) {
+        length = 3;
+        least = 0x800;
+        code_point = byte(0) & 0x0F;
+    } else if ((byte(0) & 0xF8) == 0xF0) {
+        length = 4;
+        least = 0x10000;
+        code_point = byte(0) & 0x07;
+    } else {
+        return 0;
+    }
+    if (static_cast<size_t>(end - p) < length) {
+        return 0;
+    }
+    for (size_t i = 1; i < length; ++i) {
+        if ((byte(i) & 0xC0) != 0x80) {
+            return 0;
+        }
+        code_point = (code_point << 6) | (byte(i) & 0x3F);
+    }
+    if (code_point < least || code_point > 0x10FFFF ||
+        (code_point >= 0xD800 && code_point <= 0xDFFF)) {
+        return 0;
+    }
+    return length;
+}
+
+// Checks if a code point is in one of a sorted list of ranges.
+static bool in_ranges(const CodePointRange* ranges, size_t count, char32_t code_point) {
+    const CodePointRange* after =
+        std::upper_bound(ranges, ranges + count, code_point,
+                         [](char32_t point, const CodePointRange& range) {
+                             return point < range.first;
+                         });
+    return after != ranges && code_point <= (after - 1)->last;
+}
+
+bool is_xid_start(char32_t code_point) {
+    if (code_point < 0x80) {
+        return std::isalpha(static_cast<int>(code_point));
+    }
+    return in_ranges(xid_start_ranges, xid_start_ranges_count, code_point);
+}
+
+bool is_xid_continue(char32_t code_point) {
+    if (code_point < 0x80) {
+        return std::isalnum(static_cast<int>(code_point)) || code_point == '_';
+    }
+    return in_ranges(xid_continue_ranges, xid_continue_ranges_count, code_point);
+}
+
+const char* skip_identifier_ascii(const char* p, const char* end) {
+#if defined(__SSE2__)
+    // Bytes are compared as signed, so non-ASCII bytes (negative) match none of the
+    // ranges. Setting bit 5 folds upper case letters onto lower case ones.
+    const __m128i case_bit = _mm_set1_epi8(0x20);
+    const __m128i before_a = _mm_set1_epi8('a' - 1);
+    const __m128i after_z = _mm_set1_epi8('z' + 1);
+    const __m128i before_0 = _mm_set1_epi8('0' - 1);
+    const __m128i after_9 = _mm_set1_epi8('9' + 1);
+    const __m128i underscore = _mm_set1_epi8('_');
+    const __m128i question = _mm_set1_epi8('?');
+    while (end - p >= 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i folded = _mm_or_si128(bytes, case_bit);
+        __m128i letter = _mm_and_si128(_mm_cmpgt_epi8(folded, before_a),
+                                       _mm_cmplt_epi8(folded, after_z));
+        __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(bytes, before_0),
+                                      _mm_cmplt_epi8(bytes, after_9));
+        __m128i other = _mm_or_si128(_mm_cmpeq_epi8(bytes, underscore),
+                                     _mm_cmpeq_epi8(bytes, question));
+        int matches =
+            _mm_movemask_epi8(_mm_or_si128(_mm_or_si128(letter, digit), other));
+        if (matches != 0xFFFF) {
+            return p + __builtin_ctz(~matches);
+        }
+        p += 16;
+    }
+#endif
+    while (p < end && (std::isalnum(static_cast<unsigned char>(*p)) || *p == '_' ||
+                       *p == '?')) {
+        ++p;
+    }
+    return p;
+}
+
+const char* skip_string_ascii(const char* p, const char* end) {
+#if defined(__SSE2__)
+    // A non-ASCII byte has its top bit set, which is all movemask looks at.
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i zero = _mm_setzero_si128();
+    while (end - p >= 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i stops = _mm_or_si128(_mm_cmpeq_epi8(bytes, quote),
+                                     _mm_cmpeq_epi8(bytes, zero));
+        int matches = _mm_movemask_epi8(_mm_or_si128(stops, bytes));
+        if (matches != 0) {
+            return p + __builtin_ctz(matches);
+        }
+        p += 16;
+    }
+#endif
+    while (p < end && *p != '"' && *p != '\0' && static_cast<unsigned char>(*p) < 0x80) {
+        ++p;
+    }
+    return p;
+}
@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+"""Generates src/unicode_tables.cpp, the XID_Start and XID_Continue ranges of the
+identifier characters outside ASCII, from the Unicode database Python was built with.
+
+Usage: python3 src/unicode_tables.py > src/unicode_tables.cpp
+"""
+
+import unicodedata
+
+
+def is_start(code_point):
+    return chr(code_point).isidentifier()
+
+
+def is_continue(code_point):
+    return ("a" + chr(code_point)).isidentifier()
+
+
+def ranges(predicate):
+    found, first = [], None
+    for code_point in range(0x80, 0x110000):
+        # Surrogates aren't characters, and can't be encoded in UTF-8.
+        matches = not 0xD800 <= code_point <= 0xDFFF and predicate(code_point)
+        if matches and first is None:
+            first = code_point
+        elif not matches and first is not None:
+            found.append((first, code_point - 1))
+            first = None
+    if first is not None:
+        found.append((first, 0x10FFFF))
+    return found
+
+
+def table(name, found):
+    lines = [f"const CodePointRange {name}[] = {{"]
+    line = "   "
+    for first, last in found:
+        entry = f" {{0x{first:X}, 0x{last:X}}},"
+        if len(line) + len(entry) > 90:
+            lines.append(line)
+            line = "   "
+        line += entry
+    lines.append(line)
+    lines.append("};")
+    lines.append(f"const size_t {name}_count =\n    sizeof({name}) / sizeof({name}[0]);")
+    return "\n".join(lines)
+
+
+version = unicodedata.unidata_version
+print(f"// Generated by src/unicode_tables.py from Unicode {version}. Don't edit.")
+print()
+print('#include "unicode.hpp"')
+print()
+print(table("xid_start_ranges", ranges(is_start)))
+print()
+print(table("xid_continue_ranges", ranges(is_continue)))
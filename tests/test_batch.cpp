@@ -0,0 +1,75 @@
+#include "batch.hpp"
+#include <gtest/gtest.h>
+
+bool debug_mode = false;
+DebugStream debug;
+
+// Returns a formula whose main yeets n * n through a helper pluh every formula shares
+// the name of.
+std::string square_formula(int n) {
+    return "spillingTeaAbout formula\n"
+           "pluh square(x : int) : int { yeet x * x }\n"
+           "pluh main() : int { yeet square(" +
+           std::to_string(n) + ") }";
+}
+
+// Test every formula of a batch gets its own pluhs, across several modules
+TEST(TestBatch, Compile) {
+    Scheduler scheduler(2);
+    BatchCompiler compiler("main", &scheduler, 16);
+    std::vector<std::string> sources = {};
+    for (int n = 0; n < 100; ++n) {
+        sources.push_back(square_formula(n));
+    }
+    std::vector<Formula> formulas = compiler.compile(sources);
+    ASSERT_EQ(formulas.size(), sources.size());
+    for (int n = 0; n < 100; ++n) {
+        ASSERT_TRUE(formulas[n].error.empty()) << formulas[n].error;
+        EXPECT_EQ(reinterpret_cast<int (*)()>(formulas[n].address)(), n * n);
+    }
+
+    // A later batch doesn't clash with the earlier one.
+    std::vector<Formula> more = compiler.compile({square_formula(12)});
+    EXPECT_EQ(reinterpret_cast<int (*)()>(more[0].address)(), 144);
+    EXPECT_EQ(reinterpret_cast<int (*)()>(formulas[3].address)(), 9);
+}
+
+// Test a broken formula only fails itself
+TEST(TestBatch, Errors) {
+    Scheduler scheduler(1);
+    BatchCompiler compiler("main", &scheduler);
+    std::vector<Formula> formulas = compiler.compile(
+        {square_formula(2), "spillingTeaAbout broken\npluh main() : int { yeet }",
+         "spillingTeaAbout broken\npluh main() : int { yeet missing }",
+         "spillingTeaAbout broken\npluh other() : int { yeet 1 }", square_formula(3)});
+    EXPECT_EQ(reinterpret_cast<int (*)()>(formulas[0].address)(), 4);
+    EXPECT_EQ(reinterpret_cast<int (*)()>(formulas[4].address)(), 9);
+    for (int i = 1; i <= 3; ++i) {
+        EXPECT_EQ(formulas[i].address, 0u);
+        EXPECT_FALSE(formulas[i].error.empty());
+    }
+    EXPECT_EQ(formulas[2].error, "Unknown variable: missing");
+    EXPECT_EQ(formulas[3].error, "No main pluh to call");
+}
+
+// Test bare expressions compile to functions of their variables and are cached
+TEST(TestBatch, Expression) {
+    BatchCompiler compiler;
+    std::vector<std::pair<std::string, std::string>> variables = {{"a", "int"},
+                                                                  {"b", "float"}};
+    Formula formula = compiler.compile_expression("a * b + 3", variables);
+    ASSERT_TRUE(formula.error.empty()) << formula.error;
+    EXPECT_EQ(reinterpret_cast<double (*)(int, double)>(formula.address)(2, 1.5), 6.0);
+
+    // The same expression spaced differently reuses the code, other signatures don't.
+    EXPECT_EQ(compiler.compile_expression(" a*b  +3 ", variables).address,
+              formula.address);
+    Formula as_int = compiler.compile_expression("a * b + 3", variables, "int");
+    EXPECT_NE(as_int.address, formula.address);
+    EXPECT_EQ(reinterpret_cast<int (*)(int, double)>(as_int.address)(2, 1.5), 6);
+
+    EXPECT_EQ(compiler.compile_expression("a + c", {{"a", "int"}}).error,
+              "Unknown variable: c");
+    EXPECT_FALSE(compiler.compile_expression("a +", {{"a", "int"}}).error.empty());
+    EXPECT_FALSE(compiler.compile_expression("a 1", {{"a", "int"}}).error.empty());
+}
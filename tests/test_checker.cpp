@@ -0,0 +1,112 @@
+#include "checker.hpp"
+#include "codegen.hpp"
+#include "parser.hpp"
+#include <gtest/gtest.h>
+
+bool debug_mode = false;
+DebugStream debug;
+
+// Parses and checks a program, returning the error the checker found or "" if none.
+std::string check(const std::string& code) {
+    Parser parser(code);
+    TeaSpill program = parser.parse_tea();
+    try {
+        Checker checker;
+        checker.check(program);
+    } catch (const codegen_error& e) {
+        return e.what();
+    }
+    return "";
+}
+
+// Parses a program and generates its IR, returning the error codegen reported or "" if
+// none.
+std::string generate(const std::string& code) {
+    Parser parser(code);
+    TeaSpill program = parser.parse_tea();
+    Codegen codegen;
+    testing::internal::CaptureStderr();
+    bool generated = codegen.generate_ir(program);
+    std::string output = testing::internal::GetCapturedStderr();
+    if (generated) {
+        return "";
+    }
+    // Errors are printed as "[ERROR] <error>\n".
+    return output.substr(8, output.size() - 9);
+}
+
+// Test valid programs pass the check, like they generate
+TEST(TestChecker, Valid) {
+    std::vector<std::string> programs = {
+        R"(spillingTeaAbout test
+        plug sqrt(x : float) : float
+        pluh main() : int {
+            cookUp x : int = twice(3)
+            cookUp c : char = 'a'
+            x = x + c * sqrt(2.0)
+            yap("%d %c\n", x, c)
+            holdUp (x > 0) {
+                fr? !x { ghost } justLikeThat? { x = x - 1 }
+                rizz
+            }
+            yeet x
+        }
+        pluh twice(x : int) : int { yeet x * 2 })",
+        R"(spillingTeaAbout test
+        pluh main() : int {
+            cookUp x : bool = 1 < 2.5
+            { cookUp y : float = x }
+            cookUp y : string = "shadow"
+            yeet y == "shadow"
+        })",
+    };
+    for (const auto& program : programs) {
+        EXPECT_EQ(check(program), "") << program;
+        EXPECT_EQ(generate(program), "") << program;
+    }
+}
+
+// Test invalid programs fail the check with the same error codegen reports
+TEST(TestChecker, Invalid) {
+    std::vector<std::pair<std::string, std::string>> programs = {
+        {"pluh main() : int { yeet missing }", "Unknown variable: missing"},
+        {"pluh main() : int { cookUp x : int = 1 { cookUp y : int = 2 } yeet y }",
+         "Unknown variable: y"},
+        {"pluh main() : int { yeet other() }", "Unknown pluh called: other"},
+        {"pluh f(x : int) : int { yeet x } pluh main() : int { yeet f() }",
+         "Wrong number of arguments passed to pluh: f"},
+        {"pluh main() : int { cookUp x : int = \"no\" yeet x }",
+         "Cannot convert between incompatible types!"},
+        {"pluh main() : int { yeet 1 + \"no\" }",
+         "Operands of a binary operation have incompatible types!"},
+        {"pluh main() : int { cookUp s : string = \"no\" cookUp t : string = s + s "
+         "yeet 0 }",
+         "Operands of a binary operation have incompatible types!"},
+        {"pluh main() : int { cookUp s : string = \"no\" yap(-s) yeet 0 }",
+         "Cannot negate a value of type string"},
+        {"pluh main() : int { fr? \"no\" { yeet 1 } yeet 0 }",
+         "Condition must be an int, float, char or bool!"},
+        {"pluh main() : int { ghost yeet 0 }", "ghost used outside of a holdUp loop!"},
+        {"pluh main() : int { rizz yeet 0 }", "rizz used outside of a holdUp loop!"},
+        {"pluh main() : number { yeet 0 }", "Unknown type name: number"},
+        {"pluh main() : int { yeet 0 } pluh main() : int { yeet 1 }",
+         "Pluh defined more than once: main"},
+    };
+    for (const auto& [body, error] : programs) {
+        std::string program = "spillingTeaAbout test\n" + body;
+        EXPECT_EQ(check(program), error) << program;
+        EXPECT_EQ(generate(program), error) << program;
+    }
+}
+
+// Test the longest chain of operators the parser allows doesn't overflow the stack of the
+// checker or codegen, which recurse through its tree
+TEST(TestChecker, Long_Chain) {
+    std::string code = "spillingTeaAbout test\npluh main(n : int) : int {\n    yeet n";
+    for (int i = 1; i < 10000; ++i) {
+        code += " + n";
+    }
+    code += "\n}";
+    EXPECT_EQ(check(code), "");
+    EXPECT_EQ(generate(code), "");
+}
@@ -0,0 +1,132 @@
+#include "codegen.hpp"
+#include "parser.hpp"
+#include <gtest/gtest.h>
+
+bool debug_mode = false;
+DebugStream debug;
+
+// Parses the program and generates its IR, failing the test if either step fails.
+std::string generate(const std::string& code) {
+    Parser parser(code);
+    TeaSpill program = parser.parse_tea();
+    Codegen codegen;
+    EXPECT_TRUE(codegen.generate_ir(program));
+    return codegen.output_ir();
+}
+
+// Test Pluh and Yeet
+TEST(TestCodegen, Pluh_Yeet) {
+    std::string ir = generate(R"(spillingTeaAbout test
+    pluh main() : int {
+        yeet 1337
+    })");
+    EXPECT_NE(ir.find("define i32 @main()"), std::string::npos);
+    EXPECT_NE(ir.find("ret i32 1337"), std::string::npos);
+}
+
+// Test Plug and calling pluhs declared later
+TEST(TestCodegen, Plug_Forward_Call) {
+    std::string ir = generate(R"(spillingTeaAbout test
+    plug sqrt(x : float) : float
+    pluh main() : int {
+        yeet twice(3)
+    }
+    pluh twice(x : int) : int {
+        yeet x * 2 + sqrt(4.0)
+    })");
+    EXPECT_NE(ir.find("declare double @sqrt(double)"), std::string::npos);
+    EXPECT_NE(ir.find("call i32 @twice(i32 3)"), std::string::npos);
+    EXPECT_NE(ir.find("fptosi"), std::string::npos);
+}
+
+// Test holdUp, Ghost, Rizz, Fr?, Ong?, JustLikeThat?
+TEST(TestCodegen, Control_Flow) {
+    std::string ir = generate(R"(spillingTeaAbout test
+    pluh main() : int {
+        cookUp i : int = 0
+        holdUp i < 10 {
+            i = i + 1
+            fr? i % 2 == 0 {
+                rizz
+            } ong? i == 7 {
+                ghost
+            } justLikeThat? {
+                yap(i)
+            }
+        }
+        yeet i
+    })");
+    EXPECT_NE(ir.find("holdup:"), std::string::npos);
+    EXPECT_NE(ir.find("@printf"), std::string::npos);
+}
+
+// Test that unknown variables are reported instead of generating bad IR
+TEST(TestCodegen, Unknown_Variable) {
+    Parser parser(R"(spillingTeaAbout test
+    pluh main() : int {
+        yeet nope
+    })");
+    TeaSpill program = parser.parse_tea();
+    Codegen codegen;
+    EXPECT_FALSE(codegen.generate_ir(program));
+}
+
+// Test arithmetic on strings is reported like the checker does, rather than as invalid IR
+TEST(TestCodegen, String_Arithmetic) {
+    std::vector<std::pair<std::string, std::string>> programs = {
+        {"cookUp t : string = s + s",
+         "Operands of a binary operation have incompatible types!"},
+        {"yap(s * 2)", "Operands of a binary operation have incompatible types!"},
+        {"yap(-s)", "Cannot negate a value of type string"},
+    };
+    for (const auto& [statement, error] : programs) {
+        Parser parser("spillingTeaAbout test\npluh main() : int {\n"
+                      "    cookUp s : string = \"lang\"\n    " +
+                      statement + "\n    yeet 0\n}");
+        TeaSpill program = parser.parse_tea();
+        Codegen codegen;
+        testing::internal::CaptureStderr();
+        EXPECT_FALSE(codegen.generate_ir(program)) << statement;
+        EXPECT_EQ(testing::internal::GetCapturedStderr(), "[ERROR] " + error + "\n");
+    }
+}
+
+// Test streaming generates the same IR as generating from the whole AST
+TEST(TestCodegen, Streamed) {
+    std::string code = R"(spillingTeaAbout test
+    plug sqrt(x : float) : float
+    pluh main() : int {
+        yeet twice(3) + sqrt(4.0)
+    }
+    pluh twice(x : int) : int {
+        fr? x > 0 { yap("{") }
+        yeet x * 2
+    })";
+    Codegen streamed;
+    ASSERT_TRUE(streamed.generate_ir_streamed(code));
+    EXPECT_EQ(streamed.output_ir(), generate(code));
+
+    // Written out, each pluh is defined once and not declared again after.
+    std::string ir;
+    llvm::raw_string_ostream ir_stream(ir);
+    Codegen written;
+    ASSERT_TRUE(written.generate_ir_streamed(code, &ir_stream));
+    ir_stream.flush();
+    EXPECT_NE(ir.find("define i32 @twice(i32 %x)"), std::string::npos);
+    EXPECT_NE(ir.find("declare double @sqrt(double)"), std::string::npos);
+    EXPECT_EQ(ir.find("declare i32 @twice"), std::string::npos);
+    EXPECT_LT(ir.find("source_filename"), ir.find("define i32 @main()"));
+    EXPECT_EQ(ir.find("source_filename"), ir.rfind("source_filename"));
+
+    Codegen broken;
+    EXPECT_FALSE(broken.generate_ir_streamed(R"(spillingTeaAbout test
+    pluh main() : int { yeet 1 }
+    pluh other() : int { yeet nope })"));
+    Codegen twice;
+    EXPECT_FALSE(twice.generate_ir_streamed(R"(spillingTeaAbout test
+    pluh main() : int { yeet 1 }
+    pluh main() : int { yeet 2 })", &llvm::nulls()));
+    Codegen unterminated;
+    EXPECT_FALSE(unterminated.generate_ir_streamed(R"(spillingTeaAbout test
+    pluh main() : int { { yeet 1 })"));
+}
@@ -0,0 +1,62 @@
+#include "interner.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Test equal strings are interned once, into the same characters
+TEST(TestInterner, Intern) {
+    Interner interner;
+    std::string name = "rizz";
+    std::string_view interned = interner.intern(name);
+    EXPECT_EQ(interned, "rizz");
+    EXPECT_NE(interned.data(), name.data());
+    EXPECT_EQ(interned.data()[interned.size()], '\0');
+    EXPECT_EQ(interner.intern(std::string("rizz")).data(), interned.data());
+    EXPECT_NE(interner.intern("riz").data(), interned.data());
+    EXPECT_EQ(interner.intern("").size(), 0u);
+    EXPECT_EQ(interner.intern("").data(), interner.intern(std::string()).data());
+    EXPECT_EQ(interner.size(), 3u);
+}
+
+// Test interned strings stay put while the shards grow
+TEST(TestInterner, Grow) {
+    Interner interner(1, 4);
+    std::vector<std::string_view> interned = {};
+    for (int i = 0; i < 10000; ++i) {
+        interned.push_back(interner.intern("name" + std::to_string(i)));
+    }
+    EXPECT_EQ(interner.size(), 10000u);
+    for (int i = 0; i < 10000; ++i) {
+        ASSERT_EQ(interner.intern("name" + std::to_string(i)).data(), interned[i].data());
+        ASSERT_EQ(interned[i], "name" + std::to_string(i));
+    }
+}
+
+// Test threads interning the same strings at once all get the same copy of each
+TEST(TestInterner, Threads) {
+    Interner interner(2, 4);
+    const int strings = 5000;
+    std::vector<std::vector<std::string_view>> interned(8);
+    std::vector<std::thread> threads = {};
+    for (size_t thread = 0; thread < interned.size(); ++thread) {
+        threads.emplace_back([&, thread]() {
+            // Every thread starts somewhere else, so they race on different strings.
+            interned[thread].resize(strings);
+            for (int i = 0; i < strings; ++i) {
+                int string = (i + thread * 613) % strings;
+                interned[thread][string] = interner.intern("s" + std::to_string(string));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(interner.size(), size_t(strings));
+    for (int i = 0; i < strings; ++i) {
+        ASSERT_EQ(interned[0][i], "s" + std::to_string(i));
+        for (size_t thread = 1; thread < interned.size(); ++thread) {
+            ASSERT_EQ(interned[thread][i].data(), interned[0][i].data());
+        }
+    }
+}
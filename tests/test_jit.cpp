@@ -0,0 +1,229 @@
+#include "codegen.hpp"
+#include "jit.hpp"
+#include "parser.hpp"
+#include "snapshot.hpp"
+#include <algorithm>
+#include <csignal>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <thread>
+
+bool debug_mode = false;
+DebugStream debug;
+
+const std::string program = R"(spillingTeaAbout test
+pluh triangle(n : int) : int {
+    cookUp total : int = 0
+    holdUp (n > 0) {
+        total = total + n
+        n = n - 1
+    }
+    yeet total
+})";
+
+// JIT compiles the program (through the cache, if any) and runs triangle(n).
+int run_triangle(llvm::ObjectCache* cache, int n) {
+    Parser parser(program);
+    TeaSpill tea = parser.parse_tea();
+    Codegen codegen;
+    EXPECT_TRUE(codegen.generate_ir(tea));
+    Jit jit(cache);
+    jit.add_module(codegen.take_context(), codegen.take_module());
+    return reinterpret_cast<int (*)(int)>(jit.lookup("triangle"))(n);
+}
+
+// Test running code in the JIT
+TEST(TestJit, Run) {
+    EXPECT_EQ(run_triangle(nullptr, 100), 5050);
+}
+
+// Test a snapshot is written on the first run and loaded on the next
+TEST(TestJit, Snapshot_Warm_Start) {
+    std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / "slang_test_snapshots";
+    std::filesystem::remove_all(directory);
+
+    SnapshotCache cold(directory.string(), program);
+    EXPECT_EQ(run_triangle(&cold, 10), 55);
+    EXPECT_EQ(cold.get_hits(), 0);
+    EXPECT_EQ(cold.get_misses(), 1);
+
+    SnapshotCache warm(directory.string(), program);
+    EXPECT_EQ(run_triangle(&warm, 10), 55);
+    EXPECT_EQ(warm.get_hits(), 1);
+    EXPECT_EQ(warm.get_misses(), 0);
+
+    // A different source must not pick up the snapshot.
+    SnapshotCache other(directory.string(), program + "\n");
+    EXPECT_EQ(run_triangle(&other, 10), 55);
+    EXPECT_EQ(other.get_hits(), 0);
+
+    std::filesystem::remove_all(directory);
+}
+
+// Test a snapshot is loaded without its module, and a damaged one is compiled again
+TEST(TestJit, Snapshot_Load) {
+    std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / "slang_test_snapshot_load";
+    std::filesystem::remove_all(directory);
+    {
+        SnapshotCache cold(directory.string(), program);
+        EXPECT_EQ(run_triangle(&cold, 10), 55);
+    }
+
+    SnapshotCache warm(directory.string(), program);
+    std::unique_ptr<llvm::MemoryBuffer> snapshot = warm.load("test");
+    ASSERT_NE(snapshot, nullptr);
+    EXPECT_EQ(warm.load("other"), nullptr);
+    Jit jit;
+    jit.add_object(std::move(snapshot));
+    EXPECT_EQ(reinterpret_cast<int (*)(int)>(jit.lookup("triangle"))(100), 5050);
+
+    // Flip the last byte of the object, the checksum no longer matches.
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        std::fstream file(entry.path(), std::ios::in | std::ios::out | std::ios::binary);
+        file.seekg(-1, std::ios::end);
+        char last = static_cast<char>(file.get());
+        file.seekp(-1, std::ios::end);
+        file.put(static_cast<char>(~last));
+    }
+    SnapshotCache damaged(directory.string(), program);
+    EXPECT_EQ(damaged.load("test"), nullptr);
+    EXPECT_EQ(run_triangle(&damaged, 10), 55);
+    EXPECT_EQ(damaged.get_hits(), 0);
+    EXPECT_EQ(damaged.get_misses(), 1);
+
+    std::filesystem::remove_all(directory);
+}
+
+// Test runs writing the same snapshot at once each write a whole one of their own
+TEST(TestJit, Snapshot_Concurrent_Writes) {
+    std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / "slang_test_snapshot_writes";
+    std::filesystem::remove_all(directory);
+
+    // Each writer's object is filled with a byte of its own, so a mix of two is caught.
+    llvm::LLVMContext context;
+    llvm::Module module("test", context);
+    std::vector<std::string> objects;
+    for (int i = 0; i < 4; ++i) {
+        objects.push_back(std::string(1 << 22, static_cast<char>('a' + i)));
+    }
+    std::vector<std::thread> writers;
+    for (auto& object : objects) {
+        writers.emplace_back([&]() {
+            SnapshotCache cache(directory.string(), program);
+            cache.notifyObjectCompiled(&module, llvm::MemoryBufferRef(object, "test"));
+        });
+    }
+    for (auto& writer : writers) {
+        writer.join();
+    }
+
+    SnapshotCache cache(directory.string(), program);
+    std::unique_ptr<llvm::MemoryBuffer> snapshot = cache.load("test");
+    ASSERT_NE(snapshot, nullptr);
+    EXPECT_NE(std::find(objects.begin(), objects.end(), snapshot->getBuffer().str()),
+              objects.end());
+    size_t files = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        EXPECT_EQ(entry.path().extension(), ".snap");
+        ++files;
+    }
+    EXPECT_EQ(files, 1u);
+
+    std::filesystem::remove_all(directory);
+}
+
+// Test metered code runs to completion within its budget and is stopped past it
+TEST(TestJit, Fuel) {
+    auto run_metered = [](const std::string& source, int64_t& fuel) {
+        Parser parser(source);
+        TeaSpill tea = parser.parse_tea();
+        Codegen codegen;
+        codegen.enable_fuel_metering();
+        EXPECT_TRUE(codegen.generate_ir(tea));
+        Jit jit;
+        jit.add_module(codegen.take_context(), codegen.take_module());
+        return jit.run_with_fuel(jit.lookup("main"), fuel);
+    };
+    const std::string metered = program + "\npluh main() : int { yeet triangle(100) }";
+
+    int64_t fuel = 1000000;
+    EXPECT_EQ(run_metered(metered, fuel), 5050);
+    EXPECT_GT(fuel, 0);
+    EXPECT_LT(fuel, 1000000 - 100);
+
+    fuel = 50;
+    EXPECT_THROW(run_metered(metered, fuel), out_of_fuel_error);
+    EXPECT_EQ(fuel, 0);
+
+    fuel = 1000000;
+    EXPECT_THROW(run_metered(R"(spillingTeaAbout spin
+    pluh main() : int {
+        holdUp (facts) {}
+        yeet 0
+    })",
+                             fuel),
+                 out_of_fuel_error);
+}
+
+// Test running code in an executor process, which a crash only takes down
+TEST(TestJit, Out_Of_Process) {
+    Parser parser(program + R"(
+plug raise(signal : int) : int
+pluh main() : int { yeet triangle(100) }
+pluh crash() : int { yeet raise(11) })");
+    TeaSpill tea = parser.parse_tea();
+    Codegen codegen;
+    ASSERT_TRUE(codegen.generate_ir(tea));
+    Jit jit(nullptr, 2, nullptr, SLANG_EXECUTOR);
+    EXPECT_TRUE(jit.is_out_of_process());
+    jit.add_module(codegen.take_context(), codegen.take_module());
+    uint64_t main_pluh = jit.lookup("main");
+    EXPECT_EQ(jit.run(main_pluh), 5050);
+    EXPECT_EQ(jit.run(main_pluh), 5050);
+    EXPECT_THROW(jit.define_stub("stub", main_pluh), jit_error);
+    int64_t fuel = 100;
+    EXPECT_THROW(jit.run_with_fuel(main_pluh, fuel), jit_error);
+
+    EXPECT_THROW(jit.run(jit.lookup("crash")), executor_error);
+    EXPECT_THROW(jit.run(main_pluh), executor_error);
+
+    // The compiler carries on, and a new executor runs the code again.
+    EXPECT_EQ(run_triangle(nullptr, 10), 55);
+    Parser again(program + "\npluh main() : int { yeet triangle(10) }");
+    TeaSpill tea_again = again.parse_tea();
+    Codegen regenerated;
+    ASSERT_TRUE(regenerated.generate_ir(tea_again));
+    Jit restarted(nullptr, 2, nullptr, SLANG_EXECUTOR);
+    restarted.add_module(regenerated.take_context(), regenerated.take_module());
+    EXPECT_EQ(restarted.run(restarted.lookup("main")), 55);
+
+    EXPECT_THROW(Jit(nullptr, 2, nullptr, "/nonexistent/slang-executor"), jit_error);
+}
+
+// Test SIGPIPE is only ignored while a session has an executor, and the handler it had
+// before is put back once the last one ends
+TEST(TestJit, Out_Of_Process_Sigpipe) {
+    static void (*const handler)(int) = [](int) {};
+    auto current = []() {
+        struct sigaction action {};
+        sigaction(SIGPIPE, nullptr, &action);
+        return action.sa_handler;
+    };
+    std::signal(SIGPIPE, handler);
+    {
+        Jit first(nullptr, 2, nullptr, SLANG_EXECUTOR);
+        EXPECT_EQ(current(), SIG_IGN);
+        {
+            Jit second(nullptr, 2, nullptr, SLANG_EXECUTOR);
+        }
+        EXPECT_EQ(current(), SIG_IGN);
+    }
+    EXPECT_EQ(current(), handler);
+    EXPECT_THROW(Jit(nullptr, 2, nullptr, "/nonexistent/slang-executor"), jit_error);
+    EXPECT_EQ(current(), handler);
+    std::signal(SIGPIPE, SIG_DFL);
+}
@@ -1,5 +1,7 @@
 #include "lexer.hpp"
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <vector>
 
 bool debug_mode = false;
 DebugStream debug;
@@ -113,6 +115,45 @@ TEST(TestLexer, Literals) {
     EXPECT_EQ(lexer.get_token(), Token(TokenType::END_OF_FILE, ""));
 }
 
+// Test number literals are converted as they're lexed, in every base and format
+TEST(TestLexer, Number_Literals) {
+    Lexer lexer("0 1_000_000 0xFF 0XdEaD_bEeF 0b1010 0B1111_0000 18446744073709551615 "
+                "1. .5 6.02e23 1e-3 2.5E+2 3f 1_0.2_5");
+    uint64_t ints[] = {0, 1000000, 255, 0xDEADBEEF, 10, 240, 18446744073709551615u};
+    for (uint64_t value : ints) {
+        Token token = lexer.get_token();
+        EXPECT_EQ(token.first, TokenType::INT);
+        EXPECT_EQ(token.int_value, value) << token.second;
+    }
+    double floats[] = {1.0, 0.5, 6.02e23, 1e-3, 250.0, 3.0, 10.25};
+    for (double value : floats) {
+        Token token = lexer.get_token();
+        EXPECT_EQ(token.first, TokenType::FLOAT);
+        EXPECT_EQ(token.float_value, value) << token.second;
+    }
+    EXPECT_EQ(lexer.get_token(), Token(TokenType::END_OF_FILE, ""));
+
+    // The text is kept as it was written.
+    Lexer spelling("0x1_F");
+    EXPECT_EQ(spelling.get_token(), Token(TokenType::INT, "0x1_F"));
+
+    const char* invalid[] = {"1.2.3", "12abc", "0x", "0b102", "1__0", "1_", "1e", "1e+",
+                             ".", "0x1.5", "18446744073709551616", "1e999"};
+    for (const char* code : invalid) {
+        Lexer bad(code);
+        EXPECT_THROW(bad.get_token(), invalid_literal_error) << code;
+    }
+
+    // A literal ends where something other than a name starts.
+    Lexer operators("1+0x2*3.5)");
+    EXPECT_EQ(operators.get_token(), Token(TokenType::INT, "1"));
+    EXPECT_EQ(operators.get_token(), Token(TokenType::OPERATOR, "+"));
+    EXPECT_EQ(operators.get_token(), Token(TokenType::INT, "0x2"));
+    EXPECT_EQ(operators.get_token(), Token(TokenType::OPERATOR, "*"));
+    EXPECT_EQ(operators.get_token(), Token(TokenType::FLOAT, "3.5"));
+    EXPECT_EQ(operators.get_token(), Token(TokenType::COMPLEX, ")"));
+}
+
 // Test Pluh Defintion
 TEST(TestLexer, Pluh_Definition) {
     Lexer lexer("pluh func() 4");
@@ -281,6 +322,30 @@ TEST(TestLexer, Comments) {
     EXPECT_EQ(lexer.get_token(), Token(TokenType::END_OF_FILE, ""));
 }
 
+// Test identifiers that start like a comment, and comments running into the end
+TEST(TestLexer, Comment_Prefixes) {
+    Lexer lexer("Can Blob Cancelled\nUnblockedx Blocked Unblocke Unblocked Cancelled");
+    EXPECT_EQ(lexer.get_token(), Token(TokenType::IDENTIFIER, "Can"));
+    EXPECT_EQ(lexer.get_token(), Token(TokenType::IDENTIFIER, "Blob"));
+    EXPECT_EQ(lexer.get_token(), Token(TokenType::IDENTIFIER, "Unblockedx"));
+    EXPECT_EQ(lexer.get_token(), Token(TokenType::END_OF_FILE, ""));
+
+    Lexer unterminated("x Blocked Unblocke");
+    EXPECT_EQ(unterminated.get_token(), Token(TokenType::IDENTIFIER, "x"));
+    EXPECT_EQ(unterminated.get_token(), Token(TokenType::END_OF_FILE, ""));
+}
+
+// Test tokens cut off by the end of the input
+TEST(TestLexer, End_Of_Input) {
+    Lexer op("1 <");
+    EXPECT_EQ(op.get_token(), Token(TokenType::INT, "1"));
+    EXPECT_EQ(op.get_token(), Token(TokenType::OPERATOR, "<"));
+    EXPECT_EQ(op.get_token(), Token(TokenType::END_OF_FILE, ""));
+
+    Lexer character("'");
+    EXPECT_THROW(character.get_token(), invalid_literal_error);
+}
+
 // Test Yap Int
 TEST(TestLexer, Yap) {
     Lexer lexer("yap(0)");
@@ -311,4 +376,85 @@ TEST(TestLexer, Yap_Expression) {
     EXPECT_EQ(lexer.get_token(), Token(TokenType::INT, "2"));
     EXPECT_EQ(lexer.get_token(), Token(TokenType::COMPLEX, ")"));
     EXPECT_EQ(lexer.get_token(), Token(TokenType::END_OF_FILE, ""));
-}
\ No newline at end of file
+}
+// Lexes code written to a temporary file, reading it a chunk at a time
+std::vector<std::pair<Token, int>> lex_chunked(const std::string& code,
+                                               size_t chunk_size) {
+    FILE* file = std::tmpfile();
+    std::fputs(code.c_str(), file);
+    std::fflush(file);
+    std::rewind(file);
+    Lexer lexer(fileno(file), chunk_size);
+    std::vector<std::pair<Token, int>> tokens = {};
+    do {
+        Token token = lexer.get_token();
+        tokens.emplace_back(token, lexer.get_line());
+    } while (tokens.back().first.first != TokenType::END_OF_FILE);
+    std::fclose(file);
+    return tokens;
+}
+
+// Test tokens and comments spanning chunks come out as if lexed in one piece
+TEST(TestLexer, Chunked_Input) {
+    std::string code = "spillingTeaAbout chunks\n"
+                       "Cancelled a comment running over many chunks\n"
+                       "pluh main() : int {\n"
+                       "    Blocked a block\n comment Unblocke Unblocked\n"
+                       "    cookUp total : float = 1_000.5e+3 + 0xFF_FF + .25f\n"
+                       "    fr? total >= 12345678 { yap(\"a string over chunks\") }\n"
+                       "    ong? total != 0b1010 { yap('c') }\n"
+                       "    yeet 0\n"
+                       "}\n";
+    std::vector<std::pair<Token, int>> expected = {};
+    Lexer whole(code);
+    do {
+        Token token = whole.get_token();
+        expected.emplace_back(token, whole.get_line());
+    } while (expected.back().first.first != TokenType::END_OF_FILE);
+
+    for (size_t chunk_size : {1, 2, 3, 5, 7, 16, 4096}) {
+        std::vector<std::pair<Token, int>> tokens = lex_chunked(code, chunk_size);
+        ASSERT_EQ(tokens.size(), expected.size()) << "chunk size " << chunk_size;
+        for (size_t i = 0; i < tokens.size(); ++i) {
+            EXPECT_EQ(tokens[i], expected[i]) << "chunk size " << chunk_size;
+            EXPECT_EQ(tokens[i].first.int_value, expected[i].first.int_value);
+            EXPECT_EQ(tokens[i].first.float_value, expected[i].first.float_value);
+        }
+    }
+    EXPECT_THROW(lex_chunked("cookUp x : int = 12_345abc", 4), invalid_literal_error);
+    EXPECT_THROW(lex_chunked("yap(\"unterminated", 3), invalid_literal_error);
+}
+
+// Test identifiers and strings in other scripts, and invalid UTF-8
+TEST(TestLexer, Unicode) {
+    Lexer lexer("cookUp größe_2? : string = \"héllo, 世界\"\nyap(λ + café€)");
+    EXPECT_EQ(lexer.get_token(), Token(TokenType::LET, "cookUp"));
+    EXPECT_EQ(lexer.get_token(), Token(TokenType::IDENTIFIER, "größe_2?"));
+    EXPECT_EQ(lexer.get_token(), Token(TokenType::COMPLEX, ":"));
+    EXPECT_EQ(lexer.get_token(), Token(TokenType::IDENTIFIER, "string"));
+    EXPECT_EQ(lexer.get_token(), Token(TokenType::OPERATOR, "="));
+    EXPECT_EQ(lexer.get_token(), Token(TokenType::STRING, "héllo, 世界"));
+    EXPECT_EQ(lexer.get_token(), Token(TokenType::IDENTIFIER, "yap"));
+    EXPECT_EQ(lexer.get_token(), Token(TokenType::COMPLEX, "("));
+    EXPECT_EQ(lexer.get_token(), Token(TokenType::IDENTIFIER, "λ"));
+    EXPECT_EQ(lexer.get_token(), Token(TokenType::OPERATOR, "+"));
+    EXPECT_EQ(lexer.get_token(), Token(TokenType::IDENTIFIER, "café"));
+    EXPECT_EQ(lexer.get_token(), Token(TokenType::COMPLEX, "€"));
+    EXPECT_EQ(lexer.get_token(), Token(TokenType::COMPLEX, ")"));
+    EXPECT_EQ(lexer.get_token(), Token(TokenType::END_OF_FILE, ""));
+
+    // Characters split over chunks are put back together.
+    std::string code = "pluh naïve_名前() { yap(\"ünïcödé ✓ 𝄞\") }";
+    for (size_t chunk_size : {1, 2, 3}) {
+        std::vector<std::pair<Token, int>> tokens = lex_chunked(code, chunk_size);
+        EXPECT_EQ(tokens[1].first, Token(TokenType::IDENTIFIER, "naïve_名前"));
+        EXPECT_EQ(tokens[7].first, Token(TokenType::STRING, "ünïcödé ✓ 𝄞"));
+    }
+
+    for (std::string invalid : {"\xff", "caf\xc3", "x\xc0\xaf", "\"\xed\xa0\x80\""}) {
+        Lexer broken(invalid);
+        EXPECT_THROW(while (broken.get_token().first != TokenType::END_OF_FILE){},
+                     invalid_literal_error)
+            << invalid;
+    }
+}
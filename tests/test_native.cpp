@@ -0,0 +1,162 @@
+#include "codegen.hpp"
+#include "native.hpp"
+#include "parser.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+bool debug_mode = false;
+DebugStream debug;
+
+const std::string program = R"(spillingTeaAbout test
+pluh triangle(n : int) : int {
+    cookUp total : int = 0
+    holdUp (n > 0) {
+        total = total + n
+        n = n - 1
+    }
+    yeet total
+}
+pluh main() : int {
+    yap(triangle(100))
+    yap(0 - 42)
+    yap('s')
+    yap("lang")
+    yap(triangle(3) > 5)
+    yap(triangle(3) < 5)
+    yap(3.14159)
+    yap(0.0 - 2.5)
+    yap(0.0000005)
+    yap(1.0 / 3.0)
+    yap(123456789.987654321)
+    yeet 7
+})";
+
+// Compiles a program into an executable, against the runtime if there's one.
+void compile(const std::string& code, const std::string& executable,
+             const std::string& runtime) {
+    Parser parser(code);
+    TeaSpill tea = parser.parse_tea();
+    Codegen codegen;
+    ASSERT_TRUE(codegen.generate_ir(tea));
+    std::unique_ptr<llvm::LLVMContext> context = codegen.take_context();
+    std::unique_ptr<llvm::Module> module = codegen.take_module();
+    NativeCompiler(2, runtime).compile(*module, executable);
+}
+
+// Runs an executable, returning its output and setting its exit status.
+std::string run(const std::string& executable, int& status) {
+    FILE* pipe = popen(executable.c_str(), "r");
+    std::string output = "";
+    char buffer[256];
+    while (size_t read = fread(buffer, 1, sizeof(buffer), pipe)) {
+        output.append(buffer, read);
+    }
+    status = WEXITSTATUS(pclose(pipe));
+    return output;
+}
+
+class TestNative : public ::testing::Test {
+  protected:
+    std::filesystem::path directory;
+
+    // Every test gets a directory of its own, as ctest runs them in parallel processes.
+    void SetUp() override {
+        const ::testing::TestInfo* test =
+            ::testing::UnitTest::GetInstance()->current_test_info();
+        directory = std::filesystem::temp_directory_path() /
+                    ("slang_test_native_" + std::string(test->name()) + "_" +
+                     std::to_string(getpid()));
+        std::filesystem::create_directories(directory);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(directory);
+    }
+};
+
+// Test an executable linked against libc runs main and exits with what it yeets
+TEST_F(TestNative, Libc) {
+    std::string executable = (directory / "libc").string();
+    compile(program, executable, "");
+    int status = -1;
+    std::string output = run(executable, status);
+    EXPECT_EQ(status, 7);
+    EXPECT_EQ(output, "5050\n-42\ns\nlang\nfacts\ncap\n3.141590\n-2.500000\n0.000000\n"
+                      "0.333333\n123456789.987654\n");
+}
+
+// Test the static runtime prints exactly what libc does
+TEST_F(TestNative, Static_Runtime) {
+    std::string libc = (directory / "libc").string();
+    std::string executable = (directory / "static").string();
+    compile(program, libc, "");
+    compile(program, executable, SLANG_RUNTIME);
+    int libc_status = -1;
+    int status = -1;
+    std::string expected = run(libc, libc_status);
+    EXPECT_EQ(run(executable, status), expected);
+    EXPECT_EQ(status, libc_status);
+    // Nothing of libc is linked in.
+    EXPECT_LT(std::filesystem::file_size(executable), std::filesystem::file_size(libc));
+}
+
+// Test the link is timed, by the linker the build has
+TEST_F(TestNative, Link_Time) {
+    Parser parser(program);
+    TeaSpill tea = parser.parse_tea();
+    Codegen codegen;
+    ASSERT_TRUE(codegen.generate_ir(tea));
+    std::unique_ptr<llvm::LLVMContext> context = codegen.take_context();
+    std::unique_ptr<llvm::Module> module = codegen.take_module();
+    NativeCompiler compiler(2, SLANG_RUNTIME);
+    EXPECT_EQ(compiler.get_link_time(), 0);
+    compiler.compile(*module, (directory / "static").string());
+    EXPECT_GT(compiler.get_link_time(), 0);
+#ifdef SLANG_HAVE_LLD
+    EXPECT_EQ(compiler.get_linker(), "lld (in process)");
+#else
+    EXPECT_EQ(compiler.get_linker(), "ld");
+#endif
+    EXPECT_EQ(NativeCompiler().get_linker(), "cc");
+}
+
+// Test output bigger than the runtime's buffer is all written
+TEST_F(TestNative, Static_Runtime_Flushes) {
+    std::string executable = (directory / "static").string();
+    compile(R"(spillingTeaAbout test
+    pluh main() : int {
+        cookUp i : int = 0
+        holdUp (i < 10000) {
+            yap(i)
+            i = i + 1
+        }
+        yeet 0
+    })",
+            executable, SLANG_RUNTIME);
+    int status = -1;
+    std::string output = run(executable, status);
+    EXPECT_EQ(status, 0);
+    std::string expected = "";
+    for (int i = 0; i < 10000; ++i) {
+        expected += std::to_string(i) + "\n";
+    }
+    EXPECT_EQ(output, expected);
+}
+
+// Test plugging a libc function the static runtime lacks fails to link
+TEST_F(TestNative, Static_Runtime_Missing_Symbol) {
+    std::string code = R"(spillingTeaAbout test
+    plug getpid() : int
+    pluh main() : int {
+        yeet getpid() - getpid() + 3
+    })";
+    std::string executable = (directory / "static").string();
+    EXPECT_THROW(compile(code, executable, SLANG_RUNTIME), native_error);
+    compile(code, (directory / "libc").string(), "");
+    int status = -1;
+    run((directory / "libc").string(), status);
+    EXPECT_EQ(status, 3);
+}
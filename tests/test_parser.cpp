@@ -1,4 +1,225 @@
 #include <gtest/gtest.h>
 #include "parser.hpp"
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unistd.h>
 
-// TO DO
+bool debug_mode = false;
+DebugStream debug;
+
+// Most the time per byte may grow by when an input gets 4 times longer. It stays flat on
+// linear paths (or drops, as fixed costs spread out), and grows towards 4 times on
+// quadratic ones.
+const double max_growth = 1.5;
+
+// Returns the CPU time this thread has used, in nanoseconds. Unlike the wall clock, it
+// doesn't count time spent preempted, which would make longer inputs look slower.
+double thread_cpu_ns() {
+    timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+// Parses code, returning the nanoseconds it took per byte (the best of a few runs, to
+// keep noise out). Syntax errors are fine, only the time matters.
+double parse_ns_per_byte(const std::string& code) {
+    double best = 0;
+    for (int run = 0; run < 5; ++run) {
+        double start = thread_cpu_ns();
+        try {
+            Parser parser(code);
+            parser.parse_tea();
+        } catch (const std::exception&) {
+        }
+        double ns = thread_cpu_ns() - start;
+        best = run == 0 ? ns : std::min(best, ns);
+    }
+    return best / std::max<size_t>(1, code.size());
+}
+
+// Test a program parses into its declarations
+TEST(TestParser, Tea) {
+    Parser parser(R"(spillingTeaAbout test
+    plug yap(c : char) : npc
+    pluh square(x : int) : int { yeet x * x })");
+    TeaSpill tea = parser.parse_tea();
+    EXPECT_EQ(tea.get_name(), "test");
+    ASSERT_EQ(tea.get_declarations().size(), 2u);
+    auto& plug = std::get<PluhDeclaration>(tea.get_declarations()[0]);
+    auto& pluh = std::get<PluhDeclaration>(tea.get_declarations()[1]);
+    EXPECT_FALSE(plug.get_body().has_value());
+    EXPECT_EQ(pluh.get_prototype().get_name(), "square");
+}
+
+// Test a program can be parsed a declaration at a time, or as just its prototypes
+TEST(TestParser, Declarations) {
+    std::string code = R"(spillingTeaAbout test
+    plug yap(c : char) : npc
+    pluh square(x : int) : int { fr? x > 0 { yeet x * x } yap('}') yeet 0 }
+    pluh main() : int { yeet square(3) })";
+    Parser outline(code);
+    EXPECT_EQ(outline.parse_tea_header(), "test");
+    std::vector<Prototype> prototypes = outline.parse_prototypes();
+    ASSERT_EQ(prototypes.size(), 3u);
+    EXPECT_EQ(prototypes[1].get_name(), "square");
+    EXPECT_EQ(prototypes[2].get_name(), "main");
+
+    Parser parser(code);
+    parser.parse_tea_header();
+    size_t declarations = 0;
+    while (auto declaration = parser.parse_next_declaration()) {
+        EXPECT_EQ(declaration->get_prototype().get_name(),
+                  prototypes[declarations++].get_name());
+    }
+    EXPECT_EQ(declarations, 3u);
+}
+
+// Test int literals have to fit in 32 bits, though hex and binary ones may set the sign
+TEST(TestParser, Int_Range) {
+    EXPECT_EQ(Parser("2147483647").parse_int(), Literal<int>(2147483647));
+    EXPECT_EQ(Parser("0xFFFFFFFF").parse_int(), Literal<int>(-1));
+    EXPECT_EQ(Parser("0b1000_0000_0000_0000_0000_0000_0000_0000").parse_int(),
+              Literal<int>(std::numeric_limits<int>::min()));
+    EXPECT_THROW(Parser("2147483648").parse_int(), invalid_literal_error);
+    EXPECT_THROW(Parser("0x1_0000_0000").parse_int(), invalid_literal_error);
+    EXPECT_EQ(Parser("1_5e-1").parse_float(), Literal<double>(1.5));
+}
+
+// Returns what a literal expression holds, or "node" for any other expression.
+struct Describe {
+    template <typename T>
+    std::string operator()(const Literal<T>& node) {
+        std::ostringstream text;
+        text << std::setprecision(17) << node.get_value();
+        return text.str();
+    }
+
+    template <typename T>
+    std::string operator()(T&) {
+        return "node";
+    }
+};
+
+// Test expressions and statements are 8 byte handles that keep what they hold intact,
+// whether it's inline or boxed
+TEST(TestParser, Compact_Handles) {
+    static_assert(sizeof(Expression) == 8 && sizeof(Statement) == 8);
+    std::vector<std::pair<Expression, std::string>> literals;
+    literals.emplace_back(Literal<int>(std::numeric_limits<int>::min()), "-2147483648");
+    literals.emplace_back(Literal<double>(1.5), "1.5");
+    literals.emplace_back(Literal<double>(0.1), "0.10000000000000001");
+    literals.emplace_back(Literal<double>(1e300), "1.0000000000000001e+300");
+    literals.emplace_back(Literal<bool>(true), "1");
+    literals.emplace_back(Literal<char>('\xE9'), "\xE9");
+    literals.emplace_back(Literal<std::string>("tea"), "tea");
+    literals.emplace_back(std::make_unique<VariableExpression>("x"), "node");
+    for (auto& [expression, value] : literals) {
+        EXPECT_EQ(visit(Describe(), expression), value);
+    }
+    EXPECT_EQ(literals[1].first.get_kind(), Expression::Kind::Float);
+    EXPECT_EQ(literals[2].first.get_kind(), Expression::Kind::Float);
+
+    Expression expression = Parser("f(x * (y + 1.5), 'c')").parse_expression();
+    EXPECT_EQ(expression, Parser("f(x * (y + 1.5), 'c')").parse_expression());
+    EXPECT_NE(expression, Parser("f(x * (y + 2.5), 'c')").parse_expression());
+    Expression moved = std::move(expression);
+    ASSERT_NE(moved.get_if<CallExpression>(), nullptr);
+    EXPECT_EQ(moved.get_if<CallExpression>()->get_arguments().size(), 2u);
+    EXPECT_EQ(moved.get_if<BinaryExpression>(), nullptr);
+
+    Statement ghost = Parser("ghost").parse_statement();
+    EXPECT_EQ(ghost.get_kind(), Statement::Kind::Ghost);
+    EXPECT_EQ(ghost, Statement(GhostStatement()));
+    EXPECT_NE(ghost, Statement(RizzStatement()));
+    Statement yeet = Parser("yeet 0.25").parse_statement();
+    ASSERT_NE(yeet.get_if<YeetStatement>(), nullptr);
+    EXPECT_EQ(visit(Describe(), yeet.get_if<YeetStatement>()->get_yeet_expr()), "0.25");
+}
+
+// Test the line each pluh and plug is declared on is recorded
+TEST(TestParser, Pluh_Lines) {
+    Parser parser(R"(spillingTeaAbout lines
+plug printf(s : string) : int
+
+Cancelled A comment, then a pluh split over lines
+pluh
+    square(x : int) : int {
+    yeet x * x
+}
+pluh main() : int { yeet square(3) })");
+    parser.parse_tea();
+    const auto& lines = parser.get_pluh_lines();
+    EXPECT_EQ(lines.at("printf"), 2);
+    EXPECT_EQ(lines.at("square"), 6);
+    EXPECT_EQ(lines.at("main"), 9);
+}
+
+// Test parsing a program piped in or viewed, a few bytes at a time
+TEST(TestParser, Chunked_Input) {
+    std::string code = R"(spillingTeaAbout piped
+Blocked A comment
+over lines Unblocked
+pluh square(x : int) : int {
+    yeet x * x
+}
+pluh main() : int { yeet square(0x10) })";
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    ASSERT_EQ(write(fds[1], code.data(), code.size()), ssize_t(code.size()));
+    close(fds[1]);
+    Parser parser(fds[0], 3);
+    TeaSpill tea = parser.parse_tea();
+    close(fds[0]);
+    EXPECT_EQ(tea.get_name(), "piped");
+    EXPECT_EQ(tea.get_declarations().size(), 2);
+    EXPECT_EQ(parser.get_pluh_lines().at("square"), 4);
+    EXPECT_EQ(parser.get_pluh_lines().at("main"), 7);
+
+    // A view of the code is copied in the same chunks, and parses the same.
+    Parser view(std::string_view(code), 3);
+    EXPECT_EQ(view.parse_tea().get_declarations(), tea.get_declarations());
+    EXPECT_EQ(view.get_pluh_lines(), parser.get_pluh_lines());
+}
+
+// Test nesting past the limit is a syntax error rather than a stack overflow
+TEST(TestParser, Nesting_Limit) {
+    Parser shallow(std::string(500, '(') + "1" + std::string(500, ')'));
+    EXPECT_NO_THROW(shallow.parse_expression());
+
+    Parser deep(std::string(100000, '(') + "1" + std::string(100000, ')'));
+    EXPECT_THROW(deep.parse_expression(), parse_logic_error);
+
+    // Chained operators aren't nesting, only the depth of the tree they build is bounded.
+    std::string chain = "1";
+    for (int i = 0; i < 5000; ++i) {
+        chain += " + 1";
+    }
+    Parser flat_chain(chain);
+    EXPECT_NO_THROW(flat_chain.parse_expression());
+    Parser nested_chain(std::string(500, '(') + chain + std::string(500, ')'));
+    EXPECT_NO_THROW(nested_chain.parse_expression());
+    for (int i = 0; i < 100000; ++i) {
+        chain += " + 1";
+    }
+    Parser long_chain(chain);
+    EXPECT_THROW(long_chain.parse_expression(), parse_logic_error);
+}
+
+// Test every input of the regression corpus (slow inputs found by fuzzing the lexer and
+// parser, see fuzz/) still parses in linear time. Each input is timed whole and cut to
+// its first quarter, which keeps the structure that made it slow, only shorter.
+TEST(TestParser, Linear_Time) {
+    size_t inputs = 0;
+    for (const auto& entry : std::filesystem::directory_iterator(SLANG_CORPUS_DIR)) {
+        std::ifstream file(entry.path(), std::ios::binary);
+        std::string code((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+        double quarter = parse_ns_per_byte(code.substr(0, code.size() / 4));
+        EXPECT_LT(parse_ns_per_byte(code), quarter * max_growth) << entry.path();
+        ++inputs;
+    }
+    EXPECT_GT(inputs, 0u);
+}
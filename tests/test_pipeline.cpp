@@ -0,0 +1,71 @@
+#include "pipeline.hpp"
+#include <gtest/gtest.h>
+#include <set>
+#include <sstream>
+
+bool debug_mode = false;
+DebugStream debug;
+
+// Returns a program of a chain of pluhs, each calling the one declared after it, so
+// calls go forwards across modules.
+std::string chain(int length) {
+    std::string code = "spillingTeaAbout chain\n"
+                       "pluh main() : int { yeet p0(1) }\n";
+    for (int i = 0; i < length; ++i) {
+        code += "pluh p" + std::to_string(i) + "(x : int) : int { yeet " +
+                (i + 1 < length ? "p" + std::to_string(i + 1) + "(x + 1)" : "x") + " }\n";
+    }
+    return code;
+}
+
+// Test a program compiled on a pipeline runs, with pluhs spread over many modules
+TEST(TestPipeline, Compile) {
+    Scheduler scheduler(3);
+    Pipeline pipeline(&scheduler, 4, 2);
+    Jit jit;
+    pipeline.compile(chain(50), jit);
+    EXPECT_EQ(reinterpret_cast<int (*)()>(jit.lookup("main"))(), 50);
+
+    // Every declaration was parsed by the caller and generated on a worker.
+    std::set<std::string> threads = {};
+    size_t generated = 0;
+    for (const auto& event : pipeline.get_timeline()) {
+        threads.insert(event.thread);
+        generated += event.name.rfind("generate ", 0) == 0;
+        EXPECT_LE(event.start_us, event.end_us);
+    }
+    EXPECT_EQ(generated, 51u);
+    EXPECT_TRUE(threads.count("parser"));
+    EXPECT_GE(threads.size(), 2u);
+    for (const auto& thread : threads) {
+        EXPECT_TRUE(thread == "parser" || thread.rfind("worker ", 0) == 0) << thread;
+    }
+
+    std::stringstream timeline;
+    pipeline.write_timeline(timeline);
+    EXPECT_NE(timeline.str().find("\"traceEvents\""), std::string::npos);
+    EXPECT_NE(timeline.str().find("compile module 0"), std::string::npos);
+}
+
+// Test errors in any task stop the pipeline and reach the caller
+TEST(TestPipeline, Errors) {
+    Scheduler scheduler(2);
+    Pipeline pipeline(&scheduler, 1, 1);
+    Jit unknown_variable;
+    EXPECT_THROW(pipeline.compile(chain(20) + "pluh broken() : int { yeet nope }",
+                                  unknown_variable),
+                 codegen_error);
+    Jit syntax_error;
+    EXPECT_THROW(
+        pipeline.compile(chain(20) + "pluh broken() : int { yeet }", syntax_error),
+        parse_logic_error);
+    Jit redefinition;
+    EXPECT_THROW(pipeline.compile(chain(3) + "pluh p1(x : int) : int { yeet x }",
+                                  redefinition),
+                 codegen_error);
+
+    // Pluhs compiled earlier can't be defined again either.
+    Jit jit;
+    pipeline.compile(chain(3), jit);
+    EXPECT_THROW(pipeline.compile(chain(3), jit), jit_error);
+}
@@ -0,0 +1,119 @@
+#include "codegen.hpp"
+#include "jit.hpp"
+#include "parser.hpp"
+#include "profiler.hpp"
+#include <csignal>
+#include <gtest/gtest.h>
+#include <sstream>
+
+bool debug_mode = false;
+DebugStream debug;
+
+const std::string program = R"(spillingTeaAbout profiled
+pluh inner(n : int) : int {
+    cookUp total : int = 0
+    holdUp (n > 0) {
+        total = (total + n * 7) % 1000003
+        n = n - 1
+    }
+    yeet total
+}
+
+pluh outer(n : int) : int {
+    yeet inner(n)
+}
+
+pluh main() : int {
+    cookUp sum : int = 0
+    cookUp i : int = 0
+    holdUp (i < 40) {
+        sum = (sum + outer(1000000)) % 1000003
+        i = i + 1
+    }
+    yeet sum
+})";
+
+// JIT compiles the program at -O0 (so nothing is inlined) with frame pointers, and runs
+// main with the profiler sampling it.
+int run_profiled(Profiler& profiler) {
+    Parser parser(program);
+    TeaSpill tea = parser.parse_tea();
+    profiler.set_lines(parser.get_pluh_lines());
+    Codegen codegen;
+    EXPECT_TRUE(codegen.generate_ir(tea));
+    std::unique_ptr<llvm::Module> module = codegen.take_module();
+    for (llvm::Function& function : *module) {
+        function.addFnAttr("frame-pointer", "all");
+    }
+    Jit jit(nullptr, 0);
+    jit.add_listener(profiler);
+    jit.add_module(codegen.take_context(), std::move(module));
+    uint64_t main = jit.lookup("main");
+    profiler.start();
+    int result = jit.run(main);
+    profiler.stop();
+    return result;
+}
+
+// Test samples are resolved into the stack of pluhs they were taken in, with lines
+TEST(TestProfiler, Collapsed_Stacks) {
+    Profiler profiler;
+    run_profiled(profiler);
+    ASSERT_GT(profiler.get_sample_count(), 0u);
+    EXPECT_EQ(profiler.get_dropped_count(), 0u);
+
+    std::ostringstream out;
+    profiler.write_collapsed(out);
+    std::istringstream lines(out.str());
+    std::string line;
+    size_t in_inner = 0;
+    size_t total = 0;
+    while (std::getline(lines, line)) {
+        size_t count = std::stoul(line.substr(line.rfind(' ') + 1));
+        total += count;
+        if (line.rfind("main:15;outer:11;inner:2 ", 0) == 0) {
+            in_inner += count;
+        }
+    }
+    EXPECT_EQ(total, profiler.get_sample_count());
+    // The program spends nearly all of its time in inner's loop.
+    EXPECT_GT(in_inner * 10, total * 8) << out.str();
+}
+
+// Test samples past the capacity are dropped, and only one profiler runs at a time
+TEST(TestProfiler, Limits) {
+    Profiler small(1000, 1);
+    run_profiled(small);
+    EXPECT_EQ(small.get_sample_count(), 1u);
+    EXPECT_GT(small.get_dropped_count(), 0u);
+
+    Profiler first;
+    Profiler second;
+    first.start();
+    EXPECT_THROW(second.start(), profiler_error);
+    first.stop();
+    EXPECT_NO_THROW(second.start());
+    second.stop();
+
+    EXPECT_THROW(Profiler(0), profiler_error);
+}
+
+// Test stopping puts back the way SIGPROF was handled before starting
+TEST(TestProfiler, Previous_Handler) {
+    static void (*const handler)(int) = [](int) {};
+    auto current = []() {
+        struct sigaction action {};
+        sigaction(SIGPROF, nullptr, &action);
+        return action.sa_handler;
+    };
+    std::signal(SIGPROF, handler);
+    Profiler profiler;
+    run_profiled(profiler);
+    EXPECT_GT(profiler.get_sample_count(), 0u);
+    EXPECT_EQ(current(), handler);
+
+    std::signal(SIGPROF, SIG_DFL);
+    Profiler again;
+    run_profiled(again);
+    EXPECT_EQ(current(), SIG_DFL);
+}
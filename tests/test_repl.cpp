@@ -0,0 +1,137 @@
+#include "repl.hpp"
+#include <gtest/gtest.h>
+
+bool debug_mode = false;
+DebugStream debug;
+
+// Evaluates every entry in order, then returns what they printed to stdout.
+std::string eval_all(Repl& repl, const std::vector<std::string>& entries) {
+    testing::internal::CaptureStdout();
+    for (const auto& entry : entries) {
+        EXPECT_TRUE(repl.eval(entry)) << entry;
+    }
+    return testing::internal::GetCapturedStdout();
+}
+
+// Test pluhs and expressions across entries
+TEST(TestRepl, Pluh_Expression) {
+    std::stringstream log;
+    Repl repl(log);
+    std::string output = eval_all(repl, {"pluh square(x : int) : int { yeet x * x }",
+                                         "square(12)", "square(3) + 1.5"});
+    EXPECT_EQ(output, "144\n10.500000\n");
+    EXPECT_NE(log.str().find("compiled in"), std::string::npos);
+}
+
+// Test session variables keep their values between entries
+TEST(TestRepl, Session_Variables) {
+    std::stringstream log;
+    Repl repl(log);
+    std::string output =
+        eval_all(repl, {"cookUp total : int = 1",
+                        "holdUp (total < 100) { total = total * 2 }", "total",
+                        "yap(\"done\")"});
+    EXPECT_EQ(output, "128\ndone\n");
+}
+
+// Test a session variable's initializer reads the variable it shadows
+TEST(TestRepl, Shadowing) {
+    std::stringstream log;
+    Repl repl(log);
+    std::string output =
+        eval_all(repl, {"cookUp x : int = 5", "cookUp x : int = x + 1", "x",
+                        "cookUp x : float = x / 4.0", "x"});
+    EXPECT_EQ(output, "6\n1.500000\n");
+}
+
+// Test braces and parentheses in comments don't hold an entry open
+TEST(TestRepl, Comments) {
+    std::stringstream log;
+    Repl repl(log);
+    std::istringstream in("pluh f() : int { Cancelled a { in a comment\n"
+                          "    yeet 3 }\n"
+                          "f()\n"
+                          "Blocked ( on one line Unblocked 4\n"
+                          "Blocked { over\n"
+                          "two lines Unblocked 5\n");
+    testing::internal::CaptureStdout();
+    repl.run(in);
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), "3\n4\n5\n");
+    EXPECT_EQ(log.str().find("[ERROR]"), std::string::npos) << log.str();
+}
+
+// Test redefinitions replace the old definition without breaking the JIT
+TEST(TestRepl, Redefinition) {
+    std::stringstream log;
+    Repl repl(log);
+    std::string output =
+        eval_all(repl, {"pluh f() : int { yeet 1 }", "f()", "pluh f() : int { yeet 2 }",
+                        "f()", "cookUp f_value : float = f()", "f_value"});
+    EXPECT_EQ(output, "1\n2\n2.000000\n");
+}
+
+// Test redefining a pluh hot reloads it for pluhs compiled earlier too
+TEST(TestRepl, Hot_Reload) {
+    std::stringstream log;
+    Repl repl(log);
+    std::string output = eval_all(
+        repl, {"pluh f(x : int) : int { yeet x + 1 }", "pluh g() : int { yeet f(10) }",
+               "g()", "pluh f(x : int) : int { yeet x * 2 }", "g()",
+               "pluh f(x : float) : float { yeet x / 4 }", "g()", "f(10)"});
+    EXPECT_EQ(output, "11\n20\n20\n2.500000\n");
+    EXPECT_NE(log.str().find("swapped in"), std::string::npos);
+
+    testing::internal::CaptureStdout();
+    EXPECT_TRUE(repl.reload(R"(spillingTeaAbout patch
+    pluh g() : int { yeet 7 }
+    pluh main() : int { yeet g() })",
+                            "g"));
+    EXPECT_FALSE(repl.reload("spillingTeaAbout patch", "g"));
+    EXPECT_TRUE(repl.eval("g()"));
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), "7\n");
+}
+
+// Test a hot pluh is specialized for its common argument and stays correct for others
+TEST(TestRepl, Specialization) {
+    std::stringstream log;
+    Repl repl(log);
+    std::string output = eval_all(
+        repl, {"pluh scale(x : int, by : int) : int { yeet x * by }",
+               "cookUp sum : int = 0",
+               "cookUp i : int = 0",
+               "holdUp (i < 2000) { sum = sum + scale(i, 3)\n i = i + 1 }", "sum",
+               "scale(5, 3)", "scale(5, 4)"});
+    EXPECT_EQ(output, "5997000\n15\n20\n");
+    EXPECT_NE(log.str().find("Specialized scale for by = 3"), std::string::npos);
+
+    repl.print_specializations();
+    EXPECT_NE(log.str().find("scale(#1 = 3): 1 hits, 1 misses (50.0% hit rate)"),
+              std::string::npos);
+}
+
+// Test a specialized clone refers to the variables the pluh was compiled against, not to
+// ones defined since with the same name
+TEST(TestRepl, Specialization_Bindings) {
+    std::stringstream log;
+    Repl repl(log);
+    std::string output = eval_all(
+        repl, {"cookUp x : int = 1", "pluh f(a : int) : int { yeet a + x }",
+               "cookUp x : int = 100", "f(0)", "cookUp sum : int = 0",
+               "cookUp i : int = 0",
+               "holdUp (i < 2000) { sum = sum + f(0)\n i = i + 1 }", "sum", "f(0)"});
+    EXPECT_NE(log.str().find("Specialized f for a = 0"), std::string::npos);
+    EXPECT_EQ(output, "1\n2000\n1\n");
+}
+
+// Test errors are reported and the session carries on
+TEST(TestRepl, Errors) {
+    std::stringstream log;
+    Repl repl(log);
+    testing::internal::CaptureStdout();
+    EXPECT_FALSE(repl.eval("missing + 1"));
+    EXPECT_FALSE(repl.eval("pluh broken( : int { yeet 1 }"));
+    EXPECT_FALSE(repl.eval("1 2"));
+    EXPECT_TRUE(repl.eval("40 + 2"));
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), "42\n");
+    EXPECT_NE(log.str().find("[ERROR] Unknown variable: missing"), std::string::npos);
+}
@@ -0,0 +1,130 @@
+#include "scheduler.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+// Test every task submitted runs once, from outside the workers
+TEST(TestScheduler, Submit) {
+    Scheduler scheduler(4);
+    EXPECT_EQ(scheduler.get_workers(), 4u);
+    EXPECT_EQ(scheduler.get_current_worker(), -1);
+    std::vector<std::atomic<int>> runs(1000);
+    std::vector<std::shared_ptr<Task>> tasks = {};
+    for (size_t i = 0; i < runs.size(); ++i) {
+        tasks.push_back(scheduler.submit([&, i]() { ++runs[i]; }));
+    }
+    scheduler.wait(tasks);
+    for (size_t i = 0; i < runs.size(); ++i) {
+        ASSERT_EQ(runs[i], 1) << i;
+        ASSERT_TRUE(tasks[i]->is_done());
+    }
+}
+
+// Test tasks only run once their dependencies have finished
+TEST(TestScheduler, Dependencies) {
+    Scheduler scheduler(3);
+    std::mutex mutex;
+    std::vector<int> order = {};
+    auto step = [&](int i) {
+        return [&, i]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(i);
+        };
+    };
+    auto first = scheduler.submit(step(0));
+    std::vector<std::shared_ptr<Task>> middle = {};
+    for (int i = 1; i <= 10; ++i) {
+        middle.push_back(scheduler.submit(step(i), {first}));
+    }
+    auto last = scheduler.submit(step(11), middle);
+    scheduler.wait(last);
+    ASSERT_EQ(order.size(), 12u);
+    EXPECT_EQ(order.front(), 0);
+    EXPECT_EQ(order.back(), 11);
+
+    // Depending on a finished task runs straight away.
+    auto after = scheduler.submit(step(12), {last});
+    scheduler.wait(after);
+    EXPECT_EQ(order.back(), 12);
+}
+
+// Test a task that throws fails the tasks depending on it, which don't run
+TEST(TestScheduler, Errors) {
+    Scheduler scheduler(2);
+    std::atomic<int> runs = 0;
+    auto broken = scheduler.submit([]() { throw std::runtime_error("broken"); });
+    auto fine = scheduler.submit([&]() { ++runs; });
+    auto dependent = scheduler.submit([&]() { ++runs; }, {fine, broken});
+    EXPECT_THROW(scheduler.wait(dependent), std::runtime_error);
+    EXPECT_TRUE(dependent->is_done());
+    EXPECT_NO_THROW(scheduler.wait(fine));
+    EXPECT_EQ(runs, 1);
+
+    // Waiting for a list rethrows what the first task that threw threw.
+    auto other = scheduler.submit([]() { throw std::logic_error("other"); });
+    EXPECT_THROW(scheduler.wait({fine, other, broken}), std::logic_error);
+}
+
+// Test tasks can wait for the tasks they submit, even on a single worker
+TEST(TestScheduler, Nested) {
+    Scheduler scheduler(1);
+    std::function<long(int)> sum = [&](int depth) -> long {
+        if (depth == 0) {
+            return 1;
+        }
+        std::vector<long> parts(4);
+        std::vector<std::shared_ptr<Task>> tasks = {};
+        for (size_t i = 0; i < parts.size(); ++i) {
+            tasks.push_back(scheduler.submit([&, i]() { parts[i] = sum(depth - 1); }));
+        }
+        scheduler.wait(tasks);
+        return std::accumulate(parts.begin(), parts.end(), 0L);
+    };
+    long total = 0;
+    scheduler.wait(scheduler.submit([&]() {
+        EXPECT_EQ(scheduler.get_current_worker(), 0);
+        total = sum(4);
+    }));
+    EXPECT_EQ(total, 256);
+}
+
+// Test the workers count the tasks they ran
+TEST(TestScheduler, Stats) {
+    std::vector<std::shared_ptr<Task>> tasks = {};
+    std::vector<WorkerStats> stats = {};
+    {
+        Scheduler scheduler(2);
+        for (int i = 0; i < 100; ++i) {
+            tasks.push_back(scheduler.submit([]() {}));
+        }
+        scheduler.wait(tasks);
+        stats = scheduler.get_worker_stats();
+        std::stringstream out;
+        scheduler.print_utilization(out);
+        EXPECT_NE(out.str().find("Scheduler Utilization"), std::string::npos);
+    }
+    ASSERT_EQ(stats.size(), 2u);
+    uint64_t run = 0;
+    for (const auto& worker : stats) {
+        run += worker.tasks;
+        EXPECT_GE(worker.busy_seconds, 0.0);
+    }
+    EXPECT_EQ(run, 100u);
+}
+
+// Test destroying a scheduler runs the tasks still queued first
+TEST(TestScheduler, Drain) {
+    std::atomic<int> runs = 0;
+    {
+        Scheduler scheduler(2);
+        for (int i = 0; i < 100; ++i) {
+            scheduler.submit([&]() { ++runs; });
+        }
+    }
+    EXPECT_EQ(runs, 100);
+}
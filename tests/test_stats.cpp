@@ -0,0 +1,108 @@
+#include "codegen.hpp"
+#include "jit.hpp"
+#include "parser.hpp"
+#include "stats.hpp"
+#include <gtest/gtest.h>
+
+bool debug_mode = false;
+DebugStream debug;
+
+const std::string program = R"(spillingTeaAbout test
+pluh triangle(n : int) : int {
+    cookUp total : int = 2 * 3 - 6
+    holdUp (n > 0) {
+        total = total + n * (1 + (n - n))
+        n = n - 1
+    }
+    yeet total
+})";
+
+// Returns the value of a statistic registered by the compiler.
+uint64_t get_stat(const std::string& group, const std::string& name) {
+    return Statistic::get(group, name, "").get_value();
+}
+
+// Test statistics don't count anything until they're enabled
+TEST(TestStats, Disabled) {
+    Statistic counter("test", "disabled", "Number of things counted while disabled");
+    ++counter;
+    counter += 5;
+    counter.update_max(9);
+    EXPECT_EQ(counter.get_value(), 0u);
+}
+
+// Test counting, maximums and looking statistics up by name
+TEST(TestStats, Count) {
+    Statistic::enable();
+    Statistic counter("test", "count", "Number of things counted");
+    Statistic deepest("test", "deepest", "Deepest thing counted");
+    ++counter;
+    counter += 5;
+    deepest.update_max(3);
+    deepest.update_max(2);
+    EXPECT_EQ(counter.get_value(), 6u);
+    EXPECT_EQ(deepest.get_value(), 3u);
+    EXPECT_EQ(&Statistic::get("test", "count", ""), &counter);
+
+    Statistic& created = Statistic::get("test", "created", "Number of things created");
+    ++created;
+    EXPECT_EQ(&Statistic::get("test", "created", ""), &created);
+    EXPECT_EQ(get_stat("test", "created"), 1u);
+
+    std::stringstream json;
+    Statistic::print_json(json);
+    EXPECT_NE(json.str().find("\"test.count\": 6"), std::string::npos);
+    Statistic::reset();
+    EXPECT_EQ(counter.get_value(), 0u);
+}
+
+// Test the expression depth counts unary operators and call arguments
+TEST(TestStats, Expression_Depth) {
+    Statistic::enable();
+    Statistic::reset();
+    Parser parser("spillingTeaAbout test\n"
+                  "pluh f(a : int, b : int) : int {\n"
+                  "    yeet 1 + f(-(a * 2), b)\n"
+                  "}");
+    parser.parse_tea();
+    // 1 + f(...) -> f(...) -> -(...) -> a * 2 -> a
+    EXPECT_EQ(get_stat("parser", "max_expression_depth"), 5u);
+}
+
+// Test every stage of the compiler counts its work
+TEST(TestStats, Compile) {
+    Statistic::enable();
+    Statistic::reset();
+    Parser parser(program);
+    TeaSpill tea = parser.parse_tea();
+    Codegen codegen;
+    ASSERT_TRUE(codegen.generate_ir(tea));
+    Jit jit;
+    jit.add_module(codegen.take_context(), codegen.take_module());
+    EXPECT_EQ(reinterpret_cast<int (*)(int)>(jit.lookup("triangle"))(100), 5050);
+
+    EXPECT_EQ(get_stat("lexer", "tokens.def"), 1u);
+    EXPECT_EQ(get_stat("lexer", "tokens.while"), 1u);
+    EXPECT_EQ(get_stat("lexer", "tokens.identifier"), 16u);
+    EXPECT_EQ(get_stat("ast", "nodes.hold_ups"), 1u);
+    EXPECT_EQ(get_stat("ast", "nodes.binary"), 8u);
+    EXPECT_EQ(get_stat("parser", "statements"), 5u);
+    // total + n * (1 + (n - n)) is the deepest expression.
+    EXPECT_EQ(get_stat("parser", "max_expression_depth"), 5u);
+    EXPECT_EQ(get_stat("codegen", "pluhs"), 1u);
+    EXPECT_EQ(get_stat("codegen", "symbol_lookups"), 9u);
+    // 2 * 3 and then 6 - 6 fold away.
+    EXPECT_EQ(get_stat("codegen", "constant_folds"), 2u);
+    EXPECT_GT(get_stat("codegen", "instructions"), 0u);
+    EXPECT_EQ(get_stat("jit", "modules"), 1u);
+    EXPECT_GT(get_stat("jit", "instructions.before"),
+              get_stat("jit", "instructions.after"));
+
+    std::stringstream text;
+    Statistic::print(text);
+    EXPECT_NE(text.str().find("Statistics Collected"), std::string::npos);
+    EXPECT_NE(text.str().find("Number of holdUp statements built"), std::string::npos);
+    EXPECT_NE(text.str().find("Number of times InstCombinePass changed the IR"),
+              std::string::npos);
+    EXPECT_EQ(text.str().find("PassManager"), std::string::npos);
+}
@@ -0,0 +1,89 @@
+#include "unicode.hpp"
+#include <gtest/gtest.h>
+#include <cctype>
+#include <random>
+#include <string>
+
+// Decodes a whole string as one character
+size_t decode(const std::string& bytes, char32_t& code_point) {
+    return decode_utf8(bytes.data(), bytes.data() + bytes.size(), code_point);
+}
+
+// Test decoding characters of every length, and rejecting malformed ones
+TEST(TestUnicode, Decode) {
+    char32_t code_point = 0;
+    EXPECT_EQ(decode("a", code_point), 1u);
+    EXPECT_EQ(code_point, U'a');
+    EXPECT_EQ(decode("é", code_point), 2u);
+    EXPECT_EQ(code_point, U'é');
+    EXPECT_EQ(decode("世", code_point), 3u);
+    EXPECT_EQ(code_point, U'世');
+    EXPECT_EQ(decode("𝄞", code_point), 4u);
+    EXPECT_EQ(code_point, U'𝄞');
+
+    EXPECT_EQ(decode("\x80", code_point), 0u);         // A lone continuation byte
+    EXPECT_EQ(decode("\xc3", code_point), 0u);         // Cut off
+    EXPECT_EQ(decode("\xc3(", code_point), 0u);        // Not continued
+    EXPECT_EQ(decode("\xc0\xaf", code_point), 0u);     // Overlong '/'
+    EXPECT_EQ(decode("\xe0\x80\xaf", code_point), 0u); // Overlong '/'
+    EXPECT_EQ(decode("\xed\xa0\x80", code_point), 0u); // Surrogate
+    EXPECT_EQ(decode("\xf4\x90\x80\x80", code_point), 0u); // Past U+10FFFF
+    EXPECT_EQ(decode("\xff", code_point), 0u);
+}
+
+// Test classifying characters that may start or continue identifiers
+TEST(TestUnicode, Identifier_Characters) {
+    for (char32_t letter : {U'a', U'Z', U'é', U'λ', U'Ж', U'名', U'ب', U'𝑥'}) {
+        EXPECT_TRUE(is_xid_start(letter)) << uint32_t(letter);
+        EXPECT_TRUE(is_xid_continue(letter)) << uint32_t(letter);
+    }
+    // Digits, combining marks and connectors only continue identifiers.
+    for (char32_t part : {U'7', U'_', U'\u0663', U'\u0301', U'\u00b7', U'\u203f'}) {
+        EXPECT_FALSE(is_xid_start(part)) << uint32_t(part);
+        EXPECT_TRUE(is_xid_continue(part)) << uint32_t(part);
+    }
+    for (char32_t other :
+         {U' ', U'?', U'+', U'€', U'✓', U'😀', U'\u00a0', U'\U0010ffff'}) {
+        EXPECT_FALSE(is_xid_start(other)) << uint32_t(other);
+        EXPECT_FALSE(is_xid_continue(other)) << uint32_t(other);
+    }
+}
+
+// Test the vectorized skips stop where a byte at a time does, wherever the stop is
+TEST(TestUnicode, Skip_ASCII) {
+    auto identifier = [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '?';
+    };
+    auto string = [](char c) {
+        return c != '"' && c != '\0' && static_cast<unsigned char>(c) < 0x80;
+    };
+    const std::string stops = std::string(" \"'+-.:;(){}@[]`/\0\x7f\x80\xc3\xff", 22);
+    std::mt19937 random(7);
+    for (int round = 0; round < 2000; ++round) {
+        // Runs long enough to take a few vectors, then a stop somewhere.
+        std::string bytes(random() % 70, 'x');
+        for (char& byte : bytes) {
+            byte = "azAZ09_?mQ"[random() % 10];
+        }
+        if (!bytes.empty() && random() % 4 != 0) {
+            bytes[random() % bytes.size()] = stops[random() % stops.size()];
+        }
+        const char* begin = bytes.data();
+        const char* end = begin + bytes.size();
+        const char* expected = begin;
+        while (expected < end && identifier(*expected)) {
+            ++expected;
+        }
+        EXPECT_EQ(skip_identifier_ascii(begin, end), expected) << bytes;
+        for (char& byte : bytes) {
+            if (identifier(byte)) {
+                byte = "ab +{;!~\t"[random() % 9];
+            }
+        }
+        expected = begin;
+        while (expected < end && string(*expected)) {
+            ++expected;
+        }
+        EXPECT_EQ(skip_string_ascii(begin, end), expected) << bytes;
+    }
+}